@@ -16,6 +16,7 @@ contained in those ini files.
 #include "llvm/MC/MCInstrItineraries.h"
 #include "llvm/Target/TargetRegisterInfo.h"
 #include <map>
+#include <memory>
 
 namespace opt_sched {
 
@@ -26,10 +27,15 @@ class LLVMMachineModel : public MachineModel {
 public:
   // Use a config file to initialize the machine model.
   LLVMMachineModel(const string configFile);
-  // Convert information about the target machine into the
-  // optimal scheduler machine model
-  void convertMachineModel(const llvm::ScheduleDAGInstrs &dag,
-                           const llvm::RegisterClassInfo *regClassInfo);
+  // Get the machine model read from the config file and converted for the
+  // target of the given DAG. The model is converted once for each target and
+  // set of register limits, and shared by all the functions compiled for it.
+  // If machine models are generated, the instruction types found in a
+  // function are added to the model, so every call gets its own copy of the
+  // shared model instead.
+  static std::shared_ptr<LLVMMachineModel>
+  getModel(const string &configFile, const llvm::ScheduleDAGInstrs &dag,
+           const llvm::RegisterClassInfo *regClassInfo);
   // Pointer to register info for target
   const llvm::TargetRegisterInfo *registerInfo;
   MachineModelGenerator* getMMGen() { return MMGen.get(); }
@@ -40,6 +46,13 @@ private:
   bool shouldGenerateMM;
   // The machine model generator class.
   std::unique_ptr<MachineModelGenerator> MMGen;
+
+  // Copy a converted machine model, without its generator.
+  LLVMMachineModel(const LLVMMachineModel &other);
+  // Convert information about the target machine into the
+  // optimal scheduler machine model
+  void convertMachineModel(const llvm::ScheduleDAGInstrs &dag,
+                           const llvm::RegisterClassInfo *regClassInfo);
 };
 
 // Generate a machine model for a specific chip.
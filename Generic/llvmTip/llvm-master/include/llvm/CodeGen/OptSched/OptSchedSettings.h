@@ -0,0 +1,263 @@
+/*******************************************************************************
+Description:  Holds the scheduler settings read from sched.ini and
+              hotfuncs.ini, parsed into typed values. The files are read and
+              parsed once per process, when the first function is scheduled,
+              and the settings are never changed afterwards, so they can be
+              read by any thread without locking and without looking up the
+              settings by name while scheduling.
+Created:      Oct. 2026
+Last Update:  Oct. 2026
+*******************************************************************************/
+
+#ifndef OPTSCHED_SETTINGS_H
+#define OPTSCHED_SETTINGS_H
+
+#include "llvm/CodeGen/OptSched/basic/data_dep.h"
+#include "llvm/CodeGen/OptSched/basic/graph_trans.h"
+#include "llvm/CodeGen/OptSched/generic/config.h"
+#include "llvm/CodeGen/OptSched/sched_region/sched_budget.h"
+#include "llvm/CodeGen/OptSched/sched_region/sched_cache.h"
+#include "llvm/CodeGen/OptSched/sched_region/sched_region.h"
+#include "llvm/CodeGen/OptSched/spill/bb_spill.h"
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+// hack to print spills. Each thread sets it for the function it compiles, and
+// the register allocator reads it on the same thread. The regions, which may be
+// scheduled on other threads, get their own copy of it.
+extern thread_local bool OPTSCHED_gPrintSpills;
+
+namespace opt_sched {
+
+// The functions that a setting applies to.
+enum class FUNC_SELECTION { NONE, ALL, HOT_ONLY };
+
+// The schedules that simulated register allocation runs on
+// (SIMULATE_REGISTER_ALLOCATION).
+enum class SIM_REG_ALLOC {
+  NO,
+  HEURISTIC,
+  BEST,
+  BOTH,
+  // Like BOTH, and the heuristic schedule is taken if it spills less.
+  TAKE_SCHED_WITH_LEAST_SPILLS
+};
+
+struct OptSchedSettings {
+  // Reads sched.ini and hotfuncs.ini from the given directory into the
+  // global SchedulerOptions and parses them the first time it is called.
+  // Later calls return the same settings, regardless of the directory.
+  static const OptSchedSettings &load(const std::string &cfgDir);
+  // Parses the settings from the global SchedulerOptions, which the caller
+  // has loaded, the first time it is called. For tools that do not read
+  // sched.ini from a configuration directory; no function is hot for them.
+  // Later calls, and calls to load(), return the same settings.
+  static const OptSchedSettings &parseLoaded();
+  // Returns the settings parsed by load() or parseLoaded().
+  static const OptSchedSettings &get();
+
+  // Return true if the given selection includes the function with the given
+  // name.
+  bool isSelected(FUNC_SELECTION sel, const std::string &funcName) const;
+  // Return true if the region with the given name should be scheduled, given
+  // SCHEDULE_SPECIFIC_REGIONS and REGIONS_TO_SCHEDULE.
+  bool isRegionSelected(const std::string &regionName) const;
+
+  // The functions the OptScheduler is enabled for (USE_OPT_SCHED).
+  FUNC_SELECTION useOptSched;
+  // The functions whose spill counts are printed (PRINT_SPILL_COUNTS).
+  FUNC_SELECTION printSpills;
+  // The functions listed in hotfuncs.ini.
+  Config hotFunctions;
+  // Whether only the regions in regionsToSchedule are scheduled.
+  bool scheduleSpecificRegions;
+  // The names of the regions to schedule, of the form funcName:regionNum.
+  std::set<std::string> regionsToSchedule;
+
+  // Struct for setting the pruning strategy
+  Pruning prune;
+  // Struct for setting graph transformations to apply
+  GraphTransTypes graphTransTypes;
+  // If we should schedule for register pressure only and ignore ilp.
+  bool schedForRPOnly;
+  // Precision of latency info
+  LATENCY_PRECISION latencyPrecision;
+  // The maximum DAG size to be scheduled using precise latency information.
+  int maxDagSizeForLatencyPrecision;
+  // A time limit for the whole region (basic block) in milliseconds.
+  // Defaults to no limit.
+  int regionTimeout;
+  // A time limit for each schedule length in milliseconds.
+  int lengthTimeout;
+  // How to interpret the timeout value? Timeout per instruction or
+  // timout per block
+  bool isTimeoutPerInstruction;
+  // Whether to use the lower/upper bounds defined in the input file
+  bool useFileBounds;
+  // The minimum number of instructions that a block can contain to be
+  // processed by the optimal scheduler
+  int minDagSize;
+  // The maximum number of instructions that a block can contain to be
+  // processed by the optimal scheduler
+  int maxDagSize;
+  // The number of instructions in the windows that regions bigger than that
+  // are enumerated in, or 0 if regions are enumerated as a whole. Regions
+  // bigger than maxDagSize are scheduled in windows if this is set.
+  int windowSize;
+  // The minimum weight that a block must have to be processed by the optimal
+  // scheduler.
+  float minDagWeight;
+  // Treat data dependencies of type ORDER as data dependencies
+  bool treatOrderDepsAsDataDeps;
+  // The number of bits in the hash table used in history-based domination.
+  int16_t histTableHashBits;
+  // Whether to verify that calculated schedules are optimal. Defaults to NO.
+  bool verifySchedule;
+  // Whether to enumerate schedules containing stalls (no-op instructions).
+  // In certain cases, such as having unpipelined instructions, this may
+  // result in a better schedule. Defaults to YES
+  bool enumerateStalls;
+  // Whether to apply LLVM mutations to the DAG before scheduling
+  bool enableMutations;
+  // The weight of the spill cost in the objective function. This factor
+  // defines the importance of spill cost relative to schedule length. A good
+  // value for this factor should be found experimentally, but is is expected
+  // to be large on architectures with hardware scheduling like x86 (thus
+  // making spill cost minimization the primary objective) and smaller on
+  // architectures with in-order execution like SPARC (thus making scheduling
+  // the primary objective).
+  int spillCostFactor;
+  // Check spill cost sum at all points in the block for the enumerator's best
+  // schedule and the heuristic schedule. If the latter sum is smaller, take
+  // the heuristic schedule instead (if the heuristic sched length is not
+  // larger).
+  // This can happen, when the SPILL_COST_FUNCTION is not set to SUM.
+  bool checkSpillCostSum;
+  // Check the total number of conflicts among live ranges for the enumerator's
+  // best
+  // schedule and the heuristic schedule. If the latter is smaller, take
+  // the heuristic schedule instead (if the heuristic sched length is not
+  // larger).
+  // Check conflicts
+  bool checkConflicts;
+  // Force CopyFromReg instrs to be scheduled before all other instrs in the
+  // block
+  bool fixLiveIn;
+  // Force CopyToReg instrs to be scheduled after all other instrs in the block
+  bool fixLiveOut;
+  // The spill cost function to be used.
+  SPILL_COST_FUNCTION spillCostFunction;
+  // The maximum spill cost to process. Any block whose heuristic spill cost
+  // is larger than this value will not be processed by the optimal scheduler
+  // If this field is set to 0, there will be no limit; all blocks will be
+  // processed by the optimal scheduler
+  int maxSpillCost;
+  // The algorithm to use for determining the lower bound.
+  LB_ALG lowerBoundAlgorithm;
+  // The heuristic used for the list scheduler.
+  SchedPriorities heuristicPriorities;
+  // The heuristic used for the enumerator.
+  SchedPriorities enumPriorities;
+  // The other heuristics that the list scheduler tries after the main one.
+  std::vector<SchedPriorities> heuristicPortfolio;
+  // The number of times the list scheduler tries the main heuristic with ties
+  // broken at random.
+  int heuristicPortfolioRandomRuns;
+  // Check if Heuristic is set to ISO.
+  bool llvmScheduling;
+  // The number of threads used to enumerate a region. Any value larger than
+  // one enables parallel branch-and-bound enumeration.
+  int enumThreads;
+  // The depth of the enumeration tree at which a parallel enumeration is
+  // split into work items.
+  int enumSplitDepth;
+  // The number of threads building the ants of the ACO heuristic scheduler.
+  // Any value larger than one runs the ants as a parallel colony.
+  int acoThreads;
+  // Whether the members of a parallel colony that do not enumerate keep
+  // improving the schedule while the others enumerate.
+  bool acoWithEnum;
+  // Whether the heuristic schedule is found by the ACO scheduler rather than
+  // the list scheduler (USE_ACO).
+  bool useACO;
+  // The parameters of the ACO scheduler, named after their settings. Only
+  // parsed if useACO is set.
+  bool acoUseFixedBias;
+  int acoHeuristicImportance;
+  bool acoTournament;
+  int acoFixedBias;
+  float acoBiasRatio;
+  float acoLocalDecay;
+  float acoDecayFactor;
+  int acoAntsPerIteration;
+  bool acoTrace;
+  int acoStopIterations;
+  // The order in which the enumerator explores the branches of a node, and
+  // the number of them explored by a beam search.
+  ENUM_SEARCH enumSearchStrategy;
+  int beamWidth;
+  // The order in which the target schedule lengths are enumerated.
+  LENGTH_SEARCH lengthSearch;
+  // The number of threads solving the windows of a region concurrently.
+  int windowThreads;
+  // The lowest rate of improvement, in normalized cost units per second, at
+  // which the enumerator keeps going, or 0 for no limit.
+  float minImprovementRate;
+  // The smallest region whose spill cost lower bound is computed concurrently
+  // with its length lower bound, or 0 if no region's is. Always 0 when any
+  // other kind of parallel scheduling is enabled.
+  int minDagSizeForParallelBounds;
+  // The number of threads used to schedule the regions of a function
+  // concurrently. Any value larger than one enables batched scheduling, where
+  // regions are solved on a thread pool and their schedules are applied in
+  // finalizeSchedule().
+  int regionThreads;
+  // Whether to filter the schedules by their peak excess register pressure.
+  bool filterByPerp;
+  // The filter for blocks whose schedule is kept.
+  BLOCKS_TO_KEEP blocksToKeep;
+  // The schedules that simulated register allocation runs on, and whether
+  // they include the best schedule.
+  SIM_REG_ALLOC simRegAllocMode;
+  bool simRegAlloc;
+  // The compile-time budget in milliseconds, or 0 for none, and whether it is
+  // shared by the functions of a module.
+  Milliseconds compileTimeBudget;
+  bool isBudgetPerModule;
+  // Whether the weight of a region is the frequency of its block relative to
+  // the entry of the function, rather than 1 (REGION_WEIGHTS).
+  bool useFreqWeights;
+  // The percentile of dynamic weight that a region must rank at to be
+  // enumerated, and the maximum factor its timeouts are scaled by. Both are
+  // neutral if regions are scheduled concurrently, since the ranking then
+  // depends on the order in which the threads get to the regions.
+  float enumWeightPercentile;
+  float maxWeightTimeoutScale;
+  // The configured random seed, or 0 to seed from the current time.
+  int randomSeed;
+  // The persistent cache of schedules found in earlier compilations, or NULL
+  // if the cache is disabled. Its functions are safe to call from any thread.
+  std::unique_ptr<SchedCache> schedCache;
+
+  // The options for converting LLVM DAGs, named after their settings.
+  bool filterRegisterTypes;
+  bool generateMachineModel;
+  bool addDefinedAndNotUsedRegs;
+  bool addUsedAndNotDefinedRegs;
+  bool addLiveOutAndNotDefinedRegs;
+  bool useSimpleRegisterTypes;
+
+private:
+  OptSchedSettings() {}
+  OptSchedSettings(const OptSchedSettings &) = delete;
+  void operator=(const OptSchedSettings &) = delete;
+
+  // Parses the settings from the loaded configuration files.
+  void parse(const Config &schedIni);
+};
+
+} // end namespace opt_sched
+
+#endif
@@ -8,19 +8,23 @@
 #ifndef OPTSCHED_OPTSCHEDULER_H
 #define OPTSCHED_OPTSCHEDULER_H
 
+#include "llvm/CodeGen/MachineBlockFrequencyInfo.h"
+#include "llvm/CodeGen/MachineBranchProbabilityInfo.h"
 #include "llvm/CodeGen/MachineScheduler.h"
 #include "llvm/CodeGen/OptSched/OptSchedDagWrapper.h"
 #include "llvm/CodeGen/OptSched/OptSchedMachineWrapper.h"
+#include "llvm/CodeGen/OptSched/OptSchedSettings.h"
 #include "llvm/CodeGen/OptSched/basic/data_dep.h"
 #include "llvm/CodeGen/OptSched/basic/graph_trans.h"
 #include "llvm/CodeGen/OptSched/generic/config.h"
+#include "llvm/CodeGen/OptSched/sched_region/sched_budget.h"
+#include "llvm/CodeGen/OptSched/sched_region/sched_cache.h"
 #include "llvm/CodeGen/OptSched/sched_region/sched_region.h"
+#include "llvm/Support/ThreadPool.h"
 #include <chrono>
+#include <memory>
 #include <vector>
 
-#define HEUR_NAME_CNT 8
-#define HEUR_NAME_MAX_SIZE 10
-
 namespace opt_sched {
 class ScheduleDAGOptSched;
 
@@ -34,132 +38,138 @@ private:
   // Current machine scheduler context
   llvm::MachineSchedContext *context;
   // Wrapper object for converting LLVM information about target machine
-  // into the OptSched machine model
-  LLVMMachineModel model;
-  // A list of functions that are indicated as candidates for the
-  // OptScheduler
-  Config hotFunctions;
-  // Struct for setting the pruning strategy
-  Pruning prune;
-  // Struct for setting graph transformations to apply
-  GraphTransTypes graphTransTypes;
-  // If we should schedule for register pressure only and ignore ilp.
-  bool schedForRPOnly;
+  // into the OptSched machine model. It is shared with the other functions
+  // compiled for the same target, unless machine models are generated.
+  std::shared_ptr<LLVMMachineModel> model;
+  // The settings read from the configuration files, which are shared by all
+  // functions.
+  const OptSchedSettings &settings;
   // Flag indicating whether the optScheduler should be enabled for this
   // function
   bool optSchedEnabled;
-  // Precision of latency info
-  LATENCY_PRECISION latencyPrecision;
-  // The maximum DAG size to be scheduled using precise latency information.
-  int maxDagSizeForLatencyPrecision;
   // A time limit for the whole region (basic block) in milliseconds.
   // Defaults to no limit.
   int regionTimeout;
-  // Whether to use the lower/upper bounds defined in the input file
-  bool useFileBounds;
   // A time limit for each schedule length in milliseconds.
   int lengthTimeout;
-  // How to interpret the timeout value? Timeout per instruction or
-  // timout per block
-  bool isTimeoutPerInstruction;
-  // The minimum number of instructions that a block can contain to be
-  // processed by the optimal scheduler
-  int minDagSize;
-  // The maximum number of instructions that a block can contain to be
-  // processed by the optimal scheduler
-  int maxDagSize;
-  // Treat data dependencies of type ORDER as data dependencies
-  bool treatOrderDepsAsDataDeps;
-  // The number of bits in the hash table used in history-based domination.
-  int16_t histTableHashBits;
-  // Whether to verify that calculated schedules are optimal. Defaults to NO.
-  bool verifySchedule;
-  // Whether to enumerate schedules containing stalls (no-op instructions).
-  // In certain cases, such as having unpipelined instructions, this may
-  // result in a better schedule. Defaults to YES
-  bool enumerateStalls;
-  // Whether to apply LLVM mutations to the DAG before scheduling
-  bool enableMutations;
-  // The weight of the spill cost in the objective function. This factor
-  // defines the importance of spill cost relative to schedule length. A good
-  // value for this factor should be found experimentally, but is is expected
-  // to be large on architectures with hardware scheduling like x86 (thus
-  // making spill cost minimization the primary objective) and smaller on
-  // architectures with in-order execution like SPARC (thus making scheduling
-  // the primary objective).
-  int spillCostFactor;
-  // Check spill cost sum at all points in the block for the enumerator's best
-  // schedule and the heuristic schedule. If the latter sum is smaller, take
-  // the heuristic schedule instead (if the heuristic sched length is not
-  // larger).
-  // This can happen, when the SPILL_COST_FUNCTION is not set to SUM.
-  bool checkSpillCostSum;
-  // Check the total number of conflicts among live ranges for the enumerator's
-  // best
-  // schedule and the heuristic schedule. If the latter is smaller, take
-  // the heuristic schedule instead (if the heuristic sched length is not
-  // larger).
-  // Check conflicts
-  bool checkConflicts;
-  // Force CopyFromReg instrs to be scheduled before all other instrs in the
-  // block
-  bool fixLiveIn;
+  // The compile-time budget of this function, which replaces the fixed
+  // region timeouts when COMPILE_TIME_BUDGET is set. NULL otherwise.
+  std::unique_ptr<SchedBudget> funcBudget;
+  // The share of the module's budget that this function took, if the budget
+  // is per module.
+  Milliseconds moduleBudgetShare;
   // In ISO mode this is the original DAG before ISO conversion.
   std::vector<llvm::SUnit> originalDAG;
   // The schedule generated by LLVM for ISO mode.
   std::vector<int> ISOSchedule;
-  // Force CopyToReg instrs to be scheduled after all other instrs in the block
-  bool fixLiveOut;
-  // The spill cost function to be used.
-  SPILL_COST_FUNCTION spillCostFunction;
-  // The maximum spill cost to process. Any block whose heuristic spill cost
-  // is larger than this value will not be processed by the optimal scheduler
-  // If this field is set to 0, there will be no limit; all blocks will be
-  // processed by the optimal scheduler
-  int maxSpillCost;
-  // An array of possible OptSched heuristic names
-  char hurstcNames[HEUR_NAME_CNT][HEUR_NAME_MAX_SIZE];
-  // The algorithm to use for determining the lower bound. Valid values are
-  LB_ALG lowerBoundAlgorithm;
-  // The heuristic used for the list scheduler.
-  SchedPriorities heuristicPriorities;
-  // The heuristic used for the enumerator.
-  SchedPriorities enumPriorities;
-  // Check if Heuristic is set to ISO.
-  bool llvmScheduling;
   // The number of simulated register spills in this function
   int totalSimulatedSpills;
-  // Load config files for the OptScheduler and set flags
+  // The seed of the random numbers. Each region offsets it by its number, so
+  // that its random choices do not depend on the thread it is scheduled on or
+  // on the regions scheduled before it.
+  int randomSeed;
+  // The block frequencies of the function, from which the weights of its
+  // regions are taken when REGION_WEIGHTS is FREQUENCY. NULL otherwise. The
+  // frequencies are computed here rather than required from the pass
+  // manager, so that the other machine schedulers do not pay for them.
+  std::unique_ptr<llvm::MachineBranchProbabilityInfo> branchProbs;
+  std::unique_ptr<llvm::MachineBlockFrequencyInfo> blockFreqs;
+  // A region whose schedule is being searched for on the region thread pool.
+  struct DeferredRegion {
+    std::unique_ptr<LLVMDataDepGraph> dag;
+    std::unique_ptr<SchedRegion> region;
+    // The instruction of each DAG node, or NULL for the artificial nodes.
+    std::vector<llvm::MachineInstr *> instrs;
+    llvm::MachineBasicBlock *BB;
+    // The scheduling boundary below the region, or NULL if the region ends
+    // the block. Boundaries are never moved, so this stays valid while the
+    // other regions are scheduled.
+    llvm::MachineInstr *regionEnd;
+    UDT_HASHKEY cacheKey;
+    // Whether the schedule was taken from the schedule cache instead of being
+    // searched for.
+    bool isCachedSched;
+    int regionTimeout;
+    int lengthTimeout;
+    // The share of the function's budget taken by the region.
+    Milliseconds budgetShare;
+    bool filterByPerp;
+    BLOCKS_TO_KEEP blocksToKeep;
+    // The results of FindOptimalSchedule().
+    FUNC_RESULT rslt;
+    bool isEasy;
+    InstCount normBestCost;
+    InstCount bestSchedLngth;
+    InstCount normHurstcCost;
+    InstCount hurstcSchedLngth;
+    InstSchedule *sched;
+  };
+  // The regions of the current function that were queued in batched mode.
+  std::vector<std::unique_ptr<DeferredRegion>> deferredRegions;
+  // The thread pool solving the deferred regions. Declared after them so that
+  // it finishes its work before they are destroyed.
+  std::unique_ptr<llvm::ThreadPool> regionPool;
+  // Set up the flags of the function from the OptScheduler settings
   void loadOptSchedConfig();
-  // Get lower bound algorithm
-  LB_ALG parseLowerBoundAlgorithm() const;
-  // Get spill cost function
-  SPILL_COST_FUNCTION parseSpillCostFunc() const;
+  // Set up the compile-time budget of the function
+  void setupBudget();
+  // Compute the block frequencies of the function if the region weights are
+  // taken from them
+  void setupBlockFreqs();
+  // Return the weight of the current region: the frequency of its block
+  // relative to the entry block, or 1 if region weights are disabled.
+  float getRegionWeight() const;
+  // Return true if the size of a region with the given number of instructions
+  // is in the range that OptSched schedules. With windowed scheduling there is
+  // no upper limit.
+  bool isDagSizeInRange(int instCnt) const;
+  // Return true if a region with the given number of instructions is
+  // enumerated in windows
+  bool isDagWindowed(int instCnt) const;
+  // Return true if a schedule found in the schedule cache is taken as is
+  // instead of scheduling the region
+  bool isCachedSchedUsable(const SchedCacheEntry &entry) const;
+  // Create the schedule of a DAG stored in a schedule cache entry
+  InstSchedule *createCachedSched(DataDepGraph *dag,
+                                  const SchedCacheEntry &entry);
+  // Take the share of the function's budget for a region with the given
+  // number of instructions and derive the region's timeouts from it.
+  Milliseconds reserveBudget(int instCnt, int &rgnTimeout, int &lngthTimeout);
   // Return true if the OptScheduler should be enabled for the function this
   // ScheduleDAG was created for
   bool isOptSchedEnabled() const;
-  // get latency precision setting
-  LATENCY_PRECISION fetchLatencyPrecision() const;
-  // Get OptSched heuristic setting
-  SchedPriorities parseHeuristic(const std::string &str) const;
   // Return true if we should print spill count for the current function
   bool shouldPrintSpills();
   // Add node to llvm schedule
   void ScheduleNode(llvm::SUnit *SU, unsigned CurCycle);
   // Setup dag and calculate register pressue in region
   void SetupLLVMDag();
+  // Convert the LLVM DAG of the current region to an OptSched DAG.
+  LLVMDataDepGraph *createOptSchedDag();
+  // Create a scheduling region for the given DAG with the configured
+  // settings.
+  SchedRegion *createRegion(DataDepGraph *dag);
   // Check for a mismatch between LLVM and OptSched register pressure values.
   bool rpMismatch(InstSchedule* sched);
   // Discover liveness information generated by the region boundary.
   llvm::SmallVector<llvm::RegisterMaskPair, 8> discoverBoundaryLiveness();
   // Is simulated register allocation enabled.
   bool isSimRegAllocEnabled();
+  // Return true if the current region can be solved on the region thread
+  // pool. Regions whose conversion depends on the schedule that LLVM applies
+  // to them are scheduled serially.
+  bool isRegionDeferrable() const;
+  // Queue the current region on the region thread pool and give it LLVM's
+  // schedule until the search finishes.
+  void deferRegion();
+  // Wait for the deferred regions and apply the schedules found for them.
+  void finishDeferredRegions();
+  // Reorder the instructions of a deferred region to match its schedule.
+  void applyDeferredSched(const DeferredRegion &rgn);
 
 public:
   ScheduleDAGOptSched(llvm::MachineSchedContext *C);
   ~ScheduleDAGOptSched() {}
-  // System time that the scheduler was created
-  static std::chrono::milliseconds startTime;
   // The fallback LLVM scheduler
   void fallbackScheduler();
   // Print out total block spills for the function.
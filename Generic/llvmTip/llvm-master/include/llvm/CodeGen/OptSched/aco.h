@@ -3,34 +3,54 @@
 #ifndef OPTSCHED_ACO_H
 #define OPTSCHED_ACO_H
 
+#include "llvm/CodeGen/OptSched/aco_colony.h"
 #include "llvm/CodeGen/OptSched/basic/gen_sched.h"
 
 namespace opt_sched {
 
-typedef double pheremone_t;
-
-struct Choice {
-  SchedInstruction *inst;
-  double heuristic; // range 0 to 1
-};
+class RandomStream;
 
 class ACOScheduler : public ConstrainedScheduler {
 public:
   ACOScheduler(DataDepGraph *dataDepGraph, MachineModel *machineModel, InstCount upperBound, SchedPriorities priorities);
   virtual ~ACOScheduler();
   FUNC_RESULT FindSchedule(InstSchedule *schedule, SchedRegion *region);
+  // Keeps the colony of the region going after the heuristic phase, while
+  // other members enumerate. Replaces sched with any cheaper schedule found
+  // and shares its cost with the colony. Returns once the enumeration is
+  // over, the deadline has passed or the colony stops improving.
+  void ImproveSchedule(InstSchedule *sched, Milliseconds deadline);
   inline void UpdtRdyLst_(InstCount cycleNum, int slotNum);
 private:
   pheremone_t &Pheremone(SchedInstruction *from, SchedInstruction *to);
   pheremone_t &Pheremone(InstCount from, InstCount to);
-  double Score(SchedInstruction *from, Choice choice);
 
   void PrintPheremone();
 
-  SchedInstruction *SelectInstruction(std::vector<Choice> ready, SchedInstruction *lastInst);
+  // Computes the score of each ready instruction into scores_.
+  void ComputeScores(SchedInstruction *lastInst);
+  SchedInstruction *SelectInstruction(SchedInstruction *lastInst);
   void UpdatePheremone(InstSchedule *schedule);
-  InstSchedule *FindOneSchedule();
+  void FindOneSchedule(InstSchedule *schedule);
+  // Builds the schedule together with the other members of the colony.
+  FUNC_RESULT FindScheduleInColony_(InstSchedule *schedule_out);
+  // Combines the ants of all the members at the end of an iteration.
+  void CombineIteration_(int noImprovementMax);
+  // Applies the local pheromone decay along the given path.
+  void DecayPath_(const std::vector<InstCount> &path);
+  double RandDouble_(double min, double max);
+  // The pheromone table in use, which is the colony's in a colony.
   pheremone_t *pheremone_;
+  pheremone_t *ownPheremone_;
+  // The colony of the region, or NULL if the ants are built by one thread.
+  ACOColony *colony_;
+  int mmbrIndx_;
+  // The random number stream of this member of the colony. NULL outside a
+  // colony, where the global generator is used.
+  RandomStream *rndmStrm_;
+  // If not NULL, the instructions chosen by the current ant are recorded
+  // here and the local decay is left to the end of the iteration.
+  std::vector<InstCount> *antPath_;
   pheremone_t initialValue_;
   bool use_fixed_bias;
   int count_;
@@ -42,7 +62,14 @@ private:
   double decay_factor;
   int ants_per_iteration;
   bool print_aco_trace;
-  std::vector<double> scores(std::vector<Choice> ready, SchedInstruction *last);
+  // The instructions that may be scheduled in the current slot, along with
+  // their numbers and heuristic weights (the normalized priority raised to
+  // the heuristic importance), in contiguous arrays that are reused from one
+  // slot to the next.
+  std::vector<SchedInstruction *> readyInsts_;
+  std::vector<InstCount> readyNums_;
+  std::vector<double> readyWeights_;
+  std::vector<double> scores_;
 };
 
 }
@@ -0,0 +1,144 @@
+/*******************************************************************************
+Description:  Defines the state shared by the members of a parallel ant colony.
+              Each member is an ACO scheduler working on a private copy of the
+              region (DAG and BBWithSpill), so that the ants of an iteration
+              can be built by several threads at once. The members only read
+              the shared pheromone table while building their ants and meet at
+              the end of each iteration, where one of them combines the
+              results of all and updates the table in a single batch. Once the
+              heuristic phase is over, the members that do not enumerate may
+              keep improving the schedule while the others enumerate, and the
+              cost of their best schedule is shared as an upper bound.
+Created:      Oct. 2026
+Last Update:  Oct. 2026
+*******************************************************************************/
+
+#ifndef OPTSCHED_ACO_COLONY_H
+#define OPTSCHED_ACO_COLONY_H
+
+#include "llvm/CodeGen/OptSched/generic/defines.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace opt_sched {
+
+typedef double pheremone_t;
+
+class InstSchedule;
+
+class ACOColony {
+public:
+  // The results of the ants built by one member in the current iteration.
+  struct MmbrRslt {
+    // The member's cheapest ant, or NULL if it built none.
+    InstSchedule *bestSched;
+    // The instructions chosen by each of the member's ants, in order. The
+    // local pheromone decay along these paths is applied when the iteration
+    // is combined.
+    std::vector<std::vector<InstCount>> paths;
+  };
+
+  // Creates the state shared by mmbrCnt members scheduling a region of
+  // instCnt instructions. The first enumMmbrCnt members go on to enumerate
+  // after the heuristic phase. If runWithEnum is true, the other members keep
+  // the colony going until the enumeration is done. The random number streams
+  // of the members are seeded from the given seed.
+  ACOColony(int mmbrCnt, int enumMmbrCnt, InstCount instCnt, bool runWithEnum,
+            int32_t seed);
+  ~ACOColony();
+
+  // Returns the number of members in the colony.
+  inline int GetMmbrCnt() const { return mmbrCnt_; }
+  // Returns true if the given member enumerates after the heuristic phase.
+  inline bool IsEnumMmbr(int mmbrIndx) const {
+    return mmbrIndx < enumMmbrCnt_;
+  }
+  // Returns true if the other members keep improving the schedule while the
+  // enumeration runs.
+  inline bool RunsWithEnum() const { return runWithEnum_; }
+  // Returns the seed for the random number stream of the given member.
+  inline int32_t GetSeed(int mmbrIndx) const { return seed_ + mmbrIndx; }
+
+  // Returns the shared pheromone table, with one row per instruction plus
+  // one for the empty schedule, and one column per instruction.
+  inline pheremone_t *GetPheremone() { return pheremone_.data(); }
+  // Returns the number of entries in the pheromone table.
+  inline size_t GetPheremoneSize() const { return pheremone_.size(); }
+  // The value the local pheromone decay converges to.
+  inline pheremone_t GetInitVal() const { return initVal_; }
+  inline void SetInitVal(pheremone_t initVal) { initVal_ = initVal; }
+
+  // Returns the slot in which the given member leaves the results of its
+  // ants for the current iteration.
+  inline MmbrRslt &GetMmbrRslt(int mmbrIndx) { return mmbrRslts_[mmbrIndx]; }
+
+  // Waits until all members have called this function, then calls combine in
+  // exactly one of them while the others still wait, and returns in all.
+  // Everything the members wrote before calling this is visible to combine,
+  // and everything combine writes is visible to all members on return.
+  void Synchronize(const std::function<void()> &combine);
+
+  // The best schedule found by the colony in the heuristic phase. It is owned
+  // by the colony and only written by the combining member.
+  inline InstSchedule *GetBestSched() { return bestSched_; }
+  inline void SetBestSched(InstSchedule *sched) { bestSched_ = sched; }
+  // The number of combined iterations and of those in a row that did not
+  // improve the best schedule. Only updated by the combining member.
+  inline int GetIterCnt() const { return iterCnt_; }
+  inline void IncrmntIterCnt() { iterCnt_++; }
+  inline int GetNoImprvmntCnt() const { return noImprvmntCnt_; }
+  inline void SetNoImprvmntCnt(int cnt) { noImprvmntCnt_ = cnt; }
+  // Returns true once the combining member has ended the heuristic phase.
+  inline bool IsStopped() const { return isStopped_; }
+  inline void Stop() { isStopped_ = true; }
+
+  // Returns the best (normalized) cost found so far by the members that keep
+  // the colony going during the enumeration.
+  inline InstCount GetBestCost() const {
+    return bestCost_.load(std::memory_order_acquire);
+  }
+  // Lowers the shared best cost to the given cost if it is an improvement.
+  void UpdtBestCost(InstCount cost);
+
+  // Called by each enumerating member when its enumeration is over.
+  inline void EnumDone() { runngEnumCnt_.fetch_sub(1); }
+  // Returns true once all the enumerating members are done.
+  inline bool IsEnumDone() const { return runngEnumCnt_.load() <= 0; }
+
+  // Serializes the access to the pheromone table while the colony runs along
+  // with the enumeration, since the members then work at their own pace.
+  inline std::mutex &GetPheremoneLock() { return pheremoneLock_; }
+
+private:
+  int mmbrCnt_;
+  int enumMmbrCnt_;
+  bool runWithEnum_;
+  int32_t seed_;
+
+  std::vector<pheremone_t> pheremone_;
+  pheremone_t initVal_;
+  std::vector<MmbrRslt> mmbrRslts_;
+  InstSchedule *bestSched_;
+  int iterCnt_;
+  int noImprvmntCnt_;
+  bool isStopped_;
+
+  // The barrier at which the members meet at the end of each iteration. The
+  // generation number tells the waiting members that the barrier was passed.
+  std::mutex syncLock_;
+  std::condition_variable syncCond_;
+  int arrvdCnt_;
+  unsigned long gnrtn_;
+
+  std::atomic<InstCount> bestCost_;
+  std::atomic<int> runngEnumCnt_;
+  std::mutex pheremoneLock_;
+};
+
+} // end namespace opt_sched
+
+#endif
@@ -77,8 +77,13 @@ enum SUB_GRAPH_TYPE {
   SGT_DISC
 };
 
-// Graph transformations we should apply.
-typedef struct GraphTransTypes { bool staticNodeSup; } GraphTransTypes;
+// Graph transformations we should apply, and their options.
+typedef struct GraphTransTypes {
+  bool staticNodeSup;
+  // Whether static node superiority keeps making passes over the independent
+  // nodes until no more superior nodes are found.
+  bool multiPassNodeSup;
+} GraphTransTypes;
 
 // TODO(max): Document.
 const size_t MAX_INSTNAME_LNGTH = 160;
@@ -122,6 +127,7 @@ public:
   virtual SchedInstruction *GetLeafInst() = 0;
 
   void GetInstCntPerIssuType(InstCount instCntPerIssuType[]);
+  int16_t GetIssuTypeCnt() const { return issuTypeCnt_; }
   bool IncludesUnpipelined();
 
   virtual bool IsInGraph(SchedInstruction *inst) = 0;
@@ -185,8 +191,12 @@ public:
                           long number);
   // Returns the string ID of the graph as read from the input file.
   const char *GetDagID() const;
-  // Returns the weight of the graph, as read from the input file.
+  // Returns the weight of the graph, as read from the input file or set by
+  // SetWeight().
   float GetWeight() const;
+  // Sets the weight of the graph, an estimate of how often its instructions
+  // run.
+  void SetWeight(float weight);
 
   // Given an instruction number, return a pointer to the instruction object.
   SchedInstruction *GetInstByIndx(InstCount instIndx);
@@ -199,6 +209,15 @@ public:
   FUNC_RESULT SetupForSchdulng(bool cmputTrnstvClsr);
   // Update the Dep after applying graph transformations
   FUNC_RESULT UpdateSetupForSchdulng(bool cmputTrnstvClsr);
+  // Update the Dep after a graph transformation that added its edges with
+  // CreateEdgeIncrmntly(), which keeps the transitive closure, the
+  // topological order and the critical paths up to date, so that only the
+  // per-edge data is rebuilt.
+  void UpdateSetupForNewEdges();
+  // Returns the block holding the scheduling state of the instructions and
+  // the graph's edges in CSR form. Available once the graph has been set up
+  // for scheduling.
+  InstStateBlk *GetStateBlk() const { return stateBlk_; }
 
   // Returns transformations that we will apply to the graph
   std::unique_ptr<GraphTrans> *GetGraphTrans() { return graphTrans_; }
@@ -260,11 +279,19 @@ public:
   InstCount GetInstIndx(SchedInstruction *inst);
   InstCount GetRltvCrtclPath(SchedInstruction *ref, SchedInstruction *inst,
                              DIRECTION dir);
-  void SetCrntFrwrdLwrBound(SchedInstruction *inst);
+  // Copies the current forward lower bound of an instruction into the array
+  // of forward lower bounds. If a trail is given, the old value is recorded on
+  // it.
+  void SetCrntFrwrdLwrBound(SchedInstruction *inst, UndoTrail *trail = NULL);
   void SetSttcLwrBounds();
   void SetDynmcLwrBounds();
   void CreateEdge(SchedInstruction *frmNode, SchedInstruction *toNode,
                   int ltncy, DependenceType depType);
+  // Creates an edge in a graph that has been set up for scheduling with its
+  // transitive closure, updating the closure, the topological order and the
+  // critical paths locally. The edge must not close a cycle.
+  void CreateEdgeIncrmntly(SchedInstruction *frmNode, SchedInstruction *toNode,
+                           int ltncy, DependenceType depType);
   InstCount GetDistFrmLeaf(SchedInstruction *inst);
 
   void SetPrblmtc();
@@ -356,6 +383,10 @@ protected:
 
   bool wasSetupForSchduling_;
 
+  // The scheduling state of the instructions, laid out as a structure of
+  // arrays.
+  InstStateBlk *stateBlk_;
+
   int32_t lastBlkNum_;
 
   bool isPrblmtc_;
@@ -401,10 +432,15 @@ protected:
   void CmputCrtclPaths_();
   void CmputCrtclPathsFrmRoot_();
   void CmputCrtclPathsFrmLeaf_();
-  void CmputCrtclPathsFrmRcrsvScsr_(SchedInstruction *ref);
-  void CmputCrtclPathsFrmRcrsvPrdcsr_(SchedInstruction *ref);
-  void CmputRltvCrtclPaths_(DIRECTION dir);
+  // Recomputes the critical path in the given direction of an instruction
+  // whose neighbors in the opposite direction changed, and of the
+  // instructions that it reaches in that direction, for as long as the
+  // critical paths change.
+  void UpdtCrtclPaths_(SchedInstruction *inst, DIRECTION dir);
   void CmputBasicLwrBounds_();
+  // (Re)builds the state block from the current edges and topological order
+  // and moves the state of the instructions into it.
+  void BuildStateBlk_();
 
   void WriteNodeInfoToF2File_(FILE *file);
   void WriteDepInfoToF2File_(FILE *file);
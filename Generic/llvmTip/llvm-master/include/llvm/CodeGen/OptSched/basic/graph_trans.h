@@ -14,15 +14,13 @@ Last Update:  June. 2017
 #include "llvm/CodeGen/OptSched/sched_region/sched_region.h"
 #include <list>
 #include <memory>
+#include <vector>
 
 namespace opt_sched {
 
 // Types of graph transformations.
 enum TRANS_TYPE { TT_NSP = 0 };
 
-// Enable/disable graph transformation flags.
-typedef struct GraphTransFlags { bool multiPassNodeSup; } GraphTransFlags;
-
 // An abstract graph transformation class.
 class GraphTrans {
 
@@ -30,9 +28,11 @@ public:
   GraphTrans(DataDepGraph *dataDepGraph);
   virtual ~GraphTrans(){};
 
-  // Create a graph transformation of the specified type.
+  // Create a graph transformation of the specified type, with the options in
+  // the given set of transformations.
   static std::unique_ptr<GraphTrans>
-  CreateGraphTrans(TRANS_TYPE type, DataDepGraph *dataDepGraph);
+  CreateGraphTrans(TRANS_TYPE type, DataDepGraph *dataDepGraph,
+                   const GraphTransTypes &graphTransTypes);
 
   // Apply the graph transformation to the DataDepGraph.
   virtual FUNC_RESULT ApplyTrans() = 0;
@@ -43,16 +43,10 @@ public:
 
   void SetNumNodesInGraph(InstCount numNodesInGraph);
 
-  // Enable disable graph transformation options.
-  static GraphTransFlags GRAPHTRANSFLAGS;
-
 protected:
   // Find independent nodes in the graph. Nodes are independent if
   // no path exists between them.
   bool AreNodesIndep_(SchedInstruction *inst1, SchedInstruction *inst2);
-  // Update the recursive predecessor and successor lists after adding an edge
-  // between A and B.
-  void UpdatePrdcsrAndScsr_(SchedInstruction *nodeA, SchedInstruction *nodeB);
 
   DataDepGraph *GetDataDepGraph_() const;
   SchedRegion *GetSchedRegion_() const;
@@ -89,11 +83,21 @@ inline void GraphTrans::SetNumNodesInGraph(InstCount numNodesInGraph) {
 // Node superiority graph transformation.
 class StaticNodeSupTrans : public GraphTrans {
 public:
-  StaticNodeSupTrans(DataDepGraph *dataDepGraph);
+  StaticNodeSupTrans(DataDepGraph *dataDepGraph, bool multiPass);
 
   FUNC_RESULT ApplyTrans() override;
 
 private:
+  // Whether to keep making passes until no more superior nodes are found.
+  bool multiPass_;
+  // The number of register types.
+  int16_t regTypeCnt_;
+  // The number of registers of each type that each node defines, indexed by
+  // node number and then by register type.
+  std::vector<InstCount> defCntPerRegType_;
+
+  // Count the registers of each type that each node defines.
+  void CntDefsPerRegType_();
   // Return true if node A is superior to node B.
   bool NodeIsSuperior_(SchedInstruction *nodeA, SchedInstruction *nodeB);
   // Check if there is superiority involving nodes A and B. If yes, choose which
@@ -103,11 +107,12 @@ private:
   // Add an edge from node A to B and update the graph.
   void AddSuperiorEdge_(SchedInstruction *nodeA, SchedInstruction *nodeB);
   // Keep trying to find superior nodes until none can be found or there are no more independent nodes.
-  void nodeMultiPass_(std::list<std::pair<SchedInstruction *, SchedInstruction *>>);
+  void nodeMultiPass_(std::list<std::pair<SchedInstruction *, SchedInstruction *>> &indepNodes);
 };
 
-inline StaticNodeSupTrans::StaticNodeSupTrans(DataDepGraph *dataDepGraph)
-    : GraphTrans(dataDepGraph) {}
+inline StaticNodeSupTrans::StaticNodeSupTrans(DataDepGraph *dataDepGraph,
+                                              bool multiPass)
+    : GraphTrans(dataDepGraph), multiPass_(multiPass) {}
 
 } // end namespace opt_sched
 
@@ -19,6 +19,59 @@ Last Update:  Sept. 2013
 
 namespace opt_sched {
 
+// Computes the priority keys of instructions for a given list of priority
+// schemes. A key holds a bit field for each scheme, with the first scheme in
+// the most significant bits, so comparing two keys compares the instructions
+// by the schemes in order.
+class PriorityKeyGen {
+public:
+  // Constructs a key generator for the specified dependence graph with the
+  // specified priorities.
+  PriorityKeyGen(DataDepGraph *dataDepGraph, SchedPriorities prirts);
+
+  // Returns the priorities, marked as dynamic if any of the schemes is.
+  const SchedPriorities &GetPrirts() const { return prirts_; }
+  // Returns the largest key that any instruction may get.
+  unsigned long GetMaxPriority() const { return maxPriority_; }
+
+  // Constructs the key of an instruction based on the schemes listed in
+  // prirts_. If this is an update of an existing key, changed is set to
+  // whether the key has changed.
+  unsigned long CmputKey(SchedInstruction *inst, bool isUpdate, bool &changed);
+
+private:
+  // An ordered vector of priorities
+  SchedPriorities prirts_;
+
+  // The maximum values for each part of the priority key.
+  InstCount maxUseCnt_;
+  InstCount maxCrtclPath_;
+  InstCount maxScsrCnt_;
+  InstCount maxLtncySum_;
+  InstCount maxNodeID_;
+  InstCount maxInptSchedOrder_;
+  unsigned long maxRndmVal_;
+
+  unsigned long maxPriority_;
+
+  // The number of bits for each part of the priority key.
+  int16_t useCntBits_;
+  int16_t crtclPathBits_;
+  int16_t scsrCntBits_;
+  int16_t ltncySumBits_;
+  int16_t nodeID_Bits_;
+  int16_t inptSchedOrderBits_;
+  int16_t rndmBits_;
+
+  // Returns the value of an instruction in the random order of LSH_RND.
+  unsigned long CmputRndmVal_(SchedInstruction *inst) const;
+  // Calculates a new priority key given an existing key of size keySize by
+  // appending bitCnt bits holding the value val, assuming val < maxVal.
+  static void AddPrirtyToKey_(unsigned long &key, int16_t &keySize,
+                              int16_t bitCnt, unsigned long val,
+                              unsigned long maxVal);
+};
+
 // A priority list of instruction that are ready to schedule at a given point
 // during the scheduling process.
 class ReadyList {
@@ -55,19 +108,6 @@ public:
   // Resets the list iterator to point back to the first instruction.
   void ResetIterator();
 
-  // Adds instructions at the bottoms of the given two lists which have
-  // not been added to the ready list already, and advance the internal time.
-  // TODO(max): Elaborate.
-  void AddLatestSubLists(LinkedList<SchedInstruction> *lst1,
-                         LinkedList<SchedInstruction> *lst2);
-
-  // Removes the most recently added sublist of instructions.
-  // TODO(max): Elaborate.
-  void RemoveLatestSubList();
-
-  // Copies this list to another. Both lists must be empty.
-  void CopyList(ReadyList *otherLst);
-
   // Searches the list for an instruction, returning whether it has been found
   // or not and writing the number of times it was found into hitCnt.
   bool FindInst(SchedInstruction *inst, int &hitCnt);
@@ -82,51 +122,130 @@ public:
   void Print(std::ostream &out);
 
 private:
-  // An ordered vector of priorities
-  SchedPriorities prirts_;
+  // The generator of the instructions' priority keys.
+  PriorityKeyGen keyGen_;
 
   // The priority list containing the actual instructions.
   PriorityList<SchedInstruction> *prirtyLst_;
 
-  // TODO(max): Document.
-  LinkedList<SchedInstruction> *latestSubLst_;
-
   // Array of pointers to KeyedEntry objects
   KeyedEntry<SchedInstruction, unsigned long> **keyedEntries_;
 
   // Is there a priority scheme that needs to be changed dynamically
   //    bool isDynmcPrirty_;
+};
 
-  // The maximum values for each part of the priority key.
-  InstCount maxUseCnt_;
-  InstCount maxCrtclPath_;
-  InstCount maxScsrCnt_;
-  InstCount maxLtncySum_;
-  InstCount maxNodeID_;
-  InstCount maxInptSchedOrder_;
+// The ready list of the enumerator. All the nodes on the current path of the
+// enumeration tree share a single list, kept in an array sorted by priority.
+// Instructions of equal priority are kept in the order in which they were
+// added. The changes that each node makes to the list are recorded in an undo
+// log and undone when the enumerator backtracks out of the node, so stepping
+// forward or backward costs only the changes made at that step, without
+// allocating or copying a list per node.
+class EnumReadyList {
+public:
+  // The state of the list that a tree node restores when the enumerator
+  // backtracks out of it.
+  struct State {
+    // The number of changes in the undo log.
+    InstCount logSize;
+    // The position of the iterator.
+    InstCount crntIndx;
+  };
 
-  unsigned long maxPriority_;
+  // Constructs a ready list for the specified dependence graph with the
+  // specified priorities.
+  EnumReadyList(DataDepGraph *dataDepGraph, SchedPriorities prirts);
+  // Destroys the ready list and deallocates the memory used by it.
+  ~EnumReadyList();
 
-  // The number of bits for each part of the priority key.
-  int16_t useCntBits_;
-  int16_t crtclPathBits_;
-  int16_t scsrCntBits_;
-  int16_t ltncySumBits_;
-  int16_t nodeID_Bits_;
-  int16_t inptSchedOrderBits_;
+  // Removes all instructions and logged changes from the list. The static
+  // priority keys are recomputed, so this must be called before each
+  // enumeration.
+  void Reset();
 
-  // Constructs the priority-list key based on the schemes listed in prirts_.
-  unsigned long CmputKey_(SchedInstruction *inst, bool isUpdate, bool &changed);
+  // Returns the current state of the list, to be restored by RestoreState()
+  // when undoing the changes made after this call.
+  State GetState() const;
+  // Undoes all the changes made since the given state was taken and restores
+  // the iterator.
+  void RestoreState(const State &state);
 
-  // Adds instructions at the bottom of a given list which have not been added
-  // to the ready list already.
-  void AddLatestSubList_(LinkedList<SchedInstruction> *lst);
+  // Returns the instructions in priority order, starting with the top
+  // priority instruction after a reset of the iterator.
+  SchedInstruction *GetNextPriorityInst();
+  // Removes the instruction returned by the last call to
+  // GetNextPriorityInst().
+  void RemoveNextPriorityInst();
+  // Resets the list iterator to point back to the first instruction.
+  void ResetIterator();
+  // Returns the instruction at the given index in priority order.
+  SchedInstruction *GetInstAt(InstCount indx) const {
+    assert(indx >= 0 && indx < instCnt_);
+    return elmnts_[indx].inst;
+  }
+  // Points the list iterator at the instruction at the given index, as if
+  // GetNextPriorityInst() had just returned it.
+  void SetIterator(InstCount indx);
 
-  // Calculates a new priority key given an existing key of size keySize by
-  // appending bitCnt bits holding the value val, assuming val < maxVal.
-  static void AddPrirtyToKey_(unsigned long &key, int16_t &keySize,
-                              int16_t bitCnt, unsigned long val,
-                              unsigned long maxVal);
+  // Returns the number of instructions currently in the list.
+  InstCount GetInstCnt() const { return instCnt_; }
+
+  // Adds the instructions at the bottoms of the given two lists which have
+  // not been added to the ready list already, and resets the iterator.
+  void AddLatestSubLists(LinkedList<SchedInstruction> *lst1,
+                         LinkedList<SchedInstruction> *lst2);
+
+  // Prints out the ready list, nicely formatted, into an output stream.
+  void Print(std::ostream &out);
+
+private:
+  // An instruction in the list along with its priority key.
+  struct Elmnt {
+    unsigned long key;
+    SchedInstruction *inst;
+  };
+
+  // A change to the list. Undoing it removes an added instruction from the
+  // given index or puts a removed one back at it.
+  struct Chng {
+    Elmnt elmnt;
+    InstCount indx;
+    bool isAdd;
+  };
+
+  // The generator of the instructions' priority keys.
+  PriorityKeyGen keyGen_;
+  // The number of instructions in the dependence graph.
+  InstCount totInstCnt_;
+  DataDepGraph *dataDepGraph_;
+
+  // The precomputed keys of all instructions, indexed by instruction number,
+  // or NULL if the priorities are dynamic and keys are computed as
+  // instructions are added.
+  unsigned long *sttcKeys_;
+
+  // The instructions in the list, in priority order.
+  Elmnt *elmnts_;
+  InstCount instCnt_;
+  // The index of the instruction returned by the last call to
+  // GetNextPriorityInst(), or -1 if the iterator has been reset.
+  InstCount crntIndx_;
+
+  // The undo log. Along any path, each instruction is added and removed at
+  // most once.
+  Chng *log_;
+  InstCount logSize_;
+
+  // Adds an instruction to the list and logs the change.
+  void AddInst_(SchedInstruction *inst);
+  // Adds the instructions at the bottom of a given list which have not been
+  // added to the ready list already.
+  void AddLatestSubList_(LinkedList<SchedInstruction> *lst);
+  // Inserts an element at the given index, shifting the ones after it.
+  void InsrtElmnt_(const Elmnt &elmnt, InstCount indx);
+  // Removes the element at the given index, shifting the ones after it.
+  void RmvElmnt_(InstCount indx);
 };
 
 } // end namespace opt_sched
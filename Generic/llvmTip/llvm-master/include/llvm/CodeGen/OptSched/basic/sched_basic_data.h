@@ -47,7 +47,11 @@ enum LISTSCHED_HEURISTIC {
   LSH_SC = 6,
 
   // Latency sum
-  LSH_LS = 7
+  LSH_LS = 7,
+
+  // Random: a pseudo-random order of the instructions that depends on the
+  // seed of the priorities, for breaking ties at random
+  LSH_RND = 8
 };
 
 #define MAX_SCHED_PRIRTS 10
@@ -58,6 +62,8 @@ struct SchedPriorities {
   int cnt;
   bool isDynmc;
   LISTSCHED_HEURISTIC vctr[MAX_SCHED_PRIRTS];
+  // The seed of the random order used by LSH_RND.
+  unsigned rndmSeed;
 };
 
 enum SPILL_COST_FUNCTION {
@@ -97,9 +103,13 @@ const int MAX_USES_PER_INSTR = 4096;
 // Forward declarations used to reduce the number of #includes.
 class DataDepGraph;
 class Register;
+class UndoTrail;
 
 // There is a circular dependence between SchedInstruction and SchedRange.
 class SchedRange;
+// The graph-wide scheduling state that SchedInstruction objects keep part of
+// their state in.
+struct InstStateBlk;
 
 // An object of this class contains all the information that a scheduler
 // needs to keep track of for an instruction. This class is derived from
@@ -138,8 +148,11 @@ public:
 
   // Prepares the instruction for scheduling. Should be called only once in
   // the lifetime of an instruction object.
-  void SetupForSchdulng(InstCount instCnt, bool isCP_FromScsr,
-                        bool isCP_FromPrdcsr);
+  void SetupForSchdulng();
+  // Moves the instruction's scheduling state into the given state block of
+  // its graph. Must be called after SetupForSchdulng() and before the
+  // instruction is initialized for scheduling.
+  void SetStateBlk(InstStateBlk *stateBlk);
 
   // Sets the instruction's bounds to the ones specified in the input file.
   bool UseFileBounds();
@@ -336,8 +349,9 @@ public:
                              bool enforce);
   // Untightens any tightened lower bound.
   void UnTightnLwrBounds();
-  // Marks the instruction as not tightened.
-  void CmtLwrBoundTightnng();
+  // Marks the instruction as not tightened. If a trail is given, the bounds
+  // that the tightening replaced are recorded on it.
+  void CmtLwrBoundTightnng(UndoTrail *trail = NULL);
 
   // Sets the instruction's signature.
   void SetSig(InstSignature sig);
@@ -366,18 +380,11 @@ public:
    * Entry/exit-related methods                                              *
    ***************************************************************************/
   // TODO(max): Verify that these are indeed entry/exit-related.
-  // TODO(ghassan): Document.
+  // Returns the critical path distance of this instruction from ref, which
+  // must be a recursive predecessor (successor) of it in the forward
+  // (backward) direction. The distances from ref to all of its recursive
+  // neighbors are computed together the first time one of them is asked for.
   InstCount GetRltvCrtclPath(DIRECTION dir, SchedInstruction *ref);
-
-  // Calculates the instruction's critical path distance from the given entry
-  // node assuming that the critical paths of all of its predecessors have
-  // been calculated.
-  InstCount CmputCrtclPathFrmRcrsvPrdcsr(SchedInstruction *ref);
-
-  // Calculates the instruction's critical path distance from the given exit
-  // node assuming that the critical paths of all of its successors have been
-  // calculated.
-  InstCount CmputCrtclPathFrmRcrsvScsr(SchedInstruction *ref);
   /***************************************************************************/
 
   // Returns whether the instruction blocks a scheduling cycle, i.e. prevents
@@ -467,35 +474,14 @@ protected:
   // Whether memory has been allocated for this instruction's data structures.
   bool memAllocd_;
 
-  // The priority list of this instruction's predecessors, sorted by deadline
-  // for relaxed scheduling.
-  PriorityList<SchedInstruction> *sortedPrdcsrLst_;
-  // The priority list of this instruction's successors, sorted by deadline
-  // for relaxed scheduling.
-  PriorityList<SchedInstruction> *sortedScsrLst_;
-
   /***************************************************************************
    * Used during scheduling                                                  *
    ***************************************************************************/
+  // The state block of the graph, which holds the ready cycles of this
+  // instruction, its current lower bounds and a copy of its scheduled cycle.
+  InstStateBlk *stateBlk_;
   // Whether the instruction is currently in the Ready List.
   bool ready_;
-  // Each entry in this array holds the cycle in which this instruction will
-  // become partially ready by satisfying the dependence of one predecessor.
-  // For a predecessor that has not been scheduled the corresponding entry is
-  // set to -1.
-  InstCount *rdyCyclePerPrdcsr_;
-  // A lower bound on the cycle in which this instruction will be ready. This
-  // is the maximum entry in the "readyCyclePerPrdcsr_" array. When all
-  // predecessors have been scheduled, this value gives the cycle in which
-  // this instruction will actually become ready.
-  InstCount minRdyCycle_;
-  // The previous value of the minRdyCycle_, saved before the scheduling of a
-  // predecessor to enable backtracking if this predecessor is unscheduled.
-  InstCount *prevMinRdyCyclePerPrdcsr_;
-  // An array of predecessor latencies indexed by predecessor number.
-  InstCount *ltncyPerPrdcsr_;
-  // The number of unscheduled predecessors.
-  InstCount unschduldPrdcsrCnt_;
   // The number of unscheduled successors.
   InstCount unschduldScsrCnt_;
   /***************************************************************************/
@@ -529,12 +515,13 @@ protected:
   /***************************************************************************
    * Recursive lower bounds                                                  *
    ***************************************************************************/
-  // The critical-path distances from recursive successors to be used in
-  // recursive lower bound computations.
-  InstCount *crtclPathFrmRcrsvScsr_;
-  // The critical-path distances from recursive predecessors to be used in
-  // recursive lower bound computations.
-  InstCount *crtclPathFrmRcrsvPrdcsr_;
+  // The critical-path distances to the recursive successors of this
+  // instruction, indexed by instruction number, to be used in recursive lower
+  // bound computations. NULL until first needed.
+  InstCount *crtclPathToRcrsvScsr_;
+  // The critical-path distances to the recursive predecessors of this
+  // instruction. NULL until first needed.
+  InstCount *crtclPathToRcrsvPrdcsr_;
   /***************************************************************************/
 
   /***************************************************************************
@@ -566,15 +553,19 @@ protected:
   bool mustBeInBBExit_;
 
   // TODO(ghassan): Document.
-  InstCount CmputCrtclPath_(DIRECTION dir, SchedInstruction *ref = NULL);
+  InstCount CmputCrtclPath_(DIRECTION dir);
+  // Sets the scheduled cycle of the instruction, keeping the copy in the
+  // state block (if any) up to date.
+  void SetSchedCycle_(InstCount cycle);
+  // Returns the critical-path distances from this instruction to its
+  // recursive neighbors in the given direction, computing them if needed.
+  InstCount *GetRltvCrtclPaths_(DIRECTION dir);
+  // Computes the critical-path distances from this instruction to its
+  // recursive neighbors in the given direction by visiting them in
+  // topological order.
+  void CmputRltvCrtclPaths_(DIRECTION dir);
   // Allocate the memory needed for data structures used in this node.
-  // Arguments as follows:
-  //   instCnt: The maximum number of instructions in the graph.
-  //   isCP_FromScsr: Whether this instruction will keep track of critical
-  //     paths from successors.
-  //   isCP_FromPrdcsr: Whether this instruction will keep track of critical
-  //     paths from predecessors.
-  void AllocMem_(InstCount instCnt, bool isCP_FromScsr, bool isCP_FromPrdcsr);
+  void AllocMem_();
   // Deallocates the memory used by the node's data structures.
   void DeAllocMem_();
   // Sets the predecessor order numbers on the edges between this node and its
@@ -634,21 +625,30 @@ public:
   bool IsFxd() const;
   // Untightens any tightened lower bound.
   void UnTightnLwrBounds();
-  // Marks the range as not tightened.
-  void CmtLwrBoundTightnng();
+  // Marks the range as not tightened. If a trail is given, the bounds that the
+  // tightening replaced are recorded on it, so that the tightening can be
+  // undone by undoing the trail.
+  void CmtLwrBoundTightnng(UndoTrail *trail = NULL);
   // TODO(ghassan): Document.
   bool Fix(InstCount cycle, LinkedList<SchedInstruction> *tightndLst,
            LinkedList<SchedInstruction> *fxdLst);
   // Returns whether the range is tightened in the given direction.
   bool IsTightnd(DIRECTION dir) const;
+  // Moves the forward and backward lower bounds of the range to the given
+  // locations.
+  void SetStorage(InstCount *frwrdLwrBound, InstCount *bkwrdLwrBound);
 
 protected:
-  // The forward lower bound.
+  // The forward lower bound. Points into bounds_ or into the state block of
+  // the graph.
   // TODO(ghassan): Elaborate.
-  InstCount frwrdLwrBound_;
-  // The backward lower bound.
+  InstCount *frwrdLwrBound_;
+  // The backward lower bound. Points into bounds_ or into the state block of
+  // the graph.
   // TODO(ghassan): Elaborate.
-  InstCount bkwrdLwrBound_;
+  InstCount *bkwrdLwrBound_;
+  // The storage of the bounds of a range that is not kept in a state block.
+  InstCount bounds_[2];
 
   // The last cycle number in the current target length. It is equal to the
   // target schedule length minus one.
@@ -664,11 +664,6 @@ protected:
   // A flag indicating whether the backward lower bound has been tightened.
   bool isBkwrdTightnd_;
 
-  // Whether the current range is equal to exactly one cycle, or,
-  // equivalently, whether the sum of bounds in both directions is equal to
-  // the current target length.
-  bool isFxd_;
-
   // A pointer to the instruction that owns this range.
   SchedInstruction *inst_;
 
@@ -680,6 +675,130 @@ protected:
   void InitVars_();
 };
 
+// The scheduling state of the instructions of a data dependence graph, laid
+// out as a structure of arrays indexed by instruction number. The loops that
+// visit many instructions for each scheduling step (range tightening and the
+// readiness updates of successors) walk these arrays instead of the much
+// larger instruction objects. The graph's edges are kept in compressed sparse
+// row (CSR) form: the neighbors of instruction i in direction dir are entries
+// nghbrStrt[dir][i] to nghbrStrt[dir][i + 1] - 1 of nghbrs[dir], where the
+// forward neighbors are the successors and the backward neighbors are the
+// predecessors, in the same order as in the instruction's edge lists. The
+// block is owned by the graph and rebuilt whenever its edges change.
+struct InstStateBlk {
+  // Lays out the state and edges of the given instructions, which must be
+  // numbered from 0 to instCnt - 1. tplgclOrdr lists them in topological
+  // order.
+  InstStateBlk(SchedInstruction **insts, GraphNode **tplgclOrdr,
+               InstCount instCnt);
+  ~InstStateBlk();
+
+  // Initializes the readiness state of an instruction for a new scheduling
+  // iteration.
+  void InitForSchdulng(InstCount instNum);
+  // Implement SchedInstruction::PrdcsrSchduld() and PrdcsrUnSchduld() for
+  // the instruction with the given number.
+  bool PrdcsrSchduld(InstCount instNum, InstCount prdcsrNum, InstCount cycle,
+                     InstCount &rdyCycle);
+  bool PrdcsrUnSchduld(InstCount instNum, InstCount prdcsrNum,
+                       InstCount &rdyCycle);
+
+  // Returns the index of the first and the one past the last edge of an
+  // instruction in the given direction.
+  InstCount GetFrstNghbrIndx(DIRECTION dir, InstCount instNum) const {
+    return nghbrStrt[dir][instNum];
+  }
+  InstCount GetNghbrEndIndx(DIRECTION dir, InstCount instNum) const {
+    return nghbrStrt[dir][instNum + 1];
+  }
+
+  // The number of instructions.
+  InstCount instCnt;
+  // The instructions, indexed by number. Not owned by the block.
+  SchedInstruction **insts;
+  // The instruction numbers in topological order.
+  InstCount *tplgclOrdr;
+
+  /***************************************************************************
+   * Per-instruction state                                                   *
+   ***************************************************************************/
+  // The issue type of each instruction.
+  IssueType *issuType;
+  // Whether each instruction blocks its cycle.
+  bool *blksCycle;
+  // A copy of the scheduled cycle of each instruction, or SCHD_UNSCHDULD.
+  InstCount *schedCycle;
+  // The current (dynamic) forward and backward lower bound of each
+  // instruction, indexed by direction. These are the bounds of the
+  // instructions' SchedRange objects.
+  InstCount *crntLwrBound[2];
+  // A lower bound on the cycle in which each instruction will be ready. This
+  // is the maximum of its entries in rdyCyclePerPrdcsr. When all the
+  // predecessors have been scheduled, this is the cycle in which the
+  // instruction actually becomes ready.
+  InstCount *minRdyCycle;
+  // The number of unscheduled predecessors of each instruction.
+  InstCount *unschduldPrdcsrCnt;
+  /***************************************************************************/
+
+  /***************************************************************************
+   * Per-edge state                                                          *
+   ***************************************************************************/
+  // The start of the edges of each instruction in the CSR arrays, indexed by
+  // direction, with one extra entry holding the total edge count.
+  InstCount *nghbrStrt[2];
+  // The number of the neighbor on each edge, indexed by direction.
+  InstCount *nghbrs[2];
+  // The latency of each edge, indexed by direction.
+  InstCount *nghbrLtncy[2];
+  // For each successor edge, the order of the edge in the successor's
+  // predecessor list.
+  InstCount *prdcsrNumInScsr;
+  // For each predecessor edge, the cycle in which the instruction becomes
+  // partially ready by satisfying the dependence on that predecessor, or
+  // INVALID_VALUE if the predecessor has not been scheduled.
+  InstCount *rdyCyclePerPrdcsr;
+  // For each predecessor edge, the value of minRdyCycle before that
+  // predecessor was scheduled, to enable backtracking.
+  InstCount *prevMinRdyCyclePerPrdcsr;
+  /***************************************************************************/
+};
+
+inline bool InstStateBlk::PrdcsrSchduld(InstCount instNum,
+                                        InstCount prdcsrNum, InstCount cycle,
+                                        InstCount &rdyCycle) {
+  InstCount indx = nghbrStrt[DIR_BKWRD][instNum] + prdcsrNum;
+  assert(indx < nghbrStrt[DIR_BKWRD][instNum + 1]);
+  InstCount prdcsrRdyCycle = cycle + nghbrLtncy[DIR_BKWRD][indx];
+  rdyCyclePerPrdcsr[indx] = prdcsrRdyCycle;
+  prevMinRdyCyclePerPrdcsr[indx] = minRdyCycle[instNum];
+
+  if (prdcsrRdyCycle > minRdyCycle[instNum]) {
+    minRdyCycle[instNum] = prdcsrRdyCycle;
+  }
+
+  rdyCycle = minRdyCycle[instNum];
+  unschduldPrdcsrCnt[instNum]--;
+  return (unschduldPrdcsrCnt[instNum] == 0);
+}
+
+inline bool InstStateBlk::PrdcsrUnSchduld(InstCount instNum,
+                                          InstCount prdcsrNum,
+                                          InstCount &rdyCycle) {
+  InstCount indx = nghbrStrt[DIR_BKWRD][instNum] + prdcsrNum;
+  assert(indx < nghbrStrt[DIR_BKWRD][instNum + 1]);
+  assert(rdyCyclePerPrdcsr[indx] != INVALID_VALUE);
+  rdyCycle = minRdyCycle[instNum];
+  minRdyCycle[instNum] = prevMinRdyCyclePerPrdcsr[indx];
+  rdyCyclePerPrdcsr[indx] = INVALID_VALUE;
+  unschduldPrdcsrCnt[instNum]++;
+  assert(unschduldPrdcsrCnt[instNum] !=
+             GetNghbrEndIndx(DIR_BKWRD, instNum) -
+                 GetFrstNghbrIndx(DIR_BKWRD, instNum) ||
+         minRdyCycle[instNum] == INVALID_VALUE);
+  return (unschduldPrdcsrCnt[instNum] == 1);
+}
+
 } // end namespace opt_sched
 
 #endif
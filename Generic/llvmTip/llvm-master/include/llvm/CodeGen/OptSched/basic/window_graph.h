@@ -0,0 +1,81 @@
+/*******************************************************************************
+Description:  Defines the dependence graph of a window of a larger region: a
+              range of consecutive instructions in a topological order of the
+              region's graph. The window is a complete graph of its own, with
+              an artificial root that defines the registers live into the
+              window and an artificial leaf that uses the registers live out of
+              it, so that it can be scheduled like any other region and its
+              schedule put back in place of the range. The latencies of the
+              edges from the root and to the leaf stand for the dependences
+              on the instructions before and after the window.
+Created:      Oct. 2026
+Last Update:  Oct. 2026
+*******************************************************************************/
+
+#ifndef OPTSCHED_BASIC_WINDOW_GRAPH_H
+#define OPTSCHED_BASIC_WINDOW_GRAPH_H
+
+#include "llvm/CodeGen/OptSched/basic/data_dep.h"
+#include "llvm/CodeGen/OptSched/basic/register.h"
+#include <map>
+#include <vector>
+
+namespace opt_sched {
+
+class WindowDataDepGraph : public DataDepGraph {
+public:
+  // Creates the graph of the instructions at positions bgn up to end of the
+  // given topological order of the full graph, whose registers are in the
+  // given register files. The order is that of a schedule of the full graph
+  // whose cycles, by instruction number, are also given. They time the
+  // dependences on the instructions outside the window. The full graph must
+  // be set up for scheduling.
+  WindowDataDepGraph(DataDepGraph *fullGraph, MachineModel *machMdl,
+                     RegisterFile fullRegFiles[],
+                     const std::vector<InstCount> &order,
+                     const std::vector<InstCount> &cycles, InstCount bgn,
+                     InstCount end, int wndwNum);
+  ~WindowDataDepGraph() {}
+
+  void CountDefs(RegisterFile regFiles[]);
+  void AddDefsAndUses(RegisterFile regFiles[]);
+
+  // Returns the number in the full graph of the given instruction of the
+  // window, or INVALID_VALUE for the artificial root and leaf of the window.
+  InstCount GetFullInstNum(InstCount instNum) const;
+
+private:
+  // A register of the full graph that is defined or used in the window, or
+  // that is live across it.
+  struct WndwReg {
+    Register *fullReg;
+    // Whether the register is live at the start of the window, and so defined
+    // by its root.
+    bool isLiveIn;
+    // Whether the register is live at the end of the window, and so used by
+    // its leaf.
+    bool isLiveOut;
+  };
+
+  // The graph that the window is part of.
+  DataDepGraph *fullGraph_;
+  // The instruction of the full graph at each position of the window.
+  std::vector<InstCount> fullInstNums_;
+  // The registers of the window of each type, by their number in the window.
+  std::vector<std::vector<WndwReg>> regs_;
+  // The number in the window of each register of the full graph.
+  std::map<const Register *, int> wndwRegNums_;
+
+  // Finds the registers of the window and whether they are live into and out
+  // of it.
+  void FindRegs_(RegisterFile fullRegFiles[],
+                 const std::vector<InstCount> &order, InstCount bgn,
+                 InstCount end);
+  // Returns the register of the window that stands for the given register of
+  // the full graph.
+  Register *GetWndwReg_(RegisterFile regFiles[], const Register *fullReg);
+};
+
+} // end namespace opt_sched
+
+#endif
@@ -11,16 +11,25 @@ Last Update:  Jun. 2017
 #include "llvm/CodeGen/OptSched/basic/data_dep.h"
 #include "llvm/CodeGen/OptSched/basic/gen_sched.h"
 #include "llvm/CodeGen/OptSched/basic/ready_list.h"
+#include "llvm/CodeGen/OptSched/enum/parallel_enum.h"
 #include "llvm/CodeGen/OptSched/generic/defines.h"
 #include "llvm/CodeGen/OptSched/generic/mem_mngr.h"
+#include "llvm/CodeGen/OptSched/generic/open_hash_table.h"
+#include "llvm/CodeGen/OptSched/generic/undo_trail.h"
 #include "llvm/CodeGen/OptSched/relaxed/relaxed_sched.h"
+#include <atomic>
 #include <iostream>
+#include <limits>
 #include <vector>
 
 namespace opt_sched {
 
 const int MAX_MEMBLOCK_SIZE = 10000;
 const int TIMEOUT_TO_MEMBLOCK_RATIO = 10;
+// The number of tree node records in each block of the node arena.
+const int NODE_ARENA_BLK_SIZE = 64;
+// The initial capacity of the undo trail, in changes per instruction.
+const int TRAIL_CHNGS_PER_INST = 16;
 
 class SchedRegion;
 
@@ -40,11 +49,20 @@ struct Pruning {
 
 enum ENUMTREE_NODEMODE { ETN_PRELIM, ETN_ACTIVE, ETN_HISTORY };
 
-struct TightndInst {
-  SchedInstruction *inst;
-  InstCount tightBound;
+// The order in which the enumerator explores the branches of a tree node.
+enum ENUM_SEARCH {
+  // In the priority order of the ready list.
+  ES_DEPTH_FIRST,
+  // In increasing order of the cost lower bounds of the children.
+  ES_BEST_FIRST,
+  // Like ES_BEST_FIRST, but only a given number of the best children are
+  // explored, so the search is not exhaustive.
+  ES_BEAM
 };
 
+// The rank of a branch that was found infeasible while ranking the branches.
+const InstCount INFSBL_BRNCH_RANK = std::numeric_limits<InstCount>::max();
+
 class Enumerator;
 class HistEnumTreeNode;
 class CostHistEnumTreeNode;
@@ -53,17 +71,15 @@ class EnumTreeNode {
 private:
   friend class HistEnumTreeNode;
   friend class CostHistEnumTreeNode;
+  friend class EnumTreeNodeAlloc;
 
   class ExaminedInst {
   private:
     SchedInstruction *inst_;
     bool wasRlxInfsbl_; // was it infeasible because relaxed scheduling failed
-    LinkedList<TightndInst> *tightndScsrs_;
 
   public:
-    ExaminedInst(SchedInstruction *inst, bool wasRlxInfsbl,
-                 LinkedList<SchedInstruction> *dirctTightndLst);
-    ~ExaminedInst();
+    inline void Construct(SchedInstruction *inst, bool wasRlxInfsbl);
 
     inline SchedInstruction *GetInst();
     inline bool wasRlxInfsbl() { return wasRlxInfsbl_; }
@@ -102,34 +118,39 @@ private:
 
   ENUMTREE_NODEMODE mode_;
 
-  // Array of instructions' forward lower bounds tightened up to this node
-  InstCount *frwrdLwrBounds_;
-
-  // Array hloding the number of issue slots available for each issue type
-  // based on the target schedule length and the slots that have been taken
-  InstCount avlblSlots_[MAX_ISSUTYPE_CNT];
-
-  // Array hloding the number of issue slots available for each issue type
-  // in the current machine cycle
-  int16_t avlblSlotsInCrntCycle_[MAX_ISSUTYPE_CNT];
+  // The size of the enumerator's undo trail once all the changes made in
+  // getting to this node have been recorded on it. Undoing the trail down to
+  // this size restores the lower bounds, slot availability and register
+  // pressure of this node.
+  size_t trailSize_;
 
   bool crntCycleBlkd_;
   int realSlotNum_;
 
-  // A list of "legal" instructions that have been examined at this node
-  // along with a list of immediate successors that got tightened after
-  // temporarily scheduling that instruction
-  LinkedList<ExaminedInst> *exmndInsts_;
+  // An array of "legal" instructions that have been examined at this node.
+  // Points into the node's arena record and is NULL if node superiority
+  // pruning is off.
+  ExaminedInst *exmndInsts_;
+  InstCount exmndInstCnt_;
+
+  // The indices in the ready list of the instructions to explore, best
+  // first, if the branches of this node have been ranked. Points into the
+  // node's arena record and is NULL if the search is depth-first.
+  InstCount *brnchOrdr_;
+  // The number of ranked instructions to explore, or INVALID_VALUE if the
+  // branches have not been ranked.
+  InstCount rankdBrnchCnt_;
 
   InstCount legalInstCnt_;
 
   // A list of nodes that are dominated by this node
   HistEnumTreeNode *dmntdNode_;
-  LinkedList<HistEnumTreeNode> *chldrn_;
 
   uint64_t num_;
 
-  ReadyList *rdyLst_;
+  // The state of the enumerator's ready list before the changes made to it at
+  // this node, to be restored when backtracking out of the node.
+  EnumReadyList::State prevRdyLstState_;
 
   HistEnumTreeNode *hstry_;
 
@@ -138,7 +159,6 @@ private:
   // The signature of the partial schedule up to this node
   InstSignature prtilSchedSig_;
 
-  bool isCnstrctd_;
   bool isClean_;
 
   // Have we looked for an instruction in the ready list that uses a
@@ -153,7 +173,10 @@ private:
   InstCount spillCostSum_;
   InstCount totalCost_ = -1;
   bool totalCostIsActualCost_ = false;
+  // The reserved slots at this node, or NULL if there are none. When set,
+  // points to rsrvSlotBuf_, which is part of the node's arena record.
   ReserveSlot *rsrvSlots_;
+  ReserveSlot *rsrvSlotBuf_;
 
   // (Chris)
   using SuffixType = std::vector<SchedInstruction *>;
@@ -188,18 +211,18 @@ public:
 
   bool WasRsrcDmnntNodeExmnd(SchedInstruction *cnddtInst);
 
-  inline void SetSlotAvlblty(InstCount avlblSlots[],
-                             int16_t avlblSlotsInCrntCycle[]);
+  inline void SetTrailSize(size_t size) { trailSize_ = size; }
+  inline size_t GetTrailSize() const { return trailSize_; }
+
+  // Returns the array to be filled with the order of the ranked branches.
+  inline InstCount *GetBrnchOrdr() { return brnchOrdr_; }
+  inline bool IsRankd() const { return rankdBrnchCnt_ != INVALID_VALUE; }
+  inline void SetRankdBrnchCnt(InstCount cnt) { rankdBrnchCnt_ = cnt; }
+  inline InstCount GetRankdBrnchCnt() const { return rankdBrnchCnt_; }
 
   inline InstCount GetBranchCnt(bool &isEmpty);
   inline InstCount GetBranchCnt();
 
-  // Return a pointer to the array of lower bounds
-  inline InstCount *GetLwrBounds(DIRECTION dir);
-
-  inline void GetLwrBounds(DIRECTION dir, InstCount lwrBounds[]);
-  inline void GetSlotAvlblty(InstCount avlblSlots[],
-                             int16_t avlblSlotsInCrntCycle[]);
   inline InstCount GetCrntBranchNum();
   inline SchedInstruction *GetInst();
   inline InstCount GetInstNum();
@@ -223,19 +246,15 @@ public:
 
   bool DoesPartialSchedMatch(EnumTreeNode *othr);
 
-  void SetLwrBounds(DIRECTION dir);
-  void SetLwrBounds();
-
   void SetRsrvSlots(int16_t rsrvSlotCnt, ReserveSlot *rsrvSlots);
 
   // Add a node to the list of nodes dominated by this node
   inline void AddDmntdSubProb(HistEnumTreeNode *node);
   inline HistEnumTreeNode *GetDmntdSubProb();
-  inline void AddChild(EnumTreeNode *node);
 
-  inline void SetRdyLst(ReadyList *lst);
+  inline void SetPrevRdyLstState(const EnumReadyList::State &state);
 
-  inline ReadyList *GetRdyLst();
+  inline const EnumReadyList::State &GetPrevRdyLstState();
 
   inline ENUMTREE_NODEMODE GetMode();
 
@@ -244,7 +263,6 @@ public:
 
   inline InstCount GetLegalInstCnt();
   inline void LegalInstFound();
-  inline InstCount GetChldrnCnt();
 
   inline void CreateHistory();
   inline void ReplaceHistory(HistEnumTreeNode *node);
@@ -299,13 +317,50 @@ public:
 };
 /*****************************************************************************/
 
-class EnumTreeNodeAlloc : public MemAlloc<EnumTreeNode> {
+// Allocates the nodes of an enumeration tree from an arena of fixed-size
+// records. Besides the node itself, each record holds the node's reserved
+// slots, examined instructions and branch order, so constructing a node does
+// not touch the heap. The enumerator frees nodes in the reverse order of their allocation as
+// it backtracks, which lets the arena reclaim a record by moving its top back,
+// and Reset() releases the whole tree at once.
+class EnumTreeNodeAlloc {
 public:
-  inline EnumTreeNodeAlloc(int maxSize);
-  inline ~EnumTreeNodeAlloc();
+  // Sets up an arena for the nodes of a graph with the given number of
+  // instructions. Room for examined instructions is only made in the records
+  // if node superiority pruning is on, and room for the branch order only if
+  // the branches are ranked.
+  EnumTreeNodeAlloc(InstCount instCnt, int issuRate, bool nodeSup,
+                    bool rankBrnchs);
+  ~EnumTreeNodeAlloc();
+
   inline EnumTreeNode *Alloc(EnumTreeNode *prevNode, SchedInstruction *inst,
                              Enumerator *enumrtr);
   inline void Free(EnumTreeNode *node);
+  // Frees all the allocated nodes. The record memory is kept for reuse.
+  void Reset();
+
+private:
+  // The lengths of the arrays in each record.
+  InstCount instCnt_;
+  int issuRate_;
+  InstCount exmndInstCap_;
+  InstCount brnchOrdrCap_;
+  // The offsets of the arrays within a record.
+  size_t rsrvSlotsOfst_;
+  size_t exmndInstsOfst_;
+  size_t brnchOrdrOfst_;
+  // The size of a record, including padding.
+  size_t rcrdSize_;
+  // The blocks of NODE_ARENA_BLK_SIZE records each.
+  std::vector<char *> blks_;
+  // The total number of records in all blocks.
+  int rcrdCnt_;
+  // The number of records below the top of the arena. Records below the top
+  // may be free if a node was not freed in order.
+  int topIndx_;
+
+  inline EnumTreeNode *GetNode_(int indx);
+  void AddBlk_();
 };
 /*****************************************************************************/
 
@@ -330,6 +385,10 @@ protected:
   // A pointer to a relaxed scheduler
   RJ_RelaxedScheduler *rlxdSchdulr_;
 
+  // The ready list shared by all the nodes on the current path. The ready
+  // list of the base scheduler is not used.
+  EnumReadyList *enumRdyLst_;
+
   // Array hloding the number of issue slots available for each issue type
   // based on the target schedule length and the slots that have been taken
   InstCount avlblSlots_[MAX_ISSUTYPE_CNT];
@@ -353,7 +412,7 @@ protected:
 
   InstCount minUnschduldTplgclOrdr_;
 
-  BinHashTable<HistEnumTreeNode> *exmndSubProbs_;
+  OpenHashTable<HistEnumTreeNode> *exmndSubProbs_;
 
   // A list of insts whose lower bounds have been tightened to be used for
   // efficient untightening
@@ -361,11 +420,16 @@ protected:
   LinkedList<SchedInstruction> *bkwrdTightndLst_;
   LinkedList<SchedInstruction> *dirctTightndLst_;
 
-  // A list of insts which got fixed in certain cycles to be used for
-  // efficient unfixing
+  // A list of insts which got fixed in certain cycles, to be fixed in the
+  // relaxed scheduler
   LinkedList<SchedInstruction> *fxdLst_;
 
-  InstCount fxdInstCnt_;
+  // The trail of the changes made to the lower bounds, the slot availability,
+  // the fixings of the relaxed scheduler and the region's register pressure on
+  // the way from the root to the current node and in the current probe.
+  // Backtracking and failed probes undo the trail down to the size recorded
+  // in the node they return to.
+  UndoTrail *trail_;
 
   // A structure for keeping track of any temporarily modified states so that
   // they can be restored
@@ -388,7 +452,6 @@ protected:
   long backTrackCnt_;
 
   bool alctrsSetup_;
-  MemAlloc<BinHashTblEntry<HistEnumTreeNode>> *hashTblEntryAlctr_;
   EnumTreeNodeAlloc *nodeAlctr_;
 
   InstCount *tmpLwrBounds_;
@@ -417,6 +480,29 @@ protected:
   // history domination
   HistEnumTreeNode *mostRecentMatchingHistNode_ = nullptr;
 
+  // The state shared with the other workers of a parallel enumeration, or
+  // NULL if this enumerator searches the whole tree by itself.
+  ParallelEnumState *prllState_;
+
+  // The order in which the branches of each node are explored.
+  ENUM_SEARCH srchStrtgy_;
+  // The number of branches explored at each node in a beam search.
+  int beamWidth_;
+  // Did a beam search skip a branch that might have been feasible? If so,
+  // exploring the whole tree does not prove that no better schedule exists.
+  bool isSrchCut_;
+  // The ranks of the instructions in the ready list, by ready list index.
+  // Only allocated for the search strategies that rank the branches.
+  InstCount *brnchRanks_;
+
+  // Did the last search prove that no schedule of the target length exists,
+  // whatever its cost?
+  bool isLngthInfsbl_;
+
+  // Is this node an ancestor of the work items in a parallel enumeration?
+  // Such nodes are only partially explored by this enumerator.
+  inline bool IsAboveSplit_(EnumTreeNode *node);
+
   inline void ClearState_();
   inline bool IsStateClear_();
 
@@ -434,6 +520,9 @@ protected:
   // If a feasible branch is found, a new node is created and
   // true is returned. Otherwise, false is returned
   bool FindNxtFsblBrnch_(EnumTreeNode *&newNode);
+  // Orders the instructions in the ready list by rank, best first, and
+  // records the order in the current node.
+  void RankBrnchs_();
   inline bool ChkCrntNodeForFsblty_();
 
   void RestoreCrntState_(SchedInstruction *inst, EnumTreeNode *newNode);
@@ -458,16 +547,15 @@ protected:
   bool WasDmnntSubProbExmnd_(SchedInstruction *inst, EnumTreeNode *&newNode);
 
   bool TightnLwrBounds_(SchedInstruction *inst);
-  void UnTightnLwrBounds_(SchedInstruction *newInst);
+  // Records the tightenings of the lower bounds on the trail.
   void CmtLwrBoundTightnng_();
 
   bool FixInsts_(SchedInstruction *newInst);
-  void UnFixInsts_(SchedInstruction *newInst);
-  void CmtInstFxng_();
 
-  void RestoreCrntLwrBounds_(SchedInstruction *unschduldInst);
+  // Records the slot availability in the current cycle on the trail before
+  // a new cycle is started.
+  inline void SaveCycleSlots_();
 
-  inline void CreateNewRdyLst_();
   bool RlxdSchdul_(EnumTreeNode *newNode);
 
   inline InstCount GetCycleNumFrmTime_(InstCount time);
@@ -497,6 +585,10 @@ protected:
   virtual bool ProbeBranch_(SchedInstruction *inst, EnumTreeNode *&newNode,
                             bool &isNodeDmntd, bool &isRlxInfsbl,
                             bool &isLngthFsbl);
+  // Returns the rank of the branch that schedules the given instruction in
+  // the current slot, lower being better, or INFSBL_BRNCH_RANK if the branch
+  // is found infeasible. The state is left as it was.
+  virtual InstCount RankBrnch_(SchedInstruction *inst);
   virtual bool Initialize_(InstSchedule *preSched, InstCount trgtLngth);
   virtual void CreateRootNode_();
   virtual bool EnumStall_();
@@ -517,6 +609,17 @@ public:
 
   inline int GetSearchCnt();
 
+  // Returns the trail on which the enumeration state changes are recorded.
+  inline UndoTrail *GetTrail() { return trail_; }
+
+  // Returns true if the last search proved that no schedule of its target
+  // length exists, regardless of cost. Since a schedule that fits in a length
+  // also fits in any longer one, no shorter length is feasible either.
+  inline bool WasLngthInfsbl() const { return isLngthInfsbl_; }
+  // Returns true if the last search was a beam search that skipped a branch
+  // that might have been feasible.
+  inline bool WasSrchCut() const { return isSrchCut_; }
+
   inline bool IsHistDom();
   inline bool IsRlxdPrnng();
   virtual bool IsCostEnum() = 0;
@@ -524,6 +627,11 @@ public:
   // (Chris)
   inline bool IsSchedForRPOnly() const { return schedForRPOnly_; }
 
+  // Makes this enumerator one of the workers of a parallel enumeration.
+  inline void SetParallelState(ParallelEnumState *state) {
+    prllState_ = state;
+  }
+
   // Calculates the schedule and returns it in the passed argument.
   FUNC_RESULT FindSchedule(InstSchedule *sched, SchedRegion *rgn) { return RES_ERROR; }
 };
@@ -570,6 +678,17 @@ private:
   int costLwrBound_;
   MemAlloc<CostHistEnumTreeNode> *histNodeAlctr_;
   SPILL_COST_FUNCTION spillCostFunc_;
+  // Is the search a probe for a schedule of the target length, whatever its
+  // cost? A probe stops at the first feasible schedule and prunes nothing for
+  // its cost.
+  bool isFsbltyProbe_;
+  // The cursor over the work items of the target length in a parallel
+  // enumeration, or NULL if this search explores all of them.
+  std::atomic<InstCount> *itemCrsr_;
+  // The number of work items reached so far in this search.
+  InstCount rchdItemCnt_;
+  // The index of the last work item claimed in this search.
+  InstCount clmdItemIndx_;
 
   // Virtual Functions
   void SetupAllocators_();
@@ -591,6 +710,12 @@ private:
                     bool &isNodeDmntd, bool &isRlxInfsbl, bool &isLngthFsbl);
   bool Initialize_(InstSchedule *preSched, InstCount trgtLngth);
   bool ChkCostFsblty_(SchedInstruction *inst, EnumTreeNode *&newNode);
+  // Ranks a branch by the cost lower bound of the node it leads to.
+  InstCount RankBrnch_(SchedInstruction *inst);
+  // Counts a newly reached work item, claiming the next unclaimed one if this
+  // worker has passed its last claim, and returns true if the item is the one
+  // this worker claimed.
+  bool ClaimWorkItem_();
   bool EnumStall_();
   void InitNewNode_(EnumTreeNode *newNode);
 
@@ -600,6 +725,7 @@ public:
                        SchedPriorities prirts, Pruning prune,
                        bool schedForRPOnly, bool enblStallEnum,
                        Milliseconds timeout, SPILL_COST_FUNCTION spillCostFunc,
+                       ENUM_SEARCH srchStrtgy, int beamWidth,
                        InstCount preFxdInstCnt = 0,
                        SchedInstruction *preFxdInsts[] = NULL);
   virtual ~LengthCostEnumerator();
@@ -612,6 +738,10 @@ public:
                                    Milliseconds deadline);
   bool IsCostEnum();
   SPILL_COST_FUNCTION GetSpillCostFunc() { return spillCostFunc_; }
+  // Makes the following searches probes, which find out whether the target
+  // length is feasible at all.
+  inline void SetFsbltyProbe(bool value) { isFsbltyProbe_ = value; }
+  inline bool IsFsbltyProbe() const { return isFsbltyProbe_; }
   inline InstCount GetBestCost() { return GetBestCost_(); }
 };
 /*****************************************************************************/
@@ -643,28 +773,6 @@ void EnumTreeNode::LegalInstFound() {
 }
 /*****************************************************************************/
 
-inline void EnumTreeNode::SetSlotAvlblty(InstCount avlblSlots[],
-                                         int16_t avlblSlotsInCrntCycle[]) {
-  int16_t issuTypeCnt = enumrtr_->issuTypeCnt_;
-
-  for (int16_t i = 0; i < issuTypeCnt; i++) {
-    avlblSlots_[i] = avlblSlots[i];
-    avlblSlotsInCrntCycle_[i] = avlblSlotsInCrntCycle[i];
-  }
-}
-/*****************************************************************************/
-
-inline void EnumTreeNode::GetSlotAvlblty(InstCount avlblSlots[],
-                                         int16_t avlblSlotsInCrntCycle[]) {
-  int16_t issuTypeCnt = enumrtr_->issuTypeCnt_;
-
-  for (int16_t i = 0; i < issuTypeCnt; i++) {
-    avlblSlots[i] = avlblSlots_[i];
-    avlblSlotsInCrntCycle[i] = avlblSlotsInCrntCycle_[i];
-  }
-}
-/*****************************************************************************/
-
 inline InstCount EnumTreeNode::GetBranchCnt(bool &isEmpty) {
   isEmpty = isEmpty_;
   return brnchCnt_;
@@ -674,28 +782,6 @@ inline InstCount EnumTreeNode::GetBranchCnt(bool &isEmpty) {
 InstCount EnumTreeNode::GetBranchCnt() { return brnchCnt_; }
 /**************************************************************************/
 
-void EnumTreeNode::GetLwrBounds(DIRECTION dir, InstCount lwrBounds[]) {
-  InstCount i;
-  InstCount *nodeLwrBounds;
-  InstCount instCnt = enumrtr_->totInstCnt_;
-
-  assert(dir == DIR_FRWRD);
-  nodeLwrBounds = frwrdLwrBounds_;
-
-  for (i = 0; i < instCnt; i++) {
-    lwrBounds[i] = nodeLwrBounds[i];
-  }
-}
-/**************************************************************************/
-
-InstCount *EnumTreeNode::GetLwrBounds(DIRECTION dir) {
-  InstCount *nodeLwrBounds;
-  assert(dir == DIR_FRWRD);
-  nodeLwrBounds = frwrdLwrBounds_;
-  return nodeLwrBounds;
-}
-/**************************************************************************/
-
 InstCount EnumTreeNode::GetCrntBranchNum() { return crntBrnchNum_; }
 /**************************************************************************/
 
@@ -738,14 +824,9 @@ inline void EnumTreeNode::AddDmntdSubProb(HistEnumTreeNode *node) {
 inline HistEnumTreeNode *EnumTreeNode::GetDmntdSubProb() { return dmntdNode_; }
 /**************************************************************************/
 
-inline void EnumTreeNode::AddChild(EnumTreeNode *node) {
-  assert(node->GetHistory() != NULL);
-  chldrn_->InsrtElmnt(node->GetHistory());
-}
-/**************************************************************************/
-
-inline void EnumTreeNode::SetRdyLst(ReadyList *lst) {
-  rdyLst_ = lst;
+inline void
+EnumTreeNode::SetPrevRdyLstState(const EnumReadyList::State &state) {
+  prevRdyLstState_ = state;
   mode_ = ETN_ACTIVE;
 }
 /**************************************************************************/
@@ -758,7 +839,9 @@ inline void EnumTreeNode::SetFoundInstWithUse(bool foundInstWithUse) {
 }
 /**************************************************************************/
 
-inline ReadyList *EnumTreeNode::GetRdyLst() { return rdyLst_; }
+inline const EnumReadyList::State &EnumTreeNode::GetPrevRdyLstState() {
+  return prevRdyLstState_;
+}
 /**************************************************************************/
 
 inline ENUMTREE_NODEMODE EnumTreeNode::GetMode() { return mode_; }
@@ -767,6 +850,13 @@ inline ENUMTREE_NODEMODE EnumTreeNode::GetMode() { return mode_; }
 inline InstCount EnumTreeNode::GetLegalInstCnt() { return legalInstCnt_; }
 /**************************************************************************/
 
+inline void EnumTreeNode::ExaminedInst::Construct(SchedInstruction *inst,
+                                                  bool wasRlxInfsbl) {
+  inst_ = inst;
+  wasRlxInfsbl_ = wasRlxInfsbl;
+}
+/**************************************************************************/
+
 inline SchedInstruction *EnumTreeNode::ExaminedInst::GetInst() { return inst_; }
 /**************************************************************************/
 
@@ -861,23 +951,9 @@ bool EnumTreeNode::IsNxtCycleNew_() {
 /*****************************************************************************/
 
 bool EnumTreeNode::ExaminedInst::IsRsrcDmntd(SchedInstruction *) {
-  if (!wasRlxInfsbl_)
-    return false;
-
-  for (TightndInst *tightndScsr = tightndScsrs_->GetFrstElmnt();
-       tightndScsr != NULL; tightndScsr = tightndScsrs_->GetNxtElmnt()) {
-    SchedInstruction *scsr = tightndScsr->inst;
-
-    // If the release time of one successor of the examined instruction
-    // was tighter than the current release time after the temp. scheduling
-    // of the candidate instruction, then we cannot make a judgement whether
-    // the examined dominates the candidate from rsource point of view
-    if (tightndScsr->tightBound > scsr->GetCrntLwrBound(DIR_FRWRD)) {
-      return false;
-    }
-  }
-
-  return true;
+  // The successors that got tightened by the examined instruction are not
+  // recorded, so none of them can rule out the domination.
+  return wasRlxInfsbl_;
 }
 /*****************************************************************************/
 
@@ -922,7 +998,7 @@ inline void Enumerator::UpdtRdyLst_(InstCount cycleNum, int slotNum) {
     lst1 = frstRdyLstPerCycle_[prevCycleNum];
   }
 
-  rdyLst_->AddLatestSubLists(lst1, lst2);
+  enumRdyLst_->AddLatestSubLists(lst1, lst2);
 }
 /*****************************************************************************/
 
@@ -958,19 +1034,6 @@ inline uint64_t Enumerator::GetNodeCnt() { return exmndNodeCnt_; }
 inline int Enumerator::GetSearchCnt() { return iterNum_; }
 /****************************************************************************/
 
-inline void Enumerator::CreateNewRdyLst_() {
-  ReadyList *oldLst = rdyLst_;
-
-  rdyLst_ = new ReadyList(dataDepGraph_, prirts_);
-  if (rdyLst_ == NULL)
-    Logger::Fatal("Out of memory.");
-
-  if (oldLst != NULL) {
-    rdyLst_->CopyList(oldLst);
-  }
-}
-/****************************************************************************/
-
 inline bool Enumerator::ChkCrntNodeForFsblty_() {
   SchedInstruction *inst;
 
@@ -998,23 +1061,37 @@ inline int Enumerator::GetSlotNumFrmTime_(InstCount time) {
 }
 /****************************************************************************/
 
+inline void Enumerator::SaveCycleSlots_() {
+  for (int16_t i = 0; i < issuTypeCnt_; i++) {
+    trail_->Save(avlblSlotsInCrntCycle_[i]);
+  }
+}
+/****************************************************************************/
+
 bool Enumerator::IsHistDom() { return prune_.histDom; }
 /******************************************************************************/
 
 bool Enumerator::IsRlxdPrnng() { return prune_.rlxd; }
-/******************************************************************************/
+/*****************************************************************************/
 
-inline EnumTreeNodeAlloc::EnumTreeNodeAlloc(int maxSize)
-    : MemAlloc<EnumTreeNode>(maxSize, maxSize) {}
-/****************************************************************************/
+bool Enumerator::IsAboveSplit_(EnumTreeNode *node) {
+  return prllState_ != NULL && node->GetTime() < prllState_->GetSplitDepth();
+}
+/******************************************************************************/
 
-inline EnumTreeNodeAlloc::~EnumTreeNodeAlloc() {}
+inline EnumTreeNode *EnumTreeNodeAlloc::GetNode_(int indx) {
+  char *blk = blks_[indx / NODE_ARENA_BLK_SIZE];
+  return reinterpret_cast<EnumTreeNode *>(
+      blk + (indx % NODE_ARENA_BLK_SIZE) * rcrdSize_);
+}
 /****************************************************************************/
 
 inline EnumTreeNode *EnumTreeNodeAlloc::Alloc(EnumTreeNode *prevNode,
                                               SchedInstruction *inst,
                                               Enumerator *enumrtr) {
-  EnumTreeNode *node = GetObject();
+  if (topIndx_ == rcrdCnt_)
+    AddBlk_();
+  EnumTreeNode *node = GetNode_(topIndx_++);
   node->Construct(prevNode, inst, enumrtr);
   return node;
 }
@@ -1022,7 +1099,11 @@ inline EnumTreeNode *EnumTreeNodeAlloc::Alloc(EnumTreeNode *prevNode,
 
 inline void EnumTreeNodeAlloc::Free(EnumTreeNode *node) {
   node->Clean();
-  FreeObject(node);
+
+  // Pop the free records off the top. This is normally just the given node.
+  while (topIndx_ > 0 && GetNode_(topIndx_ - 1)->isClean_) {
+    topIndx_--;
+  }
 }
 /****************************************************************************/
 
@@ -0,0 +1,65 @@
+/*******************************************************************************
+Description:  Defines the state shared between the worker threads of a
+              parallel branch-and-bound enumeration. Each worker owns a private
+              copy of the region (DAG, BBWithSpill and LengthCostEnumerator)
+              and walks the same enumeration tree. The tree is split at a
+              shallow depth into work items (partial schedules of that depth)
+              that are handed out one at a time to whichever worker asks for
+              the next one, and the cost of the best schedule found by any
+              worker is shared so that cost pruning tightens across all
+              workers.
+Created:      Oct. 2026
+Last Update:  Oct. 2026
+*******************************************************************************/
+
+#ifndef OPTSCHED_ENUM_PARALLEL_ENUM_H
+#define OPTSCHED_ENUM_PARALLEL_ENUM_H
+
+#include "llvm/CodeGen/OptSched/generic/defines.h"
+#include <atomic>
+#include <map>
+#include <mutex>
+
+namespace opt_sched {
+
+class ParallelEnumState {
+public:
+  // Creates the shared state for the given number of workers. Work items are
+  // formed by the enumeration tree nodes at depth splitDepth.
+  ParallelEnumState(int threadCnt, InstCount splitDepth);
+  ~ParallelEnumState() {}
+
+  // Returns the number of workers sharing this state.
+  inline int GetThreadCnt() const { return threadCnt_; }
+  // Returns the tree depth at which the search is split into work items.
+  inline InstCount GetSplitDepth() const { return splitDepth_; }
+
+  // Returns the best (normalized) cost found so far by any worker.
+  inline InstCount GetBestCost() const {
+    return bestCost_.load(std::memory_order_acquire);
+  }
+  // Lowers the shared best cost to the given cost if it is an improvement.
+  void UpdtBestCost(InstCount cost);
+
+  // Returns the cursor over the work items of the target length. Every worker
+  // reaches the work items of a target length in the same order, so they are
+  // identified by their index in that order. A worker takes the index of the
+  // next unclaimed item from the cursor whenever it has passed the last item
+  // it claimed, explores that item when it gets there and skips the ones
+  // before it. A worker that finishes its items early thus goes on with the
+  // items that no other worker has started.
+  std::atomic<InstCount> &GetItemCrsr(InstCount trgtLngth);
+
+private:
+  int threadCnt_;
+  InstCount splitDepth_;
+  std::atomic<InstCount> bestCost_;
+  // Guards the creation of the item cursors, which happens once per target
+  // length.
+  std::mutex crsrMutex_;
+  std::map<InstCount, std::atomic<InstCount>> itemCrsrs_;
+};
+
+} // end namespace opt_sched
+
+#endif
@@ -8,17 +8,26 @@ Last Update:  Mar. 2011
 #ifndef OPTSCHED_GENERIC_BIT_VECTOR_H
 #define OPTSCHED_GENERIC_BIT_VECTOR_H
 
+#include "llvm/CodeGen/OptSched/generic/defines.h"
 #include "llvm/CodeGen/OptSched/generic/logger.h"
 #include "llvm/CodeGen/OptSched/generic/mem_mngr.h"
+#include <cstdint>
 #include <cstring>
 #include <memory>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace opt_sched {
 
 class BitVector {
 public:
-  // The actual integral type that is used to store the bits.
-  typedef unsigned int Unit;
+  // The actual integral type that is used to store the bits. The bulk
+  // operations below work on whole units, using SSE2/AVX2 where available.
+  typedef uint64_t Unit;
 
   // Constructs a bit vector of a given length.
   BitVector(int length = 0);
@@ -28,6 +37,9 @@ public:
   // Reconstructs the vector to hold a vector of the new length. All old data
   // is discarded.
   void Construct(int length);
+  // Makes the vector a view of the given number of bits held in a buffer that
+  // the caller owns, such as a row of a bit matrix. All old data is discarded.
+  void Attach(Unit *vctr, int length);
 
   // Sets all bits to 0.
   virtual void Reset();
@@ -42,8 +54,23 @@ public:
   // Create a bit vector that is the "bitwise and" of this bit vector and
   // another bit vector.
   std::unique_ptr<BitVector> And(BitVector *otherBitVector) const;
+  // Returns the number of one bits in the "bitwise and" of this bit vector and
+  // another bit vector of the same size without constructing the result.
+  int GetAndOneCnt(const BitVector &otherBitVector) const;
+  // Returns true if this bit vector and another bit vector of the same size
+  // have at least one one bit in common.
+  bool Intersects(const BitVector &otherBitVector) const;
   // Returns true if this BitVector's one bits are a subset of "otherBitVector".
   bool IsSubVector(BitVector *otherBitVector) const;
+  // Sets every bit that is one in another bit vector of the same size.
+  void Union(const BitVector &otherBitVector);
+  // Returns the index of the first one bit at or after the given index, or
+  // INVALID_VALUE if there is none.
+  int GetNxtOneBit(int index) const;
+  // Returns the index of the first bit at or after the given index that is
+  // one in both this bit vector and another bit vector of the same size, or
+  // INVALID_VALUE if there is none.
+  int GetNxtCmnOneBit(const BitVector &otherBitVector, int index) const;
 
   // Assigns the values from src to the vector. Both vectors must be of the
   // same size.
@@ -51,9 +78,14 @@ public:
   // Compares two bit vectors.
   bool operator==(const BitVector &othr) const;
 
+  // Returns the number of units needed to store the given number of bits.
+  static int GetUnitCnt(int length);
+
 protected:
   // The buffer in which the bits are stored.
   Unit *vctr_;
+  // Whether the buffer was allocated by the vector rather than attached.
+  bool ownsVctr_;
   // The number of bits.
   int bitCnt_;
   // The number of units of the actual integer data type used.
@@ -63,6 +95,20 @@ protected:
 
   // Gets a Unit-sized bitmask for a given bit, inverted if val = false.
   static Unit GetMask_(int bitNum, bool val);
+  // Returns the number of one bits in a unit.
+  static int CntOnes_(Unit unit);
+  // Returns true if any of the first unitCnt units of the two arrays have a
+  // one bit in common.
+  static bool HasCmnOneBits_(const Unit *vctr1, const Unit *vctr2,
+                             int unitCnt);
+  // Returns true if any of the first unitCnt units of vctr1 has a one bit
+  // that is zero in the corresponding unit of vctr2.
+  static bool HasExtraOneBits_(const Unit *vctr1, const Unit *vctr2,
+                               int unitCnt);
+  // Returns the index of the first one bit at or after the given index in
+  // the "bitwise and" of this vector with a mask vector, which is this vector
+  // itself if the mask is NULL.
+  int GetNxtMaskdOneBit_(const Unit *mask, int index) const;
   // The number of bits per storage unit.
   static const int BITS_IN_UNIT = sizeof(Unit) * 8;
 };
@@ -72,21 +118,23 @@ inline BitVector::BitVector(int length) {
   unitCnt_ = 0;
   oneCnt_ = 0;
   vctr_ = NULL;
+  ownsVctr_ = false;
   Construct(length);
 }
 
 inline void BitVector::Construct(int length) {
   bitCnt_ = length;
-  unitCnt_ = (bitCnt_ + BITS_IN_UNIT - 1) / BITS_IN_UNIT;
+  unitCnt_ = GetUnitCnt(bitCnt_);
 
   if (unitCnt_ == 0)
     return;
 
-  if (vctr_)
+  if (vctr_ && ownsVctr_)
     delete[] vctr_;
   vctr_ = new Unit[unitCnt_];
   if (vctr_ == NULL)
     Logger::Fatal("Out of memory.");
+  ownsVctr_ = true;
 
   for (int i = 0; i < unitCnt_; i++) {
     vctr_[i] = 0;
@@ -95,8 +143,22 @@ inline void BitVector::Construct(int length) {
   oneCnt_ = 0;
 }
 
+inline void BitVector::Attach(Unit *vctr, int length) {
+  if (vctr_ && ownsVctr_)
+    delete[] vctr_;
+  vctr_ = vctr;
+  ownsVctr_ = false;
+  bitCnt_ = length;
+  unitCnt_ = GetUnitCnt(bitCnt_);
+
+  oneCnt_ = 0;
+  for (int i = 0; i < unitCnt_; i++) {
+    oneCnt_ += CntOnes_(vctr_[i]);
+  }
+}
+
 inline BitVector::~BitVector() {
-  if (vctr_ != NULL)
+  if (vctr_ != NULL && ownsVctr_)
     delete[] vctr_;
 }
 
@@ -141,11 +203,57 @@ inline bool BitVector::IsSubVector(BitVector *other) const {
   if (unitCnt_ > other->unitCnt_)
     return false;
 
+  return !HasExtraOneBits_(vctr_, other->vctr_, unitCnt_);
+}
+
+inline void BitVector::Union(const BitVector &otherBitVector) {
+  assert(unitCnt_ == otherBitVector.unitCnt_);
+  if (otherBitVector.oneCnt_ == 0)
+    return;
+
+  oneCnt_ = 0;
   for (int i = 0; i < unitCnt_; i++) {
-    if ((vctr_[i] & other->vctr_[i]) != vctr_[i])
-      return false;
+    vctr_[i] |= otherBitVector.vctr_[i];
+    oneCnt_ += CntOnes_(vctr_[i]);
+  }
+}
+
+inline bool BitVector::Intersects(const BitVector &otherBitVector) const {
+  assert(unitCnt_ == otherBitVector.unitCnt_);
+  if (oneCnt_ == 0 || otherBitVector.oneCnt_ == 0)
+    return false;
+
+  return HasCmnOneBits_(vctr_, otherBitVector.vctr_, unitCnt_);
+}
+
+inline int BitVector::GetNxtOneBit(int index) const {
+  return GetNxtMaskdOneBit_(NULL, index);
+}
+
+inline int BitVector::GetNxtCmnOneBit(const BitVector &otherBitVector,
+                                      int index) const {
+  assert(unitCnt_ == otherBitVector.unitCnt_);
+  return GetNxtMaskdOneBit_(otherBitVector.vctr_, index);
+}
+
+inline int BitVector::GetNxtMaskdOneBit_(const Unit *mask, int index) const {
+  assert(index >= 0);
+  if (index >= bitCnt_)
+    return INVALID_VALUE;
+
+  int unitNum = index / BITS_IN_UNIT;
+  int bitNum = index - unitNum * BITS_IN_UNIT;
+  Unit unit = vctr_[unitNum] & (~(Unit)0 << bitNum);
+  if (mask != NULL)
+    unit &= mask[unitNum];
+
+  while (unit == 0) {
+    if (++unitNum == unitCnt_)
+      return INVALID_VALUE;
+    unit = mask == NULL ? vctr_[unitNum] : vctr_[unitNum] & mask[unitNum];
   }
-  return true;
+
+  return unitNum * BITS_IN_UNIT + __builtin_ctzll(unit);
 }
 
 inline std::unique_ptr<BitVector>
@@ -158,17 +266,23 @@ BitVector::And(BitVector *otherBitVector) const {
 
   for (int i = 0; i < andedVector->unitCnt_; i++) {
     andedVector->vctr_[i] = vctr_[i] & otherBitVector->vctr_[i];
-
-    // TODO(austin) This may not be portable enough.
-    // This is a built in gcc function for counting the number of 1 bits
-    // in a number. When using x86 it should be inplemented as a single
-    // instruction ie "popcnt %rdi, %rax"
-    andedVector->oneCnt_ += __builtin_popcountll(andedVector->vctr_[i]);
+    andedVector->oneCnt_ += CntOnes_(andedVector->vctr_[i]);
   }
 
   return andedVector;
 }
 
+inline int BitVector::GetAndOneCnt(const BitVector &otherBitVector) const {
+  assert(unitCnt_ == otherBitVector.unitCnt_);
+  int oneCnt = 0;
+
+  for (int i = 0; i < unitCnt_; i++) {
+    oneCnt += CntOnes_(vctr_[i] & otherBitVector.vctr_[i]);
+  }
+
+  return oneCnt;
+}
+
 inline int BitVector::GetSize() const { return bitCnt_; }
 
 inline int BitVector::GetOneCnt() const { return oneCnt_; }
@@ -189,6 +303,10 @@ inline bool BitVector::operator==(const BitVector &other) const {
   return (memcmp(vctr_, other.vctr_, byteCnt) == 0);
 }
 
+inline int BitVector::GetUnitCnt(int length) {
+  return (length + BITS_IN_UNIT - 1) / BITS_IN_UNIT;
+}
+
 inline BitVector::Unit BitVector::GetMask_(int bitNum, bool bitVal) {
   assert(bitNum < BITS_IN_UNIT);
   Unit mask = ((Unit)1) << bitNum;
@@ -203,6 +321,69 @@ inline BitVector::Unit BitVector::GetMask_(int bitNum, bool bitVal) {
   return mask;
 }
 
+inline int BitVector::CntOnes_(Unit unit) {
+  // TODO(austin) This may not be portable enough.
+  // This is a built in gcc function for counting the number of 1 bits
+  // in a number. When using x86 it should be inplemented as a single
+  // instruction ie "popcnt %rdi, %rax"
+  return __builtin_popcountll(unit);
+}
+
+inline bool BitVector::HasCmnOneBits_(const Unit *vctr1, const Unit *vctr2,
+                                      int unitCnt) {
+  int i = 0;
+#if defined(__AVX2__)
+  for (; i + 4 <= unitCnt; i += 4) {
+    __m256i units1 = _mm256_loadu_si256((const __m256i *)(vctr1 + i));
+    __m256i units2 = _mm256_loadu_si256((const __m256i *)(vctr2 + i));
+    if (!_mm256_testz_si256(units1, units2))
+      return true;
+  }
+#elif defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 2 <= unitCnt; i += 2) {
+    __m128i units1 = _mm_loadu_si128((const __m128i *)(vctr1 + i));
+    __m128i units2 = _mm_loadu_si128((const __m128i *)(vctr2 + i));
+    __m128i cmn = _mm_and_si128(units1, units2);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(cmn, zero)) != 0xffff)
+      return true;
+  }
+#endif
+  for (; i < unitCnt; i++) {
+    if ((vctr1[i] & vctr2[i]) != 0)
+      return true;
+  }
+  return false;
+}
+
+inline bool BitVector::HasExtraOneBits_(const Unit *vctr1, const Unit *vctr2,
+                                        int unitCnt) {
+  int i = 0;
+#if defined(__AVX2__)
+  for (; i + 4 <= unitCnt; i += 4) {
+    __m256i units1 = _mm256_loadu_si256((const __m256i *)(vctr1 + i));
+    __m256i units2 = _mm256_loadu_si256((const __m256i *)(vctr2 + i));
+    // testc returns 1 if (~units2 & units1) is all zeros.
+    if (!_mm256_testc_si256(units2, units1))
+      return true;
+  }
+#elif defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 2 <= unitCnt; i += 2) {
+    __m128i units1 = _mm_loadu_si128((const __m128i *)(vctr1 + i));
+    __m128i units2 = _mm_loadu_si128((const __m128i *)(vctr2 + i));
+    __m128i extra = _mm_andnot_si128(units2, units1);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(extra, zero)) != 0xffff)
+      return true;
+  }
+#endif
+  for (; i < unitCnt; i++) {
+    if ((vctr1[i] & ~vctr2[i]) != 0)
+      return true;
+  }
+  return false;
+}
+
 // Used to track weighted spill cost where a live register can have a weight
 // that increases the cost of the register being live proportional to its
 // weight.
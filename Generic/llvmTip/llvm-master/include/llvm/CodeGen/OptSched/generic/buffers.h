@@ -13,6 +13,8 @@ Last Update:  Mar. 2011
 #define OPTSCHED_GENERIC_BUFFERS_H
 
 #include "llvm/CodeGen/OptSched/generic/defines.h"
+#include <string>
+#include <vector>
 
 namespace opt_sched {
 
@@ -48,6 +50,11 @@ public:
   FUNC_RESULT Load(char const *const fileName, char const *const path,
                    long maxByts = DFLT_INPBUF_SIZE);
   FUNC_RESULT Load(char const *const fullPath, long maxByts = DFLT_INPBUF_SIZE);
+  // Makes the buffer parse the given memory, which holds a whole file or a
+  // complete part of one. The memory is not copied and stays owned by the
+  // caller. The tokens are null-terminated in place, so the memory must be
+  // writable, and the last token must be followed by a line end unless there
+  // is a writable byte after the memory.
   FUNC_RESULT SetBuf(char *buf, long size);
 
   // This function skips all comments and white spaces (tabs are not taken
@@ -72,6 +79,8 @@ protected:
   int fileHndl;
   char crntChar, prevChar;
   bool lastChnk, cmnt, lineStrt, nxtLineRchd;
+  // Whether buf was allocated by the buffer rather than given to it.
+  bool ownsBuf;
   char fullPath[MAX_NAMESIZE];
 
   // Keeps going until it encounters a data character or a line start.
@@ -114,6 +123,51 @@ protected:
                       int endPiece, char *target, int &totLngth);
 };
 
+// A DAG file mapped into memory and indexed by the DAGs it holds. A driver can
+// thus read only the DAGs it needs, in any order, without reading the rest of
+// the file, and several threads can read different DAGs at once, each through
+// its own SpecsBuffer over the DAG's part of the file. The file is mapped
+// privately and writable, since the buffers null-terminate the tokens in
+// place, so only the pages of the DAGs that are read get copied.
+class DagFileMap {
+public:
+  DagFileMap();
+  ~DagFileMap();
+
+  // Maps the given file and finds the DAGs in it.
+  FUNC_RESULT Load(char const *const fullPath);
+  // Returns the number of DAGs in the file.
+  inline int GetDagCnt() const { return (int)dags_.size(); }
+  // Returns the ID of the DAG with the given index, as given on its dag_id
+  // line.
+  inline const std::string &GetDagID(int indx) const { return dags_[indx].id; }
+  // Returns the index of the first DAG with the given ID, or INVALID_VALUE if
+  // there is none.
+  int FindDag(const std::string &dagID) const;
+  // Sets a new buffer up for reading the DAG with the given index with
+  // DataDepGraph::ReadFrmFile(). The DAG is then the only one in the buffer.
+  // Buffers over different DAGs may be used concurrently.
+  FUNC_RESULT SetBuf(int indx, SpecsBuffer &buf);
+
+private:
+  // The part of the file that holds a DAG, from its dag line up to the next
+  // one.
+  struct DagEntry {
+    long ofst;
+    long size;
+    std::string id;
+  };
+
+  char *buf_;
+  long size_;
+  bool isMapped_;
+  std::vector<DagEntry> dags_;
+
+  // Finds the DAGs in the loaded file.
+  void Index_();
+  void Unload_();
+};
+
 } // end namespace opt_sched
 
 #endif
@@ -81,8 +81,6 @@ public:
   // Adds a new edge to the successor list and does some magic.
   // TODO(max): Elaborate on magic.
   void AddScsr(GraphEdge *edge);
-  // Adds a new node as a recursive successor.
-  void AddRcrsvScsr(GraphNode *node);
   // Removes the last edge from the successor list and optionally deletes
   // the edge object. scsr must be the destination node of that edge.
   void RmvLastScsr(GraphNode *scsr, bool delEdg);
@@ -94,8 +92,6 @@ public:
   // Adds a new edge to the predecessor list and does some magic.
   // TODO(max): Elaborate on magic.
   void AddPrdcsr(GraphEdge *edge);
-  // Adds a new node as a recursive predecessor.
-  void AddRcrsvPrdcsr(GraphNode *node);
   // Removes the last edge from the predecessor list and optionally deletes
   // the edge object. scsr must be the destination node of that edge.
   void RmvLastPrdcsr(GraphNode *prdcsr, bool delEdg);
@@ -113,13 +109,17 @@ public:
   // Finds the predecessor edge from this node to the target node. Returns
   // null if not found.
   GraphEdge *FindPrdcsr(GraphNode *trgtNode);
-  // Fills the node's recursive predecessors or recursive successors list by
-  // doing a depth first traversal either up the predecessor tree or down the
-  // successor tree.
+  // Fills the node's recursive predecessor or recursive successor bitset as
+  // the union of the bitsets of its immediate neighbors in that direction,
+  // which must have been filled already.
   void FindRcrsvNghbrs(DIRECTION dir, DirAcycGraph *graph);
   // Adds the specified node to this node' recursive predecessor or successor
   // list, depending on which direction is specified.
   void AddRcrsvNghbr(GraphNode *nghbr, DIRECTION dir);
+  // Adds the nodes in the given bitset to this node's recursive predecessor or
+  // successor bitset, depending on which direction is specified. A list built
+  // from the old bitset is dropped and rebuilt when it is next asked for.
+  void AddRcrsvNghbrs(DIRECTION dir, const BitVector &nghbrs);
   // Returns a pointer to the first successor of the node and writes the label
   // of the edge between them to the label argument. Sets the successor
   // iterator.
@@ -164,6 +164,8 @@ public:
   // Returns the topological order of this node which was calculated by
   // DepthFirstVisit().
   UDT_GNODES GetTplgclOrdr() const;
+  // Sets the topological order of this node when its graph moves it.
+  void SetTplgclOrdr(UDT_GNODES tplgclOrdr);
   // Returns the maximum among the label of the edges connecting this node to
   // its successors. Calculated by AddScsr() and UpdtMaxEdgLbl().
   UDT_GLABEL GetMaxEdgeLabel() const;
@@ -191,8 +193,14 @@ public:
   // Allocates memory for the node's predecessor or successor list and bitset,
   // depending on the specified direction.
   void AllocRcrsvInfo(DIRECTION dir, UDT_GNODES nodeCnt);
+  // Makes the node's recursive predecessor or successor bitset a view of a
+  // row of its graph's transitive closure matrix. The list is then built from
+  // the bitset and the graph's topological order when it is first asked for.
+  void AttachRcrsvInfo(DIRECTION dir, BitVector::Unit *row, UDT_GNODES nodeCnt,
+                       GraphNode **tplgclOrdr);
   // Returns the node's recursive predecessor or successor list, depending on
-  // the specified direction.
+  // the specified direction. The list starts with the neighbor farthest from
+  // this node, i.e. with the leaf or the root, respectively.
   LinkedList<GraphNode> *GetRcrsvNghbrLst(DIRECTION dir);
   // Returns the node's recursive predecessor or successor bitset, depending
   // on the specified direction. Nodes which are in the list have the bits
@@ -222,6 +230,9 @@ protected:
   LinkedList<GraphNode> *rcrsvScsrLst_;
   // A list of all recursively predecessors of this node.
   LinkedList<GraphNode> *rcrsvPrdcsrLst_;
+  // The topological order of the graph whose closure matrix holds this
+  // node's recursive neighbor bitsets, or NULL if they are not attached.
+  GraphNode **grphTplgclOrdr_;
   // A bitset indicating whether each of the other nodes in the graph is a
   // recursive successor of this node.
   BitVector *isRcrsvScsr_;
@@ -243,8 +254,9 @@ protected:
 
   // TODO(max): Document what this is.
   bool FindScsr_(GraphNode *&crntScsr, UDT_GNODES trgtNum, UDT_GLABEL trgtLbl);
-  // Actually implements the functionality of FindRcrsvNghbrs().
-  void FindRcrsvNghbrs_(GraphNode *root, DIRECTION dir, DirAcycGraph *graph);
+  // Builds the recursive neighbor list in the given direction from the
+  // attached bitset.
+  void BuildRcrsvNghbrLst_(DIRECTION dir);
 };
 
 // TODO(max): Make this class actually useful by providing a way to add nodes
@@ -270,9 +282,18 @@ public:
   // Calculates the topological order of the graph's nodes by performing a
   // depth-first traversal.
   FUNC_RESULT DepthFirstSearch();
-  // Fills the recursive predecessor or successor lists for each node in the
-  // graph, depending on the specified direction.
+  // Computes the transitive closure of the graph in the specified direction,
+  // i.e. the recursive successor or predecessor bitset of each node. The
+  // nodes are visited in reverse topological order for successors and in
+  // topological order for predecessors, so each node's bitset is the union of
+  // its neighbors' bitsets. All bitsets of one direction are rows of a single
+  // matrix owned by the graph.
   FUNC_RESULT FindRcrsvNghbrs(DIRECTION dir);
+  // Brings the transitive closure and the topological order up to date with
+  // a new edge from frmNode to toNode, which must not close a cycle. Only the
+  // bitsets of the nodes that the edge newly connects and the part of the
+  // topological order between the edge's ends are touched.
+  void UpdateForNewEdge(GraphNode *frmNode, GraphNode *toNode);
 
   inline void CycleDetected() { cycleDetected_ = true; }
 
@@ -300,6 +321,9 @@ protected:
 
   // An array holding the topological order of the graph's nodes.
   GraphNode **tplgclOrdr_;
+  // The transitive closure matrices, indexed by direction. Row i holds the
+  // recursive neighbor bitset of node i.
+  BitVector::Unit *rcrsvNghbrBits_[2];
   // Whether a depth first traversal has been performed and the topological
   // order has been calculated.
   bool dpthFrstSrchDone_;
@@ -333,16 +357,6 @@ inline void GraphNode::AddScsr(GraphEdge *edge) {
   }
 }
 
-inline void GraphNode::AddRcrsvPrdcsr(GraphNode *node) {
-  rcrsvPrdcsrLst_->InsrtElmnt(node);
-  isRcrsvPrdcsr_->SetBit(node->GetNum());
-}
-
-inline void GraphNode::AddRcrsvScsr(GraphNode *node) {
-  rcrsvScsrLst_->InsrtElmnt(node);
-  isRcrsvScsr_->SetBit(node->GetNum());
-}
-
 inline void GraphNode::UpdtMaxEdgLbl(UDT_GLABEL label) {
   if (label > maxEdgLbl_)
     maxEdgLbl_ = label;
@@ -443,10 +457,20 @@ inline UDT_GLABEL GraphNode::GetPrdcsrLblSum() const { return prdcsrLblSum_; }
 
 inline UDT_GNODES GraphNode::GetTplgclOrdr() const { return tplgclOrdr_; }
 
+inline void GraphNode::SetTplgclOrdr(UDT_GNODES tplgclOrdr) {
+  tplgclOrdr_ = tplgclOrdr;
+}
+
 inline UDT_GLABEL GraphNode::GetMaxEdgeLabel() const { return maxEdgLbl_; }
 
 inline LinkedList<GraphNode> *GraphNode::GetRcrsvNghbrLst(DIRECTION dir) {
-  return dir == DIR_FRWRD ? rcrsvScsrLst_ : rcrsvPrdcsrLst_;
+  LinkedList<GraphNode> *rcrsvNghbrLst =
+      dir == DIR_FRWRD ? rcrsvScsrLst_ : rcrsvPrdcsrLst_;
+  if (rcrsvNghbrLst == NULL && grphTplgclOrdr_ != NULL) {
+    BuildRcrsvNghbrLst_(dir);
+    rcrsvNghbrLst = dir == DIR_FRWRD ? rcrsvScsrLst_ : rcrsvPrdcsrLst_;
+  }
+  return rcrsvNghbrLst;
 }
 
 inline BitVector *GraphNode::GetRcrsvNghbrBitVector(DIRECTION dir) {
@@ -0,0 +1,311 @@
+/*******************************************************************************
+Description:  Defines an open-addressing hash table with binary keys that
+              supports concurrent lock-free insertions and lookups. Slots are
+              grouped into cache-line-sized buckets, and each slot stores the
+              key next to the element pointer, so a lookup is a linear scan of
+              consecutive cache lines rather than a walk of a linked list. When
+              the table fills up, a larger segment is added in front of the
+              existing ones instead of rehashing, so entries never move and
+              readers never need to be stopped.
+Created:      Oct. 2026
+Last Update:  Oct. 2026
+*******************************************************************************/
+
+#ifndef OPTSCHED_GENERIC_OPEN_HASH_TABLE_H
+#define OPTSCHED_GENERIC_OPEN_HASH_TABLE_H
+
+#include "llvm/CodeGen/OptSched/generic/defines.h"
+#include "llvm/CodeGen/OptSched/generic/hash_table.h"
+#include "llvm/CodeGen/OptSched/generic/logger.h"
+#include <atomic>
+#include <cstdint>
+#include <new>
+
+namespace opt_sched {
+
+template <class T> class OpenHashTable {
+private:
+  struct Slot;
+  struct Sgmnt;
+
+public:
+  // The traversal state of a lookup. Each thread uses its own cursor, so any
+  // number of lookups can be in progress at the same time.
+  struct Cursor {
+    const Sgmnt *sgmnt;
+    UDT_HASHTBL_CPCTY pos;
+    UDT_HASHTBL_CPCTY left;
+    UDT_HASHKEY key;
+    // The total length of the probe chains that the lookup has entered so
+    // far, one per segment.
+    UDT_HASHTBL_CPCTY chainLngth;
+  };
+
+  // Creates a table with 2^hashBitCnt buckets in its initial segment.
+  OpenHashTable(int16_t hashBitCnt);
+  ~OpenHashTable();
+
+  // Inserts an element. Safe to call concurrently with other insertions and
+  // lookups.
+  void InsertElement(UDT_HASHKEY key, T *elmnt);
+
+  // Returns the most recently inserted element with the given key, or NULL if
+  // there is none. Further matches are retrieved with GetPrevMatch().
+  T *GetLastMatch(UDT_HASHKEY key, Cursor &crsr) const;
+  // Returns the next older element with the key of the cursor, or NULL if
+  // there are no more matches.
+  T *GetPrevMatch(Cursor &crsr) const;
+
+  UDT_HASHTBL_CPCTY GetEntryCnt() const {
+    return entryCnt_.load(std::memory_order_relaxed);
+  }
+
+  // Removes all entries without deleting the elements. Must not be called
+  // while other threads are using the table.
+  void Clear();
+
+private:
+  // The number of slots in each cache-line-sized bucket.
+  static const int SLOTS_PER_BKT = 4;
+  static const int CACHE_LINE_SIZE = 64;
+  // Keeps the slot count of a segment representable in UDT_HASHTBL_CPCTY.
+  static const int16_t MAX_SGMNT_HASHBITS = 29;
+
+  struct Slot {
+    std::atomic<UDT_HASHKEY> key;
+    // NULL for an empty slot, or Claimed_() while the slot is being filled.
+    std::atomic<T *> elmnt;
+  };
+
+  struct Sgmnt {
+    char *mem;
+    Slot *slots;
+    int16_t hashBitCnt;
+    UDT_HASHTBL_CPCTY slotMask;
+    // Insertions beyond this count go to a new segment to keep probes short.
+    UDT_HASHTBL_CPCTY maxEntryCnt;
+    std::atomic<UDT_HASHTBL_CPCTY> entryCnt;
+    // The previous (smaller and older) segment.
+    Sgmnt *older;
+  };
+
+  // The newest segment, where all insertions go.
+  std::atomic<Sgmnt *> head_;
+  std::atomic<UDT_HASHTBL_CPCTY> entryCnt_;
+
+  static T *Claimed_() { return reinterpret_cast<T *>(1); }
+
+  static Sgmnt *AllocSgmnt_(int16_t hashBitCnt, Sgmnt *older);
+  static void FreeSgmnt_(Sgmnt *sgmnt);
+  static void ClearSgmnt_(Sgmnt *sgmnt);
+  static UDT_HASHTBL_CPCTY Home_(const Sgmnt *sgmnt, UDT_HASHKEY key);
+  // Returns the number of occupied slots starting at the home of the key.
+  static UDT_HASHTBL_CPCTY ChainLngth_(const Sgmnt *sgmnt, UDT_HASHKEY key);
+  static bool InsertInSgmnt_(Sgmnt *sgmnt, UDT_HASHKEY key, T *elmnt);
+  void Grow_(Sgmnt *full);
+  static void StartSgmnt_(Cursor &crsr);
+};
+
+template <class T> OpenHashTable<T>::OpenHashTable(int16_t hashBitCnt) {
+  assert(hashBitCnt > 0 && hashBitCnt <= MAX_SGMNT_HASHBITS);
+  head_.store(AllocSgmnt_(hashBitCnt, NULL), std::memory_order_relaxed);
+  entryCnt_.store(0, std::memory_order_relaxed);
+}
+
+template <class T> OpenHashTable<T>::~OpenHashTable() {
+  Sgmnt *older;
+  for (Sgmnt *sgmnt = head_.load(std::memory_order_relaxed); sgmnt != NULL;
+       sgmnt = older) {
+    older = sgmnt->older;
+    FreeSgmnt_(sgmnt);
+  }
+}
+
+template <class T>
+typename OpenHashTable<T>::Sgmnt *
+OpenHashTable<T>::AllocSgmnt_(int16_t hashBitCnt, Sgmnt *older) {
+  UDT_HASHTBL_CPCTY slotCnt = ((UDT_HASHTBL_CPCTY)1 << hashBitCnt) *
+                              SLOTS_PER_BKT;
+
+  Sgmnt *sgmnt = new Sgmnt;
+  if (sgmnt == NULL)
+    Logger::Fatal("Out of memory.");
+
+  sgmnt->mem = new char[slotCnt * sizeof(Slot) + CACHE_LINE_SIZE - 1];
+  if (sgmnt->mem == NULL)
+    Logger::Fatal("Out of memory.");
+
+  // Align the slots so that every bucket occupies exactly one cache line.
+  uintptr_t addr = reinterpret_cast<uintptr_t>(sgmnt->mem);
+  addr = (addr + CACHE_LINE_SIZE - 1) & ~(uintptr_t)(CACHE_LINE_SIZE - 1);
+  sgmnt->slots = reinterpret_cast<Slot *>(addr);
+
+  for (UDT_HASHTBL_CPCTY i = 0; i < slotCnt; i++) {
+    new (&sgmnt->slots[i]) Slot;
+  }
+
+  sgmnt->hashBitCnt = hashBitCnt;
+  sgmnt->slotMask = slotCnt - 1;
+  sgmnt->maxEntryCnt = slotCnt / 2;
+  sgmnt->older = older;
+  sgmnt->entryCnt.store(0, std::memory_order_relaxed);
+  ClearSgmnt_(sgmnt);
+  return sgmnt;
+}
+
+template <class T> void OpenHashTable<T>::FreeSgmnt_(Sgmnt *sgmnt) {
+  delete[] sgmnt->mem;
+  delete sgmnt;
+}
+
+template <class T> void OpenHashTable<T>::ClearSgmnt_(Sgmnt *sgmnt) {
+  for (UDT_HASHTBL_CPCTY i = 0; i <= sgmnt->slotMask; i++) {
+    sgmnt->slots[i].key.store(0, std::memory_order_relaxed);
+    sgmnt->slots[i].elmnt.store(NULL, std::memory_order_relaxed);
+  }
+  sgmnt->entryCnt.store(0, std::memory_order_relaxed);
+}
+
+template <class T>
+inline UDT_HASHTBL_CPCTY OpenHashTable<T>::Home_(const Sgmnt *sgmnt,
+                                                 UDT_HASHKEY key) {
+  // Partial schedule signatures only occupy the low bits of the key, so mix
+  // all of them into the bucket number.
+  uint64_t hash = (uint64_t)key * 0x9E3779B97F4A7C15ULL;
+  UDT_HASHTBL_CPCTY bkt = (UDT_HASHTBL_CPCTY)(hash >> (64 - sgmnt->hashBitCnt));
+  return bkt * SLOTS_PER_BKT;
+}
+
+template <class T>
+UDT_HASHTBL_CPCTY OpenHashTable<T>::ChainLngth_(const Sgmnt *sgmnt,
+                                                UDT_HASHKEY key) {
+  UDT_HASHTBL_CPCTY pos = Home_(sgmnt, key);
+  UDT_HASHTBL_CPCTY lngth = 0;
+
+  while (lngth <= sgmnt->slotMask &&
+         sgmnt->slots[pos].elmnt.load(std::memory_order_acquire) != NULL) {
+    lngth++;
+    pos = (pos + 1) & sgmnt->slotMask;
+  }
+
+  return lngth;
+}
+
+template <class T>
+bool OpenHashTable<T>::InsertInSgmnt_(Sgmnt *sgmnt, UDT_HASHKEY key,
+                                      T *elmnt) {
+  // Reserve room first, so that a free slot is guaranteed to exist.
+  if (sgmnt->entryCnt.fetch_add(1, std::memory_order_relaxed) >=
+      sgmnt->maxEntryCnt) {
+    sgmnt->entryCnt.fetch_sub(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  UDT_HASHTBL_CPCTY pos = Home_(sgmnt, key);
+
+  while (true) {
+    Slot &slot = sgmnt->slots[pos];
+    T *expctd = NULL;
+
+    if (slot.elmnt.load(std::memory_order_relaxed) == NULL &&
+        slot.elmnt.compare_exchange_strong(expctd, Claimed_(),
+                                           std::memory_order_acquire)) {
+      slot.key.store(key, std::memory_order_relaxed);
+      // Publish the key together with the element.
+      slot.elmnt.store(elmnt, std::memory_order_release);
+      return true;
+    }
+
+    pos = (pos + 1) & sgmnt->slotMask;
+  }
+}
+
+template <class T> void OpenHashTable<T>::Grow_(Sgmnt *full) {
+  if (full->hashBitCnt == MAX_SGMNT_HASHBITS)
+    Logger::Fatal("History table is full.");
+
+  Sgmnt *newSgmnt = AllocSgmnt_(full->hashBitCnt + 1, full);
+
+  // Another thread may have grown the table in the meantime.
+  if (!head_.compare_exchange_strong(full, newSgmnt,
+                                     std::memory_order_acq_rel)) {
+    FreeSgmnt_(newSgmnt);
+  }
+}
+
+template <class T>
+void OpenHashTable<T>::InsertElement(UDT_HASHKEY key, T *elmnt) {
+  assert(elmnt != NULL && elmnt != Claimed_());
+
+  while (true) {
+    Sgmnt *sgmnt = head_.load(std::memory_order_acquire);
+
+    if (InsertInSgmnt_(sgmnt, key, elmnt)) {
+      entryCnt_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    Grow_(sgmnt);
+  }
+}
+
+template <class T> void OpenHashTable<T>::StartSgmnt_(Cursor &crsr) {
+  // A lookup walks the probe chain backwards from its end, so that elements
+  // with the same key are found in the reverse order of their insertion.
+  crsr.left = ChainLngth_(crsr.sgmnt, crsr.key);
+  crsr.chainLngth += crsr.left;
+  crsr.pos = (Home_(crsr.sgmnt, crsr.key) + crsr.left) & crsr.sgmnt->slotMask;
+}
+
+template <class T>
+T *OpenHashTable<T>::GetLastMatch(UDT_HASHKEY key, Cursor &crsr) const {
+  crsr.key = key;
+  crsr.sgmnt = head_.load(std::memory_order_acquire);
+  crsr.chainLngth = 0;
+  StartSgmnt_(crsr);
+  return GetPrevMatch(crsr);
+}
+
+template <class T> T *OpenHashTable<T>::GetPrevMatch(Cursor &crsr) const {
+  while (crsr.sgmnt != NULL) {
+    while (crsr.left > 0) {
+      crsr.pos = (crsr.pos - 1) & crsr.sgmnt->slotMask;
+      crsr.left--;
+
+      const Slot &slot = crsr.sgmnt->slots[crsr.pos];
+      T *elmnt = slot.elmnt.load(std::memory_order_acquire);
+      // Skip slots that are still being filled by another thread.
+      if (elmnt != Claimed_() &&
+          slot.key.load(std::memory_order_relaxed) == crsr.key) {
+        return elmnt;
+      }
+    }
+
+    crsr.sgmnt = crsr.sgmnt->older;
+    if (crsr.sgmnt != NULL)
+      StartSgmnt_(crsr);
+  }
+
+  return NULL;
+}
+
+template <class T> void OpenHashTable<T>::Clear() {
+  Sgmnt *head = head_.load(std::memory_order_relaxed);
+
+  // Keep only the largest segment, which is sized for the previous use.
+  Sgmnt *older;
+  for (Sgmnt *sgmnt = head->older; sgmnt != NULL; sgmnt = older) {
+    older = sgmnt->older;
+    FreeSgmnt_(sgmnt);
+  }
+  head->older = NULL;
+
+  if (head->entryCnt.load(std::memory_order_relaxed) > 0)
+    ClearSgmnt_(head);
+
+  entryCnt_.store(0, std::memory_order_relaxed);
+}
+
+} // end namespace opt_sched
+
+#endif
@@ -13,8 +13,11 @@ Last Update:  Mar. 2011
 
 namespace opt_sched {
 
+// Each thread draws from a generator of its own, so threads that schedule
+// different regions do not disturb each other's sequences. A thread starts as
+// if it had been seeded with zero.
 namespace RandomGen {
-// Initialize the random number generator with a seed.
+// Initialize the random number generator of the calling thread with a seed.
 void SetSeed(int32_t iseed);
 // Get a random 32-bit value.
 uint32_t GetRand32();
@@ -27,6 +30,24 @@ uint64_t GetRand64();
 void GetRandBits(uint16_t bitCnt, unsigned char *dest);
 }
 
+// An independent instance of the same generator, for code that draws random
+// numbers concurrently with other threads. Streams with different seeds give
+// different sequences.
+class RandomStream {
+public:
+  // Creates a stream seeded as RandomGen::SetSeed() would seed the global
+  // generator.
+  explicit RandomStream(int32_t seed);
+
+  // Get a random 32-bit value.
+  uint32_t GetRand32();
+
+private:
+  long j_;
+  long k_;
+  uint32_t y_[55];
+};
+
 } // end namespace opt_sched
 
 #endif
@@ -253,128 +253,130 @@ protected:
 typedef IndexedNumericStat<int64_t> IndexedIntStat;
 typedef IndexedNumericStat<float> IndexedFloatStat;
 
-// Declarations of the actual statistical records.
+// Declarations of the actual statistical records. Each thread keeps records of
+// its own, so that threads scheduling different regions or enumerating the same
+// region do not race on them.
 // TODO(max): Document where ambiguous.
-extern IntDistributionStat nodeCount;
-extern IntDistributionStat nodesPerLength;
-extern IntDistributionStat solutionTime;
-extern IntDistributionStat solutionTimeForSolvedProblems;
+extern thread_local IntDistributionStat nodeCount;
+extern thread_local IntDistributionStat nodesPerLength;
+extern thread_local IntDistributionStat solutionTime;
+extern thread_local IntDistributionStat solutionTimeForSolvedProblems;
 
-extern IntDistributionStat iterations;
-extern IntDistributionStat enumerations;
-extern IntDistributionStat lengths;
+extern thread_local IntDistributionStat iterations;
+extern thread_local IntDistributionStat enumerations;
+extern thread_local IntDistributionStat lengths;
 
-extern IntDistributionStat feasibleSchedulesPerLength;
-extern IntDistributionStat improvementsPerLength;
+extern thread_local IntDistributionStat feasibleSchedulesPerLength;
+extern thread_local IntDistributionStat improvementsPerLength;
 
-extern IntDistributionStat costChecksPerLength;
-extern IntDistributionStat costPruningsPerLength;
-extern IntDistributionStat dynamicLBIterationsPerPath;
+extern thread_local IntDistributionStat costChecksPerLength;
+extern thread_local IntDistributionStat costPruningsPerLength;
+extern thread_local IntDistributionStat dynamicLBIterationsPerPath;
 
-extern IntDistributionStat problemSize;
-extern IntDistributionStat solvedProblemSize;
-extern IntDistributionStat unsolvedProblemSize;
+extern thread_local IntDistributionStat problemSize;
+extern thread_local IntDistributionStat solvedProblemSize;
+extern thread_local IntDistributionStat unsolvedProblemSize;
 
-extern IntDistributionStat traceCostLowerBound;
+extern thread_local IntDistributionStat traceCostLowerBound;
 
-extern IntDistributionStat traceHeuristicCost;
-extern IntDistributionStat traceOptimalCost;
+extern thread_local IntDistributionStat traceHeuristicCost;
+extern thread_local IntDistributionStat traceOptimalCost;
 
-extern IntDistributionStat traceHeuristicScheduleLength;
-extern IntDistributionStat traceOptimalScheduleLength;
+extern thread_local IntDistributionStat traceHeuristicScheduleLength;
+extern thread_local IntDistributionStat traceOptimalScheduleLength;
 
-extern IntDistributionStat regionBuildTime;
-extern IntDistributionStat heuristicTime;
-extern IntDistributionStat boundComputationTime;
-extern IntDistributionStat enumerationTime;
-extern IntDistributionStat enumerationToHeuristicTimeRatio;
-extern IntDistributionStat verificationTime;
+extern thread_local IntDistributionStat regionBuildTime;
+extern thread_local IntDistributionStat heuristicTime;
+extern thread_local IntDistributionStat boundComputationTime;
+extern thread_local IntDistributionStat enumerationTime;
+extern thread_local IntDistributionStat enumerationToHeuristicTimeRatio;
+extern thread_local IntDistributionStat verificationTime;
 
-extern IntDistributionStat historyEntriesPerIteration;
-extern IntDistributionStat historyListSize;
-extern IntDistributionStat maximumHistoryListSize;
-extern IntDistributionStat traversedHistoryListSize;
-extern IntDistributionStat historyDominationPosition;
-extern IntDistributionStat historyDominationPositionToListSize;
-extern IntDistributionStat historyTableInitializationTime;
+extern thread_local IntDistributionStat historyEntriesPerIteration;
+extern thread_local IntDistributionStat historyListSize;
+extern thread_local IntDistributionStat maximumHistoryListSize;
+extern thread_local IntDistributionStat traversedHistoryListSize;
+extern thread_local IntDistributionStat historyDominationPosition;
+extern thread_local IntDistributionStat historyDominationPositionToListSize;
+extern thread_local IntDistributionStat historyTableInitializationTime;
 
-extern IntDistributionStat scheduledLatency;
+extern thread_local IntDistributionStat scheduledLatency;
 
 // The number of regions whose scheduling timed out.
-extern TimeoutStat timeouts;
+extern thread_local TimeoutStat timeouts;
 
 // The number of perfectly matched blocks (when comparing to input).
-extern IntStat perfectMatchCount;
+extern thread_local IntStat perfectMatchCount;
 // The number of positively mismatched blocks (when comparing to input).
-extern IntStat positiveMismatchCount;
+extern thread_local IntStat positiveMismatchCount;
 // The number of negatively mismatched blocks (when comparing to input).
-extern IntStat negativeMismatchCount;
+extern thread_local IntStat negativeMismatchCount;
 // The number of blocks that were scheduled optimally but were not optimal
 // in the input (when comparing to input).
-extern IntStat positiveOptimalMismatchCount;
+extern thread_local IntStat positiveOptimalMismatchCount;
 // The number of blocks that were not scheduled optimally but were optimal
 // in the input (when comparing to input).
-extern IntStat negativeOptimalMismatchCount;
+extern thread_local IntStat negativeOptimalMismatchCount;
 // The number of blocks that were scheduled to have a lower upper bound
 // than the one specified in the input (when comparing to input).
-extern IntStat positiveUpperBoundMismatchCount;
+extern thread_local IntStat positiveUpperBoundMismatchCount;
 // The number of blocks that were scheduled to have a higher upper bound
 // than the one specified in the input (when comparing to input).
-extern IntStat negativeUpperBoundMismatchCount;
+extern thread_local IntStat negativeUpperBoundMismatchCount;
 // The number of blocks that were scheduled to have a higher lower bound
 // than the one specified in the input (when comparing to input).
-extern IntStat positiveLowerBoundMismatchCount;
+extern thread_local IntStat positiveLowerBoundMismatchCount;
 // The number of blocks that were scheduled to have a lower lower bound
 // than the one specified in the input (when comparing to input).
-extern IntStat negativeLowerBoundMismatchCount;
+extern thread_local IntStat negativeLowerBoundMismatchCount;
 
 // Enumeration stats.
-extern IntStat signatureDominationTests;
-extern IntStat signatureMatches;
-extern IntStat signatureAliases;
-extern IntStat subsetMatches;
-extern IntStat absoluteDominationHits;
-extern IntStat positiveDominationHits;
-extern IntStat negativeDominationHits;
-extern IntStat dominationPruningHits;
-extern IntStat invalidDominationHits;
-
-extern IntStat stalls;
-extern IntStat feasibilityTests;
-extern IntStat feasibilityHits;
-extern IntStat nodeSuperiorityInfeasibilityHits;
-extern IntStat rangeTighteningInfeasibilityHits;
-extern IntStat historyDominationInfeasibilityHits;
-extern IntStat relaxedSchedulingInfeasibilityHits;
-extern IntStat slotCountInfeasibilityHits;
-extern IntStat forwardLBInfeasibilityHits;
-extern IntStat backwardLBInfeasibilityHits;
-
-extern IntStat invalidSchedules;
+extern thread_local IntStat signatureDominationTests;
+extern thread_local IntStat signatureMatches;
+extern thread_local IntStat signatureAliases;
+extern thread_local IntStat subsetMatches;
+extern thread_local IntStat absoluteDominationHits;
+extern thread_local IntStat positiveDominationHits;
+extern thread_local IntStat negativeDominationHits;
+extern thread_local IntStat dominationPruningHits;
+extern thread_local IntStat invalidDominationHits;
+
+extern thread_local IntStat stalls;
+extern thread_local IntStat feasibilityTests;
+extern thread_local IntStat feasibilityHits;
+extern thread_local IntStat nodeSuperiorityInfeasibilityHits;
+extern thread_local IntStat rangeTighteningInfeasibilityHits;
+extern thread_local IntStat historyDominationInfeasibilityHits;
+extern thread_local IntStat relaxedSchedulingInfeasibilityHits;
+extern thread_local IntStat slotCountInfeasibilityHits;
+extern thread_local IntStat forwardLBInfeasibilityHits;
+extern thread_local IntStat backwardLBInfeasibilityHits;
+
+extern thread_local IntStat invalidSchedules;
 
 // File/relaxed bound comparisons.
-extern IntStat totalInstructions;
-extern IntStat instructionsWithTighterFileLB;
-extern IntStat cyclesTightenedForTighterFileLB;
-extern IntStat instructionsWithTighterRelaxedLB;
-extern IntStat cyclesTightenedForTighterRelaxedLB;
-extern IntStat instructionsWithEqualLB;
-extern IntStat instructionsWithTighterFileUB;
-extern IntStat cyclesTightenedForTighterFileUB;
-extern IntStat instructionsWithTighterRelaxedUB;
-extern IntStat cyclesTightenedForTighterRelaxedUB;
-extern IntStat instructionsWithEqualUB;
-
-extern IntStat maxReadyListSize;
-
-extern IntStat negativeNodeDominationHits;
-
-extern IndexedIntStat instructionTypeCounts;
-extern IndexedIntSetStat instructionTypeLatencies;
-extern IndexedIntSetStat dependenceTypeLatencies;
-
-extern IntStat legalListSchedulerInstructionHits;
-extern IntStat illegalListSchedulerInstructionHits;
+extern thread_local IntStat totalInstructions;
+extern thread_local IntStat instructionsWithTighterFileLB;
+extern thread_local IntStat cyclesTightenedForTighterFileLB;
+extern thread_local IntStat instructionsWithTighterRelaxedLB;
+extern thread_local IntStat cyclesTightenedForTighterRelaxedLB;
+extern thread_local IntStat instructionsWithEqualLB;
+extern thread_local IntStat instructionsWithTighterFileUB;
+extern thread_local IntStat cyclesTightenedForTighterFileUB;
+extern thread_local IntStat instructionsWithTighterRelaxedUB;
+extern thread_local IntStat cyclesTightenedForTighterRelaxedUB;
+extern thread_local IntStat instructionsWithEqualUB;
+
+extern thread_local IntStat maxReadyListSize;
+
+extern thread_local IntStat negativeNodeDominationHits;
+
+extern thread_local IndexedIntStat instructionTypeCounts;
+extern thread_local IndexedIntSetStat instructionTypeLatencies;
+extern thread_local IndexedIntSetStat dependenceTypeLatencies;
+
+extern thread_local IntStat legalListSchedulerInstructionHits;
+extern thread_local IntStat illegalListSchedulerInstructionHits;
 }
 
 } // end namespace opt_sched
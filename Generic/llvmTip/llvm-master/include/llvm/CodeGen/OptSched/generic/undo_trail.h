@@ -0,0 +1,169 @@
+/*******************************************************************************
+Description:  Implements an undo trail, a stack of the previous values of the
+              variables that a search changes as it moves forward. A search
+              notes the size of the trail at each point it may return to, and
+              going back to such a point pops the trail down to that size,
+              restoring each variable in the reverse order of its changes.
+              The cost of going back is thus proportional to the number of
+              changes rather than to the size of the saved state.
+Created:      Oct. 2026
+Last Update:  Oct. 2026
+*******************************************************************************/
+
+#ifndef OPTSCHED_GENERIC_UNDO_TRAIL_H
+#define OPTSCHED_GENERIC_UNDO_TRAIL_H
+
+#include "llvm/CodeGen/OptSched/generic/bit_vector.h"
+#include "llvm/CodeGen/OptSched/generic/defines.h"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace opt_sched {
+
+class UndoTrail {
+public:
+  // Creates an empty trail with room for the given number of changes. The
+  // trail grows as needed.
+  inline UndoTrail(size_t initCap = 0);
+
+  // Returns the number of changes on the trail.
+  inline size_t GetSize() const { return chngs_.size(); }
+  // Drops all the changes without undoing them.
+  inline void Reset();
+
+  // Records the current value of a variable that is about to be changed.
+  inline void Save(int &var);
+  inline void Save(int16_t &var);
+  inline void Save(bool &var);
+  // Records the value that a variable had before it was changed.
+  inline void Save(int &var, int prevVal);
+  // Sets a bit of a weighted bit vector, recording the change if the bit
+  // changes.
+  inline void SetBit(WeightedBitVector *vctr, int indx, bool val, int wght);
+
+  // Undoes the changes made since the trail had the given size.
+  inline void Undo(size_t size);
+
+  // While the trail is paused, the changes are not recorded. This is meant
+  // for code that rebuilds the state from scratch, after which the recorded
+  // changes still hold. Pausing may be nested.
+  inline void Pause() { pauseCnt_++; }
+  inline void Resume();
+  inline bool IsPaused() const { return pauseCnt_ > 0; }
+
+private:
+  enum CHNG_TYPE { CT_INT, CT_SHORT, CT_BOOL, CT_BIT };
+
+  // A recorded change. Bit changes keep the index of the bit in prevVal,
+  // along with the previous value of the bit and the weight to pass to the
+  // vector when setting the bit back.
+  struct Chng {
+    CHNG_TYPE type;
+    bool prevBit;
+    int prevVal;
+    int wght;
+    union {
+      int *intVar;
+      int16_t *shortVar;
+      bool *boolVar;
+      WeightedBitVector *vctr;
+    };
+  };
+
+  std::vector<Chng> chngs_;
+  int pauseCnt_;
+
+  inline void Push_(const Chng &chng);
+};
+
+inline UndoTrail::UndoTrail(size_t initCap) {
+  chngs_.reserve(initCap);
+  pauseCnt_ = 0;
+}
+
+inline void UndoTrail::Reset() {
+  chngs_.clear();
+  pauseCnt_ = 0;
+}
+
+inline void UndoTrail::Resume() {
+  assert(pauseCnt_ > 0);
+  pauseCnt_--;
+}
+
+inline void UndoTrail::Push_(const Chng &chng) {
+  if (pauseCnt_ == 0)
+    chngs_.push_back(chng);
+}
+
+inline void UndoTrail::Save(int &var) { Save(var, var); }
+
+inline void UndoTrail::Save(int &var, int prevVal) {
+  Chng chng;
+  chng.type = CT_INT;
+  chng.prevVal = prevVal;
+  chng.intVar = &var;
+  Push_(chng);
+}
+
+inline void UndoTrail::Save(int16_t &var) {
+  Chng chng;
+  chng.type = CT_SHORT;
+  chng.prevVal = var;
+  chng.shortVar = &var;
+  Push_(chng);
+}
+
+inline void UndoTrail::Save(bool &var) {
+  Chng chng;
+  chng.type = CT_BOOL;
+  chng.prevVal = var;
+  chng.boolVar = &var;
+  Push_(chng);
+}
+
+inline void UndoTrail::SetBit(WeightedBitVector *vctr, int indx, bool val,
+                              int wght) {
+  if (vctr->GetBit(indx) != val) {
+    Chng chng;
+    chng.type = CT_BIT;
+    chng.prevBit = !val;
+    chng.prevVal = indx;
+    chng.wght = wght;
+    chng.vctr = vctr;
+    Push_(chng);
+  }
+
+  vctr->SetBit(indx, val, wght);
+}
+
+inline void UndoTrail::Undo(size_t size) {
+  assert(size <= chngs_.size());
+
+  while (chngs_.size() > size) {
+    const Chng &chng = chngs_.back();
+
+    switch (chng.type) {
+    case CT_INT:
+      *chng.intVar = chng.prevVal;
+      break;
+    case CT_SHORT:
+      *chng.shortVar = static_cast<int16_t>(chng.prevVal);
+      break;
+    case CT_BOOL:
+      *chng.boolVar = chng.prevVal != 0;
+      break;
+    case CT_BIT:
+      chng.vctr->SetBit(chng.prevVal, chng.prevBit, chng.wght);
+      break;
+    }
+
+    chngs_.pop_back();
+  }
+}
+
+} // end namespace opt_sched
+
+#endif
@@ -19,9 +19,9 @@ uint16_t clcltBitsNeededToHoldNum(uint64_t value);
 // Returns the time that has passed since the start of the process, in
 // milliseconds.
 Milliseconds GetProcessorTime();
-// Returns a reference to an object that is supposed to initialized with the
-// start time of the process
-extern std::chrono::high_resolution_clock::time_point startTime;
+// The start time of the process. It is never reset, so regions that are
+// scheduled concurrently measure their timeouts from the times they start.
+extern const std::chrono::high_resolution_clock::time_point startTime;
 }
 
 inline uint16_t Utilities::clcltBitsNeededToHoldNum(uint64_t value) {
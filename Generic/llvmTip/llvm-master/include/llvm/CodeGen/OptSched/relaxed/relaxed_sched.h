@@ -111,6 +111,9 @@ class RJ_RelaxedScheduler : public RelaxedScheduler {
 private:
   InstCount chkdInstCnt_;
 
+  // The trail that FixInst() records its changes on, or NULL.
+  UndoTrail *trail_;
+
   void Initialize_(bool setPrirtyLst);
   void InitChkng_(InstCount crntCycle);
   void EndChkng_(InstCount crntCycle);
@@ -143,6 +146,10 @@ public:
 
   // Undo the fixing of an inst.
   void UnFixInst(SchedInstruction *inst, InstCount cycle);
+
+  // Make FixInst() record its changes on the given trail, so that fixings can
+  // be undone by undoing the trail instead of calling UnFixInst()
+  inline void SetTrail(UndoTrail *trail) { trail_ = trail; }
 };
 /*****************************************************************************/
 
@@ -0,0 +1,89 @@
+/*******************************************************************************
+Description:  Ranks the regions of a process by their dynamic weight, the
+              product of the weight of the region (how often it runs) and the
+              cost gap left by its heuristic schedule, and decides how much
+              enumeration time each region gets. Only the regions whose weight
+              ranks at or above ENUM_WEIGHT_PERCENTILE are enumerated, and their
+              timeouts are scaled by how much heavier than the median region
+              they are, up to MAX_WEIGHT_TIMEOUT_SCALE. Since regions are
+              scheduled one after the other, each region is ranked against the
+              regions ranked before it. Regions scheduled concurrently are
+              not ranked, since their order would make the ranking
+              nondeterministic, but the workers of one region share its
+              rank.
+Created:      Oct. 2026
+Last Update:  Oct. 2026
+*******************************************************************************/
+
+#ifndef OPTSCHED_SCHED_REGION_REGION_RANKING_H
+#define OPTSCHED_SCHED_REGION_REGION_RANKING_H
+
+#include "llvm/CodeGen/OptSched/generic/defines.h"
+#include <mutex>
+#include <vector>
+
+namespace opt_sched {
+
+class RegionRanking {
+public:
+  // The enumeration time given to a region.
+  struct Allotment {
+    // Whether the region is enumerated at all.
+    bool isEnumerated;
+    // The factor by which the timeouts of the region are scaled.
+    float timeoutScale;
+  };
+
+  // The allotment of a region that is scheduled by several workers, each with
+  // its own copy of the region. The first worker to get there ranks the
+  // region, and the others take the same allotment.
+  struct SharedAllotment {
+    std::once_flag once;
+    Allotment allotment;
+  };
+
+  // Creates a ranking with the given percentile, from 0 to 100, and maximum
+  // timeout scale.
+  RegionRanking(float enumPrcntl, float maxTimeoutScale);
+  ~RegionRanking() {}
+  RegionRanking(const RegionRanking &) = delete;
+  void operator=(const RegionRanking &) = delete;
+
+  // Returns the ranking of the process, set up from the OptSched settings the
+  // first time it is called.
+  static RegionRanking &GetInstance();
+
+  // Returns true if the weights of the regions make any difference to the
+  // time they get.
+  inline bool IsEnabled() const {
+    return enumPrcntl_ > 0 || maxTimeoutScale_ > 1;
+  }
+
+  // Ranks a region with the given dynamic weight among the regions ranked so
+  // far and returns the enumeration time allotted to it.
+  Allotment Rank(double wght);
+
+private:
+  // The weights are counted in buckets that are BCKTS_PER_OCTAVE to a power of
+  // two, from 2^MIN_WGHT_EXP up to 2^-MIN_WGHT_EXP. The first bucket holds the
+  // weights of zero and below.
+  static const int BCKTS_PER_OCTAVE = 8;
+  static const int MIN_WGHT_EXP = -64;
+  static const int BCKT_CNT = -2 * MIN_WGHT_EXP * BCKTS_PER_OCTAVE + 1;
+
+  // Returns the bucket that holds the given weight.
+  static int GetBckt_(double wght);
+  // Returns the weight in the middle of the given bucket.
+  static double GetBcktWght_(int bckt);
+
+  std::mutex lock_;
+  float enumPrcntl_;
+  float maxTimeoutScale_;
+  // The number of weights in each bucket and in all of them.
+  std::vector<int64_t> bcktCnts_;
+  int64_t totCnt_;
+};
+
+} // end namespace opt_sched
+
+#endif
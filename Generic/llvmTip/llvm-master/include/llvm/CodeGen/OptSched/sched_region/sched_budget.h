@@ -0,0 +1,52 @@
+/*******************************************************************************
+Description:  Implements a compile-time budget that is divided among the
+              regions scheduled under it. Each region is granted a share of
+              the remaining time in proportion to its size, and the part of
+              its share that a region does not use goes back to the budget, so
+              regions that are solved early leave more time to the harder ones
+              after them. A budget may be shared by concurrently scheduled
+              regions.
+Created:      Oct. 2026
+Last Update:  Oct. 2026
+*******************************************************************************/
+
+#ifndef OPTSCHED_SCHED_REGION_SCHED_BUDGET_H
+#define OPTSCHED_SCHED_REGION_SCHED_BUDGET_H
+
+#include "llvm/CodeGen/OptSched/generic/defines.h"
+#include <mutex>
+
+namespace opt_sched {
+
+class SchedBudget {
+public:
+  // Creates a budget of the given number of milliseconds for regions with a
+  // total of instCnt instructions.
+  SchedBudget(Milliseconds budget, InstCount instCnt);
+  ~SchedBudget() {}
+
+  // Takes the share of the remaining time for a region with the given number
+  // of instructions. Returns 0 once the budget is used up.
+  Milliseconds Reserve(InstCount instCnt);
+  // Charges the time that a region spent against its share, giving back what
+  // is left of the share or taking the overrun from the remaining time.
+  void Release(Milliseconds share, Milliseconds spent);
+
+  // Returns the total time charged so far.
+  Milliseconds GetSpentTime() const;
+  // Returns the time that has been neither reserved nor charged.
+  Milliseconds GetRemainingTime() const;
+
+private:
+  mutable std::mutex lock_;
+  // The time that has been neither reserved nor charged.
+  Milliseconds rmnngTime_;
+  // The number of instructions of the regions that did not reserve yet.
+  InstCount rmnngInstCnt_;
+  // The total time charged.
+  Milliseconds spentTime_;
+};
+
+} // end namespace opt_sched
+
+#endif
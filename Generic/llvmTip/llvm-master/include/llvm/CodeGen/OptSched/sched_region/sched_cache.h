@@ -0,0 +1,83 @@
+/*******************************************************************************
+Description:  Implements a persistent schedule cache. The best schedule found
+              for a region is stored on disk under a key computed from a
+              canonical form of the region's dependence graph, the machine
+              model and the scheduler settings that affect the cost of a
+              schedule, so that later compilations of an identical region can
+              reuse it instead of enumerating again. Each entry is a small
+              file that is written atomically and memory-mapped when read, so
+              the cache can be shared by concurrent compilations.
+Created:      Oct. 2026
+Last Update:  Oct. 2026
+*******************************************************************************/
+
+#ifndef OPTSCHED_SCHED_REGION_SCHED_CACHE_H
+#define OPTSCHED_SCHED_REGION_SCHED_CACHE_H
+
+#include "llvm/CodeGen/OptSched/basic/data_dep.h"
+#include "llvm/CodeGen/OptSched/basic/machine_model.h"
+#include "llvm/CodeGen/OptSched/generic/defines.h"
+#include "llvm/CodeGen/OptSched/generic/hash_table.h"
+#include <string>
+#include <vector>
+
+namespace opt_sched {
+
+// A schedule retrieved from the cache.
+struct SchedCacheEntry {
+  // The normalized cost of the schedule.
+  InstCount cost;
+  // Whether the schedule was proven to be optimal.
+  bool isOptml;
+  // The linear issue slot of each instruction, indexed by instruction number.
+  std::vector<InstCount> instSlots;
+};
+
+class SchedCache {
+public:
+  // Opens the cache stored in the given directory, creating the directory if
+  // needed. The configuration signature identifies the scheduler settings
+  // that affect the cost of a schedule; entries made with other settings are
+  // never returned.
+  SchedCache(const std::string &dir, const std::string &cnfgSig);
+  ~SchedCache() {}
+
+  // Computes the cache key of a region. The defs and uses of the region's
+  // instructions must have been added to the graph.
+  UDT_HASHKEY CmputKey(DataDepGraph *dataDepGraph,
+                       MachineModel *machMdl) const;
+
+  // Looks up the schedule stored for the given key. Returns true and fills
+  // the entry if a schedule that is consistent with the graph was found.
+  bool Find(UDT_HASHKEY key, DataDepGraph *dataDepGraph,
+            MachineModel *machMdl, SchedCacheEntry &entry) const;
+
+  // Stores a schedule for the given key, unless the cache already holds one
+  // that is at least as good.
+  void Store(UDT_HASHKEY key, InstSchedule *sched, MachineModel *machMdl,
+             InstCount instCnt, InstCount cost, bool isOptml) const;
+
+  // Fills an empty schedule with the instructions of a cached schedule.
+  static void FillSched(const SchedCacheEntry &entry, int issuRate,
+                        InstSchedule *sched);
+  // Returns the length of a cached schedule in cycles.
+  static InstCount GetSchedLngth(const SchedCacheEntry &entry, int issuRate);
+
+private:
+  // The directory holding the cache files.
+  std::string dir_;
+  // The hash of the configuration signature.
+  UDT_HASHKEY cnfgHash_;
+  // Whether the directory is usable.
+  bool isEnabled_;
+
+  // Returns the path of the file holding the entry with the given key.
+  std::string GetPath_(UDT_HASHKEY key) const;
+  // Reads the entry with the given key without validating it against a graph.
+  bool Read_(UDT_HASHKEY key, InstCount instCnt, int issuRate,
+             SchedCacheEntry &entry) const;
+};
+
+} // end namespace opt_sched
+
+#endif
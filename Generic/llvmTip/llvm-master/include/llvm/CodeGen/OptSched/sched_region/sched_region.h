@@ -16,6 +16,12 @@ Last Update:  Apr. 2011
 #include "llvm/CodeGen/OptSched/basic/data_dep.h"
 // For Enumerator, LengthCostEnumerator, EnumTreeNode and Pruning.
 #include "llvm/CodeGen/OptSched/enum/enumerator.h"
+#include "llvm/CodeGen/OptSched/enum/parallel_enum.h"
+#include "llvm/CodeGen/OptSched/aco_colony.h"
+#include "llvm/CodeGen/OptSched/sched_region/region_ranking.h"
+#include "llvm/CodeGen/OptSched/sched_region/sched_cache.h"
+#include <algorithm>
+#include <vector>
 
 namespace opt_sched {
 
@@ -37,6 +43,7 @@ enum class BLOCKS_TO_KEEP {
   ALL
 };
 
+class ACOScheduler;
 class ListScheduler;
 
 class SchedRegion {
@@ -52,12 +59,81 @@ public:
   inline DataDepGraph *GetDepGraph() { return dataDepGraph_; }
   // Returns the lower bound on the cost of this region.
   inline int GetCostLwrBound() { return costLwrBound_; }
-  // Returns the best cost found so far for this region.
-  inline InstCount GetBestCost() { return bestCost_; }
+  // Returns the best cost found so far for this region. In a parallel
+  // enumeration, this includes the schedules found by the other workers, and
+  // by the ant colony if it runs along with the enumeration.
+  inline InstCount GetBestCost() {
+    InstCount bestCost = bestCost_;
+    if (prllState_ != NULL)
+      bestCost = std::min(bestCost, prllState_->GetBestCost());
+    if (acoColony_ != NULL && acoColony_->RunsWithEnum())
+      bestCost = std::min(bestCost, acoColony_->GetBestCost());
+    return bestCost;
+  }
   // Returns a pointer to the list scheduler heurisitcs.
   inline SchedPriorities GetHeuristicPriorities() { return hurstcPrirts_; }
   // Get the number of simulated spills code added for this block.
   inline int GetSimSpills() { return totalSimSpills_; }
+  // Returns true if the last call to FindOptimalSchedule() returned a
+  // schedule that is known to be optimal. A schedule that was replaced by the
+  // heuristic one in the final checks is not.
+  inline bool IsSchedOptml() const { return isSchedOptml_; }
+  // Returns true if the last call to FindOptimalSchedule() explored its whole
+  // search tree without timing out, but skipped branches outside the beam. Its
+  // result is then RES_TIMEOUT, since the schedule is not proven optimal.
+  inline bool WasSrchCut() const { return isSrchCut_; }
+  // Makes this region one of the workers of a parallel enumeration. Each
+  // worker must have its own copy of the region and its dependence graph.
+  inline void SetParallelState(ParallelEnumState *state) {
+    prllState_ = state;
+  }
+  // Makes this region the given member of a parallel ant colony. Like the
+  // workers of a parallel enumeration, each member must have its own copy of
+  // the region and its dependence graph.
+  inline void SetACOColony(ACOColony *colony, int mmbrIndx) {
+    acoColony_ = colony;
+    acoMmbrIndx_ = mmbrIndx;
+  }
+  inline ACOColony *GetACOColony() { return acoColony_; }
+  // Sets whether this region prints its spills and register pressures. The
+  // region may be scheduled on a worker thread, so it keeps its own copy of
+  // the flag of the function it belongs to.
+  inline void SetPrintSpills(bool printSpills) { printSpills_ = printSpills; }
+  inline int GetACOMmbrIndx() const { return acoMmbrIndx_; }
+  // Makes the workers that schedule copies of this region share the
+  // enumeration time allotted to it by the region ranking, so that the region
+  // is ranked once and all of them either enumerate or do not.
+  inline void SetSharedAllotment(RegionRanking::SharedAllotment *allotment) {
+    sharedAllotment_ = allotment;
+  }
+  // Provides a schedule found by an earlier compilation of this region. It is
+  // used as the initial upper bound if it is better than the heuristic one.
+  inline void SetSeedSched(const SchedCacheEntry &entry) {
+    seedSched_ = entry;
+    hasSeedSched_ = true;
+  }
+  // Sets the list scheduling heuristics that are tried after the main one in
+  // search of a cheaper heuristic schedule: the given ones, and the main one
+  // with ties broken at random rndmRunCnt times, each in a different order.
+  void SetHurstcPortfolio(const std::vector<SchedPriorities> &prirts,
+                          int rndmRunCnt);
+  // Makes this region a window of a larger region that is enumerated in
+  // windows. A window is not ranked by its weight and never cut into windows
+  // of its own.
+  inline void SetIsWindow(bool isWndw) { isWndw_ = isWndw; }
+  // Sets the seed that the random number generator of the calling thread is
+  // reset to when this region is scheduled, so that the random choices made
+  // for the region depend neither on the thread nor on the regions scheduled
+  // before it.
+  inline void SetRndmSeed(int32_t seed) { rndmSeed_ = seed; }
+  // Returns true if the enumerator should stop when its rate of improving the
+  // cost gets too low.
+  inline bool ChksImprvmntRate() const { return minImprvmntRate_ > 0; }
+  // Returns true if the rate at which the enumerator has been improving the
+  // cost of this region, measured from the improvement before the last one,
+  // has dropped below MIN_IMPROVEMENT_RATE. Always false before the first
+  // improvement.
+  bool IsImprvmntStalled(Milliseconds now) const;
 
   // TODO(max): Document.
   virtual FUNC_RESULT
@@ -73,6 +149,14 @@ public:
   virtual FUNC_RESULT BuildFromFile() = 0;
   // TODO(max): Document.
   virtual int CmputCostLwrBound() = 0;
+  // Computes the part of the cost lower bound that does not depend on the
+  // schedule length lower bound. It reads the graph's transitive closure and
+  // adds to the registers' live intervals, but does not touch the graph's
+  // lower bounds, so it may run while the relaxed schedulers compute them.
+  virtual InstCount CmputSpillCostLwrBound() = 0;
+  // Combines a bound computed by CmputSpillCostLwrBound() with the schedule
+  // length lower bound into the cost lower bound.
+  virtual InstCount CmputCostLwrBound(InstCount spillCostLwrBound) = 0;
   // TODO(max): Document.
   virtual InstCount UpdtOptmlSched(InstSchedule *crntSched,
                                    LengthCostEnumerator *enumrtr) = 0;
@@ -148,6 +232,8 @@ protected:
   SchedPriorities hurstcPrirts_;
   // Scheduling heuristics to use when enumerating
   SchedPriorities enumPrirts_;
+  // Other list scheduling heuristics to try after the main one
+  std::vector<SchedPriorities> hurstcPortfolio_;
 
   // The pruning technique to use for this region.
   Pruning prune_;
@@ -165,18 +251,78 @@ protected:
   // total simulated spills.
   int totalSimSpills_;
 
+  // The state shared with the other workers of a parallel enumeration, or
+  // NULL if the region is scheduled by a single thread.
+  ParallelEnumState *prllState_;
+
+  // The ant colony this region is a member of, or NULL if the heuristic
+  // scheduler runs in a single thread.
+  ACOColony *acoColony_;
+  int acoMmbrIndx_;
+
+  // The allotment shared with the other workers scheduling this region, or
+  // NULL if the region is scheduled by a single thread.
+  RegionRanking::SharedAllotment *sharedAllotment_;
+
+  // Whether this region is a window of a larger region.
+  bool isWndw_;
+
+  // The seed of the random numbers drawn while scheduling this region.
+  int32_t rndmSeed_;
+
+  // A schedule of this region taken from the schedule cache, if any.
+  SchedCacheEntry seedSched_;
+  bool hasSeedSched_;
+
+  // Whether the schedule last returned by FindOptimalSchedule() is optimal.
+  bool isSchedOptml_;
+  // Whether the last enumeration finished with a cut beam search.
+  bool isSrchCut_;
+  // Whether to print the spills and register pressures of this region.
+  bool printSpills_;
+
+  // The lowest rate of improvement, in normalized cost units per second, at
+  // which the enumerator keeps going. Zero disables the check.
+  float minImprvmntRate_;
+  // The size and time of the last improvement found by the enumerator.
+  InstCount lastImprvmnt_;
+  Milliseconds lastImprvmntTime_;
+  // The time of the improvement before the last one, or of the start of the
+  // enumeration.
+  Milliseconds prevImprvmntTime_;
+
+  // The minimum number of instructions for the spill cost lower bound to be
+  // computed concurrently with the length lower bound. Zero disables it.
+  InstCount minPrllBoundsSize_;
+
   // TODO(max): Document.
   void UseFileBounds_();
 
+  // Ranks this region by its weight times the cost of its best schedule so
+  // far and returns the enumeration time allotted to it.
+  RegionRanking::Allotment AllotEnumTime_();
+
   // Top-level function for enumerative scheduling
   FUNC_RESULT Optimize_(Milliseconds startTime, Milliseconds rgnTimeout,
                         Milliseconds lngthTimeout);
+  // Keeps the ant colony going instead of enumerating, in a member of the
+  // colony that does not enumerate.
+  FUNC_RESULT ImproveWithACO_(ACOScheduler *acoSchdulr, Milliseconds startTime,
+                              Milliseconds rgnTimeout);
   // TODO(max): Document.
   void CmputLwrBounds_(bool useFileBounds);
   // TODO(max): Document.
   bool CmputUprBounds_(InstSchedule *lstSched, bool useFileBounds);
+  // Replaces the heuristic schedule with the seed schedule if the latter is
+  // cheaper.
+  void UseSeedSched_(InstSchedule *lstSched);
+  // Runs the heuristics of the portfolio and replaces the heuristic schedule
+  // with the cheapest of their schedules if that is cheaper.
+  void UseHurstcPortfolio_(InstSchedule *lstSched);
   // Handle the enumerator's result
   void HandlEnumrtrRslt_(FUNC_RESULT rslt, InstCount trgtLngth);
+  // Records an improvement of the best cost by the enumerator.
+  void RecordImprvmnt_(InstCount imprvmnt);
 
   // Simulate local register allocation.
   void RegAlloc_(InstSchedule *&bestSched, InstSchedule *&lstSched);
@@ -200,6 +346,15 @@ protected:
   virtual FUNC_RESULT Enumerate_(Milliseconds startTime,
                                  Milliseconds rgnTimeout,
                                  Milliseconds lngthTimeout) = 0;
+  // Returns true if the region is too big to be enumerated as a whole and is
+  // enumerated in windows instead.
+  virtual bool IsWindowed_() const = 0;
+  // Improves the best schedule by enumerating windows of consecutive
+  // instructions of it and putting their schedules back in place. Never
+  // proves the schedule optimal.
+  virtual FUNC_RESULT OptimizeInWindows_(Milliseconds startTime,
+                                         Milliseconds rgnTimeout,
+                                         Milliseconds lngthTimeout) = 0;
   // TODO(max): Document.
   virtual void FinishHurstc_() = 0;
   // TODO(max): Document.
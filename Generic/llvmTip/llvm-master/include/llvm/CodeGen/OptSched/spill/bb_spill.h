@@ -23,14 +23,39 @@ class Register;
 class RegisterFile;
 class BitVector;
 
+// The order in which the target schedule lengths are enumerated.
+enum LENGTH_SEARCH {
+  // From the lower bound up, one length at a time.
+  LS_LINEAR,
+  // Find the shortest feasible length by probing lengths that bisect the
+  // interval between the lower bound and the length of the best schedule,
+  // then enumerate the lengths from the shortest one that is not proven
+  // infeasible up.
+  LS_BISECT,
+  // Like LS_BISECT, but first probe lengths at exponentially growing
+  // distances from the lower bound to find a feasible one.
+  LS_EXPONENTIAL
+};
+
 class BBWithSpill : public SchedRegion {
 private:
   LengthCostEnumerator *enumrtr_;
+  // The enumerator's undo trail while enumerating, NULL otherwise. Scheduling
+  // an instruction records the changes to the spill info on it, so that
+  // unscheduling can restore them.
+  UndoTrail *trail_;
 
   InstCount crntSpillCost_;
   InstCount optmlSpillCost_;
 
   bool enblStallEnum_;
+  // The order in which the target lengths are enumerated.
+  LENGTH_SEARCH lngthSrch_;
+  // The number of instructions in the windows that the region is enumerated
+  // in if it is bigger than that, or 0 if it is enumerated as a whole.
+  InstCount wndwSize_;
+  // The number of threads that enumerate windows at once.
+  int wndwThrdCnt_;
   int spillCostFactor_;
   int schedCostFactor_;
 
@@ -58,6 +83,14 @@ private:
   // calculated.
   InstCount dynamicSlilLowerBound_ = 0;
 
+  // (SLIL only) For each instruction and register type, a bit vector indexed
+  // by register number indicating whether the instruction belongs to the
+  // live interval or the possible live interval of that register. Indexed by
+  // instNum * regTypeCnt_ + regType. Lets the dynamic SLIL lower bound be
+  // updated with a few word-level popcounts instead of a scan of all the
+  // live registers.
+  BitVector *instIntrvlRegs_;
+
   int entryInstCnt_;
   int exitInstCnt_;
   int schduldEntryInstCnt_;
@@ -93,6 +126,10 @@ private:
   void CmputAbslutUprBound_();
   ConstrainedScheduler *AllocHeuristicScheduler_();
   bool EnableEnum_();
+  bool IsWindowed_() const;
+  FUNC_RESULT OptimizeInWindows_(Milliseconds startTime,
+                                 Milliseconds rgnTimeout,
+                                 Milliseconds lngthTimeout);
 
   // BBWithSpill-specific Functions:
   InstCount CmputCostLwrBound_(InstCount schedLngth);
@@ -101,7 +138,15 @@ private:
   InstCount CmputDynmcCost_();
 
   void UpdateSpillInfoForSchdul_(SchedInstruction *inst, bool trackCnflcts);
-  void UpdateSpillInfoForUnSchdul_(SchedInstruction *inst);
+  // Record a variable or a live register bit on the trail, if any, before
+  // changing it.
+  inline void SaveVal_(int &var);
+  inline void SetLiveBit_(WeightedBitVector &vctr, int indx, bool val,
+                          int wght);
+  void SetupIntrvlRegs_();
+  // Returns the number of live registers of the given type whose live
+  // interval and possible live interval do not contain the instruction.
+  int CntLiveRegsOutOfIntrvl_(SchedInstruction *inst, int16_t regType) const;
   void SetupPhysRegs_();
   void CmputCrntSpillCost_();
   bool ChkSchedule_(InstSchedule *bestSched, InstSchedule *lstSched);
@@ -120,6 +165,8 @@ public:
   FUNC_RESULT BuildFromFile();
 
   int CmputCostLwrBound();
+  InstCount CmputSpillCostLwrBound();
+  InstCount CmputCostLwrBound(InstCount spillCostLwrBound);
 
   InstCount UpdtOptmlSched(InstSchedule *crntSched,
                            LengthCostEnumerator *enumrtr);
@@ -9,9 +9,9 @@ Description:  A wrapper that convert an LLVM ScheduleDAG to an OptSched
 #include "llvm/CodeGen/MachineRegisterInfo.h"
 #include "llvm/CodeGen/MachineScheduler.h"
 #include "llvm/CodeGen/OptSched/OptSchedDagWrapper.h"
+#include "llvm/CodeGen/OptSched/OptSchedSettings.h"
 #include "llvm/CodeGen/OptSched/basic/register.h"
 #include "llvm/CodeGen/OptSched/basic/sched_basic_data.h"
-#include "llvm/CodeGen/OptSched/generic/config.h"
 #include "llvm/CodeGen/OptSched/generic/logger.h"
 #include "llvm/CodeGen/RegisterPressure.h"
 #include "llvm/CodeGen/TargetPassConfig.h"
@@ -56,8 +56,7 @@ LLVMDataDepGraph::LLVMDataDepGraph(
   maxDagSizeForPrcisLtncy_ = maxDagSizeForPrcisLtncy;
   includesNonStandardBlock_ = false;
   includesUnsupported_ = false;
-  ShouldFilterRegisterTypes = SchedulerOptions::getInstance().GetBool(
-      "FILTER_REGISTERS_TYPES_WITH_LOW_PRP", false);
+  ShouldFilterRegisterTypes = OptSchedSettings::get().filterRegisterTypes;
   includesUnpipelined_ = true;
 
   if (ShouldFilterRegisterTypes)
@@ -65,7 +64,7 @@ LLVMDataDepGraph::LLVMDataDepGraph(
 
   // The extra 2 are for the artifical root and leaf nodes.
   instCnt_ = nodeCnt_ = llvmNodes_.size() + 2;
-  // TODO(max99x): Find real weight.
+  // The scheduler sets the real weight when REGION_WEIGHTS asks for it.
   weight_ = 1.0f;
 
   std::snprintf(dagID_, MAX_NAMESIZE, "%s:%d",
@@ -90,6 +89,9 @@ void LLVMDataDepGraph::ConvertLLVMNodes_() {
   std::string instName;
   std::string opCode;
   int ltncy;
+  // Should we try to generate scheduling types for instructions in this
+  // region
+  bool shouldGenerateMM = OptSchedSettings::get().generateMachineModel;
 
 #ifdef IS_DEBUG
   Logger::Info("Building opt_sched DAG out of llvm DAG");
@@ -113,11 +115,6 @@ void LLVMDataDepGraph::ConvertLLVMNodes_() {
 
     instName = opCode = schedDag_->TII->getName(instr->getOpcode());
 
-    // Should we try to generate scheduling types for instructions in this
-    // region
-    bool shouldGenerateMM = SchedulerOptions::getInstance().GetBool(
-        "GENERATE_MACHINE_MODEL", false);
-
     if (shouldGenerateMM) {
       assert(llvmMachMdl_->getMMGen() &&
              "Machine Model Generator was not initialized");
@@ -262,11 +259,10 @@ void LLVMDataDepGraph::CountDefs(RegisterFile regFiles[]) {
   // Track all regs that are defined.
   std::set<unsigned> defs;
   // Should we add uses that have no definition.
-  bool addUsedAndNotDefined =
-      SchedulerOptions::getInstance().GetBool("ADD_USED_AND_NOT_DEFINED_REGS");
+  bool addUsedAndNotDefined = OptSchedSettings::get().addUsedAndNotDefinedRegs;
   // Should we add live-out registers that have no definition.
-  bool addLiveOutAndNotDefined = SchedulerOptions::getInstance().GetBool(
-      "ADD_LIVE_OUT_AND_NOT_DEFINED_REGS");
+  bool addLiveOutAndNotDefined =
+      OptSchedSettings::get().addLiveOutAndNotDefinedRegs;
 
   // count live-in as defs in root node
   for (const RegisterMaskPair &L : schedDag_->getRegPressure().LiveInRegs) {
@@ -370,8 +366,7 @@ void LLVMDataDepGraph::AddDefsAndUses(RegisterFile regFiles[]) {
   // Check for any registers that are not used but are also not in LLVM's
   // live-out set.
   // Optionally, add these registers as uses in the aritificial leaf node.
-  if (SchedulerOptions::getInstance().GetBool(
-          "ADD_DEFINED_AND_NOT_USED_REGS")) {
+  if (OptSchedSettings::get().addDefinedAndNotUsedRegs) {
     for (int16_t i = 0; i < machMdl_->GetRegTypeCnt(); i++) {
       for (int j = 0; j < regFiles[i].GetRegCnt(); j++) {
         Register *reg = regFiles[i].GetReg(j);
@@ -442,8 +437,7 @@ void LLVMDataDepGraph::AddDefsAndUses(RegisterFile regFiles[]) {
 
 void LLVMDataDepGraph::AddUse_(unsigned resNo, InstCount nodeIndex,
                                RegisterFile regFiles[]) {
-  bool addUsedAndNotDefined =
-      SchedulerOptions::getInstance().GetBool("ADD_USED_AND_NOT_DEFINED_REGS");
+  bool addUsedAndNotDefined = OptSchedSettings::get().addUsedAndNotDefinedRegs;
   std::vector<int> resTypes = GetRegisterType_(resNo);
 
   if (addUsedAndNotDefined && lastDef_.find(resNo) == lastDef_.end()) {
@@ -527,8 +521,8 @@ void LLVMDataDepGraph::AddLiveInReg_(unsigned resNo, RegisterFile regFiles[]) {
 
 void LLVMDataDepGraph::AddLiveOutReg_(unsigned resNo, RegisterFile regFiles[]) {
   // Should we add live-out registers that have no definition.
-  bool addLiveOutAndNotDefined = SchedulerOptions::getInstance().GetBool(
-      "ADD_LIVE_OUT_AND_NOT_DEFINED_REGS");
+  bool addLiveOutAndNotDefined =
+      OptSchedSettings::get().addLiveOutAndNotDefinedRegs;
   // index of leaf node in insts_
   int leafIndex = llvmNodes_.size() + 1;
   std::vector<int> regTypes = GetRegisterType_(resNo);
@@ -577,8 +571,7 @@ void LLVMDataDepGraph::AddDefAndNotUsed_(Register *reg,
 }
 
 int LLVMDataDepGraph::GetRegisterWeight_(const unsigned resNo) const {
-  bool useSimpleTypes =
-      SchedulerOptions::getInstance().GetBool("USE_SIMPLE_REGISTER_TYPES");
+  bool useSimpleTypes = OptSchedSettings::get().useSimpleRegisterTypes;
   // If using simple register types ignore PSet weight.
   if (useSimpleTypes)
     return 1;
@@ -595,8 +588,7 @@ int LLVMDataDepGraph::GetRegisterWeight_(const unsigned resNo) const {
 // register sets associated with the class.
 std::vector<int>
 LLVMDataDepGraph::GetRegisterType_(const unsigned resNo) const {
-  bool useSimpleTypes =
-      SchedulerOptions::getInstance().GetBool("USE_SIMPLE_REGISTER_TYPES");
+  bool useSimpleTypes = OptSchedSettings::get().useSimpleRegisterTypes;
   const TargetRegisterInfo &TRI = *schedDag_->TRI;
   std::vector<int> pSetTypes;
 
@@ -4,8 +4,8 @@ Description:  A wrapper that convert an LLVM target to an OptSched MachineModel.
 
 #include "llvm/CodeGen/MachineInstr.h"
 #include "llvm/CodeGen/OptSched/OptSchedMachineWrapper.h"
+#include "llvm/CodeGen/OptSched/OptSchedSettings.h"
 #include "llvm/CodeGen/OptSched/basic/machine_model.h"
-#include "llvm/CodeGen/OptSched/generic/config.h"
 #include "llvm/CodeGen/OptSched/generic/logger.h"
 #include "llvm/CodeGen/ScheduleDAGInstrs.h"
 #include "llvm/CodeGen/TargetPassConfig.h"
@@ -14,7 +14,9 @@ Description:  A wrapper that convert an LLVM target to an OptSched MachineModel.
 #include "llvm/Target/TargetInstrInfo.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetRegisterInfo.h"
+#include <map>
 #include <memory>
+#include <mutex>
 
 #define DEBUG_TYPE "optsched"
 
@@ -47,6 +49,10 @@ createCortexA7MMGenerator(const llvm::ScheduleDAGInstrs *dag,
   return make_unique<CortexA7MMGenerator>(dag, mm);
 }
 
+// The converted machine models, by config file, target and register limits.
+std::map<std::string, std::shared_ptr<LLVMMachineModel>> convertedModels;
+std::mutex convertedModelsLock;
+
 } // end anonymous namespace
 
 
@@ -54,6 +60,44 @@ LLVMMachineModel::LLVMMachineModel(const string configFile)
     : MachineModel(configFile), registerInfo(nullptr), shouldGenerateMM(false),
       MMGen(nullptr) {}
 
+LLVMMachineModel::LLVMMachineModel(const LLVMMachineModel &other)
+    : MachineModel(other), registerInfo(other.registerInfo),
+      shouldGenerateMM(other.shouldGenerateMM), MMGen(nullptr) {}
+
+std::shared_ptr<LLVMMachineModel>
+LLVMMachineModel::getModel(const string &configFile,
+                           const ScheduleDAGInstrs &dag,
+                           const RegisterClassInfo *regClassInfo) {
+  // The register limits may differ between the functions of a target, since
+  // they depend on the registers reserved in each function.
+  const TargetRegisterInfo *TRI = dag.TRI;
+  std::string key = configFile + ";" + dag.TM.getTarget().getName();
+  for (unsigned pSet = 0; pSet < TRI->getNumRegPressureSets(); ++pSet)
+    key += ";" + std::to_string(regClassInfo->getRegPressureSetLimit(pSet));
+
+  std::shared_ptr<LLVMMachineModel> model;
+  {
+    std::lock_guard<std::mutex> lock(convertedModelsLock);
+    std::shared_ptr<LLVMMachineModel> &entry = convertedModels[key];
+    if (!entry) {
+      entry.reset(new LLVMMachineModel(configFile));
+      entry->convertMachineModel(dag, regClassInfo);
+    }
+    model = entry;
+  }
+
+  if (model->shouldGenerateMM) {
+    model.reset(new LLVMMachineModel(*model));
+    if (model->mdlName_ == "ARM-Cortex-A7")
+      model->MMGen = createCortexA7MMGenerator(&dag, model.get());
+    else
+      Logger::Error("Could not find machine model generator for target \"%s\"",
+                    model->mdlName_.c_str());
+  }
+
+  return model;
+}
+
 void LLVMMachineModel::convertMachineModel(
     const ScheduleDAGInstrs &dag, const RegisterClassInfo *regClassInfo) {
   const TargetMachine &target = dag.TM;
@@ -63,16 +107,7 @@ void LLVMMachineModel::convertMachineModel(
   Logger::Info("Machine model: %s", mdlName_.c_str());
 
   // Should we try to generate a machine model using LLVM itineraries.
-  shouldGenerateMM =
-      SchedulerOptions::getInstance().GetBool("GENERATE_MACHINE_MODEL", false);
-
-  if (shouldGenerateMM) {
-    if (mdlName_ == "ARM-Cortex-A7")
-      MMGen = createCortexA7MMGenerator(&dag, this);
-    else
-      Logger::Error("Could not find machine model generator for target \"%s\"",
-                    mdlName_.c_str());
-  }
+  shouldGenerateMM = OptSchedSettings::get().generateMachineModel;
 
   // Clear The registerTypes list to read registers limits from the LLVM machine
   // model
@@ -0,0 +1,390 @@
+#include "llvm/CodeGen/OptSched/OptSchedSettings.h"
+#include "llvm/CodeGen/OptSched/generic/logger.h"
+#include <cassert>
+#include <cstring>
+#include <mutex>
+
+thread_local bool OPTSCHED_gPrintSpills;
+
+namespace opt_sched {
+
+#define HEUR_NAME_CNT 9
+#define HEUR_NAME_MAX_SIZE 10
+
+// The names of the list scheduling heuristics, indexed by LISTSCHED_HEURISTIC.
+static const char *const hurstcNames[HEUR_NAME_CNT] = {
+    "CP", "LUC", "UC", "NID", "CPR", "ISO", "SC", "LS", "RND"};
+
+// The settings of the process, set once by OptSchedSettings::load().
+static std::unique_ptr<OptSchedSettings> loadedSettings;
+static std::once_flag loadFlag;
+
+static FUNC_SELECTION parseFuncSelection(const Config &schedIni,
+                                         const char *name) {
+  std::string value = schedIni.GetString(name);
+  if (value == "YES") {
+    return FUNC_SELECTION::ALL;
+  } else if (value == "NO") {
+    return FUNC_SELECTION::NONE;
+  } else if (value == "HOT_ONLY") {
+    return FUNC_SELECTION::HOT_ONLY;
+  } else {
+    Logger::Error("Unknown value for %s: %s. Assuming NO.", name,
+                  value.c_str());
+    return FUNC_SELECTION::NONE;
+  }
+}
+
+static LATENCY_PRECISION parseLatencyPrecision(const std::string &lpName) {
+  if (lpName == "PRECISE") {
+    return LTP_PRECISE;
+  } else if (lpName == "ROUGH") {
+    return LTP_ROUGH;
+  } else if (lpName == "UNITY") {
+    return LTP_UNITY;
+  } else {
+    Logger::Error("Unrecognized latency precision. Defaulted to PRECISE.");
+    return LTP_PRECISE;
+  }
+}
+
+static LB_ALG parseLowerBoundAlgorithm(const std::string &LBalg) {
+  if (LBalg == "RJ") {
+    return LBA_RJ;
+  } else if (LBalg == "LC") {
+    return LBA_LC;
+  } else {
+    Logger::Error("Unrecognized lower bound technique. Defaulted to Rim-Jain.");
+    return LBA_RJ;
+  }
+}
+
+static SchedPriorities parseHeuristic(const std::string &str) {
+  SchedPriorities prirts;
+  int len = str.length();
+  char word[HEUR_NAME_MAX_SIZE];
+  int wIndx = 0;
+  prirts.cnt = 0;
+  prirts.isDynmc = false;
+  prirts.rndmSeed = 0;
+  int i, j;
+
+  for (i = 0; i <= len; i++) {
+    char ch = str.c_str()[i];
+    if (ch == '_' || ch == 0) { // end of word
+      word[wIndx] = 0;
+      for (j = 0; j < HEUR_NAME_CNT; j++) {
+        if (strcmp(word, hurstcNames[j]) == 0) {
+          prirts.vctr[prirts.cnt] = (LISTSCHED_HEURISTIC)j;
+          if ((LISTSCHED_HEURISTIC)j == LSH_LUC)
+            prirts.isDynmc = true;
+          break;
+        } // end if
+      }   // end for j
+      if (j == HEUR_NAME_CNT) {
+        Logger::Error("Unrecognized heuristic %s. Defaulted to CP.", word);
+        prirts.vctr[prirts.cnt] = LSH_CP;
+      }
+      prirts.cnt++;
+      wIndx = 0;
+    } else {
+      word[wIndx] = ch;
+      wIndx++;
+    } // end else
+  }   // end for i
+  return prirts;
+}
+
+static SPILL_COST_FUNCTION parseSpillCostFunc(const std::string &name) {
+  // PERP used to be called PEAK.
+  if (name == "PERP" || name == "PEAK") {
+    return SCF_PERP;
+  } else if (name == "PRP") {
+    return SCF_PRP;
+  } else if (name == "PEAK_PER_TYPE") {
+    return SCF_PEAK_PER_TYPE;
+  } else if (name == "SUM") {
+    return SCF_SUM;
+  } else if (name == "PEAK_PLUS_AVG") {
+    return SCF_PEAK_PLUS_AVG;
+  } else if (name == "SLIL") {
+    return SCF_SLIL;
+  } else {
+    Logger::Error("Unrecognized spill cost function. Defaulted to PERP.");
+    return SCF_PERP;
+  }
+}
+
+static BLOCKS_TO_KEEP parseBlocksToKeep(const std::string &name) {
+  if (name == "ZERO_COST") {
+    return BLOCKS_TO_KEEP::ZERO_COST;
+  } else if (name == "OPTIMAL") {
+    return BLOCKS_TO_KEEP::OPTIMAL;
+  } else if (name == "IMPROVED") {
+    return BLOCKS_TO_KEEP::IMPROVED;
+  } else if (name == "IMPROVED_OR_OPTIMAL") {
+    return BLOCKS_TO_KEEP::IMPROVED_OR_OPTIMAL;
+  } else {
+    return BLOCKS_TO_KEEP::ALL;
+  }
+}
+
+static SIM_REG_ALLOC parseSimRegAlloc(const std::string &name) {
+  if (name == "NO") {
+    return SIM_REG_ALLOC::NO;
+  } else if (name == "HEURISTIC") {
+    return SIM_REG_ALLOC::HEURISTIC;
+  } else if (name == "BEST") {
+    return SIM_REG_ALLOC::BEST;
+  } else if (name == "BOTH") {
+    return SIM_REG_ALLOC::BOTH;
+  } else if (name == "TAKE_SCHED_WITH_LEAST_SPILLS") {
+    return SIM_REG_ALLOC::TAKE_SCHED_WITH_LEAST_SPILLS;
+  } else {
+    Logger::Error("Unrecognized simulated register allocation %s. Defaulted "
+                  "to NO.",
+                  name.c_str());
+    return SIM_REG_ALLOC::NO;
+  }
+}
+
+static ENUM_SEARCH parseEnumSearch(const std::string &name) {
+  if (name == "DEPTH_FIRST") {
+    return ES_DEPTH_FIRST;
+  } else if (name == "BEST_FIRST") {
+    return ES_BEST_FIRST;
+  } else if (name == "BEAM") {
+    return ES_BEAM;
+  } else {
+    Logger::Error("Unrecognized enumeration search strategy. Defaulted to "
+                  "DEPTH_FIRST.");
+    return ES_DEPTH_FIRST;
+  }
+}
+
+static LENGTH_SEARCH parseLengthSearch(const std::string &name) {
+  if (name == "LINEAR") {
+    return LS_LINEAR;
+  } else if (name == "BISECT") {
+    return LS_BISECT;
+  } else if (name == "EXPONENTIAL") {
+    return LS_EXPONENTIAL;
+  } else {
+    Logger::Error("Unrecognized length search. Defaulted to LINEAR.");
+    return LS_LINEAR;
+  }
+}
+
+const OptSchedSettings &OptSchedSettings::load(const std::string &cfgDir) {
+  std::call_once(loadFlag, [&cfgDir]() {
+    SchedulerOptions &schedIni = SchedulerOptions::getInstance();
+    schedIni.Load(cfgDir + "sched.ini");
+
+    std::unique_ptr<OptSchedSettings> settings(new OptSchedSettings);
+    settings->hotFunctions.Load(cfgDir + "hotfuncs.ini");
+    settings->parse(schedIni);
+    loadedSettings = std::move(settings);
+  });
+  return *loadedSettings;
+}
+
+const OptSchedSettings &OptSchedSettings::parseLoaded() {
+  std::call_once(loadFlag, []() {
+    std::unique_ptr<OptSchedSettings> settings(new OptSchedSettings);
+    settings->parse(SchedulerOptions::getInstance());
+    loadedSettings = std::move(settings);
+  });
+  return *loadedSettings;
+}
+
+const OptSchedSettings &OptSchedSettings::get() {
+  assert(loadedSettings && "The OptSched settings were not loaded");
+  return *loadedSettings;
+}
+
+bool OptSchedSettings::isSelected(FUNC_SELECTION sel,
+                                  const std::string &funcName) const {
+  switch (sel) {
+  case FUNC_SELECTION::ALL:
+    return true;
+  case FUNC_SELECTION::HOT_ONLY:
+    return hotFunctions.GetBool(funcName, false);
+  default:
+    return false;
+  }
+}
+
+bool OptSchedSettings::isRegionSelected(const std::string &regionName) const {
+  return !scheduleSpecificRegions ||
+         regionsToSchedule.find(regionName) != regionsToSchedule.end();
+}
+
+void OptSchedSettings::parse(const Config &schedIni) {
+  useOptSched = parseFuncSelection(schedIni, "USE_OPT_SCHED");
+  printSpills = parseFuncSelection(schedIni, "PRINT_SPILL_COUNTS");
+  scheduleSpecificRegions = schedIni.GetBool("SCHEDULE_SPECIFIC_REGIONS");
+  for (const std::string &name : schedIni.GetStringList("REGIONS_TO_SCHEDULE"))
+    regionsToSchedule.insert(name);
+
+  latencyPrecision =
+      parseLatencyPrecision(schedIni.GetString("LATENCY_PRECISION"));
+  maxDagSizeForLatencyPrecision =
+      schedIni.GetInt("MAX_DAG_SIZE_FOR_PRECISE_LATENCY");
+  treatOrderDepsAsDataDeps = schedIni.GetBool("TREAT_ORDER_DEPS_AS_DATA_DEPS");
+
+  // setup pruning
+  prune.rlxd = schedIni.GetBool("APPLY_RELAXED_PRUNING");
+  prune.nodeSup = schedIni.GetBool("DYNAMIC_NODE_SUPERIORITY");
+  prune.histDom = schedIni.GetBool("APPLY_HISTORY_DOMINATION");
+  prune.spillCost = schedIni.GetBool("APPLY_SPILL_COST_PRUNING");
+  prune.useSuffixConcatenation =
+      schedIni.GetBool("ENABLE_SUFFIX_CONCATENATION");
+
+  // setup graph transformations
+  graphTransTypes.staticNodeSup = schedIni.GetBool("STATIC_NODE_SUPERIORITY");
+  graphTransTypes.multiPassNodeSup =
+      schedIni.GetBool("MULTI_PASS_NODE_SUPERIORITY");
+
+  schedForRPOnly = schedIni.GetBool("SCHEDULE_FOR_RP_ONLY");
+  histTableHashBits =
+      static_cast<int16_t>(schedIni.GetInt("HIST_TABLE_HASH_BITS"));
+  verifySchedule = schedIni.GetBool("VERIFY_SCHEDULE");
+  enableMutations = schedIni.GetBool("LLVM_MUTATIONS");
+  enumerateStalls = schedIni.GetBool("ENUMERATE_STALLS");
+  spillCostFactor = schedIni.GetInt("SPILL_COST_FACTOR");
+  checkSpillCostSum = schedIni.GetBool("CHECK_SPILL_COST_SUM");
+  checkConflicts = schedIni.GetBool("CHECK_CONFLICTS");
+  fixLiveIn = schedIni.GetBool("FIX_LIVEIN");
+  fixLiveOut = schedIni.GetBool("FIX_LIVEOUT");
+  maxSpillCost = schedIni.GetInt("MAX_SPILL_COST");
+  lowerBoundAlgorithm = parseLowerBoundAlgorithm(schedIni.GetString("LB_ALG"));
+  heuristicPriorities = parseHeuristic(schedIni.GetString("HEURISTIC"));
+  // To support old sched.ini files setting NID as the heuristic means LLVM
+  // scheduling is enabled.
+  llvmScheduling = schedIni.GetBool("LLVM_SCHEDULING", false) ||
+                   schedIni.GetString("HEURISTIC") == "NID";
+  enumPriorities = parseHeuristic(schedIni.GetString("ENUM_HEURISTIC"));
+  for (const std::string &name : schedIni.GetStringList("HEURISTIC_PORTFOLIO"))
+    heuristicPortfolio.push_back(parseHeuristic(name));
+  heuristicPortfolioRandomRuns =
+      schedIni.GetInt("HEURISTIC_PORTFOLIO_RANDOM_RUNS", 0);
+  spillCostFunction =
+      parseSpillCostFunc(schedIni.GetString("SPILL_COST_FUNCTION"));
+  regionTimeout = schedIni.GetInt("REGION_TIMEOUT");
+  lengthTimeout = schedIni.GetInt("LENGTH_TIMEOUT");
+  isTimeoutPerInstruction = schedIni.GetString("TIMEOUT_PER") == "INSTR";
+  minDagSize = schedIni.GetInt("MIN_DAG_SIZE");
+  maxDagSize = schedIni.GetInt("MAX_DAG_SIZE");
+  windowSize = schedIni.GetInt("WINDOW_SIZE", 0);
+  minDagWeight = schedIni.GetFloat("MIN_DAG_WEIGHT", 0);
+  useFileBounds = schedIni.GetBool("USE_FILE_BOUNDS");
+  filterByPerp = schedIni.GetBool("FILTER_BY_PERP");
+  blocksToKeep = parseBlocksToKeep(schedIni.GetString("BLOCKS_TO_KEEP"));
+  simRegAllocMode =
+      parseSimRegAlloc(schedIni.GetString("SIMULATE_REGISTER_ALLOCATION"));
+  simRegAlloc = simRegAllocMode == SIM_REG_ALLOC::BEST ||
+                simRegAllocMode == SIM_REG_ALLOC::BOTH ||
+                simRegAllocMode == SIM_REG_ALLOC::TAKE_SCHED_WITH_LEAST_SPILLS;
+
+  enumThreads = schedIni.GetInt("ENUM_THREADS", 1);
+  regionThreads = schedIni.GetInt("REGION_THREADS", 1);
+  enumSplitDepth = schedIni.GetInt("ENUM_SPLIT_DEPTH", 3);
+  if (enumThreads > 1 && enumSplitDepth < 1) {
+    Logger::Error("Invalid ENUM_SPLIT_DEPTH %d. Using 3.", enumSplitDepth);
+    enumSplitDepth = 3;
+  }
+  useACO = schedIni.GetBool("USE_ACO", false);
+  acoThreads = 1;
+  if (useACO)
+    acoThreads = schedIni.GetInt("ACO_THREADS", 1);
+  if (acoThreads < 1) {
+    Logger::Error("Invalid ACO_THREADS %d. Using 1.", acoThreads);
+    acoThreads = 1;
+  }
+  acoWithEnum = schedIni.GetBool("ACO_CONCURRENT_WITH_ENUM", false);
+  if (useACO) {
+    acoUseFixedBias = schedIni.GetBool("ACO_USE_FIXED_BIAS");
+    acoHeuristicImportance = schedIni.GetInt("ACO_HEURISTIC_IMPORTANCE");
+    acoTournament = schedIni.GetBool("ACO_TOURNAMENT");
+    acoFixedBias = schedIni.GetInt("ACO_FIXED_BIAS");
+    acoBiasRatio = schedIni.GetFloat("ACO_BIAS_RATIO");
+    acoLocalDecay = schedIni.GetFloat("ACO_LOCAL_DECAY");
+    acoDecayFactor = schedIni.GetFloat("ACO_DECAY_FACTOR");
+    acoAntsPerIteration = schedIni.GetInt("ACO_ANT_PER_ITERATION");
+    acoTrace = schedIni.GetBool("ACO_TRACE");
+    acoStopIterations = schedIni.GetInt("ACO_STOP_ITERATIONS");
+  }
+
+  enumSearchStrategy = parseEnumSearch(
+      schedIni.GetString("ENUM_SEARCH_STRATEGY", "DEPTH_FIRST"));
+  beamWidth = schedIni.GetInt("BEAM_WIDTH", 4);
+  if (enumSearchStrategy == ES_BEAM && beamWidth < 1) {
+    Logger::Error("Invalid beam width %d. Defaulted to 4.", beamWidth);
+    beamWidth = 4;
+  }
+  lengthSearch =
+      parseLengthSearch(schedIni.GetString("LENGTH_SEARCH", "LINEAR"));
+  windowThreads = schedIni.GetInt("WINDOW_THREADS", 1);
+  minImprovementRate = schedIni.GetFloat("MIN_IMPROVEMENT_RATE", 0);
+  minDagSizeForParallelBounds =
+      schedIni.GetInt("MIN_DAG_SIZE_FOR_PARALLEL_BOUNDS", 100);
+  // The other kinds of parallel scheduling already keep the cores busy.
+  if (regionThreads > 1 || enumThreads > 1 || acoThreads > 1 ||
+      windowThreads > 1)
+    minDagSizeForParallelBounds = 0;
+
+  compileTimeBudget = schedIni.GetInt("COMPILE_TIME_BUDGET", 0);
+  std::string scope = schedIni.GetString("BUDGET_SCOPE", "FUNCTION");
+  isBudgetPerModule = scope == "MODULE";
+  if (compileTimeBudget > 0 && scope != "MODULE" && scope != "FUNCTION")
+    Logger::Error("Unrecognized budget scope %s. Using FUNCTION.",
+                  scope.c_str());
+  std::string regionWeights = schedIni.GetString("REGION_WEIGHTS", "NONE");
+  useFreqWeights = regionWeights == "FREQUENCY";
+  if (regionWeights != "FREQUENCY" && regionWeights != "NONE")
+    Logger::Error("Unrecognized region weights %s. Using NONE.",
+                  regionWeights.c_str());
+  enumWeightPercentile = schedIni.GetFloat("ENUM_WEIGHT_PERCENTILE", 0);
+  maxWeightTimeoutScale = schedIni.GetFloat("MAX_WEIGHT_TIMEOUT_SCALE", 1);
+  // A compile-time budget sets the timeouts of the regions, and scaling them
+  // would overrun it.
+  if (compileTimeBudget > 0)
+    maxWeightTimeoutScale = 1;
+  if (regionThreads > 1 &&
+      (enumWeightPercentile > 0 || maxWeightTimeoutScale > 1)) {
+    Logger::Info("Regions are not ranked by weight with REGION_THREADS "
+                 "larger than 1.");
+    enumWeightPercentile = 0;
+    maxWeightTimeoutScale = 1;
+  }
+  randomSeed = schedIni.GetInt("RANDOM_SEED", 0);
+
+  std::string schedCacheDir = schedIni.GetString("SCHED_CACHE_DIR", "NONE");
+  if (schedCacheDir != "NONE") {
+    // The settings that change the cost of a schedule. The latencies and
+    // registers are part of the cached graph itself.
+    static const char *const cacheSettings[] = {
+        "SPILL_COST_FUNCTION",     "SPILL_COST_FACTOR",
+        "SCHEDULE_FOR_RP_ONLY",    "ENUMERATE_STALLS",
+        "CHECK_SPILL_COST_SUM",    "CHECK_CONFLICTS",
+        "FIX_LIVEIN",              "FIX_LIVEOUT",
+        "MAX_SPILL_COST",          "STATIC_NODE_SUPERIORITY",
+        "FILTER_BY_PERP",          "MULTI_PASS_NODE_SUPERIORITY"};
+    std::string cnfgSig;
+    for (const char *setting : cacheSettings)
+      cnfgSig += std::string(setting) + "=" +
+                 schedIni.GetString(setting, "") + ";";
+    schedCache.reset(new SchedCache(schedCacheDir, cnfgSig));
+  }
+
+  filterRegisterTypes =
+      schedIni.GetBool("FILTER_REGISTERS_TYPES_WITH_LOW_PRP", false);
+  generateMachineModel = schedIni.GetBool("GENERATE_MACHINE_MODEL", false);
+  addDefinedAndNotUsedRegs = schedIni.GetBool("ADD_DEFINED_AND_NOT_USED_REGS");
+  addUsedAndNotDefinedRegs = schedIni.GetBool("ADD_USED_AND_NOT_DEFINED_REGS");
+  addLiveOutAndNotDefinedRegs =
+      schedIni.GetBool("ADD_LIVE_OUT_AND_NOT_DEFINED_REGS");
+  useSimpleRegisterTypes = schedIni.GetBool("USE_SIMPLE_REGISTER_TYPES");
+}
+
+} // end namespace opt_sched
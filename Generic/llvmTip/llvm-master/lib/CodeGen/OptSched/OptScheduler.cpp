@@ -9,28 +9,28 @@
 #include "llvm/CodeGen/MachineScheduler.h"
 #include "llvm/CodeGen/OptSched/OptSchedDagWrapper.h"
 #include "llvm/CodeGen/OptSched/OptScheduler.h"
+#include "llvm/CodeGen/OptSched/aco_colony.h"
 #include "llvm/CodeGen/OptSched/basic/data_dep.h"
 #include "llvm/CodeGen/OptSched/basic/graph_trans.h"
 #include "llvm/CodeGen/OptSched/basic/register.h"
-#include "llvm/CodeGen/OptSched/generic/config.h"
+#include "llvm/CodeGen/OptSched/enum/parallel_enum.h"
 #include "llvm/CodeGen/OptSched/generic/utilities.h"
-#include "llvm/CodeGen/OptSched/generic/random.h"
 #include "llvm/CodeGen/OptSched/sched_region/sched_region.h"
 #include "llvm/CodeGen/OptSched/spill/bb_spill.h"
 #include "llvm/CodeGen/RegisterClassInfo.h"
 #include "llvm/CodeGen/ScheduleDAG.h"
 #include "llvm/CodeGen/ScheduleDAGInstrs.h"
+#include "llvm/IR/Module.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <chrono>
+#include <memory>
+#include <thread>
 
 #define DEBUG_TYPE "optsched"
 
-// hack to print spills
-bool OPTSCHED_gPrintSpills;
-
 // read path to configuration directory from command line
 static llvm::cl::opt<std::string>
     OptSchedCfg("optsched-cfg", llvm::cl::Hidden,
@@ -45,6 +45,12 @@ static llvm::ScheduleDAGInstrs *createOptSched(llvm::MachineSchedContext *C) {
 static llvm::MachineSchedRegistry
     OptSchedRegistry("optsched", "Use the OptSched scheduler.", createOptSched);
 
+// The compile-time budget shared by the functions of a module when
+// BUDGET_SCOPE is MODULE, and the module it belongs to. Each thread compiles
+// one module at a time, so each thread has a budget of its own.
+static thread_local std::unique_ptr<opt_sched::SchedBudget> moduleBudget;
+static thread_local const llvm::Module *budgetModule = NULL;
+
 // If this iterator is a debug value, increment until reaching the End or a
 // non-debug instruction. static method from llvm/CodeGen/MachineScheduler.cpp
 static llvm::MachineBasicBlock::iterator
@@ -60,31 +66,16 @@ nextIfDebug(llvm::MachineBasicBlock::iterator I,
 namespace opt_sched {
 ScheduleDAGOptSched::ScheduleDAGOptSched(llvm::MachineSchedContext *C)
     : llvm::ScheduleDAGMILive(C, llvm::make_unique<llvm::GenericScheduler>(C)),
-      context(C), model(OptSchedCfg + "machine_model.cfg"),
+      context(C), settings(OptSchedSettings::load(OptSchedCfg)),
       totalSimulatedSpills(0) {
-
-  // valid heuristic names
-  std::strcpy(hurstcNames[(int)LSH_CP], "CP");
-  std::strcpy(hurstcNames[(int)LSH_LUC], "LUC");
-  std::strcpy(hurstcNames[(int)LSH_UC], "UC");
-  std::strcpy(hurstcNames[(int)LSH_NID], "NID");
-  std::strcpy(hurstcNames[(int)LSH_CPR], "CPR");
-  std::strcpy(hurstcNames[(int)LSH_ISO], "ISO");
-  std::strcpy(hurstcNames[(int)LSH_SC], "SC");
-  std::strcpy(hurstcNames[(int)LSH_LS], "LS");
-
-  // Setup config object
-  Config &schedIni = SchedulerOptions::getInstance();
-  // load OptSched ini file
-  schedIni.Load(OptSchedCfg + "sched.ini");
-  // load hot functions ini file
-  hotFunctions.Load(OptSchedCfg + "hotfuncs.ini");
-
   // Convert machine model
-  model.convertMachineModel(static_cast<llvm::ScheduleDAGInstrs&>(*this), RegClassInfo);
+  model = LLVMMachineModel::getModel(OptSchedCfg + "machine_model.cfg", *this,
+                                     RegClassInfo);
 
-  // Load config files for the OptScheduler
+  // Set up the flags of the function
   loadOptSchedConfig();
+  setupBudget();
+  setupBlockFreqs();
 }
 
 void ScheduleDAGOptSched::SetupLLVMDag() {
@@ -115,18 +106,11 @@ void ScheduleDAGOptSched::schedule() {
   // regions. Region names are of the form:
   //   funcName:regionNum
   // No leading zeroes in regionNum, and no whitespace.
-  // Get config options.
-  Config &schedIni = SchedulerOptions::getInstance();
-  const bool scheduleSpecificRegions =
-      schedIni.GetBool("SCHEDULE_SPECIFIC_REGIONS");
-  if (scheduleSpecificRegions) {
-    const std::list<std::string> regionList =
-        schedIni.GetStringList("REGIONS_TO_SCHEDULE");
+  if (settings.scheduleSpecificRegions) {
     const std::string regionName =
         context->MF->getFunction()->getName().data() + std::string(":") +
         std::to_string(regionNum);
-    optSchedEnabled = std::find(std::begin(regionList), std::end(regionList),
-                                regionName) != std::end(regionList);
+    optSchedEnabled = settings.isRegionSelected(regionName);
   }
 
   if (!optSchedEnabled) {
@@ -178,7 +162,7 @@ void ScheduleDAGOptSched::schedule() {
   }
 
   // Use LLVM's heuristic schedule as input to the B&B scheduler.
-  if (llvmScheduling) {
+  if (settings.llvmScheduling) {
 
     ScheduleDAGMILive::schedule();
 
@@ -261,13 +245,13 @@ void ScheduleDAGOptSched::schedule() {
 #endif
   // discoverBoundaryLiveness();
   // build LLVM DAG
-  if (!llvmScheduling) {
+  if (!settings.llvmScheduling) {
     SetupLLVMDag();
     // Init topo for fast search for cycles and/or mutations
     Topo.InitDAGTopologicalSorting();
 
     // apply mutations
-    if (enableMutations) {
+    if (settings.enableMutations) {
       postprocessDAG();
     }
   }
@@ -301,21 +285,37 @@ void ScheduleDAGOptSched::schedule() {
   }
 #endif
 
+  // In batched mode the region is solved on the region thread pool, and its
+  // schedule is applied when the whole function has been seen.
+  if (isRegionDeferrable()) {
+    deferRegion();
+    return;
+  }
+
   // convert dag
-  LLVMDataDepGraph dag(context, this, &model, latencyPrecision, BB,
-                       graphTransTypes, RPTracker.getPressure().MaxSetPressure,
-                       treatOrderDepsAsDataDeps, maxDagSizeForLatencyPrecision,
-                       regionNum);
+  std::unique_ptr<LLVMDataDepGraph> dagPtr(createOptSchedDag());
+  LLVMDataDepGraph &dag = *dagPtr;
   // create region
-  SchedRegion *region = new BBWithSpill(
-      &model, &dag, 0, histTableHashBits, lowerBoundAlgorithm,
-      heuristicPriorities, enumPriorities, verifySchedule, prune,
-      schedForRPOnly, enumerateStalls, spillCostFactor, spillCostFunction,
-      checkSpillCostSum, checkConflicts, fixLiveIn, fixLiveOut, maxSpillCost);
+  SchedRegion *region = createRegion(&dag);
 
   // count defs, add defs and uses
   region->BuildFromFile();
 
+  // Look for a schedule found by an earlier compilation of this region.
+  UDT_HASHKEY cacheKey = 0;
+  SchedCacheEntry cacheEntry;
+  bool isCacheHit = false;
+  if (settings.schedCache) {
+    cacheKey = settings.schedCache->CmputKey(&dag, model.get());
+    isCacheHit =
+        settings.schedCache->Find(cacheKey, &dag, model.get(), cacheEntry);
+    if (isCacheHit) {
+      Logger::Info("Found a%s schedule with cost %d in the schedule cache.",
+                   cacheEntry.isOptml ? "n optimal" : "", cacheEntry.cost);
+      region->SetSeedSched(cacheEntry);
+    }
+  }
+
   // Schedule
   bool isEasy;
   InstCount normBestCost = 0;
@@ -324,53 +324,183 @@ void ScheduleDAGOptSched::schedule() {
   InstCount hurstcSchedLngth = 0;
   InstSchedule *sched = NULL;
   FUNC_RESULT rslt;
-
-  if (isTimeoutPerInstruction) {
+  // The region whose schedule is taken.
+  SchedRegion *bestRegion = region;
+  // The private copies of the region used by the other workers of a parallel
+  // enumeration or ant colony.
+  std::vector<std::unique_ptr<LLVMDataDepGraph>> workerDags;
+  std::vector<std::unique_ptr<SchedRegion>> workerRegions;
+
+  if (settings.isTimeoutPerInstruction) {
     // Re-calculate timeout values if timeout setting is per instruction
     // becuase we want a unique value per DAG size
-    regionTimeout = schedIni.GetInt("REGION_TIMEOUT") * dag.GetInstCnt();
-    lengthTimeout = schedIni.GetInt("LENGTH_TIMEOUT") * dag.GetInstCnt();
+    regionTimeout = settings.regionTimeout * dag.GetInstCnt();
+    lengthTimeout = settings.lengthTimeout * dag.GetInstCnt();
   }
 
-  // Setup time before scheduling
-  Utilities::startTime = std::chrono::high_resolution_clock::now();
-
-  if (dag.GetInstCnt() < minDagSize || dag.GetInstCnt() > maxDagSize) {
+  if (!isDagSizeInRange(dag.GetInstCnt())) {
     rslt = RES_FAIL;
     Logger::Error("Dag skipped due to out-of-range size. DAG size = %d, \
 									valid range is [%d, %d]",
-                  dag.GetInstCnt(), minDagSize, maxDagSize);
+                  dag.GetInstCnt(), settings.minDagSize, settings.maxDagSize);
+  } else if (dag.GetWeight() < settings.minDagWeight) {
+    rslt = RES_FAIL;
+    Logger::Info("Dag skipped due to low weight. DAG weight = %g, minimum "
+                 "is %g",
+                 dag.GetWeight(), settings.minDagWeight);
   } else {
-    bool filterByPerp = schedIni.GetBool("FILTER_BY_PERP");
-    auto blocksToKeep = [&]() {
-      auto setting = schedIni.GetString("BLOCKS_TO_KEEP");
-      if (setting == "ZERO_COST")
-        return BLOCKS_TO_KEEP::ZERO_COST;
-      else if (setting == "OPTIMAL")
-        return BLOCKS_TO_KEEP::OPTIMAL;
-      else if (setting == "IMPROVED")
-        return BLOCKS_TO_KEEP::IMPROVED;
-      else if (setting == "IMPROVED_OR_OPTIMAL")
-        return BLOCKS_TO_KEEP::IMPROVED_OR_OPTIMAL;
-      else
-        return BLOCKS_TO_KEEP::ALL;
-    }();
-    rslt = region->FindOptimalSchedule(
-        useFileBounds, regionTimeout, lengthTimeout, isEasy, normBestCost,
-        bestSchedLngth, normHurstcCost, hurstcSchedLngth, sched, filterByPerp,
-        blocksToKeep);
+    // In budget mode the timeouts come from the region's share of the budget.
+    Milliseconds budgetShare = 0;
+    Milliseconds rgnStart = Utilities::GetProcessorTime();
+    if (funcBudget)
+      budgetShare = reserveBudget(dag.GetInstCnt(), regionTimeout,
+                                  lengthTimeout);
+    bool filterByPerp = settings.filterByPerp;
+    BLOCKS_TO_KEEP blocksToKeep = settings.blocksToKeep;
+    bool useCachedSched = isCacheHit && isCachedSchedUsable(cacheEntry);
+    if (useCachedSched) {
+      // The cached schedule is optimal, so there is nothing left to search.
+      sched = createCachedSched(&dag, cacheEntry);
+      normBestCost = normHurstcCost = cacheEntry.cost;
+      bestSchedLngth = hurstcSchedLngth = sched->GetCrntLngth();
+      isEasy = true;
+      rslt = RES_SUCCESS;
+      // The region was not scheduled, so it has no simulated spills.
+      bestRegion = NULL;
+    } else if (((settings.enumThreads > 1 && regionTimeout != 0) ||
+                settings.acoThreads > 1) &&
+               !isDagWindowed(dag.GetInstCnt())) {
+      // Parallel enumeration or ant colony. The schedulers modify the state
+      // of the DAG they work on, so every worker schedules its own copy of the
+      // region. The first enumWorkerCnt workers enumerate, and any others are
+      // only there for the ant colony.
+      // A region that is enumerated in windows has no workers, since it solves
+      // its windows in parallel instead.
+      int enumWorkerCnt = regionTimeout != 0 ? settings.enumThreads : 1;
+      int workerCnt = std::max(enumWorkerCnt, settings.acoThreads);
+      for (int i = 1; i < workerCnt; i++) {
+        workerDags.emplace_back(createOptSchedDag());
+        workerRegions.emplace_back(createRegion(workerDags.back().get()));
+        workerRegions.back()->BuildFromFile();
+        if (isCacheHit)
+          workerRegions.back()->SetSeedSched(cacheEntry);
+      }
+
+      struct WorkerResult {
+        FUNC_RESULT rslt;
+        bool isEasy;
+        InstCount normBestCost;
+        InstCount bestSchedLngth;
+        InstCount normHurstcCost;
+        InstCount hurstcSchedLngth;
+        InstSchedule *sched;
+      };
+      std::vector<WorkerResult> results(workerCnt);
+      std::unique_ptr<ParallelEnumState> prllState;
+      if (enumWorkerCnt > 1)
+        prllState.reset(
+            new ParallelEnumState(enumWorkerCnt, settings.enumSplitDepth));
+      std::unique_ptr<ACOColony> colony;
+      if (settings.acoThreads > 1)
+        colony.reset(new ACOColony(workerCnt, enumWorkerCnt, dag.GetInstCnt(),
+                                   settings.acoWithEnum,
+                                   randomSeed + 2 * workerCnt * regionNum));
+      RegionRanking::SharedAllotment allotment;
+
+      auto runWorker = [&](int i) {
+        SchedRegion *workerRegion = i == 0 ? region : workerRegions[i - 1].get();
+        WorkerResult &res = results[i];
+        res.sched = NULL;
+        if (i < enumWorkerCnt)
+          workerRegion->SetParallelState(prllState.get());
+        workerRegion->SetACOColony(colony.get(), i);
+        workerRegion->SetSharedAllotment(&allotment);
+        res.rslt = workerRegion->FindOptimalSchedule(
+            settings.useFileBounds, regionTimeout, lengthTimeout, res.isEasy,
+            res.normBestCost, res.bestSchedLngth, res.normHurstcCost,
+            res.hurstcSchedLngth, res.sched, filterByPerp, blocksToKeep);
+        workerRegion->SetParallelState(NULL);
+        workerRegion->SetACOColony(NULL, 0);
+        workerRegion->SetSharedAllotment(NULL);
+        if (colony && i < enumWorkerCnt)
+          colony->EnumDone();
+      };
+
+      std::vector<std::thread> workers;
+      for (int i = 1; i < workerCnt; i++)
+        workers.emplace_back(runWorker, i);
+      runWorker(0);
+      for (std::thread &worker : workers)
+        worker.join();
+
+      // Take the cheapest schedule. The search is only complete if no worker
+      // timed out. The workers that only run the ant colony prove nothing, so
+      // they do not count.
+      int best = INVALID_VALUE;
+      bool timedOut = false;
+      for (int i = 0; i < workerCnt; i++) {
+        const WorkerResult &res = results[i];
+        if (res.rslt == RES_TIMEOUT && i < enumWorkerCnt)
+          timedOut = true;
+        if (!(res.rslt == RES_SUCCESS || res.rslt == RES_TIMEOUT) ||
+            res.sched == NULL)
+          continue;
+        if (best == INVALID_VALUE ||
+            res.normBestCost < results[best].normBestCost)
+          best = i;
+      }
+
+      for (int i = 0; i < workerCnt; i++) {
+        if (i != best && results[i].sched != NULL)
+          delete results[i].sched;
+      }
+
+      if (best == INVALID_VALUE) {
+        rslt = results[0].rslt == RES_SUCCESS ? RES_FAIL : results[0].rslt;
+      } else {
+        const WorkerResult &res = results[best];
+        FUNC_RESULT bestRslt = best < enumWorkerCnt ? res.rslt : RES_SUCCESS;
+        rslt = (bestRslt == RES_SUCCESS && timedOut) ? RES_TIMEOUT : bestRslt;
+        isEasy = res.isEasy;
+        normBestCost = res.normBestCost;
+        bestSchedLngth = res.bestSchedLngth;
+        normHurstcCost = res.normHurstcCost;
+        hurstcSchedLngth = res.hurstcSchedLngth;
+        sched = res.sched;
+        if (best > 0)
+          bestRegion = workerRegions[best - 1].get();
+      }
+    } else {
+      rslt = region->FindOptimalSchedule(
+          settings.useFileBounds, regionTimeout, lengthTimeout, isEasy,
+          normBestCost, bestSchedLngth, normHurstcCost, hurstcSchedLngth, sched,
+          filterByPerp, blocksToKeep);
+    }
+    if (funcBudget)
+      funcBudget->Release(budgetShare,
+                          Utilities::GetProcessorTime() - rgnStart);
+    if (settings.schedCache && !useCachedSched &&
+        (rslt == RES_SUCCESS || rslt == RES_TIMEOUT) && sched != NULL &&
+        regionTimeout != 0) {
+      // Take optimality from the region, which knows whether the schedule it
+      // returned is the one it proved optimal.
+      bool isOptml = rslt == RES_SUCCESS && bestRegion->IsSchedOptml();
+      settings.schedCache->Store(cacheKey, sched, model.get(),
+                                 dag.GetInstCnt(), normBestCost, isOptml);
+    }
+
     if ((!(rslt == RES_SUCCESS || rslt == RES_TIMEOUT) || sched == NULL)) {
       Logger::Info("OptSched run failed: rslt=%d, sched=%p. Falling back.",
                    rslt, (void *)sched);
 
-      if (!llvmScheduling)
+      if (!settings.llvmScheduling)
         fallbackScheduler();
 
     } else {
       Logger::Info("OptSched succeeded.");
       // Count simulated spills.
-      if (isSimRegAllocEnabled()) {
-        totalSimulatedSpills += region->GetSimSpills();
+      if (isSimRegAllocEnabled() && bestRegion != NULL) {
+        totalSimulatedSpills += bestRegion->GetSimSpills();
       }
 
       // Convert back to LLVM.
@@ -448,6 +578,185 @@ void ScheduleDAGOptSched::schedule() {
   delete region;
 }
 
+bool ScheduleDAGOptSched::isRegionDeferrable() const {
+  if (settings.regionThreads <= 1)
+    return false;
+  // In ISO mode the DAG is built from the schedule that LLVM gives the region.
+  if (settings.llvmScheduling)
+    return false;
+  // LLVM adjusts the lane liveness flags of the operands and places the debug
+  // values while it schedules a region, so reordering such a region after LLVM
+  // has scheduled it would leave them inconsistent.
+  if (ShouldTrackLaneMasks || !DbgValues.empty() || FirstDbgValue != NULL)
+    return false;
+  // Generating the machine model adds instruction types to it while the DAG
+  // is built, which would race with the regions reading it on the pool.
+  if (settings.generateMachineModel)
+    return false;
+  // Regions that OptSched skips fall back to LLVM right away.
+  int instCnt = SUnits.size() + 2;
+  return isDagSizeInRange(instCnt) &&
+         getRegionWeight() >= settings.minDagWeight;
+}
+
+void ScheduleDAGOptSched::deferRegion() {
+  std::unique_ptr<DeferredRegion> rgn(new DeferredRegion);
+
+  rgn->dag.reset(createOptSchedDag());
+  rgn->region.reset(createRegion(rgn->dag.get()));
+  // count defs, add defs and uses. After this the region no longer refers to
+  // the LLVM DAG, which is rebuilt for the next region.
+  rgn->region->BuildFromFile();
+
+  // A cached schedule is handled as in schedule(): a proven-optimal one
+  // replaces the search, and any other one seeds it.
+  rgn->cacheKey = 0;
+  rgn->isCachedSched = false;
+  rgn->sched = NULL;
+  if (settings.schedCache) {
+    SchedCacheEntry cacheEntry;
+    rgn->cacheKey = settings.schedCache->CmputKey(rgn->dag.get(), model.get());
+    if (settings.schedCache->Find(rgn->cacheKey, rgn->dag.get(), model.get(),
+                                  cacheEntry)) {
+      Logger::Info("Found a%s schedule with cost %d in the schedule cache.",
+                   cacheEntry.isOptml ? "n optimal" : "", cacheEntry.cost);
+      if (isCachedSchedUsable(cacheEntry)) {
+        rgn->isCachedSched = true;
+        rgn->sched = createCachedSched(rgn->dag.get(), cacheEntry);
+        rgn->rslt = RES_SUCCESS;
+        rgn->isEasy = true;
+        rgn->normBestCost = rgn->normHurstcCost = cacheEntry.cost;
+        rgn->bestSchedLngth = rgn->hurstcSchedLngth =
+            rgn->sched->GetCrntLngth();
+      } else {
+        rgn->region->SetSeedSched(cacheEntry);
+      }
+    }
+  }
+
+  rgn->instrs.assign(rgn->dag->GetInstCnt(), NULL);
+  for (size_t i = 0; i < SUnits.size(); i++) {
+    if (SUnits[i].isInstr())
+      rgn->instrs[i] = SUnits[i].getInstr();
+  }
+  rgn->BB = BB;
+  rgn->regionEnd = RegionEnd == BB->end() ? NULL : &*RegionEnd;
+
+  rgn->regionTimeout = regionTimeout;
+  rgn->lengthTimeout = lengthTimeout;
+  if (settings.isTimeoutPerInstruction) {
+    rgn->regionTimeout = settings.regionTimeout * rgn->dag->GetInstCnt();
+    rgn->lengthTimeout = settings.lengthTimeout * rgn->dag->GetInstCnt();
+  }
+  rgn->budgetShare = 0;
+  rgn->filterByPerp = settings.filterByPerp;
+  rgn->blocksToKeep = settings.blocksToKeep;
+
+  // The cached schedule is applied along with the others, in region order.
+  if (rgn->isCachedSched) {
+    deferredRegions.push_back(std::move(rgn));
+    ScheduleDAGMILive::schedule();
+    return;
+  }
+
+  if (!regionPool)
+    regionPool.reset(new llvm::ThreadPool(settings.regionThreads));
+
+  DeferredRegion *task = rgn.get();
+  deferredRegions.push_back(std::move(rgn));
+  regionPool->async([this, task]() {
+    // The share is taken when the region starts, so that it includes the time
+    // left over by the regions that finished before.
+    Milliseconds rgnStart = Utilities::GetProcessorTime();
+    if (funcBudget)
+      task->budgetShare =
+          reserveBudget(task->dag->GetInstCnt(), task->regionTimeout,
+                        task->lengthTimeout);
+    task->rslt = task->region->FindOptimalSchedule(
+        settings.useFileBounds, task->regionTimeout, task->lengthTimeout,
+        task->isEasy, task->normBestCost, task->bestSchedLngth,
+        task->normHurstcCost, task->hurstcSchedLngth, task->sched,
+        task->filterByPerp, task->blocksToKeep);
+    if (funcBudget)
+      funcBudget->Release(task->budgetShare,
+                          Utilities::GetProcessorTime() - rgnStart);
+  });
+
+  // Give the region LLVM's schedule for now. It is kept if OptSched fails.
+  ScheduleDAGMILive::schedule();
+}
+
+void ScheduleDAGOptSched::finishDeferredRegions() {
+  if (deferredRegions.empty())
+    return;
+
+  regionPool->wait();
+
+  for (std::unique_ptr<DeferredRegion> &rgn : deferredRegions) {
+    FUNC_RESULT rslt = rgn->rslt;
+    InstSchedule *sched = rgn->sched;
+
+    if (settings.schedCache && !rgn->isCachedSched &&
+        (rslt == RES_SUCCESS || rslt == RES_TIMEOUT) && sched != NULL &&
+        rgn->regionTimeout != 0) {
+      bool isOptml = rslt == RES_SUCCESS && rgn->region->IsSchedOptml();
+      settings.schedCache->Store(rgn->cacheKey, sched, model.get(),
+                                 rgn->dag->GetInstCnt(), rgn->normBestCost,
+                                 isOptml);
+    }
+
+    if (!(rslt == RES_SUCCESS || rslt == RES_TIMEOUT) || sched == NULL) {
+      Logger::Info("OptSched run failed: rslt=%d, sched=%p. Keeping the LLVM "
+                   "schedule.",
+                   rslt, (void *)sched);
+    } else {
+      Logger::Info("OptSched succeeded.");
+      // Count simulated spills.
+      // A region that was not scheduled has no simulated spills.
+      if (isSimRegAllocEnabled() && !rgn->isCachedSched)
+        totalSimulatedSpills += rgn->region->GetSimSpills();
+      applyDeferredSched(*rgn);
+    }
+
+    delete sched;
+  }
+
+  deferredRegions.clear();
+}
+
+void ScheduleDAGOptSched::applyDeferredSched(const DeferredRegion &rgn) {
+  llvm::MachineBasicBlock::iterator regionEnd =
+      rgn.regionEnd == NULL ? rgn.BB->end()
+                            : llvm::MachineBasicBlock::iterator(rgn.regionEnd);
+
+  // The region has no debug values, so it consists of exactly the
+  // instructions of its DAG, in the order LLVM left them in.
+  llvm::MachineBasicBlock::iterator top = regionEnd;
+  for (llvm::MachineInstr *instr : rgn.instrs) {
+    if (instr != NULL)
+      --top;
+  }
+
+  InstCount cycle, slot;
+  for (InstCount i = rgn.sched->GetFrstInst(cycle, slot); i != INVALID_VALUE;
+       i = rgn.sched->GetNxtInst(cycle, slot)) {
+    if (i == SCHD_STALL)
+      continue;
+
+    llvm::MachineInstr *instr = rgn.instrs[i];
+    if (instr == NULL)
+      continue;
+
+    if (&*top == instr) {
+      ++top;
+    } else {
+      rgn.BB->splice(top, rgn.BB, instr);
+      if (LIS)
+        LIS->handleMove(*instr, /*UpdateFlags=*/true);
+    }
+  }
+}
+
 void ScheduleDAGOptSched::ScheduleNode(llvm::SUnit *SU, unsigned CurCycle) {
 #ifdef IS_DEBUG_CONVERT_LLVM
   Logger::Info("*** Scheduling [%lu]: ", CurCycle);
@@ -494,69 +803,158 @@ void ScheduleDAGOptSched::fallbackScheduler() {
   }
 
   // Only call LLVM scheduler if the heurisitc is not ISO.
-  if (!llvmScheduling)
+  if (!settings.llvmScheduling)
     ScheduleDAGMILive::schedule();
 }
 
 void ScheduleDAGOptSched::loadOptSchedConfig() {
-  SchedulerOptions &schedIni = SchedulerOptions::getInstance();
   // setup OptScheduler configuration options
   optSchedEnabled = isOptSchedEnabled();
-  latencyPrecision = fetchLatencyPrecision();
-  maxDagSizeForLatencyPrecision =
-      schedIni.GetInt("MAX_DAG_SIZE_FOR_PRECISE_LATENCY");
-  treatOrderDepsAsDataDeps = schedIni.GetBool("TREAT_ORDER_DEPS_AS_DATA_DEPS");
+  regionTimeout = settings.regionTimeout;
+  lengthTimeout = settings.lengthTimeout;
 
   // should we print spills for the current function
   OPTSCHED_gPrintSpills = shouldPrintSpills();
 
-  // setup pruning
-  prune.rlxd = schedIni.GetBool("APPLY_RELAXED_PRUNING");
-  prune.nodeSup = schedIni.GetBool("DYNAMIC_NODE_SUPERIORITY");
-  prune.histDom = schedIni.GetBool("APPLY_HISTORY_DOMINATION");
-  prune.spillCost = schedIni.GetBool("APPLY_SPILL_COST_PRUNING");
-  prune.useSuffixConcatenation =
-      schedIni.GetBool("ENABLE_SUFFIX_CONCATENATION");
-
-  // setup graph transformations
-  graphTransTypes.staticNodeSup = schedIni.GetBool("STATIC_NODE_SUPERIORITY");
-  // setup graph transformation flags
-  GraphTrans::GRAPHTRANSFLAGS.multiPassNodeSup =
-      schedIni.GetBool("MULTI_PASS_NODE_SUPERIORITY");
-
-  schedForRPOnly = schedIni.GetBool("SCHEDULE_FOR_RP_ONLY");
-  histTableHashBits =
-      static_cast<int16_t>(schedIni.GetInt("HIST_TABLE_HASH_BITS"));
-  verifySchedule = schedIni.GetBool("VERIFY_SCHEDULE");
-  enableMutations = schedIni.GetBool("LLVM_MUTATIONS");
-  enumerateStalls = schedIni.GetBool("ENUMERATE_STALLS");
-  spillCostFactor = schedIni.GetInt("SPILL_COST_FACTOR");
-  checkSpillCostSum = schedIni.GetBool("CHECK_SPILL_COST_SUM");
-  checkConflicts = schedIni.GetBool("CHECK_CONFLICTS");
-  fixLiveIn = schedIni.GetBool("FIX_LIVEIN");
-  fixLiveOut = schedIni.GetBool("FIX_LIVEOUT");
-  maxSpillCost = schedIni.GetInt("MAX_SPILL_COST");
-  lowerBoundAlgorithm = parseLowerBoundAlgorithm();
-  heuristicPriorities = parseHeuristic(schedIni.GetString("HEURISTIC"));
-  // To support old sched.ini files setting NID as the heuristic means LLVM
-  // scheduling is enabled.
-  llvmScheduling = schedIni.GetBool("LLVM_SCHEDULING", false) ||
-                   schedIni.GetString("HEURISTIC") == "NID";
-  enumPriorities = parseHeuristic(schedIni.GetString("ENUM_HEURISTIC"));
-  spillCostFunction = parseSpillCostFunc();
-  regionTimeout = schedIni.GetInt("REGION_TIMEOUT");
-  lengthTimeout = schedIni.GetInt("LENGTH_TIMEOUT");
-  if (schedIni.GetString("TIMEOUT_PER") == "INSTR")
-    isTimeoutPerInstruction = true;
-  else
-    isTimeoutPerInstruction = false;
-  minDagSize = schedIni.GetInt("MIN_DAG_SIZE");
-  maxDagSize = schedIni.GetInt("MAX_DAG_SIZE");
-  useFileBounds = schedIni.GetBool("USE_FILE_BOUNDS");
-  int randomSeed = schedIni.GetInt("RANDOM_SEED", 0);
+  randomSeed = settings.randomSeed;
   if (randomSeed == 0)
     randomSeed = time(NULL);
-  RandomGen::SetSeed(randomSeed);
+}
+
+LLVMDataDepGraph *ScheduleDAGOptSched::createOptSchedDag() {
+  LLVMDataDepGraph *dag = new LLVMDataDepGraph(
+      context, this, model.get(), settings.latencyPrecision, BB,
+      settings.graphTransTypes, RPTracker.getPressure().MaxSetPressure,
+      settings.treatOrderDepsAsDataDeps, settings.maxDagSizeForLatencyPrecision,
+      regionNum);
+  dag->SetWeight(getRegionWeight());
+  return dag;
+}
+
+SchedRegion *ScheduleDAGOptSched::createRegion(DataDepGraph *dag) {
+  SchedRegion *region = new BBWithSpill(
+      model.get(), dag, 0, settings.histTableHashBits,
+      settings.lowerBoundAlgorithm, settings.heuristicPriorities,
+      settings.enumPriorities, settings.verifySchedule, settings.prune,
+      settings.schedForRPOnly, settings.enumerateStalls,
+      settings.spillCostFactor, settings.spillCostFunction,
+      settings.checkSpillCostSum, settings.checkConflicts, settings.fixLiveIn,
+      settings.fixLiveOut, settings.maxSpillCost);
+  region->SetRndmSeed(randomSeed + regionNum);
+  region->SetHurstcPortfolio(settings.heuristicPortfolio,
+                             settings.heuristicPortfolioRandomRuns);
+  region->SetPrintSpills(OPTSCHED_gPrintSpills);
+  return region;
+}
+
+void ScheduleDAGOptSched::setupBudget() {
+  Milliseconds budget = settings.compileTimeBudget;
+  funcBudget.reset();
+  moduleBudgetShare = 0;
+  if (budget <= 0 || !optSchedEnabled)
+    return;
+
+  // The budget of the function is divided among its regions by size.
+  int funcInstCnt = 0;
+  for (const llvm::MachineBasicBlock &MBB : MF)
+    for (const llvm::MachineInstr &MI : MBB)
+      if (!MI.isDebugValue())
+        funcInstCnt++;
+
+  if (settings.isBudgetPerModule) {
+    // The module's budget is divided among its functions by the size of
+    // their IR, since the machine code of the functions that come later does
+    // not exist yet.
+    const llvm::Function *F = MF.getFunction();
+    const llvm::Module *M = F->getParent();
+    if (M != budgetModule || !moduleBudget) {
+      int moduleInstCnt = 0;
+      for (const llvm::Function &G : *M)
+        for (const llvm::BasicBlock &BB : G)
+          moduleInstCnt += BB.size();
+      moduleBudget.reset(new SchedBudget(budget, moduleInstCnt));
+      budgetModule = M;
+    }
+
+    int irInstCnt = 0;
+    for (const llvm::BasicBlock &BB : *F)
+      irInstCnt += BB.size();
+    budget = moduleBudgetShare = moduleBudget->Reserve(irInstCnt);
+  }
+
+  funcBudget.reset(new SchedBudget(budget, funcInstCnt));
+}
+
+void ScheduleDAGOptSched::setupBlockFreqs() {
+  blockFreqs.reset();
+  branchProbs.reset();
+  if (!settings.useFreqWeights || !optSchedEnabled)
+    return;
+
+  branchProbs.reset(new llvm::MachineBranchProbabilityInfo());
+  blockFreqs.reset(new llvm::MachineBlockFrequencyInfo());
+  blockFreqs->calculate(MF, *branchProbs, *context->MLI);
+}
+
+float ScheduleDAGOptSched::getRegionWeight() const {
+  if (!blockFreqs)
+    return 1.0f;
+
+  // Frequencies are only meaningful relative to the entry of the function.
+  // Profile data is reflected in them, but the absolute profile counts are
+  // not used, so that functions with and without profiles weigh alike.
+  return (float)blockFreqs->getBlockFreq(BB).getFrequency() /
+         blockFreqs->getEntryFreq();
+}
+
+bool ScheduleDAGOptSched::isDagSizeInRange(int instCnt) const {
+  return instCnt >= settings.minDagSize &&
+         (instCnt <= settings.maxDagSize || settings.windowSize > 0);
+}
+
+bool ScheduleDAGOptSched::isDagWindowed(int instCnt) const {
+  return settings.windowSize > 0 && instCnt > settings.windowSize;
+}
+
+bool ScheduleDAGOptSched::isCachedSchedUsable(
+    const SchedCacheEntry &entry) const {
+  // A proven-optimal cached schedule is taken as is, unless the experimental
+  // SLIL block filter needs the heuristic schedule to decide on it.
+  BLOCKS_TO_KEEP blocksToKeep = settings.blocksToKeep;
+  return entry.isOptml &&
+         (settings.spillCostFunction != SCF_SLIL ||
+          blocksToKeep == BLOCKS_TO_KEEP::ALL ||
+          blocksToKeep == BLOCKS_TO_KEEP::OPTIMAL ||
+          blocksToKeep == BLOCKS_TO_KEEP::IMPROVED_OR_OPTIMAL ||
+          (blocksToKeep == BLOCKS_TO_KEEP::ZERO_COST && entry.cost == 0));
+}
+
+InstSchedule *
+ScheduleDAGOptSched::createCachedSched(DataDepGraph *dag,
+                                       const SchedCacheEntry &entry) {
+  dag->SetAbslutSchedUprBound(
+      SchedCache::GetSchedLngth(entry, model->GetIssueRate()));
+  InstSchedule *sched =
+      new InstSchedule(model.get(), dag, settings.verifySchedule);
+  if (sched == NULL)
+    Logger::Fatal("Out of memory.");
+  SchedCache::FillSched(entry, model->GetIssueRate(), sched);
+  return sched;
+}
+
+Milliseconds ScheduleDAGOptSched::reserveBudget(int instCnt, int &rgnTimeout,
+                                                int &lngthTimeout) {
+  Milliseconds share = funcBudget->Reserve(instCnt);
+
+  // Keep the configured ratio between the length and region timeouts.
+  int64_t cnfgRgnTimeout = settings.regionTimeout;
+  int64_t cnfgLngthTimeout = settings.lengthTimeout;
+  rgnTimeout = share;
+  lngthTimeout = share;
+  if (cnfgRgnTimeout > 0 && cnfgLngthTimeout < cnfgRgnTimeout)
+    lngthTimeout = std::max<int64_t>(share * cnfgLngthTimeout / cnfgRgnTimeout,
+                                     share > 0 ? 1 : 0);
+  return share;
 }
 
 llvm::SmallVector<llvm::RegisterMaskPair, 8>
@@ -587,125 +985,15 @@ ScheduleDAGOptSched::discoverBoundaryLiveness() {
 }
 
 bool ScheduleDAGOptSched::isOptSchedEnabled() const {
-  // check scheduler ini file to see if optsched is enabled
-  std::string optSchedOption =
-      SchedulerOptions::getInstance().GetString("USE_OPT_SCHED");
-  if (optSchedOption == "YES") {
-    return true;
-  } else if (optSchedOption == "HOT_ONLY") {
-    // get the name of the function this scheduler was created for
-    std::string functionName = context->MF->getFunction()->getName();
-    // check the list of hot functions for the name of the current function
-    return hotFunctions.GetBool(functionName, false);
-  } else if (optSchedOption == "NO") {
-    return false;
-  } else {
-    DEBUG(llvm::dbgs() << "Invalid value for USE_OPT_SCHED" << optSchedOption
-                       << "Assuming NO.\n");
-    return false;
-  }
-}
-
-LATENCY_PRECISION ScheduleDAGOptSched::fetchLatencyPrecision() const {
-  std::string lpName =
-      SchedulerOptions::getInstance().GetString("LATENCY_PRECISION");
-  if (lpName == "PRECISE") {
-    return LTP_PRECISE;
-  } else if (lpName == "ROUGH") {
-    return LTP_ROUGH;
-  } else if (lpName == "UNITY") {
-    return LTP_UNITY;
-  } else {
-    Logger::Error("Unrecognized latency precision. Defaulted to PRECISE.");
-    return LTP_PRECISE;
-  }
-}
-
-LB_ALG ScheduleDAGOptSched::parseLowerBoundAlgorithm() const {
-  std::string LBalg = SchedulerOptions::getInstance().GetString("LB_ALG");
-  if (LBalg == "RJ") {
-    return LBA_RJ;
-  } else if (LBalg == "LC") {
-    return LBA_LC;
-  } else {
-    Logger::Error("Unrecognized lower bound technique. Defaulted to Rim-Jain.");
-    return LBA_RJ;
-  }
-}
-
-SchedPriorities
-ScheduleDAGOptSched::parseHeuristic(const std::string &str) const {
-  SchedPriorities prirts;
-  int len = str.length();
-  char word[HEUR_NAME_MAX_SIZE];
-  int wIndx = 0;
-  prirts.cnt = 0;
-  prirts.isDynmc = false;
-  int i, j;
-
-  for (i = 0; i <= len; i++) {
-    char ch = str.c_str()[i];
-    if (ch == '_' || ch == 0) { // end of word
-      word[wIndx] = 0;
-      for (j = 0; j < HEUR_NAME_CNT; j++) {
-        if (strcmp(word, hurstcNames[j]) == 0) {
-          prirts.vctr[prirts.cnt] = (LISTSCHED_HEURISTIC)j;
-          if ((LISTSCHED_HEURISTIC)j == LSH_LUC)
-            prirts.isDynmc = true;
-          break;
-        } // end if
-      }   // end for j
-      if (j == HEUR_NAME_CNT) {
-        Logger::Error("Unrecognized heuristic %s. Defaulted to CP.", word);
-        prirts.vctr[prirts.cnt] = LSH_CP;
-      }
-      prirts.cnt++;
-      wIndx = 0;
-    } else {
-      word[wIndx] = ch;
-      wIndx++;
-    } // end else
-  }   // end for i
-  return prirts;
-}
-
-SPILL_COST_FUNCTION ScheduleDAGOptSched::parseSpillCostFunc() const {
-  std::string name =
-      SchedulerOptions::getInstance().GetString("SPILL_COST_FUNCTION");
-  // PERP used to be called PEAK.
-  if (name == "PERP" || name == "PEAK") {
-    return SCF_PERP;
-  } else if (name == "PRP") {
-    return SCF_PRP;
-  } else if (name == "PEAK_PER_TYPE") {
-    return SCF_PEAK_PER_TYPE;
-  } else if (name == "SUM") {
-    return SCF_SUM;
-  } else if (name == "PEAK_PLUS_AVG") {
-    return SCF_PEAK_PLUS_AVG;
-  } else if (name == "SLIL") {
-    return SCF_SLIL;
-  } else {
-    Logger::Error("Unrecognized spill cost function. Defaulted to PERP.");
-    return SCF_PERP;
-  }
+  // get the name of the function this scheduler was created for
+  std::string functionName = context->MF->getFunction()->getName();
+  // check the scheduler settings and the list of hot functions
+  return settings.isSelected(settings.useOptSched, functionName);
 }
 
 bool ScheduleDAGOptSched::shouldPrintSpills() {
-  std::string printSpills =
-      SchedulerOptions::getInstance().GetString("PRINT_SPILL_COUNTS");
-  if (printSpills == "YES") {
-    return true;
-  } else if (printSpills == "NO") {
-    return false;
-  } else if (printSpills == "HOT_ONLY") {
-    std::string functionName = context->MF->getFunction()->getName();
-    return hotFunctions.GetBool(functionName, false);
-  } else {
-    Logger::Error("Unknown value for PRINT_SPILL_COUNTS: %s. Assuming NO.",
-                  printSpills.c_str());
-    return false;
-  }
+  std::string functionName = context->MF->getFunction()->getName();
+  return settings.isSelected(settings.printSpills, functionName);
 }
 
 bool ScheduleDAGOptSched::rpMismatch(InstSchedule *sched) {
@@ -727,8 +1015,19 @@ bool ScheduleDAGOptSched::rpMismatch(InstSchedule *sched) {
 }
 
 void ScheduleDAGOptSched::finalizeSchedule() {
+  finishDeferredRegions();
   llvm::ScheduleDAGMILive::finalizeSchedule();
 
+  if (funcBudget) {
+    Milliseconds spentTime = funcBudget->GetSpentTime();
+    Logger::Info("Function %s used %lld ms of its scheduling budget with "
+                 "%lld ms left.",
+                 MF.getName().data(), (long long)spentTime,
+                 (long long)funcBudget->GetRemainingTime());
+    if (moduleBudgetShare > 0)
+      moduleBudget->Release(moduleBudgetShare, spentTime);
+  }
+
   if (isSimRegAllocEnabled()) {
     llvm::dbgs() << "*************************************\n";
     llvm::dbgs() << "Function: " << MF.getName()
@@ -740,14 +1039,7 @@ void ScheduleDAGOptSched::finalizeSchedule() {
 
 bool ScheduleDAGOptSched::isSimRegAllocEnabled() {
   // This will return false if only the list schedule is allocated.
-  return (
-      OPTSCHED_gPrintSpills &&
-      (SchedulerOptions::getInstance().GetString(
-           "SIMULATE_REGISTER_ALLOCATION") == "BEST" ||
-       SchedulerOptions::getInstance().GetString(
-           "SIMULATE_REGISTER_ALLOCATION") == "BOTH" ||
-       SchedulerOptions::getInstance().GetString(
-           "SIMULATE_REGISTER_ALLOCATION") == "TAKE_SCHED_WITH_LEAST_SPILLS"));
+  return OPTSCHED_gPrintSpills && settings.simRegAlloc;
 }
 
 } // namespace opt_sched
@@ -1,13 +1,19 @@
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
+#include <mutex>
+#include <numeric>
 #include <sstream>
+#include <utility>
 #include "llvm/CodeGen/OptSched/aco.h"
+#include "llvm/CodeGen/OptSched/OptSchedSettings.h"
 #include "llvm/CodeGen/OptSched/basic/data_dep.h"
 #include "llvm/CodeGen/OptSched/basic/ready_list.h"
 #include "llvm/CodeGen/OptSched/basic/register.h"
 #include "llvm/CodeGen/OptSched/sched_region/sched_region.h"
 #include "llvm/CodeGen/OptSched/generic/config.h"
 #include "llvm/CodeGen/OptSched/generic/random.h"
+#include "llvm/CodeGen/OptSched/generic/utilities.h"
 
 namespace opt_sched {
 
@@ -35,17 +41,17 @@ ACOScheduler::ACOScheduler(DataDepGraph *dataDepGraph, MachineModel *machineMode
   prirts_ = priorities;
   rdyLst_ = new ReadyList(dataDepGraph_, priorities);
   count_ = dataDepGraph->GetInstCnt();
-  Config &schedIni = SchedulerOptions::getInstance();
+  const OptSchedSettings &settings = OptSchedSettings::get();
   
-  use_fixed_bias = schedIni.GetBool("ACO_USE_FIXED_BIAS");
-  heuristicImportance_ = schedIni.GetInt("ACO_HEURISTIC_IMPORTANCE");
-  use_tournament = schedIni.GetBool("ACO_TOURNAMENT");
-  fixed_bias = schedIni.GetInt("ACO_FIXED_BIAS");
-  bias_ratio = schedIni.GetFloat("ACO_BIAS_RATIO");
-  local_decay = schedIni.GetFloat("ACO_LOCAL_DECAY");
-  decay_factor = schedIni.GetFloat("ACO_DECAY_FACTOR");
-  ants_per_iteration = schedIni.GetInt("ACO_ANT_PER_ITERATION");
-  print_aco_trace = schedIni.GetBool("ACO_TRACE");
+  use_fixed_bias = settings.acoUseFixedBias;
+  heuristicImportance_ = settings.acoHeuristicImportance;
+  use_tournament = settings.acoTournament;
+  fixed_bias = settings.acoFixedBias;
+  bias_ratio = settings.acoBiasRatio;
+  local_decay = settings.acoLocalDecay;
+  decay_factor = settings.acoDecayFactor;
+  ants_per_iteration = settings.acoAntsPerIteration;
+  print_aco_trace = settings.acoTrace;
   
   /*
   std::cerr << "useOldAlg===="<<useOldAlg<<"\n\n";
@@ -56,14 +62,18 @@ ACOScheduler::ACOScheduler(DataDepGraph *dataDepGraph, MachineModel *machineMode
   std::cerr << "decay_factor===="<<decay_factor<<"\n\n";
   std::cerr << "ants_per_iteration===="<<ants_per_iteration<<"\n\n";
   */
-  int pheremone_size = (count_ + 1) * count_;
-  pheremone_ = new pheremone_t[pheremone_size];
-  
+  // The table is allocated on first use, since the members of a colony share
+  // the colony's table instead.
+  pheremone_ = ownPheremone_ = NULL;
+  colony_ = NULL;
+  mmbrIndx_ = 0;
+  rndmStrm_ = NULL;
+  antPath_ = NULL;
 }
 
 ACOScheduler::~ACOScheduler() {
   delete rdyLst_;
-  delete[] pheremone_;
+  delete[] ownPheremone_;
 }
 
 // Pheremone table lookup
@@ -84,18 +94,41 @@ pheremone_t &ACOScheduler::Pheremone(InstCount from, InstCount to) {
   return pheremone_[(row * count_) + to];
 }
 
-double ACOScheduler::Score(SchedInstruction *from, Choice choice) {
-  return Pheremone(from, choice.inst) * pow(choice.heuristic, heuristicImportance_);
+// Raises the heuristic to the given importance. The importance is a small
+// integer, so repeated multiplication is cheaper than pow(). From an
+// importance of 3 up, each product is rounded, so the weight may differ from
+// pow() in its last bits.
+static inline double HeuristicWeight(double heuristic, int importance) {
+  if (importance < 0)
+    return pow(heuristic, importance);
+  double weight = 1;
+  for (int i = 0; i < importance; i++)
+    weight *= heuristic;
+  return weight;
+}
+
+double ACOScheduler::RandDouble_(double min, double max) {
+  if (rndmStrm_ == NULL)
+    return RandDouble(min, max);
+  double rand = (double) rndmStrm_->GetRand32() / INT32_MAX;
+  return (rand * (max - min)) + min;
 }
 
-std::vector<double> ACOScheduler::scores(std::vector<Choice> ready, SchedInstruction *last) {
-  std::vector<double> s;
-  for (auto choice : ready)
-    s.push_back(Score(last, choice));
-  return s;
+// The scores of all the choices are computed in one pass over contiguous
+// arrays, reading the pheremone row of the last instruction only once.
+void ACOScheduler::ComputeScores(SchedInstruction *lastInst) {
+  size_t choiceCount = readyInsts_.size();
+  const pheremone_t *row = &Pheremone(lastInst == NULL ? -1 : lastInst->GetNum(), 0);
+  const InstCount *nums = readyNums_.data();
+  const double *weights = readyWeights_.data();
+  scores_.resize(choiceCount);
+  double *scores = scores_.data();
+  for (size_t i = 0; i < choiceCount; i++)
+    scores[i] = row[nums[i]] * weights[i];
 }
 
-SchedInstruction *ACOScheduler::SelectInstruction(std::vector<Choice> ready, SchedInstruction *lastInst) {
+SchedInstruction *ACOScheduler::SelectInstruction(SchedInstruction *lastInst) {
+    ComputeScores(lastInst);
     #if USE_ACS
     double choose_best_chance;    
     if (use_fixed_bias)
@@ -103,63 +136,55 @@ SchedInstruction *ACOScheduler::SelectInstruction(std::vector<Choice> ready, Sch
     else
         choose_best_chance = bias_ratio;
      
-    if (RandDouble(0, 1) < choose_best_chance) {
+    if (RandDouble_(0, 1) < choose_best_chance) {
         if (print_aco_trace)
             std::cerr<<"choose_best, use fixed bais: "<<use_fixed_bias<<"\n";
         pheremone_t max = -1;
-        Choice maxChoice;
-        for (auto choice : ready) {
-            if (Score(lastInst, choice) > max) {
-                max = Score(lastInst, choice);
-                maxChoice = choice;
+        size_t maxPos = 0;
+        for (size_t i = 0; i < scores_.size(); i++) {
+            if (scores_[i] > max) {
+                max = scores_[i];
+                maxPos = i;
             }
         }   
-        return maxChoice.inst;
+        return readyInsts_[maxPos];
     }
     #endif
     if (use_tournament){
-        int POPULATION_SIZE = ready.size();
-        int r_pos = (int) (RandDouble(0, 1) *POPULATION_SIZE);
-        int s_pos = (int) (RandDouble(0, 1) *POPULATION_SIZE);
-    //    int t_pos = (int) (RandDouble(0, 1) *POPULATION_SIZE);
-        Choice r = ready[r_pos];
-        Choice s = ready[s_pos];
-    //    Choice t = ready[t_pos];
+        int POPULATION_SIZE = readyInsts_.size();
+        int r_pos = (int) (RandDouble_(0, 1) *POPULATION_SIZE);
+        int s_pos = (int) (RandDouble_(0, 1) *POPULATION_SIZE);
         if (print_aco_trace) {
             std::cerr << "tournament Start \n";
             std::cerr << "array_size:"<<POPULATION_SIZE<<"\n";
             std::cerr<<"r:\t"<<r_pos<<"\n";
             std::cerr<<"s:\t"<<s_pos<<"\n";
-    //        std::cerr<<"t:\t"<<t_pos<<"\n";
 
-            std::cerr<<"Score r"<<Score(lastInst, r)<<"\n";
-            std::cerr<<"Score s"<<Score(lastInst, s)<<"\n";
-   //         std::cerr<<"Score t"<<Score(lastInst, t)<<"\n";
+            std::cerr<<"Score r"<<scores_[r_pos]<<"\n";
+            std::cerr<<"Score s"<<scores_[s_pos]<<"\n";
         }
-        if (Score(lastInst, r) >= Score(lastInst, s)) //&& Score(lastInst, r) >= Score(lastInst, t))
-            return r.inst;
-   //     else if (Score(lastInst, s) >= Score(lastInst, r) && Score(lastInst, s) >= Score(lastInst, t))
-   //         return s.inst;
+        if (scores_[r_pos] >= scores_[s_pos])
+            return readyInsts_[r_pos];
         else
-            return s.inst;
+            return readyInsts_[s_pos];
     }      
-    pheremone_t sum = 0;
-    for (auto choice : ready)
-        sum += Score(lastInst, choice);
-    pheremone_t point = RandDouble(0, sum);
-    for (auto choice : ready) {
-        point -= Score(lastInst, choice);
-        if (point <= 0)
-            return choice.inst;
-    }
+    // roulette wheel: the scores are turned into their running sums, and the
+    // first choice whose running sum reaches the random point is taken
+    std::partial_sum(scores_.begin(), scores_.end(), scores_.begin());
+    pheremone_t point = RandDouble_(0, scores_.back());
+    auto pos = std::lower_bound(scores_.begin(), scores_.end(), point);
+    if (pos != scores_.end())
+        return readyInsts_[pos - scores_.begin()];
     std::cerr << "returning last instruction" << std::endl;
-    assert(point < 0.001); // floats should not be this inaccurate
-    return ready.back().inst;
+    assert(point - scores_.back() < 0.001); // floats should not be this inaccurate
+    return readyInsts_.back();
 }
 
-InstSchedule *ACOScheduler::FindOneSchedule() {
+void ACOScheduler::FindOneSchedule(InstSchedule *schedule) {
   SchedInstruction *lastInst = NULL;
-  InstSchedule *schedule = new InstSchedule(machMdl_, dataDepGraph_, true);
+  schedule->Reset();
+  if (antPath_ != NULL)
+    antPath_->clear();
   InstCount maxPriority = rdyLst_->MaxPriority();
   if (maxPriority == 0) maxPriority = 1; // divide by 0 is bad
   Initialize_();
@@ -168,15 +193,17 @@ InstSchedule *ACOScheduler::FindOneSchedule() {
     // convert the ready list from a custom priority queue to a std::vector,
     // much nicer for this particular scheduler
     UpdtRdyLst_(crntCycleNum_, crntSlotNum_);
-    std::vector<Choice> ready;
+    readyInsts_.clear();
+    readyNums_.clear();
+    readyWeights_.clear();
     unsigned long heuristic;
     SchedInstruction *inst = rdyLst_->GetNextPriorityInst(heuristic);
     while (inst != NULL) {
       if (ChkInstLglty_(inst)) {
-        Choice c;
-        c.inst = inst;
-        c.heuristic = (double) heuristic / maxPriority;
-        ready.push_back(c);
+        readyInsts_.push_back(inst);
+        readyNums_.push_back(inst->GetNum());
+        readyWeights_.push_back(HeuristicWeight(
+            (double) heuristic / maxPriority, heuristicImportance_));
       }
       inst = rdyLst_->GetNextPriorityInst(heuristic);
     }
@@ -186,20 +213,24 @@ InstSchedule *ACOScheduler::FindOneSchedule() {
     /*
      std::stringstream stream; 
      stream << "Ready list: "; 
-    for (auto choice : ready) { 
-      stream << choice.inst->GetNum() << ", "; 
+    for (auto readyInst : readyInsts_) { 
+      stream << readyInst->GetNum() << ", "; 
     } 
     Logger::Info(stream.str().c_str()); 
     */
 
     inst = NULL;
-    if (!ready.empty())
-      inst = SelectInstruction(ready, lastInst);
+    if (!readyInsts_.empty())
+      inst = SelectInstruction(lastInst);
 	if (inst != NULL) {
 #ifdef USE_ACS
  		// local pheremone decay
-		pheremone_t *pheremone = &Pheremone(lastInst, inst);
-		*pheremone = (1 - local_decay) * *pheremone + local_decay * initialValue_;
+		if (antPath_ != NULL) {
+			antPath_->push_back(inst->GetNum());
+		} else {
+			pheremone_t *pheremone = &Pheremone(lastInst, inst);
+			*pheremone = (1 - local_decay) * *pheremone + local_decay * initialValue_;
+		}
 #endif
 		lastInst = inst;
 	}
@@ -230,19 +261,36 @@ InstSchedule *ACOScheduler::FindOneSchedule() {
     rdyLst_->ResetIterator();
   }
   rgn_->UpdateScheduleCost(schedule);
-  return schedule;
 }
 
 FUNC_RESULT ACOScheduler::FindSchedule(InstSchedule *schedule_out, SchedRegion *region) {
   rgn_ = region;
-  
+  colony_ = region->GetACOColony();
+  if (colony_ != NULL)
+    return FindScheduleInColony_(schedule_out);
+
+  int pheremone_size = (count_ + 1) * count_;
+  if (ownPheremone_ == NULL) {
+    ownPheremone_ = new pheremone_t[pheremone_size];
+    if (ownPheremone_ == NULL)
+      Logger::Fatal("Out of memory.");
+  }
+  pheremone_ = ownPheremone_;
+
+  // The ants reuse these schedules instead of allocating one each.
+  InstSchedule *schedule = new InstSchedule(machMdl_, dataDepGraph_, true);
+  InstSchedule *iterationBest = new InstSchedule(machMdl_, dataDepGraph_, true);
+  InstSchedule *bestSchedule = new InstSchedule(machMdl_, dataDepGraph_, true);
+  if (schedule == NULL || iterationBest == NULL || bestSchedule == NULL)
+    Logger::Fatal("Out of memory.");
+
   // initialize pheremone
   // for this, we need the cost of the pure heuristic schedule
-  int pheremone_size = (count_ + 1) * count_;
   for (int i = 0; i < pheremone_size; i++)
     pheremone_[i] = 1;
   initialValue_ = 1;
-  InstCount heuristicCost = FindOneSchedule()->GetCost() + 1; // prevent divide by zero
+  FindOneSchedule(schedule);
+  InstCount heuristicCost = schedule->GetCost() + 1; // prevent divide by zero
 
 #if USE_ACS
   initialValue_ = 2.0 / ((double) count_ * heuristicCost);
@@ -253,23 +301,17 @@ FUNC_RESULT ACOScheduler::FindSchedule(InstSchedule *schedule_out, SchedRegion *
     pheremone_[i] = initialValue_;
   std::cerr<<"initialValue_"<<initialValue_<<std::endl;
 
-  InstSchedule *bestSchedule = NULL;
-  Config &schedIni = SchedulerOptions::getInstance();
-  int noImprovementMax = schedIni.GetInt("ACO_STOP_ITERATIONS");
+  bool hasBest = false;
+  int noImprovementMax = OptSchedSettings::get().acoStopIterations;
   int noImprovement = 0; // how many iterations with no improvement
   int iterations = 0;
   while (true) {
-    InstSchedule *iterationBest = NULL;
     for (int i = 0; i < ants_per_iteration; i++) {
-      InstSchedule *schedule = FindOneSchedule();
+      FindOneSchedule(schedule);
       if(print_aco_trace)
          PrintSchedule(schedule); 
-      if (iterationBest == NULL || schedule->GetCost() < iterationBest->GetCost()) {
-        delete iterationBest;
-        iterationBest = schedule;
-      } else {
-        delete schedule;
-      }
+      if (i == 0 || schedule->GetCost() < iterationBest->GetCost())
+        std::swap(schedule, iterationBest);
     }
 #if !USE_ACS
     UpdatePheremone(iterationBest);
@@ -277,13 +319,12 @@ FUNC_RESULT ACOScheduler::FindSchedule(InstSchedule *schedule_out, SchedRegion *
     /* PrintSchedule(iterationBest); */
     /* std::cout << iterationBest->GetCost() << std::endl; */
     // TODO DRY
-    if (bestSchedule == NULL || iterationBest->GetCost() < bestSchedule->GetCost()) {
-      delete bestSchedule;
-      bestSchedule = iterationBest;
+    if (!hasBest || iterationBest->GetCost() < bestSchedule->GetCost()) {
+      std::swap(bestSchedule, iterationBest);
+      hasBest = true;
       Logger::Info("ACO found schedule with spill cost %d", bestSchedule->GetCost());
       noImprovement = 0;
     } else {
-      delete iterationBest;
       noImprovement++;
       /* if (*iterationBest == *bestSchedule) */
       /*   std::cout << "same" << std::endl; */
@@ -297,12 +338,219 @@ FUNC_RESULT ACOScheduler::FindSchedule(InstSchedule *schedule_out, SchedRegion *
   }
   PrintSchedule(bestSchedule);
   schedule_out->Copy(bestSchedule);
+  delete schedule;
+  delete iterationBest;
   delete bestSchedule;
 
   Logger::Info("ACO finished after %d iterations", iterations);
   return RES_SUCCESS;
 }
 
+// In a colony, the ants of an iteration are shared out among the members,
+// which build them at the same time on their own copies of the region. The
+// table is only read while the ants are built. The local decay along each
+// ant's path is recorded and applied with the global update when the members
+// meet at the end of the iteration, so the ants of an iteration do not see
+// each other's decay as they do when built one after the other.
+FUNC_RESULT ACOScheduler::FindScheduleInColony_(InstSchedule *schedule_out) {
+  mmbrIndx_ = rgn_->GetACOMmbrIndx();
+  pheremone_ = colony_->GetPheremone();
+  RandomStream rndmStrm(colony_->GetSeed(mmbrIndx_));
+  rndmStrm_ = &rndmStrm;
+  int mmbrCnt = colony_->GetMmbrCnt();
+  ACOColony::MmbrRslt &rslt = colony_->GetMmbrRslt(mmbrIndx_);
+
+  int noImprovementMax = OptSchedSettings::get().acoStopIterations;
+
+  // The ants of this member reuse these schedules.
+  InstSchedule *schedule = new InstSchedule(machMdl_, dataDepGraph_, true);
+  InstSchedule *memberBest = new InstSchedule(machMdl_, dataDepGraph_, true);
+  if (schedule == NULL || memberBest == NULL)
+    Logger::Fatal("Out of memory.");
+
+  // Each member builds one ant on the uniform table. The cheapest of these
+  // gives the initial pheremone.
+  rslt.paths.resize(1);
+  antPath_ = &rslt.paths[0];
+  FindOneSchedule(memberBest);
+  rslt.bestSched = memberBest;
+  colony_->Synchronize([&]() {
+    InstCount heuristicCost = memberBest->GetCost();
+    for (int i = 0; i < mmbrCnt; i++)
+      heuristicCost = std::min(heuristicCost,
+                               colony_->GetMmbrRslt(i).bestSched->GetCost());
+    heuristicCost++; // prevent divide by zero
+
+#if USE_ACS
+    pheremone_t initVal = 2.0 / ((double) count_ * heuristicCost);
+#else
+    pheremone_t initVal = (double) ants_per_iteration / heuristicCost;
+#endif
+    colony_->SetInitVal(initVal);
+    std::fill(pheremone_, pheremone_ + colony_->GetPheremoneSize(), initVal);
+    std::cerr<<"initialValue_"<<initVal<<std::endl;
+
+    InstSchedule *bestSchedule = new InstSchedule(machMdl_, dataDepGraph_, true);
+    if (bestSchedule == NULL)
+      Logger::Fatal("Out of memory.");
+    colony_->SetBestSched(bestSchedule);
+  });
+  initialValue_ = colony_->GetInitVal();
+
+  // This member builds ants mmbrIndx_, mmbrIndx_ + mmbrCnt, and so on.
+  int antCnt = 0;
+  if (mmbrIndx_ < ants_per_iteration)
+    antCnt = (ants_per_iteration - mmbrIndx_ + mmbrCnt - 1) / mmbrCnt;
+  rslt.paths.resize(antCnt);
+
+  while (true) {
+    for (int i = 0; i < antCnt; i++) {
+      antPath_ = &rslt.paths[i];
+      FindOneSchedule(schedule);
+      if(print_aco_trace)
+         PrintSchedule(schedule); 
+      if (i == 0 || schedule->GetCost() < memberBest->GetCost())
+        std::swap(schedule, memberBest);
+    }
+    rslt.bestSched = antCnt > 0 ? memberBest : NULL;
+
+    colony_->Synchronize([&]() { CombineIteration_(noImprovementMax); });
+    if (colony_->IsStopped())
+      break;
+  }
+  antPath_ = NULL;
+  rndmStrm_ = NULL;
+
+  schedule_out->Copy(colony_->GetBestSched());
+  delete schedule;
+  delete memberBest;
+
+  if (mmbrIndx_ == 0) {
+    PrintSchedule(schedule_out);
+    Logger::Info("ACO finished after %d iterations with %d threads",
+                 colony_->GetIterCnt(), mmbrCnt);
+  }
+  return RES_SUCCESS;
+}
+
+void ACOScheduler::CombineIteration_(int noImprovementMax) {
+  InstSchedule *iterationBest = NULL;
+  for (int i = 0; i < colony_->GetMmbrCnt(); i++) {
+    ACOColony::MmbrRslt &rslt = colony_->GetMmbrRslt(i);
+#if USE_ACS
+    for (const std::vector<InstCount> &path : rslt.paths)
+      DecayPath_(path);
+#endif
+    if (rslt.bestSched != NULL &&
+        (iterationBest == NULL ||
+         rslt.bestSched->GetCost() < iterationBest->GetCost()))
+      iterationBest = rslt.bestSched;
+  }
+  assert(iterationBest != NULL);
+
+#if !USE_ACS
+  UpdatePheremone(iterationBest);
+#endif
+  InstSchedule *bestSchedule = colony_->GetBestSched();
+  if (colony_->GetIterCnt() == 0 ||
+      iterationBest->GetCost() < bestSchedule->GetCost()) {
+    bestSchedule->Copy(iterationBest);
+    Logger::Info("ACO found schedule with spill cost %d", bestSchedule->GetCost());
+    colony_->SetNoImprvmntCnt(0);
+  } else {
+    colony_->SetNoImprvmntCnt(colony_->GetNoImprvmntCnt() + 1);
+    if (colony_->GetNoImprvmntCnt() > noImprovementMax) {
+      colony_->Stop();
+      return;
+    }
+  }
+#if USE_ACS
+  UpdatePheremone(bestSchedule);
+#endif
+  colony_->IncrmntIterCnt();
+}
+
+void ACOScheduler::DecayPath_(const std::vector<InstCount> &path) {
+  InstCount lastInstNum = -1;
+  for (InstCount instNum : path) {
+    pheremone_t *pheremone = &Pheremone(lastInstNum, instNum);
+    *pheremone = (1 - local_decay) * *pheremone + local_decay * initialValue_;
+    lastInstNum = instNum;
+  }
+}
+
+// Once the enumeration has started, the members that keep the colony going
+// work at their own pace. Each iteration builds its ants on a snapshot of the
+// table and then applies its update to the shared table under a lock.
+void ACOScheduler::ImproveSchedule(InstSchedule *sched, Milliseconds deadline) {
+  assert(colony_ != NULL);
+  int noImprovementMax = OptSchedSettings::get().acoStopIterations;
+  size_t pheremoneSize = colony_->GetPheremoneSize();
+
+  pheremone_t *snapshot = new pheremone_t[pheremoneSize];
+  InstSchedule *schedule = new InstSchedule(machMdl_, dataDepGraph_, true);
+  InstSchedule *iterationBest = new InstSchedule(machMdl_, dataDepGraph_, true);
+  if (snapshot == NULL || schedule == NULL || iterationBest == NULL)
+    Logger::Fatal("Out of memory.");
+
+  // A stream other than the one used in the heuristic phase, which would
+  // repeat the same choices.
+  RandomStream rndmStrm(colony_->GetSeed(mmbrIndx_ + colony_->GetMmbrCnt()));
+  rndmStrm_ = &rndmStrm;
+  std::vector<std::vector<InstCount>> paths(ants_per_iteration);
+  int noImprovement = 0;
+  int iterations = 0;
+
+  while (!colony_->IsEnumDone() &&
+         (deadline == INVALID_VALUE ||
+          Utilities::GetProcessorTime() < deadline)) {
+    {
+      std::lock_guard<std::mutex> lock(colony_->GetPheremoneLock());
+      std::copy(colony_->GetPheremone(),
+                colony_->GetPheremone() + pheremoneSize, snapshot);
+    }
+    pheremone_ = snapshot;
+
+    for (int i = 0; i < ants_per_iteration; i++) {
+      antPath_ = &paths[i];
+      FindOneSchedule(schedule);
+      if (i == 0 || schedule->GetCost() < iterationBest->GetCost())
+        std::swap(schedule, iterationBest);
+    }
+
+    if (iterationBest->GetCost() < sched->GetCost()) {
+      sched->Copy(iterationBest);
+      colony_->UpdtBestCost(sched->GetCost());
+      Logger::Info("ACO found schedule with cost %d during enumeration",
+                   sched->GetCost());
+      noImprovement = 0;
+    } else if (++noImprovement > noImprovementMax) {
+      break;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(colony_->GetPheremoneLock());
+      pheremone_ = colony_->GetPheremone();
+#if USE_ACS
+      for (const std::vector<InstCount> &path : paths)
+        DecayPath_(path);
+      UpdatePheremone(sched);
+#else
+      UpdatePheremone(iterationBest);
+#endif
+    }
+    iterations++;
+  }
+
+  pheremone_ = colony_->GetPheremone();
+  antPath_ = NULL;
+  rndmStrm_ = NULL;
+  delete[] snapshot;
+  delete schedule;
+  delete iterationBest;
+  Logger::Info("ACO ran %d iterations during enumeration", iterations);
+}
+
 void ACOScheduler::UpdatePheremone(InstSchedule *schedule) {
   // I wish InstSchedule allowed you to just iterate over it, but it's got this
   // cycle and slot thing which needs to be accounted for
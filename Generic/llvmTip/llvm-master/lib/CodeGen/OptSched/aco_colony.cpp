@@ -0,0 +1,52 @@
+#include "llvm/CodeGen/OptSched/aco_colony.h"
+#include "llvm/CodeGen/OptSched/basic/data_dep.h"
+#include <limits>
+
+namespace opt_sched {
+
+ACOColony::ACOColony(int mmbrCnt, int enumMmbrCnt, InstCount instCnt,
+                     bool runWithEnum, int32_t seed)
+    : mmbrCnt_(mmbrCnt), enumMmbrCnt_(enumMmbrCnt), runWithEnum_(runWithEnum),
+      seed_(seed), pheremone_((instCnt + 1) * instCnt, 1), initVal_(1),
+      mmbrRslts_(mmbrCnt), bestSched_(NULL), iterCnt_(0), noImprvmntCnt_(0),
+      isStopped_(false), arrvdCnt_(0), gnrtn_(0),
+      bestCost_(std::numeric_limits<InstCount>::max()),
+      runngEnumCnt_(enumMmbrCnt) {
+  assert(mmbrCnt_ > 1);
+  assert(enumMmbrCnt_ > 0 && enumMmbrCnt_ <= mmbrCnt_);
+
+  for (MmbrRslt &rslt : mmbrRslts_)
+    rslt.bestSched = NULL;
+}
+
+ACOColony::~ACOColony() {
+  if (bestSched_ != NULL)
+    delete bestSched_;
+}
+
+void ACOColony::Synchronize(const std::function<void()> &combine) {
+  std::unique_lock<std::mutex> lock(syncLock_);
+  unsigned long gnrtn = gnrtn_;
+
+  if (++arrvdCnt_ < mmbrCnt_) {
+    syncCond_.wait(lock, [&]() { return gnrtn_ != gnrtn; });
+    return;
+  }
+
+  // The last member to arrive combines the iteration and releases the others.
+  combine();
+  arrvdCnt_ = 0;
+  gnrtn_++;
+  syncCond_.notify_all();
+}
+
+void ACOColony::UpdtBestCost(InstCount cost) {
+  InstCount crntBest = bestCost_.load(std::memory_order_relaxed);
+
+  while (cost < crntBest &&
+         !bestCost_.compare_exchange_weak(crntBest, cost,
+                                          std::memory_order_acq_rel)) {
+  }
+}
+
+} // end namespace opt_sched
@@ -1,30 +1,34 @@
 #include "llvm/CodeGen/OptSched/spill/bb_spill.h"
+#include "llvm/CodeGen/OptSched/OptSchedSettings.h"
 #include "llvm/CodeGen/OptSched/basic/data_dep.h"
 #include "llvm/CodeGen/OptSched/basic/register.h"
 #include "llvm/CodeGen/OptSched/basic/reg_alloc.h"
+#include "llvm/CodeGen/OptSched/basic/window_graph.h"
 #include "llvm/CodeGen/OptSched/enum/enumerator.h"
 #include "llvm/CodeGen/OptSched/generic/logger.h"
 #include "llvm/CodeGen/OptSched/generic/random.h"
-#include "llvm/CodeGen/OptSched/generic/config.h"
 #include "llvm/CodeGen/OptSched/generic/stats.h"
 #include "llvm/CodeGen/OptSched/generic/utilities.h"
 #include "llvm/CodeGen/OptSched/list_sched/list_sched.h"
 #include "llvm/CodeGen/OptSched/relaxed/relaxed_sched.h"
 #include "llvm/CodeGen/OptSched/aco.h"
+#include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <iostream>
 #include <map>
 #include <numeric>
 #include <set>
 #include <sstream>
+#include <thread>
 #include <utility>
 
-extern bool OPTSCHED_gPrintSpills;
-
 namespace opt_sched {
 
 // The denominator used when calculating cost weight.
 static const int COST_WGHT_BASE = 10000;
+// A probe of a target length gets the length timeout divided by this.
+static const int PROBE_TIMEOUT_DIVISOR = 10;
 
 BBWithSpill::BBWithSpill(MachineModel *machMdl, DataDepGraph *dataDepGraph,
                          long rgnNum, int16_t sigHashSize, LB_ALG lbAlg,
@@ -40,6 +44,8 @@ BBWithSpill::BBWithSpill(MachineModel *machMdl, DataDepGraph *dataDepGraph,
 
   costLwrBound_ = 0;
   enumrtr_ = NULL;
+  trail_ = NULL;
+  instIntrvlRegs_ = NULL;
   optmlSpillCost_ = INVALID_VALUE;
 
   crntCycleNum_ = INVALID_VALUE;
@@ -49,6 +55,10 @@ BBWithSpill::BBWithSpill(MachineModel *machMdl, DataDepGraph *dataDepGraph,
   schedForRPOnly_ = schedForRPOnly;
 
   enblStallEnum_ = enblStallEnum;
+  const OptSchedSettings &settings = OptSchedSettings::get();
+  lngthSrch_ = settings.lengthSearch;
+  wndwSize_ = settings.windowSize;
+  wndwThrdCnt_ = settings.windowThreads;
   spillCostFactor_ = spillCostFactor;
   schedCostFactor_ = COST_WGHT_BASE;
   spillCostFunc_ = spillCostFunc;
@@ -92,6 +102,9 @@ BBWithSpill::~BBWithSpill() {
   delete[] livePhysRegs_;
   delete[] spillCosts_;
   delete[] peakRegPressures_;
+
+  if (instIntrvlRegs_ != NULL)
+    delete[] instIntrvlRegs_;
 }
 /*****************************************************************************/
 
@@ -106,8 +119,7 @@ bool BBWithSpill::EnableEnum_() {
 /*****************************************************************************/
 
 ConstrainedScheduler *BBWithSpill::AllocHeuristicScheduler_() {
-  Config &schedIni = SchedulerOptions::getInstance();
-  if (schedIni.GetBool("USE_ACO", false))
+  if (OptSchedSettings::get().useACO)
     return new ACOScheduler(dataDepGraph_, machMdl_, abslutSchedUprBound_, hurstcPrirts_);
   else
     return new ListScheduler(dataDepGraph_, machMdl_, abslutSchedUprBound_, hurstcPrirts_);
@@ -214,12 +226,14 @@ static InstCount ComputeSLILStaticLowerBound(int64_t regTypeCnt_,
                              ->GetRcrsvNghbrBitVector(DIR_BKWRD);
         assert(recSuccBV->GetSize() == recPredBV->GetSize() &&
                "Successor list size doesn't match predecessor list size!");
-        for (int k = 0; k < recSuccBV->GetSize(); ++k) {
-          if (recSuccBV->GetBit(k) & recPredBV->GetBit(k)) {
-            if (definedRegisters[j]->AddToInterval(
-                    dataDepGraph_->GetInstByIndx(k))) {
-              ++closureLowerBound;
-            }
+        if (!recSuccBV->Intersects(*recPredBV))
+          continue;
+        for (int k = recSuccBV->GetNxtCmnOneBit(*recPredBV, 0);
+             k != INVALID_VALUE;
+             k = recSuccBV->GetNxtCmnOneBit(*recPredBV, k + 1)) {
+          if (definedRegisters[j]->AddToInterval(
+                  dataDepGraph_->GetInstByIndx(k))) {
+            ++closureLowerBound;
           }
         }
       }
@@ -306,20 +320,26 @@ static InstCount ComputeSLILStaticLowerBound(int64_t regTypeCnt_,
 /*****************************************************************************/
 
 InstCount BBWithSpill::CmputCostLwrBound() {
-  InstCount useCnt, spillCostLwrBound = 0;
-  SchedInstruction *inst;
+  return CmputCostLwrBound(CmputSpillCostLwrBound());
+}
+/*****************************************************************************/
+
+InstCount BBWithSpill::CmputSpillCostLwrBound() {
+  InstCount spillCostLwrBound = 0;
 
   if (spillCostFunc_ == SCF_SLIL) {
     spillCostLwrBound =
         ComputeSLILStaticLowerBound(regTypeCnt_, regFiles_, dataDepGraph_);
     dynamicSlilLowerBound_ = spillCostLwrBound;
     staticSlilLowerBound_ = spillCostLwrBound;
+    SetupIntrvlRegs_();
   }
 
-  // for(InstCount i=0; i< dataDepGraph_->GetInstCnt(); i++) {
-  //   inst = dataDepGraph_->GetInstByIndx(i);
-  // }
+  return spillCostLwrBound;
+}
+/*****************************************************************************/
 
+InstCount BBWithSpill::CmputCostLwrBound(InstCount spillCostLwrBound) {
   InstCount staticLowerBound =
       schedLwrBound_ * schedCostFactor_ + spillCostLwrBound * spillCostFactor_;
 
@@ -334,6 +354,50 @@ InstCount BBWithSpill::CmputCostLwrBound() {
 }
 /*****************************************************************************/
 
+void BBWithSpill::SetupIntrvlRegs_() {
+  InstCount instCnt = dataDepGraph_->GetInstCnt();
+
+  if (instIntrvlRegs_ == NULL) {
+    instIntrvlRegs_ = new BitVector[instCnt * regTypeCnt_];
+    if (instIntrvlRegs_ == NULL)
+      Logger::Fatal("Out of memory.");
+
+    for (InstCount i = 0; i < instCnt; i++) {
+      for (int16_t j = 0; j < regTypeCnt_; j++) {
+        instIntrvlRegs_[i * regTypeCnt_ + j].Construct(
+            regFiles_[j].GetRegCnt());
+      }
+    }
+  }
+
+  for (int16_t i = 0; i < regTypeCnt_; i++) {
+    for (int j = 0; j < regFiles_[i].GetRegCnt(); j++) {
+      const Register *reg = regFiles_[i].GetReg(j);
+      for (const SchedInstruction *inst : reg->GetLiveInterval()) {
+        instIntrvlRegs_[inst->GetNum() * regTypeCnt_ + i].SetBit(j);
+      }
+      for (const SchedInstruction *inst : reg->GetPossibleLiveInterval()) {
+        instIntrvlRegs_[inst->GetNum() * regTypeCnt_ + i].SetBit(j);
+      }
+    }
+  }
+}
+/*****************************************************************************/
+
+int BBWithSpill::CntLiveRegsOutOfIntrvl_(SchedInstruction *inst,
+                                         int16_t regType) const {
+  int liveCnt = liveRegs_[regType].GetOneCnt();
+
+  // Before the static lower bound is computed, all intervals are empty.
+  if (instIntrvlRegs_ == NULL || liveCnt == 0)
+    return liveCnt;
+
+  const BitVector &intrvlRegs =
+      instIntrvlRegs_[inst->GetNum() * regTypeCnt_ + regType];
+  return liveCnt - liveRegs_[regType].GetAndOneCnt(intrvlRegs);
+}
+/*****************************************************************************/
+
 void BBWithSpill::InitForSchdulng() {
   InitForCostCmputtn_();
 
@@ -399,6 +463,13 @@ InstCount BBWithSpill::CmputCost_(InstSchedule *sched, COST_COMP_MODE compMode,
   SchedInstruction *inst;
 
   if (compMode == CCM_STTC) {
+    // The spill info is reset and rebuilt from the whole schedule. While the
+    // enumerator is running, the only schedule costed this way is its own
+    // complete schedule, whose rebuilt info is what the enumerator had already
+    // computed, so the intermediate changes need not be recorded.
+    if (trail_ != NULL)
+      trail_->Pause();
+
     if (spillCostFunc_ != SCF_SPILLS) {
       InitForCostCmputtn_();
 
@@ -414,6 +485,9 @@ InstCount BBWithSpill::CmputCost_(InstSchedule *sched, COST_COMP_MODE compMode,
       regAlloc.AllocRegs();
       crntSpillCost_ = regAlloc.GetCost();
     }
+
+    if (trail_ != NULL)
+      trail_->Resume();
   }
 
   assert(sched->IsComplete());
@@ -448,6 +522,21 @@ void BBWithSpill::CmputCrntSpillCost_() {
 }
 /*****************************************************************************/
 
+inline void BBWithSpill::SaveVal_(int &var) {
+  if (trail_ != NULL)
+    trail_->Save(var);
+}
+/*****************************************************************************/
+
+inline void BBWithSpill::SetLiveBit_(WeightedBitVector &vctr, int indx,
+                                     bool val, int wght) {
+  if (trail_ != NULL)
+    trail_->SetBit(&vctr, indx, val, wght);
+  else
+    vctr.SetBit(indx, val, wght);
+}
+/*****************************************************************************/
+
 void BBWithSpill::UpdateSpillInfoForSchdul_(SchedInstruction *inst,
                                             bool trackCnflcts) {
   int16_t regType;
@@ -488,13 +577,15 @@ void BBWithSpill::UpdateSpillInfoForSchdul_(SchedInstruction *inst,
       // consider the last use of a register. Thus, an additional increment must
       // happen here.
       if (spillCostFunc_ == SCF_SLIL) {
+        SaveVal_(sumOfLiveIntervalLengths_[regType]);
         sumOfLiveIntervalLengths_[regType]++;
         if (!use->IsInInterval(inst) && !use->IsInPossibleInterval(inst)) {
+          SaveVal_(dynamicSlilLowerBound_);
           ++dynamicSlilLowerBound_;
         }
       }
 
-      liveRegs_[regType].SetBit(regNum, false, use->GetWght());
+      SetLiveBit_(liveRegs_[regType], regNum, false, use->GetWght());
 
 #ifdef IS_DEBUG_REG_PRESSURE
       Logger::Info("Reg type %d now has %d live regs", regType,
@@ -502,7 +593,7 @@ void BBWithSpill::UpdateSpillInfoForSchdul_(SchedInstruction *inst,
 #endif
 
       if (regFiles_[regType].GetPhysRegCnt() > 0 && physRegNum >= 0)
-        livePhysRegs_[regType].SetBit(physRegNum, false, use->GetWght());
+        SetLiveBit_(livePhysRegs_[regType], physRegNum, false, use->GetWght());
     }
   }
 
@@ -524,7 +615,7 @@ void BBWithSpill::UpdateSpillInfoForSchdul_(SchedInstruction *inst,
       regFiles_[regType].AddConflictsWithLiveRegs(
           regNum, liveRegs_[regType].GetOneCnt());
 
-    liveRegs_[regType].SetBit(regNum, true, def->GetWght());
+    SetLiveBit_(liveRegs_[regType], regNum, true, def->GetWght());
 
 #ifdef IS_DEBUG_REG_PRESSURE
     Logger::Info("Reg type %d now has %d live regs", regType,
@@ -532,7 +623,7 @@ void BBWithSpill::UpdateSpillInfoForSchdul_(SchedInstruction *inst,
 #endif
 
     if (regFiles_[regType].GetPhysRegCnt() > 0 && physRegNum >= 0)
-      livePhysRegs_[regType].SetBit(physRegNum, true, def->GetWght());
+      SetLiveBit_(livePhysRegs_[regType], physRegNum, true, def->GetWght());
     def->ResetCrntUseCnt();
     //}
   }
@@ -540,7 +631,7 @@ void BBWithSpill::UpdateSpillInfoForSchdul_(SchedInstruction *inst,
   newSpillCost = 0;
 
 #ifdef IS_DEBUG_SLIL_CORRECT
-  if (OPTSCHED_gPrintSpills) {
+  if (printSpills_) {
     Logger::Info(
         "Printing live range lengths for instruction BEFORE calculation.");
     for (int j = 0; j < sumOfLiveIntervalLengths_.size(); j++) {
@@ -553,20 +644,17 @@ void BBWithSpill::UpdateSpillInfoForSchdul_(SchedInstruction *inst,
 
   for (int16_t i = 0; i < regTypeCnt_; i++) {
     liveRegs = liveRegs_[i].GetWghtedCnt();
-    if (liveRegs > peakRegPressures_[i])
+    if (liveRegs > peakRegPressures_[i]) {
+      SaveVal_(peakRegPressures_[i]);
       peakRegPressures_[i] = liveRegs;
+    }
 
     // (Chris): Compute sum of live range lengths at this point
     if (spillCostFunc_ == SCF_SLIL) {
+      SaveVal_(sumOfLiveIntervalLengths_[i]);
+      SaveVal_(dynamicSlilLowerBound_);
       sumOfLiveIntervalLengths_[i] += liveRegs_[i].GetOneCnt();
-      for (int j = 0; j < liveRegs_[i].GetSize(); ++j) {
-        if (liveRegs_[i].GetBit(j)) {
-          const Register *reg = regFiles_[i].GetReg(j);
-          if (!reg->IsInInterval(inst) && !reg->IsInPossibleInterval(inst)) {
-            ++dynamicSlilLowerBound_;
-          }
-        }
-      }
+      dynamicSlilLowerBound_ += CntLiveRegsOutOfIntrvl_(inst, i);
     }
 
 #ifdef IS_DEBUG_REG_PRESSURE
@@ -584,6 +672,7 @@ void BBWithSpill::UpdateSpillInfoForSchdul_(SchedInstruction *inst,
       newSpillCost += excessRegs;
     }
     if (spillCostFunc_ == SCF_SLIL) {
+      SaveVal_(slilSpillCost_);
       slilSpillCost_ = std::accumulate(sumOfLiveIntervalLengths_.begin(),
                                        sumOfLiveIntervalLengths_.end(), 0);
     }
@@ -594,7 +683,7 @@ void BBWithSpill::UpdateSpillInfoForSchdul_(SchedInstruction *inst,
   }
 
 #ifdef IS_DEBUG_SLIL_CORRECT
-  if (OPTSCHED_gPrintSpills) {
+  if (printSpills_) {
     Logger::Info(
         "Printing live range lengths for instruction AFTER calculation.");
     for (int j = 0; j < sumOfLiveIntervalLengths_.size(); j++) {
@@ -604,6 +693,7 @@ void BBWithSpill::UpdateSpillInfoForSchdul_(SchedInstruction *inst,
   }
 #endif
 
+  SaveVal_(crntStepNum_);
   crntStepNum_++;
   spillCosts_[crntStepNum_] = newSpillCost;
 
@@ -611,128 +701,25 @@ void BBWithSpill::UpdateSpillInfoForSchdul_(SchedInstruction *inst,
   Logger::Info("Spill cost at step  %d = %d", crntStepNum_, newSpillCost);
 #endif
 
+  SaveVal_(totSpillCost_);
   totSpillCost_ += newSpillCost;
-  if (newSpillCost > peakSpillCost_)
+  if (newSpillCost > peakSpillCost_) {
+    SaveVal_(peakSpillCost_);
     peakSpillCost_ = newSpillCost;
+  }
+  SaveVal_(crntSpillCost_);
   CmputCrntSpillCost_();
 
+  SaveVal_(schduldInstCnt_);
   schduldInstCnt_++;
-  if (inst->MustBeInBBEntry())
+  if (inst->MustBeInBBEntry()) {
+    SaveVal_(schduldEntryInstCnt_);
     schduldEntryInstCnt_++;
-  if (inst->MustBeInBBExit())
-    schduldExitInstCnt_++;
-}
-/*****************************************************************************/
-
-void BBWithSpill::UpdateSpillInfoForUnSchdul_(SchedInstruction *inst) {
-  int16_t regType;
-  int i, defCnt, useCnt, regNum, physRegNum;
-  Register **defs, **uses;
-  Register *def, *use;
-  bool isLive;
-
-#ifdef IS_DEBUG_REG_PRESSURE
-  Logger::Info("Updating reg pressure after unscheduling Inst %d",
-               inst->GetNum());
-#endif
-
-  defCnt = inst->GetDefs(defs);
-  useCnt = inst->GetUses(uses);
-
-  // (Chris): Update the SLIL for all live regs at this point.
-  if (spillCostFunc_ == SCF_SLIL) {
-    for (int i = 0; i < regTypeCnt_; ++i) {
-      for (int j = 0; j < liveRegs_[i].GetSize(); ++j) {
-        if (liveRegs_[i].GetBit(j)) {
-          const Register *reg = regFiles_[i].GetReg(j);
-          sumOfLiveIntervalLengths_[i]--;
-          if (!reg->IsInInterval(inst) && !reg->IsInPossibleInterval(inst)) {
-            --dynamicSlilLowerBound_;
-          }
-        }
-      }
-      assert(sumOfLiveIntervalLengths_[i] >= 0 &&
-             "UpdateSpillInfoForUnSchdul_: SLIL negative!");
-    }
-  }
-
-  // Update Live regs
-  for (i = 0; i < defCnt; i++) {
-    def = defs[i];
-    regType = def->GetType();
-    regNum = def->GetNum();
-    physRegNum = def->GetPhysicalNumber();
-
-#ifdef IS_DEBUG_REG_PRESSURE
-    Logger::Info("Inst %d defines reg %d of type %d and %d uses",
-                 inst->GetNum(), regNum, regType, def->GetUseCnt());
-#endif
-
-    // if (def->GetUseCnt() > 0) {
-    assert(liveRegs_[regType].GetBit(regNum));
-    liveRegs_[regType].SetBit(regNum, false, def->GetWght());
-
-#ifdef IS_DEBUG_REG_PRESSURE
-    Logger::Info("Reg type %d now has %d live regs", regType,
-                 liveRegs_[regType].GetOneCnt());
-#endif
-
-    if (regFiles_[regType].GetPhysRegCnt() > 0 && physRegNum >= 0)
-      livePhysRegs_[regType].SetBit(physRegNum, false, def->GetWght());
-    def->ResetCrntUseCnt();
-    //}
   }
-
-  for (i = 0; i < useCnt; i++) {
-    use = uses[i];
-    regType = use->GetType();
-    regNum = use->GetNum();
-    physRegNum = use->GetPhysicalNumber();
-
-#ifdef IS_DEBUG_REG_PRESSURE
-    Logger::Info("Inst %d uses reg %d of type %d and %d uses", inst->GetNum(),
-                 regNum, regType, use->GetUseCnt());
-#endif
-
-    isLive = use->IsLive();
-    use->DelCrntUse();
-    assert(use->IsLive());
-
-    if (isLive == false) {
-      // (Chris): Since this was the last use, the above SLIL calculation didn't
-      // take this instruction into account.
-      if (spillCostFunc_ == SCF_SLIL) {
-        sumOfLiveIntervalLengths_[regType]--;
-        if (!use->IsInInterval(inst) && !use->IsInPossibleInterval(inst)) {
-          --dynamicSlilLowerBound_;
-        }
-        assert(sumOfLiveIntervalLengths_[regType] >= 0 &&
-               "UpdateSpillInfoForUnSchdul_: SLIL negative!");
-      }
-      liveRegs_[regType].SetBit(regNum, true, use->GetWght());
-
-#ifdef IS_DEBUG_REG_PRESSURE
-      Logger::Info("Reg type %d now has %d live regs", regType,
-                   liveRegs_[regType].GetOneCnt());
-#endif
-
-      if (regFiles_[regType].GetPhysRegCnt() > 0 && physRegNum >= 0)
-        livePhysRegs_[regType].SetBit(physRegNum, true, use->GetWght());
-    }
+  if (inst->MustBeInBBExit()) {
+    SaveVal_(schduldExitInstCnt_);
+    schduldExitInstCnt_++;
   }
-
-  schduldInstCnt_--;
-  if (inst->MustBeInBBEntry())
-    schduldEntryInstCnt_--;
-  if (inst->MustBeInBBExit())
-    schduldExitInstCnt_--;
-
-  totSpillCost_ -= spillCosts_[crntStepNum_];
-  crntStepNum_--;
-
-#ifdef IS_DEBUG_REG_PRESSURE
-// Logger::Info("Spill cost at step  %d = %d", crntStepNum_, newSpillCost);
-#endif
 }
 /*****************************************************************************/
 
@@ -762,10 +749,30 @@ void BBWithSpill::UnschdulInst(SchedInstruction *inst, InstCount cycleNum,
   }
 
   assert(inst != NULL);
+  assert(trail_ != NULL);
 
-  UpdateSpillInfoForUnSchdul_(inst);
-  peakSpillCost_ = trgtNode->GetPeakSpillCost();
-  CmputCrntSpillCost_();
+#ifdef IS_DEBUG_REG_PRESSURE
+  Logger::Info("Updating reg pressure after unscheduling Inst %d",
+               inst->GetNum());
+#endif
+
+  // The use counts of the registers are not on the trail.
+  Register **defs, **uses;
+  int defCnt = inst->GetDefs(defs);
+  int useCnt = inst->GetUses(uses);
+
+  for (int i = 0; i < defCnt; i++) {
+    defs[i]->ResetCrntUseCnt();
+  }
+
+  for (int i = 0; i < useCnt; i++) {
+    uses[i]->DelCrntUse();
+    assert(uses[i]->IsLive());
+  }
+
+  // Restore the live registers and the costs to what they were at the target
+  // node.
+  trail_->Undo(trgtNode->GetTrailSize());
 }
 /*****************************************************************************/
 
@@ -793,9 +800,11 @@ Enumerator *BBWithSpill::AllocEnumrtr_(Milliseconds timeout) {
       enblStallEnum = false;
     }*/
 
+  const OptSchedSettings &settings = OptSchedSettings::get();
   enumrtr_ = new LengthCostEnumerator(
       dataDepGraph_, machMdl_, schedUprBound_, sigHashSize_, enumPrirts_,
-      prune_, schedForRPOnly_, enblStallEnum, timeout, spillCostFunc_, 0, NULL);
+      prune_, schedForRPOnly_, enblStallEnum, timeout, spillCostFunc_,
+      settings.enumSearchStrategy, settings.beamWidth, 0, NULL);
   if (enumrtr_ == NULL)
     Logger::Fatal("Out of memory.");
 
@@ -809,8 +818,8 @@ FUNC_RESULT BBWithSpill::Enumerate_(Milliseconds startTime,
   InstCount trgtLngth;
   FUNC_RESULT rslt = RES_SUCCESS;
   int iterCnt = 0;
-  int costLwrBound = 0;
   bool timeout = false;
+  bool isSrchCut = false;
 
   Milliseconds rgnDeadline, lngthDeadline;
   rgnDeadline =
@@ -819,31 +828,122 @@ FUNC_RESULT BBWithSpill::Enumerate_(Milliseconds startTime,
       (rgnTimeout == INVALID_VALUE) ? INVALID_VALUE : startTime + lngthTimeout;
   assert(lngthDeadline <= rgnDeadline);
 
-  for (trgtLngth = schedLwrBound_; trgtLngth <= schedUprBound_; trgtLngth++) {
+  trail_ = enumrtr_->GetTrail();
+
+  // The shortest length that has not been proven infeasible.
+  InstCount minLngth = schedLwrBound_;
+  // The shortest length that is known to be feasible, which is at most that
+  // of the best schedule so far.
+  InstCount fsblLngth = bestSchedLngth_;
+  // The distance from minLngth of the next length to probe in an exponential
+  // search, or 0 once a probe has found a feasible length.
+  InstCount lngthStep = lngthSrch_ == LS_EXPONENTIAL ? 1 : 0;
+  bool isSrchng = lngthSrch_ != LS_LINEAR;
+  // A probe only has to find one schedule, so it gets a fraction of the length
+  // timeout. If it does not finish in time, the lengths are enumerated in full
+  // from minLngth up, as in a linear search.
+  Milliseconds probeTimeout =
+      std::max((Milliseconds)1, lngthTimeout / PROBE_TIMEOUT_DIVISOR);
+  // The upper bound only goes down as the best cost improves.
+  std::vector<bool> isLngthEnumd(schedUprBound_ - schedLwrBound_ + 1, false);
+
+  while (true) {
+    // The lengths that are still worth probing are those between minLngth
+    // and the shortest feasible length or the upper bound. minLngth itself is
+    // enumerated in full next anyway, so it is never probed.
+    InstCount maxLngth = std::min(fsblLngth, schedUprBound_ + 1);
+    if (isSrchng && maxLngth - minLngth <= 1)
+      isSrchng = false;
+
+    bool isProbe = isSrchng;
+    if (isSrchng) {
+      if (lngthStep > 0) {
+        trgtLngth = std::min(minLngth + lngthStep, maxLngth - 1);
+        lngthStep *= 2;
+      } else {
+        trgtLngth = minLngth + (maxLngth - minLngth) / 2;
+      }
+    } else {
+      // Enumerate the remaining lengths from the shortest one up.
+      trgtLngth = minLngth;
+      while (trgtLngth <= schedUprBound_ &&
+             isLngthEnumd[trgtLngth - schedLwrBound_])
+        trgtLngth++;
+    }
+
+    if (trgtLngth > schedUprBound_)
+      break;
+
+    Milliseconds deadline = lngthDeadline;
+    if (isProbe && rgnDeadline != INVALID_VALUE)
+      deadline = std::min(Utilities::GetProcessorTime() + probeTimeout,
+                          rgnDeadline);
+
     InitForSchdulng();
     //#ifdef IS_DEBUG_ENUM_ITERS
-    Logger::Info("Enumerating at target length %d", trgtLngth);
+    Logger::Info("%s target length %d", isProbe ? "Probing" : "Enumerating at",
+                 trgtLngth);
     //#endif
+    // A probe looks for any schedule of the target length, whatever its cost.
+    enumrtr_->SetFsbltyProbe(isProbe);
     rslt = enumrtr_->FindFeasibleSchedule(enumCrntSched_, trgtLngth, this,
-                                          costLwrBound, lngthDeadline);
-    if (rslt == RES_TIMEOUT)
-      timeout = true;
-    HandlEnumrtrRslt_(rslt, trgtLngth);
+                                          trgtLngth - schedLwrBound_,
+                                          deadline);
+    if (enumrtr_->WasSrchCut())
+      isSrchCut = true;
+
+    // In a parallel enumeration, a probe searches the whole tree by itself,
+    // and a full enumeration counts the work items claimed by other workers
+    // as length-feasible, so the lengths that either proves infeasible are
+    // infeasible for all workers.
+    if (isProbe) {
+      if (rslt == RES_SUCCESS) {
+        fsblLngth = trgtLngth;
+        lngthStep = 0;
+      } else if (enumrtr_->WasLngthInfsbl()) {
+        minLngth = trgtLngth + 1;
+      } else if (rslt != RES_ERROR) {
+        // The probe timed out, or skipped branches for the beam or the
+        // history without proving them infeasible.
+        Logger::Info("Probing target length %d was inconclusive.", trgtLngth);
+        isSrchng = false;
+      }
+    } else {
+      if (rslt == RES_TIMEOUT)
+        timeout = true;
+      HandlEnumrtrRslt_(rslt, trgtLngth);
+      isLngthEnumd[trgtLngth - schedLwrBound_] = true;
+      if (enumrtr_->WasLngthInfsbl())
+        minLngth = std::max(minLngth, trgtLngth + 1);
+    }
 
-    if (bestCost_ == 0 || rslt == RES_ERROR ||
-        lngthDeadline == rgnDeadline && rslt == RES_TIMEOUT)
+    if (GetBestCost() == 0 || rslt == RES_ERROR)
       break;
 
+    if (!isProbe && lngthDeadline == rgnDeadline && rslt == RES_TIMEOUT)
+      break;
+
+    // Longer target lengths are not tried once the improvements have dried
+    // up.
+    if (!isProbe && rslt == RES_TIMEOUT &&
+        IsImprvmntStalled(Utilities::GetProcessorTime())) {
+      Logger::Info("Stopping the enumeration as the cost improvement rate "
+                   "dropped below %g per second.",
+                   minImprvmntRate_);
+      break;
+    }
+
     enumrtr_->Reset();
     enumCrntSched_->Reset();
     CmputSchedUprBound_();
     iterCnt++;
-    costLwrBound += 1;
     lngthDeadline = Utilities::GetProcessorTime() + lngthTimeout;
     if (lngthDeadline > rgnDeadline)
       lngthDeadline = rgnDeadline;
   }
 
+  trail_ = NULL;
+
 #ifdef IS_DEBUG_ITERS
   Stats::iterations.Record(iterCnt);
   Stats::enumerations.Record(enumrtr_->GetSearchCnt());
@@ -855,13 +955,240 @@ FUNC_RESULT BBWithSpill::Enumerate_(Milliseconds startTime,
   if (rslt == RES_SUCCESS || rslt == RES_FAIL) {
     rslt = RES_SUCCESS;
   }
-  if (timeout)
+  // A beam search that skipped branches proves nothing about the schedules it
+  // did not find, so its best schedule is no more optimal than one found
+  // before a timeout.
+  isSrchCut_ = isSrchCut && !timeout;
+  if (timeout || isSrchCut)
     rslt = RES_TIMEOUT;
 
   return rslt;
 }
 /*****************************************************************************/
 
+bool BBWithSpill::IsWindowed_() const {
+  return wndwSize_ > 0 && instCnt_ > wndwSize_ && !isWndw_;
+}
+/*****************************************************************************/
+
+// Places the instructions of a graph in the given order, each one at the
+// earliest slot that is not before the previous instruction and satisfies its
+// latencies and the issue slots of the machine, and returns the issue slot of
+// each instruction.
+static void PlaceInOrder(MachineModel *machMdl, DataDepGraph *graph,
+                         const std::vector<InstCount> &order,
+                         std::vector<InstCount> &instSlots) {
+  int issuRate = machMdl->GetIssueRate();
+  std::vector<InstCount> instCycles(graph->GetInstCnt(), 0);
+  std::vector<int> filledSlots(machMdl->GetIssueTypeCnt(), 0);
+  InstCount crntCycle = 0;
+  int crntSlot = 0;
+
+  instSlots.assign(graph->GetInstCnt(), INVALID_VALUE);
+  for (InstCount instNum : order) {
+    SchedInstruction *inst = graph->GetInstByIndx(instNum);
+    // The graph may not have been set up for scheduling yet.
+    IssueType issuType = machMdl->GetIssueType(inst->GetInstType());
+    InstCount cycle = crntCycle;
+    UDT_GLABEL ltncy;
+    for (SchedInstruction *prdcsr = inst->GetFrstPrdcsr(NULL, &ltncy);
+         prdcsr != NULL; prdcsr = inst->GetNxtPrdcsr(NULL, &ltncy)) {
+      cycle = std::max(cycle, instCycles[prdcsr->GetNum()] + ltncy);
+    }
+
+    if (cycle == crntCycle &&
+        (crntSlot == issuRate ||
+         filledSlots[issuType] == machMdl->GetSlotsPerCycle(issuType)))
+      cycle++;
+    if (cycle > crntCycle) {
+      crntCycle = cycle;
+      crntSlot = 0;
+      std::fill(filledSlots.begin(), filledSlots.end(), 0);
+    }
+
+    instCycles[instNum] = crntCycle;
+    instSlots[instNum] = crntCycle * issuRate + crntSlot;
+    crntSlot++;
+    filledSlots[issuType]++;
+  }
+}
+/*****************************************************************************/
+
+FUNC_RESULT BBWithSpill::OptimizeInWindows_(Milliseconds startTime,
+                                            Milliseconds rgnTimeout,
+                                            Milliseconds lngthTimeout) {
+  // A window of the region and the region scheduling it.
+  struct Wndw {
+    InstCount bgn;
+    InstCount end;
+    std::unique_ptr<WindowDataDepGraph> graph;
+    std::unique_ptr<BBWithSpill> rgn;
+    // The instructions of the window in the order of its best schedule, or
+    // empty if the window could not be scheduled.
+    std::vector<InstCount> order;
+  };
+
+  int issuRate = machMdl_->GetIssueRate();
+  enumBestSched_ = AllocNewSched_();
+  enumBestSched_->Copy(bestSched_);
+
+  // The instructions in the order of the best schedule so far. The artificial
+  // root and leaf stay at the ends, out of all windows.
+  std::vector<InstCount> order;
+  InstCount cycleNum, slotNum;
+  for (InstCount i = bestSched_->GetFrstInst(cycleNum, slotNum);
+       i != INVALID_VALUE; i = bestSched_->GetNxtInst(cycleNum, slotNum)) {
+    if (i != SCHD_STALL)
+      order.push_back(i);
+  }
+  assert((InstCount)order.size() == instCnt_);
+  InstCount wndwdInstCnt = instCnt_ - 2;
+
+  // The second pass shifts the windows by half a window, so that the
+  // instructions on either side of a boundary of the first pass end up in the
+  // same window. The windows of a pass do not overlap and are independent.
+  const int PASS_CNT = 2;
+  int wndwCnt = 0;
+  for (int pass = 0; pass < PASS_CNT; pass++) {
+    InstCount ofst = pass * wndwSize_ / PASS_CNT;
+    // The cycles of the instructions in the best schedule so far, whose order
+    // the windows are taken from.
+    std::vector<InstCount> cycles(instCnt_);
+    for (InstCount i = 0; i < instCnt_; i++)
+      cycles[i] = enumBestSched_->GetSchedCycle(i);
+
+    std::vector<Wndw> wndws;
+    for (InstCount bgn = 1 + ofst; bgn < instCnt_ - 1; bgn += wndwSize_) {
+      Wndw wndw;
+      wndw.bgn = bgn;
+      wndw.end = std::min(bgn + wndwSize_, instCnt_ - 1);
+      if (wndw.end - wndw.bgn > 1)
+        wndws.push_back(std::move(wndw));
+    }
+
+    // The windows are set up in this thread, since that walks the full graph
+    // with the iterators of its instructions.
+    for (int i = 0; i < (int)wndws.size(); i++) {
+      Wndw &wndw = wndws[i];
+      InstCount wndwInstCnt = wndw.end - wndw.bgn;
+      wndw.graph.reset(new WindowDataDepGraph(
+          dataDepGraph_, machMdl_, regFiles_, order, cycles, wndw.bgn,
+          wndw.end, wndwCnt++));
+      wndw.rgn.reset(new BBWithSpill(
+          machMdl_, wndw.graph.get(), rgnNum_, sigHashSize_, lbAlg_,
+          hurstcPrirts_, enumPrirts_, vrfySched_, prune_, schedForRPOnly_,
+          enblStallEnum_, spillCostFactor_, spillCostFunc_, chkSpillCostSum_,
+          chkCnflcts_, fixLivein_, fixLiveout_, maxSpillCost_));
+      wndw.rgn->SetIsWindow(true);
+      wndw.rgn->SetRndmSeed(rndmSeed_ + wndwCnt);
+      wndw.rgn->SetHurstcPortfolio(hurstcPortfolio_, 0);
+      wndw.rgn->SetPrintSpills(printSpills_);
+      wndw.rgn->BuildFromFile();
+
+      // The window starts from its part of the best schedule, so that it
+      // never comes back with a worse one.
+      std::vector<InstCount> wndwOrder(1, wndwInstCnt);
+      for (InstCount j = 0; j < wndwInstCnt; j++)
+        wndwOrder.push_back(j);
+      wndwOrder.push_back(wndwInstCnt + 1);
+      SchedCacheEntry seed;
+      seed.cost = 0;
+      seed.isOptml = false;
+      PlaceInOrder(machMdl_, wndw.graph.get(), wndwOrder, seed.instSlots);
+      wndw.rgn->SetSeedSched(seed);
+    }
+
+    // Each window gets its share of the region's time limits.
+    auto solveWndw = [&](Wndw &wndw) {
+      InstCount wndwInstCnt = wndw.end - wndw.bgn;
+      Milliseconds wndwRgnTimeout = rgnTimeout;
+      Milliseconds wndwLngthTimeout = lngthTimeout;
+      if (rgnTimeout > 0) {
+        InstCount shareDnmntr = wndwdInstCnt * PASS_CNT;
+        wndwRgnTimeout =
+            std::max(rgnTimeout * wndwInstCnt / shareDnmntr, (Milliseconds)1);
+        wndwLngthTimeout = std::min(
+            std::max(lngthTimeout * wndwInstCnt / shareDnmntr, (Milliseconds)1),
+            wndwRgnTimeout);
+      }
+
+      bool isEasy;
+      InstCount cost, schedLngth, hurstcCost, hurstcSchedLngth;
+      InstSchedule *sched = NULL;
+      FUNC_RESULT rslt = wndw.rgn->FindOptimalSchedule(
+          false, wndwRgnTimeout, wndwLngthTimeout, isEasy, cost, schedLngth,
+          hurstcCost, hurstcSchedLngth, sched, false, BLOCKS_TO_KEEP::ALL);
+      if ((rslt == RES_SUCCESS || rslt == RES_TIMEOUT) && sched != NULL) {
+        InstCount cycleNum, slotNum;
+        for (InstCount i = sched->GetFrstInst(cycleNum, slotNum);
+             i != INVALID_VALUE; i = sched->GetNxtInst(cycleNum, slotNum)) {
+          InstCount fullInstNum = i == SCHD_STALL
+                                      ? INVALID_VALUE
+                                      : wndw.graph->GetFullInstNum(i);
+          if (fullInstNum != INVALID_VALUE)
+            wndw.order.push_back(fullInstNum);
+        }
+      }
+      delete sched;
+    };
+
+    std::atomic<int> nxtWndw(0);
+    auto solveWndws = [&]() {
+      for (int i = nxtWndw++; i < (int)wndws.size(); i = nxtWndw++)
+        solveWndw(wndws[i]);
+    };
+    std::vector<std::thread> thrds;
+    for (int i = 1; i < std::min(wndwThrdCnt_, (int)wndws.size()); i++)
+      thrds.emplace_back(solveWndws);
+    solveWndws();
+    for (std::thread &thrd : thrds)
+      thrd.join();
+
+    // Put the schedules of the windows in place and keep the result if it is
+    // better than the best schedule so far.
+    std::vector<InstCount> newOrder = order;
+    for (Wndw &wndw : wndws) {
+      if ((InstCount)wndw.order.size() == wndw.end - wndw.bgn)
+        std::copy(wndw.order.begin(), wndw.order.end(),
+                  newOrder.begin() + wndw.bgn);
+    }
+
+    SchedCacheEntry entry;
+    entry.cost = 0;
+    entry.isOptml = false;
+    PlaceInOrder(machMdl_, dataDepGraph_, newOrder, entry.instSlots);
+    if (SchedCache::GetSchedLngth(entry, issuRate) >
+        dataDepGraph_->GetAbslutSchedUprBound())
+      continue;
+
+    InstSchedule *sched = AllocNewSched_();
+    SchedCache::FillSched(entry, issuRate, sched);
+    if (sched->Verify(machMdl_, dataDepGraph_)) {
+      InstCount execCost;
+      CmputNormCost_(sched, CCM_STTC, execCost, false);
+      Logger::Info("Windowed pass %d of DAG %s found a schedule with cost %d.",
+                   pass, dataDepGraph_->GetDagID(), sched->GetCost());
+
+      if (sched->GetCost() < bestCost_) {
+        std::swap(sched, enumBestSched_);
+        bestCost_ = enumBestSched_->GetCost();
+        bestSchedLngth_ = enumBestSched_->GetCrntLngth();
+        order = newOrder;
+      }
+    }
+    delete sched;
+  }
+
+  Milliseconds solnTime = Utilities::GetProcessorTime() - startTime;
+  Logger::Info("DAG enumerated in windows in %lld ms with length=%d, tot "
+               "cost = %d, cost imp=%d.",
+               solnTime, bestSchedLngth_, bestCost_, hurstcCost_ - bestCost_);
+
+  // The windows prove nothing about the schedule of the whole region.
+  return RES_TIMEOUT;
+}
+/*****************************************************************************/
+
 InstCount BBWithSpill::UpdtOptmlSched(InstSchedule *crntSched,
                                       LengthCostEnumerator *) {
   InstCount crntCost;
@@ -882,14 +1209,18 @@ InstCount BBWithSpill::UpdtOptmlSched(InstSchedule *crntSched,
     if (crntSched->GetCrntLngth() > schedLwrBound_)
       Logger::Info("$$$ GOOD_HIT: Better spill cost for a longer schedule");
 
+    RecordImprvmnt_(bestCost_ - crntCost);
     bestCost_ = crntCost;
     optmlSpillCost_ = crntSpillCost_;
     bestSchedLngth_ = crntSched->GetCrntLngth();
     enumBestSched_->Copy(crntSched);
     bestSched_ = enumBestSched_;
+
+    if (prllState_ != NULL)
+      prllState_->UpdtBestCost(bestCost_);
   }
 
-  return bestCost_;
+  return GetBestCost();
 }
 /*****************************************************************************/
 
@@ -923,14 +1254,12 @@ bool BBWithSpill::ChkCostFsblty(InstCount trgtLngth, EnumTreeNode *node) {
   // assert(cost >= 0);
   assert(dynmcCostLwrBound >= 0);
 
-  fsbl = dynmcCostLwrBound < bestCost_;
+  fsbl = dynmcCostLwrBound < GetBestCost();
 
-  if (fsbl) {
-    node->SetCost(crntCost);
-    node->SetCostLwrBound(dynmcCostLwrBound);
-    node->SetPeakSpillCost(peakSpillCost_);
-    node->SetSpillCostSum(totSpillCost_);
-  }
+  node->SetCost(crntCost);
+  node->SetCostLwrBound(dynmcCostLwrBound);
+  node->SetPeakSpillCost(peakSpillCost_);
+  node->SetSpillCostSum(totSpillCost_);
   return fsbl;
 }
 /*****************************************************************************/
@@ -4,7 +4,11 @@
 #include <cstdlib>
 #include <cstring>
 #include <fcntl.h>
+#include <sys/stat.h>
 #include <unistd.h>
+#ifndef WIN32
+#include <sys/mman.h>
+#endif
 
 namespace opt_sched {
 
@@ -34,6 +38,7 @@ static inline bool IsCommentStart(const char &c) { return c == CMNT_STRT; }
 InputBuffer::InputBuffer() {
   fileHndl = FILEOPEN_ERROR;
   buf = NULL;
+  ownsBuf = false;
   totSize = DFLT_INPBUF_SIZE;
   crntLineNum = 0;
   crntLineOfst = 0;
@@ -69,14 +74,13 @@ FUNC_RESULT InputBuffer::Load(char const *const _fullPath, long maxByts) {
     return RES_ERROR;
   }
 
-  if (buf != NULL) {
-    delete[] buf;
-  }
+  Clean();
 
   // Allocate an extra byte for possible null termination.
   buf = new char[totSize + 1];
   if (buf == NULL)
     Logger::Fatal("Out of memory.");
+  ownsBuf = true;
   if ((loadedByts = read(fileHndl, buf, totSize)) == 0) {
     Logger::Fatal("Empty input file: %s.", fullPath);
   }
@@ -106,7 +110,9 @@ FUNC_RESULT InputBuffer::SetBuf(char *_buf, long size) {
     return RES_ERROR;
   }
 
+  Clean();
   buf = _buf;
+  ownsBuf = false;
 
   if (buf == NULL) {
     Logger::Error("Invalid input buffer.");
@@ -308,10 +314,9 @@ NXTLINE_TYPE InputBuffer::GetNxtVldLine_(int &pieceCnt, char *strng[],
 }
 
 void InputBuffer::Clean() {
-  if (buf) {
+  if (buf && ownsBuf)
     delete[] buf;
-    buf = NULL;
-  }
+  buf = NULL;
 }
 
 void InputBuffer::Unload() {
@@ -583,4 +588,136 @@ FUNC_RESULT SpecsBuffer::checkTitle(char const *const title) {
 
 SpecsBuffer::SpecsBuffer() { nxtLineType = NXT_DATA; }
 
+DagFileMap::DagFileMap() {
+  buf_ = NULL;
+  size_ = 0;
+  isMapped_ = false;
+}
+
+DagFileMap::~DagFileMap() { Unload_(); }
+
+FUNC_RESULT DagFileMap::Load(char const *const fullPath) {
+  Unload_();
+
+  int fileHndl = open(fullPath, INPFILE_OPENFLAGS);
+  if (fileHndl == FILEOPEN_ERROR) {
+    Logger::Error("Error openning input file: %s.", fullPath);
+    return RES_ERROR;
+  }
+
+  struct stat fileStat;
+  if (fstat(fileHndl, &fileStat) != 0 || fileStat.st_size == 0) {
+    Logger::Error("Empty input file: %s.", fullPath);
+    close(fileHndl);
+    return RES_ERROR;
+  }
+  size_ = fileStat.st_size;
+
+#ifndef WIN32
+  // The last token of the last DAG is null-terminated on the line end that
+  // follows it. A file without one is read into memory instead, where there
+  // is room for the null after the end of the file.
+  void *addr =
+      mmap(NULL, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileHndl, 0);
+  if (addr != MAP_FAILED) {
+    buf_ = (char *)addr;
+    isMapped_ = IsLineEnd(buf_[size_ - 1]);
+    if (!isMapped_)
+      munmap(addr, size_);
+  }
+#endif
+
+  if (!isMapped_) {
+    buf_ = new char[size_ + 1];
+    if (buf_ == NULL)
+      Logger::Fatal("Out of memory.");
+
+    long loadedByts = 0;
+    while (loadedByts < size_) {
+      long byts = read(fileHndl, buf_ + loadedByts, size_ - loadedByts);
+      if (byts <= 0) {
+        Logger::Error("Error reading input file: %s.", fullPath);
+        close(fileHndl);
+        Unload_();
+        return RES_ERROR;
+      }
+      loadedByts += byts;
+    }
+  }
+
+  close(fileHndl);
+  Index_();
+  return RES_SUCCESS;
+}
+
+void DagFileMap::Unload_() {
+  if (buf_ != NULL) {
+#ifndef WIN32
+    if (isMapped_)
+      munmap(buf_, size_);
+    else
+#endif
+      delete[] buf_;
+  }
+
+  buf_ = NULL;
+  size_ = 0;
+  isMapped_ = false;
+  dags_.clear();
+}
+
+// A DAG starts with a line whose first token is "dag". Its ID is on the first
+// dag_id line that follows.
+void DagFileMap::Index_() {
+  long lineOfst = 0;
+
+  while (lineOfst < size_) {
+    const char *line = buf_ + lineOfst;
+    const char *lineEnd = (const char *)memchr(line, LF, size_ - lineOfst);
+    long lineLngth = lineEnd == NULL ? size_ - lineOfst : lineEnd - line + 1;
+
+    if (lineLngth > 3 && strncmp(line, "dag", 3) == 0 &&
+        IsWhitespace(line[3])) {
+      if (!dags_.empty())
+        dags_.back().size = lineOfst - dags_.back().ofst;
+      DagEntry dag;
+      dag.ofst = lineOfst;
+      dag.size = 0;
+      dags_.push_back(dag);
+    } else if (!dags_.empty() && dags_.back().id.empty() && lineLngth > 6 &&
+               strncmp(line, "dag_id", 6) == 0 && IsWhitespace(line[6])) {
+      const char *idStrt = line + 6;
+      const char *end = line + lineLngth;
+      while (idStrt < end && IsWhitespace(*idStrt))
+        idStrt++;
+      const char *idEnd = idStrt;
+      while (idEnd < end && !IsWhitespace(*idEnd) && !IsLineEnd(*idEnd))
+        idEnd++;
+      dags_.back().id.assign(idStrt, idEnd - idStrt);
+    }
+
+    lineOfst += lineLngth;
+  }
+
+  if (!dags_.empty())
+    dags_.back().size = size_ - dags_.back().ofst;
+}
+
+int DagFileMap::FindDag(const std::string &dagID) const {
+  for (size_t i = 0; i < dags_.size(); i++) {
+    if (dags_[i].id == dagID)
+      return (int)i;
+  }
+
+  return INVALID_VALUE;
+}
+
+FUNC_RESULT DagFileMap::SetBuf(int indx, SpecsBuffer &buf) {
+  assert(indx >= 0 && indx < GetDagCnt());
+  // Each DAG ends on a line end, except maybe the last one, which has the
+  // extra byte allocated after the file if it is not mapped.
+  const DagEntry &dag = dags_[indx];
+  return buf.SetBuf(buf_ + dag.ofst, dag.size);
+}
+
 } // end namespace opt_sched
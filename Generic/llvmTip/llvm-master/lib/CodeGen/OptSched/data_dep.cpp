@@ -2,6 +2,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <iostream>
+#include <queue>
 
 #include "llvm/CodeGen/OptSched/OptSchedMachineWrapper.h"
 #include "llvm/CodeGen/OptSched/basic/data_dep.h"
@@ -10,12 +11,11 @@
 #include "llvm/CodeGen/OptSched/basic/register.h"
 #include "llvm/CodeGen/OptSched/generic/logger.h"
 #include "llvm/CodeGen/OptSched/generic/stats.h"
+#include "llvm/CodeGen/OptSched/generic/undo_trail.h"
 #include "llvm/CodeGen/OptSched/relaxed/relaxed_sched.h"
 #include "llvm/Support/Debug.h"
 
 // only print pressure if enabled by sched.ini
-extern bool OPTSCHED_gPrintSpills;
-
 namespace opt_sched {
 
 // The maximum number of blocks allowed in a trace.
@@ -185,6 +185,7 @@ DataDepGraph::DataDepGraph(MachineModel *machMdl, LATENCY_PRECISION ltncyPrcsn,
 
   dagFileFormat_ = DFF_BB;
   wasSetupForSchduling_ = false;
+  stateBlk_ = NULL;
   strcpy(dagID_, "unknown");
 
   instTypeCnt_ = (int16_t)machMdl->GetInstTypeCnt();
@@ -216,6 +217,7 @@ DataDepGraph::~DataDepGraph() {
     delete[] insts_;
   }
 
+  delete stateBlk_;
   delete[] instCntPerType_;
 }
 
@@ -228,7 +230,7 @@ FUNC_RESULT DataDepGraph::SetupForSchdulng(bool cmputTrnstvClsr) {
 
   for (i = 0; i < instCnt_; i++) {
     SchedInstruction *inst = insts_[i];
-    inst->SetupForSchdulng(instCnt_, cmputTrnstvClsr, cmputTrnstvClsr);
+    inst->SetupForSchdulng();
     InstType instType = inst->GetInstType();
     IssueType issuType = machMdl_->GetIssueType(instType);
     assert(issuType < issuTypeCnt_);
@@ -249,6 +251,8 @@ FUNC_RESULT DataDepGraph::SetupForSchdulng(bool cmputTrnstvClsr) {
     DepthFirstSearch();
   }
 
+  BuildStateBlk_();
+
   frwrdLwrBounds_ = new InstCount[instCnt_];
   bkwrdLwrBounds_ = new InstCount[instCnt_];
 
@@ -263,8 +267,6 @@ FUNC_RESULT DataDepGraph::SetupForSchdulng(bool cmputTrnstvClsr) {
       return RES_ERROR;
     if (FindRcrsvNghbrs(DIR_BKWRD) == RES_ERROR)
       return RES_ERROR;
-    CmputRltvCrtclPaths_(DIR_FRWRD);
-    CmputRltvCrtclPaths_(DIR_BKWRD);
   }
 
   CmputAbslutUprBound_();
@@ -277,7 +279,7 @@ FUNC_RESULT DataDepGraph::UpdateSetupForSchdulng(bool cmputTrnstvClsr) {
   InstCount i;
   for (i = 0; i < instCnt_; i++) {
     SchedInstruction *inst = insts_[i];
-    inst->SetupForSchdulng(instCnt_, cmputTrnstvClsr, cmputTrnstvClsr);
+    inst->SetupForSchdulng();
     InstType instType = inst->GetInstType();
     IssueType issuType = machMdl_->GetIssueType(instType);
     assert(issuType < issuTypeCnt_);
@@ -290,6 +292,8 @@ FUNC_RESULT DataDepGraph::UpdateSetupForSchdulng(bool cmputTrnstvClsr) {
   // Do a depth-first search leading to a topological sort
   DepthFirstSearch();
 
+  BuildStateBlk_();
+
   delete[] frwrdLwrBounds_;
   delete[] bkwrdLwrBounds_;
 
@@ -303,8 +307,6 @@ FUNC_RESULT DataDepGraph::UpdateSetupForSchdulng(bool cmputTrnstvClsr) {
       return RES_ERROR;
     if (FindRcrsvNghbrs(DIR_BKWRD) == RES_ERROR)
       return RES_ERROR;
-    CmputRltvCrtclPaths_(DIR_FRWRD);
-    CmputRltvCrtclPaths_(DIR_BKWRD);
   }
 
   CmputAbslutUprBound_();
@@ -313,11 +315,42 @@ FUNC_RESULT DataDepGraph::UpdateSetupForSchdulng(bool cmputTrnstvClsr) {
   return RES_SUCCESS;
 }
 
+void DataDepGraph::UpdateSetupForNewEdges() {
+  assert(wasSetupForSchduling_);
+
+  // The edge counts and numbering of the instructions and the state block
+  // are the only parts of the setup that CreateEdgeIncrmntly() leaves stale.
+  for (InstCount i = 0; i < instCnt_; i++) {
+    insts_[i]->SetupForSchdulng();
+  }
+
+  BuildStateBlk_();
+  CmputAbslutUprBound_();
+  CmputBasicLwrBounds_();
+}
+
+void DataDepGraph::BuildStateBlk_() {
+  InstStateBlk *oldBlk = stateBlk_;
+
+  stateBlk_ = new InstStateBlk(insts_, tplgclOrdr_, instCnt_);
+  if (stateBlk_ == NULL)
+    Logger::Fatal("Out of memory.");
+
+  // The instructions copy their state from the old block, so it is deleted
+  // only after they have all moved.
+  for (InstCount i = 0; i < instCnt_; i++) {
+    insts_[i]->SetStateBlk(stateBlk_);
+  }
+
+  delete oldBlk;
+}
+
 void DataDepGraph::InitGraphTrans() {
   graphTransCnt_ = 0;
 
   if (graphTransTypes_.staticNodeSup)
-    graphTrans_[graphTransCnt_++] = GraphTrans::CreateGraphTrans(TT_NSP, this);
+    graphTrans_[graphTransCnt_++] =
+        GraphTrans::CreateGraphTrans(TT_NSP, this, graphTransTypes_);
 }
 
 void DataDepGraph::CmputBasicLwrBounds_() {
@@ -923,6 +956,23 @@ void DataDepGraph::CreateEdge(SchedInstruction *frmNode,
   }
 }
 
+void DataDepGraph::CreateEdgeIncrmntly(SchedInstruction *frmNode,
+                                       SchedInstruction *toNode, int ltncy,
+                                       DependenceType depType) {
+  assert(wasSetupForSchduling_);
+  CreateEdge(frmNode, toNode, ltncy, depType);
+  UpdateForNewEdge(frmNode, toNode);
+
+  // The topological order is up to date, so the critical paths can be
+  // propagated from the ends of the new edge if it lengthens any of them.
+  if (frmNode->GetCrtclPath(DIR_FRWRD) + ltncy >
+      toNode->GetCrtclPath(DIR_FRWRD))
+    UpdtCrtclPaths_(toNode, DIR_FRWRD);
+  if (toNode->GetCrtclPath(DIR_BKWRD) + ltncy >
+      frmNode->GetCrtclPath(DIR_BKWRD))
+    UpdtCrtclPaths_(frmNode, DIR_BKWRD);
+}
+
 void DataDepGraph::CreateEdge_(InstCount frmNodeNum, InstCount toNodeNum,
                                int ltncy, DependenceType depType) {
   GraphEdge *edge;
@@ -1149,66 +1199,6 @@ bool DataDepGraph::UseFileBounds() {
   return match;
 }
 
-void DataDepGraph::CmputRltvCrtclPaths_(DIRECTION dir) {
-  InstCount i;
-
-  if (dir == DIR_FRWRD) {
-    for (i = 0; i < instCnt_; i++) {
-      CmputCrtclPathsFrmRcrsvPrdcsr_(insts_[i]);
-    }
-  } else {
-    assert(dir == DIR_BKWRD);
-
-    for (i = 0; i < instCnt_; i++) {
-      CmputCrtclPathsFrmRcrsvScsr_(insts_[i]);
-    }
-  }
-}
-
-void DataDepGraph::CmputCrtclPathsFrmRcrsvPrdcsr_(SchedInstruction *ref) {
-  LinkedList<GraphNode> *rcrsvScsrLst = ref->GetRcrsvNghbrLst(DIR_FRWRD);
-  SchedInstruction *inst = GetLeafInst();
-  GraphNode *node;
-  InstCount cp = 0;
-
-  assert(rcrsvScsrLst != NULL);
-
-  // Visit the nodes in reverse topological order
-  for (node = rcrsvScsrLst->GetLastElmnt(); node != NULL;
-       node = rcrsvScsrLst->GetPrevElmnt()) {
-    inst = (SchedInstruction *)node;
-    cp = inst->CmputCrtclPathFrmRcrsvPrdcsr(ref);
-  }
-
-  assert(inst == GetLeafInst()); // the last instruction must be the leaf
-
-  // The forward CP of the root relative to this entry must be
-  // equal to the backward CP of the entry relative to the leaf
-  assert(cp == ref->GetCrtclPath(DIR_BKWRD));
-}
-
-void DataDepGraph::CmputCrtclPathsFrmRcrsvScsr_(SchedInstruction *ref) {
-  LinkedList<GraphNode> *rcrsvPrdcsrLst = ref->GetRcrsvNghbrLst(DIR_BKWRD);
-  SchedInstruction *inst = GetRootInst();
-  GraphNode *node;
-  InstCount cp = 0;
-
-  assert(rcrsvPrdcsrLst != NULL);
-
-  // Visit the nodes in reverse topological order
-  for (node = rcrsvPrdcsrLst->GetLastElmnt(); node != NULL;
-       node = rcrsvPrdcsrLst->GetPrevElmnt()) {
-    inst = (SchedInstruction *)node;
-    cp = inst->CmputCrtclPathFrmRcrsvScsr(ref);
-  }
-
-  assert(inst == GetRootInst()); // the last instruction must be the root
-
-  // The backward CP of the root relative to this exit must be
-  // equal to the forward CP of th exit relative to the root
-  assert(cp == ref->GetCrtclPath(DIR_FRWRD));
-}
-
 void DataDepGraph::PrintLwrBounds(DIRECTION dir, std::ostream &out,
                                   char const *const title) {
   out << '\n' << title;
@@ -2896,8 +2886,6 @@ void InstSchedule::Print(std::ostream &out, char const *const label) {
 }
 
 void InstSchedule::PrintRegPressures() {
-  if (!OPTSCHED_gPrintSpills)
-    return;
   Logger::Info("OptSched max reg pressures");
   InstCount i;
   LLVMMachineModel *llvmModel = static_cast<LLVMMachineModel *>(machMdl_);
@@ -2954,10 +2942,6 @@ bool InstSchedule::Verify(MachineModel *machMdl, DataDepGraph *dataDepGraph) {
   if (!VerifyDataDeps_(dataDepGraph))
     return false;
 
-#ifdef IS_DEBUG_PEAK_PRESSURE
-  PrintRegPressures();
-#endif
-
 #ifdef IS_DEBUG_PRINT_SCHEDULE
   Print(std::cout, "debug");
 #endif
@@ -3170,6 +3154,47 @@ void DataDepGraph::CmputCrtclPathsFrmLeaf_() {
   }
 }
 
+void DataDepGraph::UpdtCrtclPaths_(SchedInstruction *inst, DIRECTION dir) {
+  typedef std::pair<InstCount, SchedInstruction *> QueueEntry;
+  // The instructions are recomputed in topological order in the given
+  // direction, so that all of an instruction's neighbors in the opposite
+  // direction are final when it is recomputed.
+  std::priority_queue<QueueEntry, std::vector<QueueEntry>,
+                      std::greater<QueueEntry>>
+      queue;
+  auto getOrdr = [&](SchedInstruction *queuedInst) {
+    InstCount ordr = queuedInst->GetTplgclOrdr();
+    return dir == DIR_FRWRD ? ordr : instCnt_ - 1 - ordr;
+  };
+
+  queue.push(QueueEntry(getOrdr(inst), inst));
+  while (!queue.empty()) {
+    SchedInstruction *crntInst = queue.top().second;
+    queue.pop();
+
+    InstCount prevCrtclPath = crntInst->GetCrtclPath(dir);
+    InstCount crtclPath = dir == DIR_FRWRD ? crntInst->CmputCrtclPathFrmRoot()
+                                           : crntInst->CmputCrtclPathFrmLeaf();
+    // New edges only lengthen paths, and an unchanged critical path does not
+    // affect the instructions beyond this one.
+    assert(crtclPath >= prevCrtclPath);
+    if (crtclPath == prevCrtclPath)
+      continue;
+
+    if (dir == DIR_FRWRD) {
+      for (SchedInstruction *scsr = crntInst->GetFrstScsr(); scsr != NULL;
+           scsr = crntInst->GetNxtScsr()) {
+        queue.push(QueueEntry(getOrdr(scsr), scsr));
+      }
+    } else {
+      for (SchedInstruction *prdcsr = crntInst->GetFrstPrdcsr(); prdcsr != NULL;
+           prdcsr = crntInst->GetNxtPrdcsr()) {
+        queue.push(QueueEntry(getOrdr(prdcsr), prdcsr));
+      }
+    }
+  }
+}
+
 void DataDepGraph::CmputCrtclPaths_() {
   CmputCrtclPathsFrmRoot_();
   CmputCrtclPathsFrmLeaf_();
@@ -3219,6 +3244,8 @@ const char *DataDepGraph::GetDagID() const { return dagID_; }
 
 float DataDepGraph::GetWeight() const { return weight_; }
 
+void DataDepGraph::SetWeight(float weight) { weight_ = weight; }
+
 void DataDepGraph::GetFileSchedBounds(InstCount &lwrBound,
                                       InstCount &uprBound) const {
   lwrBound = fileSchedLwrBound_;
@@ -3248,8 +3275,11 @@ InstCount DataDepGraph::GetInstIndx(SchedInstruction *inst) {
   return instNum;
 }
 
-void DataDepGraph::SetCrntFrwrdLwrBound(SchedInstruction *inst) {
+void DataDepGraph::SetCrntFrwrdLwrBound(SchedInstruction *inst,
+                                        UndoTrail *trail) {
   InstCount bound = inst->GetCrntLwrBound(DIR_FRWRD);
+  if (trail != NULL)
+    trail->Save(frwrdLwrBounds_[inst->GetNum()]);
   frwrdLwrBounds_[inst->GetNum()] = bound;
 }
 
@@ -3265,10 +3295,10 @@ bool DataDepGraph::DoesFeedUser(SchedInstruction *inst) {
 #ifdef IS_DEBUG_RP_ONLY
   Logger::Info("Testing inst %d", inst->GetNum());
 #endif
-  LinkedList<GraphNode> *rcrsvSuccs = inst->GetRcrsvNghbrLst(DIR_FRWRD);
-  for (GraphNode *succ = rcrsvSuccs->GetFrstElmnt(); succ != NULL;
-       succ = rcrsvSuccs->GetNxtElmnt()) {
-    SchedInstruction *succInst = static_cast<SchedInstruction *>(succ);
+  BitVector *rcrsvSuccs = inst->GetRcrsvNghbrBitVector(DIR_FRWRD);
+  for (int succNum = rcrsvSuccs->GetNxtOneBit(0); succNum != INVALID_VALUE;
+       succNum = rcrsvSuccs->GetNxtOneBit(succNum + 1)) {
+    SchedInstruction *succInst = insts_[succNum];
     Register **uses;
     int numUses = succInst->GetUses(uses);
 
@@ -8,43 +8,23 @@
 #include <algorithm>
 #include <iterator>
 #include <memory>
+#include <new>
 #include <sstream>
 
 namespace opt_sched {
 
 EnumTreeNode::EnumTreeNode() {
-  isCnstrctd_ = false;
   isClean_ = true;
-  rdyLst_ = NULL;
+  exmndInsts_ = NULL;
+  exmndInstCnt_ = 0;
+  brnchOrdr_ = NULL;
+  rsrvSlots_ = NULL;
+  rsrvSlotBuf_ = NULL;
 }
 /*****************************************************************************/
 
 EnumTreeNode::~EnumTreeNode() {
-  assert(isCnstrctd_ || isClean_);
-  assert(isCnstrctd_ || rdyLst_ == NULL);
-
-  if (isCnstrctd_) {
-    assert(frwrdLwrBounds_ != NULL);
-    delete[] frwrdLwrBounds_;
-
-    assert(exmndInsts_ != NULL);
-    for (ExaminedInst *exmndInst = exmndInsts_->GetFrstElmnt();
-         exmndInst != NULL; exmndInst = exmndInsts_->GetNxtElmnt()) {
-      delete exmndInst;
-    }
-    exmndInsts_->Reset();
-    delete exmndInsts_;
-
-    assert(chldrn_ != NULL);
-    delete chldrn_;
-
-    if (rdyLst_ != NULL)
-      delete rdyLst_;
-    if (rsrvSlots_ != NULL)
-      delete[] rsrvSlots_;
-  } else {
-    assert(isClean_);
-  }
+  assert(isClean_);
 }
 /*****************************************************************************/
 
@@ -55,7 +35,6 @@ void EnumTreeNode::Init_() {
   fsblBrnchCnt_ = 0;
   legalInstCnt_ = 0;
   hstry_ = NULL;
-  rdyLst_ = NULL;
   dmntdNode_ = NULL;
   isArchivd_ = false;
   isFsbl_ = true;
@@ -66,20 +45,17 @@ void EnumTreeNode::Init_() {
   costLwrBound_ = INVALID_VALUE;
   crntCycleBlkd_ = false;
   rsrvSlots_ = NULL;
+  exmndInstCnt_ = 0;
+  rankdBrnchCnt_ = INVALID_VALUE;
   totalCostIsActualCost_ = false;
   totalCost_ = -1;
+  trailSize_ = 0;
   suffix_.clear();
 }
 /*****************************************************************************/
 
 void EnumTreeNode::Construct(EnumTreeNode *prevNode, SchedInstruction *inst,
                              Enumerator *enumrtr) {
-  if (isCnstrctd_) {
-    if (isClean_ == false) {
-      Clean();
-    }
-  }
-
   Init_();
 
   prevNode_ = prevNode;
@@ -87,22 +63,6 @@ void EnumTreeNode::Construct(EnumTreeNode *prevNode, SchedInstruction *inst,
   enumrtr_ = enumrtr;
   time_ = prevNode_ == NULL ? 0 : prevNode_->time_ + 1;
 
-  InstCount instCnt = enumrtr_->totInstCnt_;
-
-  if (isCnstrctd_ == false) {
-    exmndInsts_ = new LinkedList<ExaminedInst>(instCnt);
-    if (exmndInsts_ == NULL)
-      Logger::Fatal("Out of memory.");
-
-    chldrn_ = new LinkedList<HistEnumTreeNode>(instCnt);
-    if (chldrn_ == NULL)
-      Logger::Fatal("Out of memory.");
-
-    frwrdLwrBounds_ = new InstCount[instCnt];
-    if (frwrdLwrBounds_ == NULL)
-      Logger::Fatal("Out of memory.");
-  }
-
   if (enumrtr_->IsHistDom()) {
     CreateTmpHstry_();
   }
@@ -111,48 +71,20 @@ void EnumTreeNode::Construct(EnumTreeNode *prevNode, SchedInstruction *inst,
 
   dmntdNode_ = NULL;
 
-  isCnstrctd_ = true;
   isClean_ = false;
 }
 /*****************************************************************************/
 
 void EnumTreeNode::Reset() {
-  assert(isCnstrctd_);
-
-  if (rdyLst_ != NULL) {
-    rdyLst_->Reset();
-  }
-
-  if (exmndInsts_ != NULL) {
-    for (ExaminedInst *exmndInst = exmndInsts_->GetFrstElmnt();
-         exmndInst != NULL; exmndInst = exmndInsts_->GetNxtElmnt()) {
-      delete exmndInst;
-    }
-    exmndInsts_->Reset();
-  }
-
-  if (chldrn_ != NULL) {
-    chldrn_->Reset();
-  }
-
+  exmndInstCnt_ = 0;
   suffix_.clear();
 }
 /*****************************************************************************/
 
 void EnumTreeNode::Clean() {
-  assert(isCnstrctd_);
   Reset();
 
-  if (rdyLst_ != NULL) {
-    delete rdyLst_;
-    rdyLst_ = NULL;
-  }
-
-  if (rsrvSlots_ != NULL) {
-    delete[] rsrvSlots_;
-    rsrvSlots_ = NULL;
-  }
-
+  rsrvSlots_ = NULL;
   isClean_ = true;
 }
 /*****************************************************************************/
@@ -174,18 +106,6 @@ void EnumTreeNode::FormPrtilSchedSig_() {
 }
 /*****************************************************************************/
 
-void EnumTreeNode::SetLwrBounds() { SetLwrBounds(DIR_FRWRD); }
-/*****************************************************************************/
-
-void EnumTreeNode::SetLwrBounds(DIRECTION dir) {
-  assert(dir == DIR_FRWRD);
-  InstCount *&nodeLwrBounds = frwrdLwrBounds_;
-  assert(nodeLwrBounds != NULL);
-  DataDepGraph *dataDepGraph = enumrtr_->dataDepGraph_;
-  dataDepGraph->GetCrntLwrBounds(dir, nodeLwrBounds);
-}
-/*****************************************************************************/
-
 void EnumTreeNode::SetRsrvSlots(int16_t rsrvSlotCnt, ReserveSlot *rsrvSlots) {
   assert(rsrvSlots_ == NULL);
   rsrvSlots_ = NULL;
@@ -196,9 +116,7 @@ void EnumTreeNode::SetRsrvSlots(int16_t rsrvSlotCnt, ReserveSlot *rsrvSlots) {
 
   int issuRate = enumrtr_->machMdl_->GetIssueRate();
 
-  rsrvSlots_ = new ReserveSlot[issuRate];
-  if (rsrvSlots_ == NULL)
-    Logger::Fatal("Out of memory.");
+  rsrvSlots_ = rsrvSlotBuf_;
 
   for (int i = 0; i < issuRate; i++) {
     rsrvSlots_[i].strtCycle = rsrvSlots[i].strtCycle;
@@ -258,12 +176,9 @@ void EnumTreeNode::NewBranchExmnd(SchedInstruction *inst, bool isLegal,
 
       if (enumrtr_->prune_.nodeSup) {
         if (!isNodeDmntd) {
-          ExaminedInst *exmndInst;
-          exmndInst =
-              new ExaminedInst(inst, wasRlxInfsbl, enumrtr_->dirctTightndLst_);
-          if (exmndInst == NULL)
-            Logger::Fatal("Out of memory.");
-          exmndInsts_->InsrtElmnt(exmndInst);
+          assert(exmndInsts_ != NULL);
+          assert(exmndInstCnt_ < enumrtr_->totInstCnt_);
+          exmndInsts_[exmndInstCnt_++].Construct(inst, wasRlxInfsbl);
         }
       }
     }
@@ -329,8 +244,8 @@ bool EnumTreeNode::WasSprirNodeExmnd(SchedInstruction *cnddtInst) {
   if (cnddtInst == NULL)
     return false;
 
-  for (ExaminedInst *exmndInst = exmndInsts_->GetFrstElmnt(); exmndInst != NULL;
-       exmndInst = exmndInsts_->GetNxtElmnt()) {
+  for (InstCount i = 0; i < exmndInstCnt_; i++) {
+    ExaminedInst *exmndInst = &exmndInsts_[i];
     SchedInstruction *inst = exmndInst->GetInst();
     assert(inst != cnddtInst);
 
@@ -364,8 +279,8 @@ bool EnumTreeNode::WasRsrcDmnntNodeExmnd(SchedInstruction *cnddtInst) {
   SchedInstruction *inst;
   ExaminedInst *exmndInst;
 
-  for (exmndInst = exmndInsts_->GetFrstElmnt(); exmndInst != NULL;
-       exmndInst = exmndInsts_->GetNxtElmnt()) {
+  for (InstCount i = 0; i < exmndInstCnt_; i++) {
+    exmndInst = &exmndInsts_[i];
     inst = exmndInst->GetInst();
     assert(inst != cnddtInst);
 
@@ -385,11 +300,10 @@ bool EnumTreeNode::IsBranchDominated(SchedInstruction *cnddtInst) {
   // Check if the given instruction can be fessibly replaced by a previously
   // examined instruction, which was found to be infeasible, thus proving by
   // contradiction that the given instruction is infeasible for this slot
-  ExaminedInst *exmndInst = exmndInsts_->GetFrstElmnt();
-  if (exmndInst == NULL)
+  if (exmndInstCnt_ == 0)
     return false;
 
-  SchedInstruction *inst = exmndInst->GetInst();
+  SchedInstruction *inst = exmndInsts_[0].GetInst();
   assert(inst->IsSchduld() == false);
 
   if (cnddtInst->GetIssueType() != inst->GetIssueType())
@@ -418,24 +332,83 @@ void EnumTreeNode::Archive() {
 }
 /**************************************************************************/
 
-EnumTreeNode::ExaminedInst::ExaminedInst(SchedInstruction *inst,
-                                         bool wasRlxInfsbl,
-                                         LinkedList<SchedInstruction> *) {
-  inst_ = inst;
-  wasRlxInfsbl_ = wasRlxInfsbl;
-  tightndScsrs_ = NULL;
+namespace {
+size_t RoundUp(size_t size, size_t algnmnt) {
+  return (size + algnmnt - 1) / algnmnt * algnmnt;
+}
+} // end anonymous namespace
+
+EnumTreeNodeAlloc::EnumTreeNodeAlloc(InstCount instCnt, int issuRate,
+                                     bool nodeSup, bool rankBrnchs) {
+  typedef EnumTreeNode::ExaminedInst ExaminedInst;
+
+  instCnt_ = instCnt;
+  issuRate_ = issuRate;
+  // At most one examined instruction is recorded per instruction.
+  exmndInstCap_ = nodeSup ? instCnt : 0;
+  // The ready list never holds more than all the instructions.
+  brnchOrdrCap_ = rankBrnchs ? instCnt : 0;
+
+  rsrvSlotsOfst_ = RoundUp(sizeof(EnumTreeNode), alignof(ReserveSlot));
+  exmndInstsOfst_ = RoundUp(rsrvSlotsOfst_ + issuRate_ * sizeof(ReserveSlot),
+                            alignof(ExaminedInst));
+  brnchOrdrOfst_ =
+      RoundUp(exmndInstsOfst_ + exmndInstCap_ * sizeof(ExaminedInst),
+              alignof(InstCount));
+  rcrdSize_ = RoundUp(brnchOrdrOfst_ + brnchOrdrCap_ * sizeof(InstCount),
+                      alignof(EnumTreeNode));
+
+  rcrdCnt_ = 0;
+  topIndx_ = 0;
+}
+/****************************************************************************/
+
+EnumTreeNodeAlloc::~EnumTreeNodeAlloc() {
+  Reset();
+
+  for (int i = 0; i < rcrdCnt_; i++) {
+    GetNode_(i)->~EnumTreeNode();
+  }
+
+  for (char *blk : blks_) {
+    delete[] blk;
+  }
 }
 /****************************************************************************/
 
-EnumTreeNode::ExaminedInst::~ExaminedInst() {
-  if (tightndScsrs_ != NULL) {
-    for (TightndInst *inst = tightndScsrs_->GetFrstElmnt(); inst != NULL;
-         inst = tightndScsrs_->GetNxtElmnt()) {
-      delete inst;
+void EnumTreeNodeAlloc::AddBlk_() {
+  char *blk = new char[NODE_ARENA_BLK_SIZE * rcrdSize_];
+  if (blk == NULL)
+    Logger::Fatal("Out of memory.");
+
+  for (int i = 0; i < NODE_ARENA_BLK_SIZE; i++) {
+    char *rcrd = blk + i * rcrdSize_;
+    EnumTreeNode *node = new (rcrd) EnumTreeNode;
+    node->rsrvSlotBuf_ = reinterpret_cast<ReserveSlot *>(rcrd + rsrvSlotsOfst_);
+    if (exmndInstCap_ > 0) {
+      node->exmndInsts_ =
+          reinterpret_cast<EnumTreeNode::ExaminedInst *>(rcrd + exmndInstsOfst_);
+    }
+    if (brnchOrdrCap_ > 0) {
+      node->brnchOrdr_ = reinterpret_cast<InstCount *>(rcrd + brnchOrdrOfst_);
     }
-    tightndScsrs_->Reset();
-    delete tightndScsrs_;
   }
+
+  blks_.push_back(blk);
+  rcrdCnt_ += NODE_ARENA_BLK_SIZE;
+}
+/****************************************************************************/
+
+void EnumTreeNodeAlloc::Reset() {
+  // The nodes that are still in the tree own their ready lists, which are
+  // allocated separately.
+  for (int i = 0; i < topIndx_; i++) {
+    EnumTreeNode *node = GetNode_(i);
+    if (!node->isClean_)
+      node->Clean();
+  }
+
+  topIndx_ = 0;
 }
 /****************************************************************************/
 
@@ -463,6 +436,10 @@ Enumerator::Enumerator(DataDepGraph *dataDepGraph, MachineModel *machMdl,
   isCnstrctd_ = false;
   rdyLst_ = NULL;
   prirts_ = prirts;
+
+  enumRdyLst_ = new EnumReadyList(dataDepGraph_, prirts_);
+  if (enumRdyLst_ == NULL)
+    Logger::Fatal("Out of memory.");
   prune_ = prune;
   schedForRPOnly_ = schedForRPOnly;
   enblStallEnum_ = enblStallEnum;
@@ -476,6 +453,12 @@ Enumerator::Enumerator(DataDepGraph *dataDepGraph, MachineModel *machMdl,
   if (rlxdSchdulr_ == NULL)
     Logger::Fatal("Out of memory.");
 
+  trail_ = new UndoTrail(totInstCnt_ * TRAIL_CHNGS_PER_INST);
+  if (trail_ == NULL)
+    Logger::Fatal("Out of memory.");
+
+  rlxdSchdulr_->SetTrail(trail_);
+
   for (int16_t i = 0; i < issuTypeCnt_; i++) {
     neededSlots_[i] = instCntPerIssuType_[i];
 #ifdef IS_DEBUG_ISSUE_TYPES
@@ -488,23 +471,20 @@ Enumerator::Enumerator(DataDepGraph *dataDepGraph, MachineModel *machMdl,
   maxNodeCnt_ = 0;
   createdNodeCnt_ = 0;
   exmndNodeCnt_ = 0;
-  fxdInstCnt_ = 0;
   minUnschduldTplgclOrdr_ = 0;
   backTrackCnt_ = 0;
   fsblSchedCnt_ = 0;
   imprvmntCnt_ = 0;
   prevTrgtLngth_ = INVALID_VALUE;
   rgn_ = NULL;
-
-  int16_t sigSize = 8 * sizeof(InstSignature) - 1;
+  prllState_ = NULL;
 
   Milliseconds histTableInitTime = Utilities::GetProcessorTime();
 
   exmndSubProbs_ = NULL;
 
   if (IsHistDom()) {
-    exmndSubProbs_ =
-        new BinHashTable<HistEnumTreeNode>(sigSize, sigHashSize, true);
+    exmndSubProbs_ = new OpenHashTable<HistEnumTreeNode>(sigHashSize);
     if (exmndSubProbs_ == NULL)
       Logger::Fatal("Out of memory.");
   }
@@ -537,6 +517,12 @@ Enumerator::Enumerator(DataDepGraph *dataDepGraph, MachineModel *machMdl,
   if (tmpLwrBounds_ == NULL)
     Logger::Fatal("Out of memory.");
 
+  srchStrtgy_ = ES_DEPTH_FIRST;
+  beamWidth_ = 0;
+  isSrchCut_ = false;
+  isLngthInfsbl_ = false;
+  brnchRanks_ = NULL;
+
   SetInstSigs_();
   iterNum_ = 0;
   preFxdInstCnt_ = preFxdInstCnt;
@@ -561,27 +547,24 @@ Enumerator::~Enumerator() {
   delete fxdLst_;
   delete bkwrdTightndLst_;
   delete[] tmpLwrBounds_;
+  delete[] brnchRanks_;
+  delete enumRdyLst_;
+  delete trail_;
   tmpHstryNode_->Clean();
   delete tmpHstryNode_;
 }
 /****************************************************************************/
 
 void Enumerator::SetupAllocators_() {
-  int memAllocBlkSize = memAllocBlkSize_;
   int lastInstsEntryCnt = issuRate_ * (dataDepGraph_->GetMaxLtncy());
-  int maxNodeCnt = issuRate_ * schedUprBound_ + 1;
 
-  nodeAlctr_ = new EnumTreeNodeAlloc(maxNodeCnt);
+  nodeAlctr_ = new EnumTreeNodeAlloc(totInstCnt_, issuRate_, prune_.nodeSup,
+                                     srchStrtgy_ != ES_DEPTH_FIRST);
 
   if (nodeAlctr_ == NULL)
     Logger::Fatal("Out of memory.");
 
   if (IsHistDom()) {
-    hashTblEntryAlctr_ =
-        new MemAlloc<BinHashTblEntry<HistEnumTreeNode>>(memAllocBlkSize);
-    if (hashTblEntryAlctr_ == NULL)
-      Logger::Fatal("Out of memory.");
-
     bitVctr1_ = new BitVector(totInstCnt_);
     bitVctr2_ = new BitVector(totInstCnt_);
 
@@ -604,9 +587,6 @@ void Enumerator::SetupAllocators_() {
 
 void Enumerator::ResetAllocators_() {
   nodeAlctr_->Reset();
-
-  if (IsHistDom())
-    hashTblEntryAlctr_->Reset();
 }
 /****************************************************************************/
 
@@ -616,8 +596,6 @@ void Enumerator::FreeAllocators_() {
   delete rlxdSchdulr_;
 
   if (IsHistDom()) {
-    delete hashTblEntryAlctr_;
-    hashTblEntryAlctr_ = NULL;
     delete bitVctr1_;
     delete bitVctr2_;
     delete[] lastInsts_;
@@ -628,7 +606,7 @@ void Enumerator::FreeAllocators_() {
 
 void Enumerator::Reset() {
   if (IsHistDom()) {
-    exmndSubProbs_->Clear(false, hashTblEntryAlctr_);
+    exmndSubProbs_->Clear();
   }
 
   ResetAllocators_();
@@ -656,6 +634,8 @@ bool Enumerator::Initialize_(InstSchedule *sched, InstCount trgtLngth) {
   minUnschduldTplgclOrdr_ = 0;
   backTrackCnt_ = 0;
   iterNum_++;
+  trail_->Reset();
+  isSrchCut_ = false;
 
   if (ConstrainedScheduler::Initialize_(trgtSchedLngth_, fxdLst_) == false) {
     return false;
@@ -698,8 +678,7 @@ bool Enumerator::Initialize_(InstSchedule *sched, InstCount trgtLngth) {
   rlxdSchdulr_->SetupPrirtyLst();
 
   createdNodeCnt_ = 0;
-  fxdInstCnt_ = 0;
-  rdyLst_ = NULL;
+  enumRdyLst_->Reset();
   CreateRootNode_();
   crntNode_ = rootNode_;
   ClearState_();
@@ -748,13 +727,12 @@ void Enumerator::SetInstSigs_() {
 
 void Enumerator::CreateRootNode_() {
   rootNode_ = nodeAlctr_->Alloc(NULL, NULL, this);
-  CreateNewRdyLst_();
-  rootNode_->SetRdyLst(rdyLst_);
-  rootNode_->SetLwrBounds(DIR_FRWRD);
+  rootNode_->SetPrevRdyLstState(enumRdyLst_->GetState());
   assert(rsrvSlotCnt_ == 0);
   rootNode_->SetRsrvSlots(rsrvSlotCnt_, rsrvSlots_);
   InitNewNode_(rootNode_);
   CmtLwrBoundTightnng_();
+  rootNode_->SetTrailSize(trail_->GetSize());
 }
 /*****************************************************************************/
 
@@ -900,7 +878,10 @@ void AppendAndCheckSuffixSchedules(
   }
 
   // Before backtracking, reset the SchedRegion state to where it was before
-  // concatenation.
+  // concatenation. The replay rebuilds the state that the trail already
+  // describes, so it is not recorded.
+  UndoTrail *trail = thisAsLengthCostEnum->GetTrail();
+  trail->Pause();
   rgn_->InitForSchdulng();
   InstCount cycleNum, slotNum;
   for (auto instNum = crntSched_->GetFrstInst(cycleNum, slotNum);
@@ -909,6 +890,7 @@ void AppendAndCheckSuffixSchedules(
     rgn_->SchdulInst(dataDepGraph_->GetInstByIndx(instNum), cycleNum, slotNum,
                      false);
   }
+  trail->Resume();
 }
 } // namespace
 
@@ -925,8 +907,10 @@ FUNC_RESULT Enumerator::FindFeasibleSchedule_(InstSchedule *sched,
     return RES_ERROR;
 
   assert(trgtLngth <= schedUprBound_);
+  isLngthInfsbl_ = false;
 
   if (Initialize_(sched, trgtLngth) == false) {
+    isLngthInfsbl_ = true;
     return RES_FAIL;
   }
 
@@ -934,10 +918,17 @@ FUNC_RESULT Enumerator::FindFeasibleSchedule_(InstSchedule *sched,
   uint64_t prevNodeCnt = exmndNodeCnt_;
 #endif
 
+  // Whether to stop when the cost stops improving fast enough.
+  bool chkImprvmntRate = rgn_ != NULL && rgn_->ChksImprvmntRate();
+
   while (!(allNodesExplrd || WasObjctvMet_())) {
-    if (deadline != INVALID_VALUE && Utilities::GetProcessorTime() > deadline) {
-      isTimeout = true;
-      break;
+    if (deadline != INVALID_VALUE || chkImprvmntRate) {
+      Milliseconds now = Utilities::GetProcessorTime();
+      if ((deadline != INVALID_VALUE && now > deadline) ||
+          (chkImprvmntRate && rgn_->IsImprvmntStalled(now))) {
+        isTimeout = true;
+        break;
+      }
     }
 
     mostRecentMatchingHistNode_ = nullptr;
@@ -998,6 +989,12 @@ FUNC_RESULT Enumerator::FindFeasibleSchedule_(InstSchedule *sched,
   Stats::nodesPerLength.Record(crntNodeCnt);
 #endif
 
+  // Branches pruned for their cost or by history domination, and nodes that
+  // were left unexplored, count as length-feasible, so the root is only
+  // length-infeasible if the length itself rules out every schedule.
+  if (allNodesExplrd && !rootNode_->IsLngthFsbl())
+    isLngthInfsbl_ = true;
+
   if (isTimeout)
     return RES_TIMEOUT;
   // Logger::Info("\nEnumeration at length %d done\n", trgtLngth);
@@ -1016,7 +1013,7 @@ bool Enumerator::FindNxtFsblBrnch_(EnumTreeNode *&newNode) {
   bool isLngthFsbl = true;
 
 #if defined(IS_DEBUG) || defined(IS_DEBUG_READY_LIST)
-  InstCount rdyInstCnt = rdyLst_->GetInstCnt();
+  InstCount rdyInstCnt = enumRdyLst_->GetInstCnt();
 #endif
   assert(crntNode_->IsLeaf() || (brnchCnt != rdyInstCnt) ? 1 : rdyInstCnt);
 // brnchCnt == rdyInstCnt == 0 ? 1 : rdyInstCnt);
@@ -1024,7 +1021,7 @@ bool Enumerator::FindNxtFsblBrnch_(EnumTreeNode *&newNode) {
 #ifdef IS_DEBUG_READY_LIST
   Logger::Info("Ready List Size is %d", rdyInstCnt);
   // Warning! That will reset the instruction iterator!
-  // rdyLst_->Print(Logger::GetLogStream());
+  // enumRdyLst_->Print(Logger::GetLogStream());
 
   Stats::maxReadyListSize.SetMax(rdyInstCnt);
 #endif
@@ -1032,6 +1029,9 @@ bool Enumerator::FindNxtFsblBrnch_(EnumTreeNode *&newNode) {
   if (crntBrnchNum == 0 && schedForRPOnly_)
     crntNode_->SetFoundInstWithUse(IsUseInRdyLst_());
 
+  if (crntBrnchNum == 0 && srchStrtgy_ != ES_DEPTH_FIRST && brnchCnt > 1)
+    RankBrnchs_();
+
   for (i = crntBrnchNum; i < brnchCnt && crntNode_->IsFeasible(); i++) {
 #ifdef IS_DEBUG_FLOW
     Logger::Info("Probing branch %d out of %d", i, brnchCnt);
@@ -1053,7 +1053,23 @@ bool Enumerator::FindNxtFsblBrnch_(EnumTreeNode *&newNode) {
         continue;
       }
     } else {
-      inst = rdyLst_->GetNextPriorityInst();
+      if (crntNode_->IsRankd()) {
+        InstCount indx = crntNode_->GetBrnchOrdr()[i];
+        inst = enumRdyLst_->GetInstAt(indx);
+
+        if (i >= crntNode_->GetRankdBrnchCnt()) {
+          // The branch is outside the beam. It is skipped without being
+          // proven infeasible.
+          crntNode_->NewBranchExmnd(inst, false, false, false, false,
+                                    DIR_FRWRD, true);
+          continue;
+        }
+
+        enumRdyLst_->SetIterator(indx);
+      } else {
+        inst = enumRdyLst_->GetNextPriorityInst();
+      }
+
       assert(inst != NULL);
       bool isLegal = ChkInstLglty_(inst);
       isLngthFsbl = isLegal;
@@ -1094,6 +1110,40 @@ bool Enumerator::FindNxtFsblBrnch_(EnumTreeNode *&newNode) {
 }
 /*****************************************************************************/
 
+void Enumerator::RankBrnchs_() {
+  InstCount rdyInstCnt = crntNode_->GetBranchCnt() - 1;
+  InstCount *ordr = crntNode_->GetBrnchOrdr();
+  assert(rdyInstCnt == enumRdyLst_->GetInstCnt());
+
+  for (InstCount indx = 0; indx < rdyInstCnt; indx++) {
+    ordr[indx] = indx;
+    brnchRanks_[indx] = RankBrnch_(enumRdyLst_->GetInstAt(indx));
+  }
+
+  // Equally ranked branches keep their priority order.
+  InstCount *ranks = brnchRanks_;
+  std::stable_sort(ordr, ordr + rdyInstCnt, [ranks](InstCount a, InstCount b) {
+    return ranks[a] < ranks[b];
+  });
+
+  InstCount rankdCnt = rdyInstCnt;
+
+  if (srchStrtgy_ == ES_BEAM && beamWidth_ < rdyInstCnt) {
+    rankdCnt = beamWidth_;
+    // The search is only cut if a branch outside the beam may be feasible.
+    if (brnchRanks_[ordr[rankdCnt]] != INFSBL_BRNCH_RANK)
+      isSrchCut_ = true;
+  }
+
+  crntNode_->SetRankdBrnchCnt(rankdCnt);
+  // Probing the branches may have matched history nodes.
+  mostRecentMatchingHistNode_ = nullptr;
+}
+/*****************************************************************************/
+
+InstCount Enumerator::RankBrnch_(SchedInstruction *) { return 0; }
+/*****************************************************************************/
+
 bool Enumerator::ProbeBranch_(SchedInstruction *inst, EnumTreeNode *&newNode,
                               bool &isNodeDmntd, bool &isRlxInfsbl,
                               bool &isLngthFsbl) {
@@ -1188,7 +1238,6 @@ bool Enumerator::ProbeBranch_(SchedInstruction *inst, EnumTreeNode *&newNode,
   state_.instFxd = true;
 
   newNode = nodeAlctr_->Alloc(crntNode_, inst, this);
-  newNode->SetLwrBounds(DIR_FRWRD);
   newNode->SetRsrvSlots(rsrvSlotCnt_, rsrvSlots_);
 
   // If a node (sub-problem) that dominates the candidate node (sub-problem)
@@ -1231,6 +1280,9 @@ bool Enumerator::ProbeIssuSlotFsblty_(SchedInstruction *inst) {
   if (issuType != ISSU_STALL) {
     assert(avlblSlotsInCrntCycle_[issuType] > 0);
     assert(avlblSlots_[issuType] > 0);
+    trail_->Save(avlblSlotsInCrntCycle_[issuType]);
+    trail_->Save(avlblSlots_[issuType]);
+    trail_->Save(neededSlots_[issuType]);
     avlblSlotsInCrntCycle_[issuType]--;
     avlblSlots_[issuType]--;
     neededSlots_[issuType]--;
@@ -1246,6 +1298,8 @@ bool Enumerator::ProbeIssuSlotFsblty_(SchedInstruction *inst) {
     // scheduled, because it was not clear then which type was affected
     // by each stall
     if (endOfCycle) {
+      trail_->Save(avlblSlots_[i]);
+      trail_->Save(avlblSlotsInCrntCycle_[i]);
       avlblSlots_[i] -= avlblSlotsInCrntCycle_[i];
       avlblSlotsInCrntCycle_[i] = 0;
     }
@@ -1267,24 +1321,18 @@ void Enumerator::RestoreCrntState_(SchedInstruction *inst,
     }
   }
 
-  if (state_.lwrBoundsTightnd) {
-    UnTightnLwrBounds_(inst);
-  }
-
   if (state_.instSchduld) {
     assert(inst != NULL);
     UndoRsrvSlots_(inst);
     inst->UnSchedule();
   }
 
-  if (state_.issuSlotsProbed) {
-    crntNode_->GetSlotAvlblty(avlblSlots_, avlblSlotsInCrntCycle_);
-
-    if (inst != NULL) {
-      IssueType issuType = inst->GetIssueType();
-      neededSlots_[issuType]++;
-    }
-  }
+  // Undo the slot counts, the tightened lower bounds and the fixed
+  // instructions of the failed probe.
+  trail_->Undo(crntNode_->GetTrailSize());
+  tightndLst_->Reset();
+  dirctTightndLst_->Reset();
+  fxdLst_->Reset();
 
   ClearState_();
 }
@@ -1294,16 +1342,15 @@ void Enumerator::StepFrwrd_(EnumTreeNode *&newNode) {
   SchedInstruction *instToSchdul = newNode->GetInst();
   InstCount instNumToSchdul;
 
-  CreateNewRdyLst_();
-  // Let the new node inherit its parent's ready list before we update it
-  newNode->SetRdyLst(rdyLst_);
+  // Let the new node record the state of the ready list before we update it
+  newNode->SetPrevRdyLstState(enumRdyLst_->GetState());
 
   if (instToSchdul == NULL) {
     instNumToSchdul = SCHD_STALL;
   } else {
     instNumToSchdul = instToSchdul->GetNum();
     SchdulInst_(instToSchdul, crntCycleNum_);
-    rdyLst_->RemoveNextPriorityInst();
+    enumRdyLst_->RemoveNextPriorityInst();
 
     if (instToSchdul->GetTplgclOrdr() == minUnschduldTplgclOrdr_) {
       minUnschduldTplgclOrdr_++;
@@ -1316,6 +1363,7 @@ void Enumerator::StepFrwrd_(EnumTreeNode *&newNode) {
   assert(crntCycleNum_ <= trgtSchedLngth_);
 
   if (crntSlotNum_ == 0) {
+    SaveCycleSlots_();
     InitNewCycle_();
   }
 
@@ -1328,7 +1376,7 @@ void Enumerator::StepFrwrd_(EnumTreeNode *&newNode) {
                instNumToSchdul, crntCycleNum_, crntNode_->GetCostLwrBound());
 #endif
 
-  CmtLwrBoundTightnng_();
+  crntNode_->SetTrailSize(trail_->GetSize());
   ClearState_();
 }
 /*****************************************************************************/
@@ -1344,12 +1392,10 @@ void Enumerator::InitNewNode_(EnumTreeNode *newNode) {
     assert(crntNode_->GetHistory() != tmpHstryNode_);
   }
 
-  crntNode_->SetSlotAvlblty(avlblSlots_, avlblSlotsInCrntCycle_);
-
   UpdtRdyLst_(crntCycleNum_, crntSlotNum_);
   bool isLeaf = schduldInstCnt_ == totInstCnt_;
 
-  crntNode_->SetBranchCnt(rdyLst_->GetInstCnt(), isLeaf);
+  crntNode_->SetBranchCnt(enumRdyLst_->GetInstCnt(), isLeaf);
 
   createdNodeCnt_++;
   crntNode_->SetNum(createdNodeCnt_);
@@ -1488,13 +1534,15 @@ bool Enumerator::BackTrack_() {
   SchedInstruction *inst = crntNode_->GetInst();
   EnumTreeNode *trgtNode = crntNode_->GetParent();
 
-  rdyLst_->RemoveLatestSubList();
+  enumRdyLst_->RestoreState(crntNode_->GetPrevRdyLstState());
 
-  if (IsHistDom()) {
+  // Nodes above the split depth of a parallel enumeration have subtrees that
+  // were partly explored by other workers, so they cannot be used for
+  // history domination.
+  if (IsHistDom() && !IsAboveSplit_(crntNode_)) {
     assert(!crntNode_->IsArchived());
     HistEnumTreeNode *crntHstry = crntNode_->GetHistory();
-    exmndSubProbs_->InsertElement(crntNode_->GetSig(), crntHstry,
-                                  hashTblEntryAlctr_);
+    exmndSubProbs_->InsertElement(crntNode_->GetSig(), crntHstry);
     SetTotalCostsAndSuffixes(crntNode_, trgtNode, trgtSchedLngth_,
                              prune_.useSuffixConcatenation);
     crntNode_->Archive();
@@ -1506,8 +1554,6 @@ bool Enumerator::BackTrack_() {
 
   EnumTreeNode *prevNode = crntNode_;
   crntNode_ = trgtNode;
-  rdyLst_ = crntNode_->GetRdyLst();
-  assert(rdyLst_ != NULL);
 
   MovToPrevSlot_(crntNode_->GetRealSlotNum());
 
@@ -1522,16 +1568,12 @@ bool Enumerator::BackTrack_() {
                trgtNode->GetCostLwrBound());
 #endif
 
-  crntNode_->GetSlotAvlblty(avlblSlots_, avlblSlotsInCrntCycle_);
+  // Restore the slot counts, the lower bounds and the fixed instructions to
+  // what they were when the target node was created.
+  trail_->Undo(trgtNode->GetTrailSize());
   isCrntCycleBlkd_ = crntNode_->GetCrntCycleBlkd();
 
-  if (inst != NULL) {
-    IssueType issuType = inst->GetIssueType();
-    neededSlots_[issuType]++;
-  }
-
   crntSched_->RemoveLastInst();
-  RestoreCrntLwrBounds_(inst);
 
   if (inst != NULL) {
     // int hitCnt;
@@ -1554,18 +1596,17 @@ bool Enumerator::BackTrack_() {
 
 bool Enumerator::WasDmnntSubProbExmnd_(SchedInstruction *,
                                        EnumTreeNode *&newNode) {
+  HistEnumTreeNode *exNode;
+  OpenHashTable<HistEnumTreeNode>::Cursor crsr;
+  int trvrsdListSize = 0;
 #ifdef IS_DEBUG_SPD
   Stats::signatureDominationTests++;
 #endif
-  HistEnumTreeNode *exNode;
-  int listSize = exmndSubProbs_->GetListSize(newNode->GetSig());
-  int trvrsdListSize = 0;
-  Stats::historyListSize.Record(listSize);
   mostRecentMatchingHistNode_ = nullptr;
   bool mostRecentMatchWasSet = false;
 
-  for (exNode = exmndSubProbs_->GetLastMatch(newNode->GetSig()); exNode != NULL;
-       exNode = exmndSubProbs_->GetPrevMatch()) {
+  for (exNode = exmndSubProbs_->GetLastMatch(newNode->GetSig(), crsr);
+       exNode != NULL; exNode = exmndSubProbs_->GetPrevMatch(crsr)) {
     trvrsdListSize++;
 #ifdef IS_DEBUG_SPD
     Stats::signatureMatches++;
@@ -1590,6 +1631,10 @@ bool Enumerator::WasDmnntSubProbExmnd_(SchedInstruction *,
 
         nodeAlctr_->Free(newNode);
         newNode = NULL;
+        // The chains of the older segments, which the lookup has not entered
+        // yet, are not counted.
+        int listSize = crsr.chainLngth;
+        Stats::historyListSize.Record(listSize);
 #ifdef IS_DEBUG_SPD
         Stats::positiveDominationHits++;
         Stats::traversedHistoryListSize.Record(trvrsdListSize);
@@ -1606,6 +1651,7 @@ bool Enumerator::WasDmnntSubProbExmnd_(SchedInstruction *,
     }
   }
 
+  Stats::historyListSize.Record(crsr.chainLngth);
   Stats::traversedHistoryListSize.Record(trvrsdListSize);
   return false;
 }
@@ -1617,6 +1663,13 @@ bool Enumerator::TightnLwrBounds_(SchedInstruction *newInst) {
   InstCount nxtAvlblCycle[MAX_ISSUTYPE_CNT];
   bool fsbl;
   InstCount i;
+  // The scan below reads the state block rather than the instructions, and
+  // only visits an instruction object if its bound needs tightening.
+  const InstStateBlk *blk = dataDepGraph_->GetStateBlk();
+  const InstCount *schedCycle = blk->schedCycle;
+  const InstCount *frwrdLwrBound = blk->crntLwrBound[DIR_FRWRD];
+  const InstCount *bkwrdLwrBound = blk->crntLwrBound[DIR_BKWRD];
+  InstCount lastCycle = trgtSchedLngth_ - 1;
 
   assert(fxdLst_->GetElmntCnt() == 0);
   assert(tightndLst_->GetElmntCnt() == 0);
@@ -1636,72 +1689,60 @@ bool Enumerator::TightnLwrBounds_(SchedInstruction *newInst) {
   }
 
   for (i = minUnschduldTplgclOrdr_; i < totInstCnt_; i++) {
-    inst = dataDepGraph_->GetInstByTplgclOrdr(i);
-    assert(inst != newInst ||
-           inst->GetCrntLwrBound(DIR_FRWRD) == crntCycleNum_);
+    InstCount instNum = blk->tplgclOrdr[i];
+    assert(newInst == NULL || instNum != newInst->GetNum() ||
+           frwrdLwrBound[instNum] == crntCycleNum_);
 
-    if (inst->IsSchduld() == false) {
-      IssueType issuType = inst->GetIssueType();
-      newLwrBound = nxtAvlblCycle[issuType];
+    if (schedCycle[instNum] == SCHD_UNSCHDULD) {
+      newLwrBound = nxtAvlblCycle[blk->issuType[instNum]];
 
-      if (newLwrBound > inst->GetCrntLwrBound(DIR_FRWRD)) {
+      if (newLwrBound > frwrdLwrBound[instNum]) {
+        inst = blk->insts[instNum];
 #ifdef IS_DEBUG_FLOW
-        Logger::Info("Tightening LB of inst %d from %d to %d", inst->GetNum(),
-                     inst->GetCrntLwrBound(DIR_FRWRD), newLwrBound);
+        Logger::Info("Tightening LB of inst %d from %d to %d", instNum,
+                     frwrdLwrBound[instNum], newLwrBound);
 #endif
         fsbl = inst->TightnLwrBoundRcrsvly(DIR_FRWRD, newLwrBound, tightndLst_,
                                            fxdLst_, false);
 
         if (fsbl == false) {
-          return false;
+          break;
         }
       }
 
-      assert(inst->GetCrntLwrBound(DIR_FRWRD) >= newLwrBound);
+      assert(frwrdLwrBound[instNum] >= newLwrBound);
 
-      if (inst->GetCrntLwrBound(DIR_FRWRD) > inst->GetCrntDeadline()) {
-        return false;
+      // The forward bound is past the deadline.
+      if (frwrdLwrBound[instNum] + bkwrdLwrBound[instNum] > lastCycle) {
+        fsbl = false;
+        break;
       }
     }
   }
 
-  for (inst = tightndLst_->GetFrstElmnt(); inst != NULL;
-       inst = tightndLst_->GetNxtElmnt()) {
-    dataDepGraph_->SetCrntFrwrdLwrBound(inst);
+  // Record the tightening on the trail even if it failed half way, so that
+  // undoing the probe restores the bounds.
+  CmtLwrBoundTightnng_();
+
+  if (fsbl == false) {
+    return false;
   }
 
   return FixInsts_(newInst);
 }
 /****************************************************************************/
 
-void Enumerator::UnTightnLwrBounds_(SchedInstruction *newInst) {
-  UnFixInsts_(newInst);
-
-  SchedInstruction *inst;
-
-  for (inst = tightndLst_->GetFrstElmnt(); inst != NULL;
-       inst = tightndLst_->GetNxtElmnt()) {
-    inst->UnTightnLwrBounds();
-    dataDepGraph_->SetCrntFrwrdLwrBound(inst);
-    assert(inst->IsFxd() == false);
-  }
-
-  tightndLst_->Reset();
-  dirctTightndLst_->Reset();
-}
-/*****************************************************************************/
-
 void Enumerator::CmtLwrBoundTightnng_() {
   SchedInstruction *inst;
 
   for (inst = tightndLst_->GetFrstElmnt(); inst != NULL;
        inst = tightndLst_->GetNxtElmnt()) {
-    inst->CmtLwrBoundTightnng();
+    inst->CmtLwrBoundTightnng(trail_);
+    dataDepGraph_->SetCrntFrwrdLwrBound(inst, trail_);
   }
 
   tightndLst_->Reset();
   dirctTightndLst_->Reset();
-  CmtInstFxng_();
 }
 /*****************************************************************************/
 
@@ -1710,8 +1751,6 @@ bool Enumerator::FixInsts_(SchedInstruction *newInst) {
 
   bool newInstFxd = false;
 
-  fxdInstCnt_ = 0;
-
   for (SchedInstruction *inst = fxdLst_->GetFrstElmnt(); inst != NULL;
        inst = fxdLst_->GetNxtElmnt()) {
     assert(inst->IsFxd());
@@ -1730,8 +1769,6 @@ bool Enumerator::FixInsts_(SchedInstruction *newInst) {
 #endif
       break;
     }
-
-    fxdInstCnt_++;
   }
 
   if (fsbl)
@@ -1740,79 +1777,12 @@ bool Enumerator::FixInsts_(SchedInstruction *newInst) {
       // We need to fix the new inst. only if it has not been fixed before
       {
         fsbl = rlxdSchdulr_->FixInst(newInst, crntCycleNum_);
-
-        if (fsbl) {
-          fxdLst_->InsrtElmnt(newInst);
-          fxdInstCnt_++;
-        }
       }
     }
 
-  return fsbl;
-}
-/*****************************************************************************/
-
-void Enumerator::UnFixInsts_(SchedInstruction *newInst) {
-  InstCount unfxdInstCnt = 0;
-  SchedInstruction *inst;
-
-  for (inst = fxdLst_->GetFrstElmnt(), unfxdInstCnt = 0;
-       inst != NULL && unfxdInstCnt < fxdInstCnt_;
-       inst = fxdLst_->GetNxtElmnt(), unfxdInstCnt++) {
-    assert(inst->IsFxd() || inst == newInst);
-    InstCount cycle = inst == newInst ? crntCycleNum_ : inst->GetFxdCycle();
-    rlxdSchdulr_->UnFixInst(inst, cycle);
-  }
-
-  assert(unfxdInstCnt == fxdInstCnt_);
+  // The fixing is on the trail, so the list is no longer needed.
   fxdLst_->Reset();
-  fxdInstCnt_ = 0;
-}
-/*****************************************************************************/
-
-void Enumerator::CmtInstFxng_() {
-  fxdLst_->Reset();
-  fxdInstCnt_ = 0;
-}
-/*****************************************************************************/
-
-void Enumerator::RestoreCrntLwrBounds_(SchedInstruction *unschduldInst) {
-  InstCount *frwrdLwrBounds = crntNode_->GetLwrBounds(DIR_FRWRD);
-  bool unschduldInstDone = false;
-
-  for (InstCount i = 0; i < totInstCnt_; i++) {
-    SchedInstruction *inst = dataDepGraph_->GetInstByIndx(i);
-    InstCount fxdCycle = 0;
-    bool preFxd = inst->IsFxd();
-
-    if (preFxd) {
-      fxdCycle = inst->GetFxdCycle();
-    }
-
-    inst->SetCrntLwrBound(DIR_FRWRD, frwrdLwrBounds[i]);
-    dataDepGraph_->SetCrntFrwrdLwrBound(inst);
-    bool postFxd = inst->IsFxd();
-
-    if (preFxd && !postFxd) { // if got untightened and unfixed
-      rlxdSchdulr_->UnFixInst(inst, fxdCycle);
-
-      if (inst == unschduldInst) {
-        unschduldInstDone = true;
-      }
-    }
-  }
-
-  if (unschduldInst != NULL && !unschduldInstDone) {
-    // Assume that the instruction has not been unscheduled yet
-    // i.e. lower bound restoration occurs before unscheduling
-    assert(unschduldInst->IsSchduld());
-
-    if (unschduldInst->IsFxd() == false)
-    // only if the untightening got it unfixed
-    {
-      rlxdSchdulr_->UnFixInst(unschduldInst, unschduldInst->GetSchedCycle());
-    }
-  }
+  return fsbl;
 }
 /*****************************************************************************/
 
@@ -1835,8 +1805,6 @@ bool Enumerator::RlxdSchdul_(EnumTreeNode *newNode) {
       return false;
     }
 
-    fxdLst_->InsrtElmnt(inst);
-    fxdInstCnt_++;
 #ifdef IS_DEBUG_FIX
     Logger::Info("%d [%d], ", inst->GetNum(), inst->GetFxdCycle());
 #endif
@@ -1850,7 +1818,7 @@ bool Enumerator::RlxdSchdul_(EnumTreeNode *newNode) {
 /*****************************************************************************/
 
 bool Enumerator::IsUseInRdyLst_() {
-  assert(rdyLst_ != NULL);
+  assert(enumRdyLst_ != NULL);
   bool isEmptyNode = false;
   InstCount brnchCnt = crntNode_->GetBranchCnt(isEmptyNode);
   SchedInstruction *inst;
@@ -1859,15 +1827,15 @@ bool Enumerator::IsUseInRdyLst_() {
 #ifdef IS_DEBUG_RP_ONLY
   Logger::Info("Looking for a use in the ready list with nodes:");
   for (int i = 0; i < brnchCnt - 1; i++) {
-    inst = rdyLst_->GetNextPriorityInst();
+    inst = enumRdyLst_->GetNextPriorityInst();
     assert(inst != NULL);
     Logger::Info("#%d:%d", i, inst->GetNum());
   }
-  rdyLst_->ResetIterator();
+  enumRdyLst_->ResetIterator();
 #endif
 
   for (int i = 0; i < brnchCnt - 1; i++) {
-    inst = rdyLst_->GetNextPriorityInst();
+    inst = enumRdyLst_->GetNextPriorityInst();
     assert(inst != NULL);
     if (inst->GetAdjustedUseCnt() != 0 || dataDepGraph_->DoesFeedUser(inst)) {
       foundUse = true;
@@ -1881,7 +1849,7 @@ bool Enumerator::IsUseInRdyLst_() {
 #endif
   }
 
-  rdyLst_->ResetIterator();
+  enumRdyLst_->ResetIterator();
   return foundUse;
 }
 /*****************************************************************************/
@@ -1996,11 +1964,25 @@ LengthCostEnumerator::LengthCostEnumerator(
     DataDepGraph *dataDepGraph, MachineModel *machMdl, InstCount schedUprBound,
     int16_t sigHashSize, SchedPriorities prirts, Pruning prune,
     bool schedForRPOnly, bool enblStallEnum, Milliseconds timeout,
-    SPILL_COST_FUNCTION spillCostFunc, InstCount preFxdInstCnt,
-    SchedInstruction *preFxdInsts[])
+    SPILL_COST_FUNCTION spillCostFunc, ENUM_SEARCH srchStrtgy, int beamWidth,
+    InstCount preFxdInstCnt, SchedInstruction *preFxdInsts[])
     : Enumerator(dataDepGraph, machMdl, schedUprBound, sigHashSize, prirts,
                  prune, schedForRPOnly, enblStallEnum, timeout, preFxdInstCnt,
                  preFxdInsts) {
+  srchStrtgy_ = srchStrtgy;
+  beamWidth_ = beamWidth;
+
+  if (srchStrtgy_ != ES_DEPTH_FIRST) {
+    brnchRanks_ = new InstCount[totInstCnt_];
+    if (brnchRanks_ == NULL)
+      Logger::Fatal("Out of memory.");
+  }
+
+  // A beam search does not explore the whole tree, so the absence of a
+  // better schedule below a node cannot be recorded in the history table.
+  if (srchStrtgy_ == ES_BEAM)
+    prune_.histDom = false;
+
   SetupAllocators_();
 
   costChkCnt_ = 0;
@@ -2008,6 +1990,10 @@ LengthCostEnumerator::LengthCostEnumerator(
   isEarlySubProbDom_ = false;
   costLwrBound_ = 0;
   spillCostFunc_ = spillCostFunc;
+  isFsbltyProbe_ = false;
+  itemCrsr_ = NULL;
+  rchdItemCnt_ = 0;
+  clmdItemIndx_ = INVALID_VALUE;
   tmpHstryNode_ = new CostHistEnumTreeNode;
   if (tmpHstryNode_ == NULL)
     Logger::Fatal("Out of memory.");
@@ -2077,6 +2063,16 @@ FUNC_RESULT LengthCostEnumerator::FindFeasibleSchedule(InstSchedule *sched,
                                                        Milliseconds deadline) {
   rgn_ = rgn;
   costLwrBound_ = costLwrBound;
+
+  // A probe searches the whole tree by itself, since the items it claimed
+  // would be skipped by a full enumeration of the same length, and it leaves
+  // them as soon as it finds a schedule.
+  itemCrsr_ = NULL;
+  if (prllState_ != NULL && !isFsbltyProbe_)
+    itemCrsr_ = &prllState_->GetItemCrsr(trgtLngth);
+  rchdItemCnt_ = 0;
+  clmdItemIndx_ = INVALID_VALUE;
+
   FUNC_RESULT rslt = FindFeasibleSchedule_(sched, trgtLngth, deadline);
 
 #ifdef IS_DEBUG_TRACE_ENUM
@@ -2106,7 +2102,7 @@ bool LengthCostEnumerator::WasObjctvMet_() {
     imprvmntCnt_++;
   }
 
-  return newCost == costLwrBound_;
+  return newCost == costLwrBound_ || isFsbltyProbe_;
 }
 /*****************************************************************************/
 
@@ -2127,13 +2123,21 @@ bool LengthCostEnumerator::ProbeBranch_(SchedInstruction *inst,
 
   isLngthFsbl = true;
 
+  // In a parallel enumeration, each subtree rooted at the split depth is
+  // explored by the worker that claims it. The items must be counted before
+  // any check that depends on the best cost or the history of this worker,
+  // so that every worker counts them alike.
+  if (itemCrsr_ != NULL &&
+      newNode->GetTime() == prllState_->GetSplitDepth() && !ClaimWorkItem_())
+    return false;
+
   isFsbl = ChkCostFsblty_(inst, newNode);
 
   if (isFsbl == false) {
     return false;
   }
 
-  if (IsHistDom()) {
+  if (IsHistDom() && !IsAboveSplit_(newNode)) {
     assert(newNode != NULL);
     EnumTreeNode *parent = newNode->GetParent();
 
@@ -2155,6 +2159,18 @@ bool LengthCostEnumerator::ProbeBranch_(SchedInstruction *inst,
 }
 /*****************************************************************************/
 
+bool LengthCostEnumerator::ClaimWorkItem_() {
+  InstCount itemIndx = rchdItemCnt_++;
+
+  if (itemIndx > clmdItemIndx_)
+    clmdItemIndx_ = itemCrsr_->fetch_add(1, std::memory_order_relaxed);
+
+  // The items before the claimed one were claimed by other workers.
+  assert(itemIndx <= clmdItemIndx_);
+  return itemIndx == clmdItemIndx_;
+}
+/*****************************************************************************/
+
 bool LengthCostEnumerator::ChkCostFsblty_(SchedInstruction *inst,
                                           EnumTreeNode *&newNode) {
   bool isFsbl = true;
@@ -2163,8 +2179,13 @@ bool LengthCostEnumerator::ChkCostFsblty_(SchedInstruction *inst,
 
   rgn_->SchdulInst(inst, crntCycleNum_, crntSlotNum_, false);
 
+  // The check also sets the node's costs, which a probe needs for history
+  // domination even though it ignores the result. Nodes above the split depth
+  // are not pruned either, since the best cost differs between the workers,
+  // which must all reach the same work items.
   if (prune_.spillCost) {
-    isFsbl = rgn_->ChkCostFsblty(trgtSchedLngth_, newNode);
+    isFsbl = rgn_->ChkCostFsblty(trgtSchedLngth_, newNode) || isFsbltyProbe_ ||
+             IsAboveSplit_(newNode);
 
     if (!isFsbl) {
       costPruneCnt_++;
@@ -2181,6 +2202,34 @@ bool LengthCostEnumerator::ChkCostFsblty_(SchedInstruction *inst,
 }
 /*****************************************************************************/
 
+InstCount LengthCostEnumerator::RankBrnch_(SchedInstruction *inst) {
+  if (!ChkInstLglty_(inst))
+    return INFSBL_BRNCH_RANK;
+
+  EnumTreeNode *newNode;
+  bool isNodeDmntd = false, isRlxInfsbl = false, isLngthFsbl = true;
+  InstCount rank = INFSBL_BRNCH_RANK;
+
+  // The cost check and the history check of ProbeBranch_() are left to the
+  // real probe, which is also where a parallel work item is skipped if another
+  // worker claimed it. The work items and their ancestors are ranked whatever
+  // the best cost, so that every worker reaches the items in the same order.
+  if (Enumerator::ProbeBranch_(inst, newNode, isNodeDmntd, isRlxInfsbl,
+                               isLngthFsbl)) {
+    rgn_->SchdulInst(inst, crntCycleNum_, crntSlotNum_, false);
+
+    if (rgn_->ChkCostFsblty(trgtSchedLngth_, newNode) || isFsbltyProbe_ ||
+        IsAboveSplit_(crntNode_))
+      rank = newNode->GetCostLwrBound();
+
+    rgn_->UnschdulInst(inst, crntCycleNum_, crntSlotNum_, crntNode_);
+  }
+
+  RestoreCrntState_(inst, newNode);
+  return rank;
+}
+/*****************************************************************************/
+
 bool LengthCostEnumerator::BackTrack_() {
   SchedInstruction *inst = crntNode_->GetInst();
 
@@ -2188,7 +2237,7 @@ bool LengthCostEnumerator::BackTrack_() {
 
   bool fsbl = Enumerator::BackTrack_();
 
-  if (prune_.spillCost) {
+  if (prune_.spillCost && !isFsbltyProbe_ && !IsAboveSplit_(crntNode_)) {
     if (fsbl) {
       assert(crntNode_->GetCostLwrBound() >= 0);
       fsbl = crntNode_->GetCostLwrBound() < GetBestCost_();
@@ -2204,9 +2253,7 @@ InstCount LengthCostEnumerator::GetBestCost_() { return rgn_->GetBestCost(); }
 
 void LengthCostEnumerator::CreateRootNode_() {
   rootNode_ = nodeAlctr_->Alloc(NULL, NULL, this);
-  CreateNewRdyLst_();
-  rootNode_->SetRdyLst(rdyLst_);
-  rootNode_->SetLwrBounds(DIR_FRWRD);
+  rootNode_->SetPrevRdyLstState(enumRdyLst_->GetState());
 
   assert(rsrvSlotCnt_ == 0);
   rootNode_->SetRsrvSlots(rsrvSlotCnt_, rsrvSlots_);
@@ -2218,6 +2265,7 @@ void LengthCostEnumerator::CreateRootNode_() {
 
   InitNewNode_(rootNode_);
   CmtLwrBoundTightnng_();
+  rootNode_->SetTrailSize(trail_->GetSize());
 }
 /*****************************************************************************/
 
@@ -144,15 +144,21 @@ bool ConstrainedScheduler::Initialize_(InstCount trgtSchedLngth,
 }
 
 void ConstrainedScheduler::SchdulInst_(SchedInstruction *inst, InstCount) {
-  InstCount prdcsrNum, scsrRdyCycle;
+  InstStateBlk *blk = dataDepGraph_->GetStateBlk();
+  InstCount instNum = inst->GetNum();
+  InstCount end = blk->GetNghbrEndIndx(DIR_FRWRD, instNum);
+  InstCount scsrRdyCycle;
 
   // Notify each successor of this instruction that it has been scheduled.
-  for (SchedInstruction *crntScsr = inst->GetFrstScsr(&prdcsrNum);
-       crntScsr != NULL; crntScsr = inst->GetNxtScsr(&prdcsrNum)) {
-    bool wasLastPrdcsr =
-        crntScsr->PrdcsrSchduld(prdcsrNum, crntCycleNum_, scsrRdyCycle);
+  // Only the state block is touched, unless the successor becomes ready.
+  for (InstCount i = blk->GetFrstNghbrIndx(DIR_FRWRD, instNum); i < end; i++) {
+    InstCount scsrNum = blk->nghbrs[DIR_FRWRD][i];
+    bool wasLastPrdcsr = blk->PrdcsrSchduld(scsrNum, blk->prdcsrNumInScsr[i],
+                                            crntCycleNum_, scsrRdyCycle);
 
     if (wasLastPrdcsr) {
+      SchedInstruction *crntScsr = blk->insts[scsrNum];
+
       // If all other predecessors of this successor have been scheduled then
       // we now know in which cycle this successor will become ready.
       assert(scsrRdyCycle < schedUprBound_);
@@ -179,7 +185,10 @@ void ConstrainedScheduler::SchdulInst_(SchedInstruction *inst, InstCount) {
 }
 
 void ConstrainedScheduler::UnSchdulInst_(SchedInstruction *inst) {
-  InstCount prdcsrNum, scsrRdyCycle;
+  InstStateBlk *blk = dataDepGraph_->GetStateBlk();
+  InstCount instNum = inst->GetNum();
+  InstCount strt = blk->GetFrstNghbrIndx(DIR_FRWRD, instNum);
+  InstCount scsrRdyCycle;
 
   assert(inst->IsSchduld());
 
@@ -187,11 +196,15 @@ void ConstrainedScheduler::UnSchdulInst_(SchedInstruction *inst) {
   // The successors are visted in the reverse order so that each one will be
   // at the bottom of its first-ready list (if the scheduling of this
   // instruction has caused it to go there).
-  for (SchedInstruction *crntScsr = inst->GetLastScsr(&prdcsrNum);
-       crntScsr != NULL; crntScsr = inst->GetPrevScsr(&prdcsrNum)) {
-    bool wasLastPrdcsr = crntScsr->PrdcsrUnSchduld(prdcsrNum, scsrRdyCycle);
+  for (InstCount i = blk->GetNghbrEndIndx(DIR_FRWRD, instNum) - 1; i >= strt;
+       i--) {
+    InstCount scsrNum = blk->nghbrs[DIR_FRWRD][i];
+    bool wasLastPrdcsr =
+        blk->PrdcsrUnSchduld(scsrNum, blk->prdcsrNumInScsr[i], scsrRdyCycle);
 
     if (wasLastPrdcsr) {
+      SchedInstruction *crntScsr = blk->insts[scsrNum];
+
       // If this predecessor was the last to schedule and thus resolved the
       // cycle in which this successor will become ready, then this successor
       // must now be taken out of the first ready list for the cycle in which
@@ -292,7 +305,9 @@ bool ConstrainedScheduler::ChkInstLglty_(SchedInstruction *inst) {
   if (isCrntCycleBlkd_)
     return false;
   // Logger::Info("Cycle not blocked");
-  if (inst->BlocksCycle() && crntSlotNum_ != 0)
+  const InstStateBlk *blk = dataDepGraph_->GetStateBlk();
+  InstCount instNum = inst->GetNum();
+  if (blk->blksCycle[instNum] && crntSlotNum_ != 0)
     return false;
   // Logger::Info("Does not block cycle");
   if (includesUnpipelined_ && rsrvSlots_ &&
@@ -302,7 +317,7 @@ bool ConstrainedScheduler::ChkInstLglty_(SchedInstruction *inst) {
   }
   // Logger::Info("Pipelining OK");
 
-  IssueType issuType = inst->GetIssueType();
+  IssueType issuType = blk->issuType[instNum];
   assert(issuType < issuTypeCnt_);
   assert(avlblSlotsInCrntCycle_[issuType] >= 0);
   // Logger::Info("avlblSlots = %d", avlblSlotsInCrntCycle_[issuType]);
@@ -3,7 +3,9 @@
 #include "llvm/CodeGen/OptSched/generic/defines.h"
 #include "llvm/CodeGen/OptSched/generic/lnkd_lst.h"
 #include "llvm/CodeGen/OptSched/generic/logger.h"
+#include <algorithm>
 #include <cstdio>
+#include <cstring>
 
 namespace opt_sched {
 
@@ -22,6 +24,7 @@ GraphNode::GraphNode(UDT_GNODES num, UDT_GNODES maxNodeCnt) {
 
   rcrsvScsrLst_ = NULL;
   rcrsvPrdcsrLst_ = NULL;
+  grphTplgclOrdr_ = NULL;
   isRcrsvScsr_ = NULL;
   isRcrsvPrdcsr_ = NULL;
 }
@@ -85,7 +88,27 @@ void GraphNode::DepthFirstVisit(GraphNode *tplgclOrdr[],
 }
 
 void GraphNode::FindRcrsvNghbrs(DIRECTION dir, DirAcycGraph *graph) {
-  FindRcrsvNghbrs_(this, dir, graph);
+  LinkedList<GraphEdge> *nghbrLst = (dir == DIR_FRWRD) ? scsrLst_ : prdcsrLst_;
+  BitVector *isRcrsvNghbr = GetRcrsvNghbrBitVector(dir);
+
+  for (GraphEdge *crntEdge = nghbrLst->GetFrstElmnt(); crntEdge != NULL;
+       crntEdge = nghbrLst->GetNxtElmnt()) {
+    GraphNode *nghbr = crntEdge->GetOtherNode(this);
+
+    // In a DAG, successors come after a node in topological order and
+    // predecessors come before it. An edge that goes the other way closes a
+    // cycle, and the neighbor's bitset is not complete yet.
+    if ((dir == DIR_FRWRD && nghbr->tplgclOrdr_ <= tplgclOrdr_) ||
+        (dir == DIR_BKWRD && nghbr->tplgclOrdr_ >= tplgclOrdr_)) {
+      graph->CycleDetected();
+      Logger::Info("Detected a cycle between nodes %d and %d in graph", num_,
+                   nghbr->GetNum());
+      continue;
+    }
+
+    isRcrsvNghbr->Union(*nghbr->GetRcrsvNghbrBitVector(dir));
+    isRcrsvNghbr->SetBit(nghbr->GetNum());
+  }
 }
 
 void GraphNode::AddRcrsvNghbr(GraphNode *nghbr, DIRECTION dir) {
@@ -96,6 +119,76 @@ void GraphNode::AddRcrsvNghbr(GraphNode *nghbr, DIRECTION dir) {
   isRcrsvNghbr->SetBit(nghbr->GetNum());
 }
 
+void GraphNode::AddRcrsvNghbrs(DIRECTION dir, const BitVector &nghbrs) {
+  LinkedList<GraphNode> *&rcrsvNghbrLst =
+      dir == DIR_FRWRD ? rcrsvScsrLst_ : rcrsvPrdcsrLst_;
+  BitVector *isRcrsvNghbr = GetRcrsvNghbrBitVector(dir);
+
+  if (nghbrs.IsSubVector(isRcrsvNghbr))
+    return;
+
+  isRcrsvNghbr->Union(nghbrs);
+
+  // The list is sorted by the topological order, so it is rebuilt rather than
+  // extended.
+  if (rcrsvNghbrLst != NULL) {
+    delete rcrsvNghbrLst;
+    rcrsvNghbrLst = NULL;
+  }
+}
+
+void GraphNode::AttachRcrsvInfo(DIRECTION dir, BitVector::Unit *row,
+                                UDT_GNODES nodeCnt, GraphNode **tplgclOrdr) {
+  LinkedList<GraphNode> *&rcrsvNghbrLst =
+      dir == DIR_FRWRD ? rcrsvScsrLst_ : rcrsvPrdcsrLst_;
+  BitVector *&isRcrsvNghbr = dir == DIR_FRWRD ? isRcrsvScsr_ : isRcrsvPrdcsr_;
+
+  // A list that was built for an older closure is stale.
+  if (rcrsvNghbrLst != NULL) {
+    delete rcrsvNghbrLst;
+    rcrsvNghbrLst = NULL;
+  }
+
+  if (isRcrsvNghbr == NULL) {
+    isRcrsvNghbr = new BitVector;
+    if (isRcrsvNghbr == NULL)
+      Logger::Fatal("Out of memory.");
+  }
+
+  isRcrsvNghbr->Attach(row, nodeCnt);
+  grphTplgclOrdr_ = tplgclOrdr;
+}
+
+void GraphNode::BuildRcrsvNghbrLst_(DIRECTION dir) {
+  LinkedList<GraphNode> *&rcrsvNghbrLst =
+      dir == DIR_FRWRD ? rcrsvScsrLst_ : rcrsvPrdcsrLst_;
+  BitVector *isRcrsvNghbr = GetRcrsvNghbrBitVector(dir);
+  UDT_GNODES nodeCnt = isRcrsvNghbr->GetSize();
+
+  assert(rcrsvNghbrLst == NULL && grphTplgclOrdr_ != NULL);
+  rcrsvNghbrLst = new LinkedList<GraphNode>;
+  if (rcrsvNghbrLst == NULL)
+    Logger::Fatal("Out of memory.");
+
+  // Only the nodes on this node's side of the topological order can be
+  // neighbors. They are listed from the farthest one inward.
+  if (dir == DIR_FRWRD) {
+    for (UDT_GNODES i = nodeCnt - 1; i > tplgclOrdr_; i--) {
+      GraphNode *node = grphTplgclOrdr_[i];
+      if (isRcrsvNghbr->GetBit(node->GetNum()))
+        rcrsvNghbrLst->InsrtElmnt(node);
+    }
+  } else {
+    for (UDT_GNODES i = 0; i < tplgclOrdr_; i++) {
+      GraphNode *node = grphTplgclOrdr_[i];
+      if (isRcrsvNghbr->GetBit(node->GetNum()))
+        rcrsvNghbrLst->InsrtElmnt(node);
+    }
+  }
+
+  assert(rcrsvNghbrLst->GetElmntCnt() == isRcrsvNghbr->GetOneCnt());
+}
+
 void GraphNode::AllocRcrsvInfo(DIRECTION dir, UDT_GNODES nodeCnt) {
   if (dir == DIR_FRWRD) {
     if (rcrsvScsrLst_ != NULL) {
@@ -189,46 +282,6 @@ bool GraphNode::FindScsr_(GraphNode *&crntScsr, UDT_GNODES trgtNum,
   return false;
 }
 
-void GraphNode::FindRcrsvNghbrs_(GraphNode *root, DIRECTION dir,
-                                 DirAcycGraph *graph) {
-  LinkedList<GraphEdge> *nghbrLst = (dir == DIR_FRWRD) ? scsrLst_ : prdcsrLst_;
-
-  color_ = COL_GRAY;
-
-  // Iterate through the neighbor list of this node and recursively visit them
-  // This recursion will bottom up when the root or leaf node is reached, which
-  // then gets added to the very top of the recursive neighbor list.
-  for (GraphEdge *crntEdge = nghbrLst->GetFrstElmnt(); crntEdge != NULL;
-       crntEdge = nghbrLst->GetNxtElmnt()) {
-    GraphNode *nghbr = crntEdge->GetOtherNode(this);
-    if (nghbr->GetColor() == COL_WHITE) {
-      nghbr->FindRcrsvNghbrs_(root, dir, graph);
-    }
-  }
-
-  // When all the neighbors of this node have been recursively visited, the
-  // node is finished. It is marked black and inserted in the recursive list.
-  color_ = COL_BLACK;
-
-  if (this != root) {
-
-    // Check if there is a cycle in the graph
-    BitVector *thisBitVector = this->GetRcrsvNghbrBitVector(dir);
-    if (thisBitVector && thisBitVector->GetBit(root->GetNum()) == true) {
-      graph->CycleDetected();
-      Logger::Info("Detected a cycle between nodes %d and %d in graph",
-                   root->GetNum(), this->GetNum());
-    }
-
-    // Add this node to the recursive neighbor list of the root node of
-    // this search.
-    root->GetRcrsvNghbrLst(dir)->InsrtElmnt(this);
-    // Set the corresponding boolean vector entry to indicate that this
-    // node is a recursive neighbor of the root node of this search.
-    root->GetRcrsvNghbrBitVector(dir)->SetBit(num_);
-  }
-}
-
 bool GraphNode::IsScsrEquvlnt(GraphNode *othrNode) {
   UDT_GLABEL thisLbl = 0;
   UDT_GLABEL othrLbl = 0;
@@ -328,6 +381,8 @@ DirAcycGraph::DirAcycGraph() {
   maxScsrCnt_ = 0;
   root_ = leaf_ = NULL;
   tplgclOrdr_ = NULL;
+  rcrsvNghbrBits_[DIR_FRWRD] = NULL;
+  rcrsvNghbrBits_[DIR_BKWRD] = NULL;
   dpthFrstSrchDone_ = false;
   cycleDetected_ = false;
 }
@@ -335,6 +390,10 @@ DirAcycGraph::DirAcycGraph() {
 DirAcycGraph::~DirAcycGraph() {
   if (tplgclOrdr_ != NULL)
     delete[] tplgclOrdr_;
+  if (rcrsvNghbrBits_[DIR_FRWRD] != NULL)
+    delete[] rcrsvNghbrBits_[DIR_FRWRD];
+  if (rcrsvNghbrBits_[DIR_BKWRD] != NULL)
+    delete[] rcrsvNghbrBits_[DIR_BKWRD];
 }
 
 void DirAcycGraph::CreateEdge_(UDT_GNODES frmNodeNum, UDT_GNODES toNodeNum,
@@ -380,36 +439,89 @@ FUNC_RESULT DirAcycGraph::DepthFirstSearch() {
 }
 
 FUNC_RESULT DirAcycGraph::FindRcrsvNghbrs(DIRECTION dir) {
-  for (UDT_GNODES i = 0; i < nodeCnt_; i++) {
-    GraphNode *node = nodes_[i];
-
-    // Set the colors of all nodes to white (not visited yet) before starting
-    // each recursive search.
-    for (UDT_GNODES j = 0; j < nodeCnt_; j++) {
-      nodes_[j]->SetColor(COL_WHITE);
-    }
+  assert(dpthFrstSrchDone_);
+  int unitCnt = BitVector::GetUnitCnt(nodeCnt_);
+  size_t mtrxSize = (size_t)nodeCnt_ * unitCnt;
+
+  if (rcrsvNghbrBits_[dir] != NULL)
+    delete[] rcrsvNghbrBits_[dir];
+  rcrsvNghbrBits_[dir] = new BitVector::Unit[mtrxSize];
+  if (rcrsvNghbrBits_[dir] == NULL)
+    Logger::Fatal("Out of memory.");
+  memset(rcrsvNghbrBits_[dir], 0, mtrxSize * sizeof(BitVector::Unit));
 
-    node->AllocRcrsvInfo(dir, nodeCnt_);
+  for (UDT_GNODES i = 0; i < nodeCnt_; i++) {
+    assert(nodes_[i]->GetNum() == i);
+    nodes_[i]->AttachRcrsvInfo(dir, rcrsvNghbrBits_[dir] + (size_t)i * unitCnt,
+                               nodeCnt_, tplgclOrdr_);
+  }
 
+  // Visit each node after all of its neighbors in the given direction.
+  for (UDT_GNODES i = 0; i < nodeCnt_; i++) {
+    GraphNode *node = tplgclOrdr_[dir == DIR_FRWRD ? nodeCnt_ - 1 - i : i];
     node->FindRcrsvNghbrs(dir, this);
-
-    assert((dir == DIR_FRWRD &&
-            node->GetRcrsvNghbrLst(dir)->GetFrstElmnt() == leaf_) ||
-           (dir == DIR_BKWRD &&
-            node->GetRcrsvNghbrLst(dir)->GetFrstElmnt() == root_) ||
-           node == root_ || node == leaf_);
-    assert(node != root_ ||
-           node->GetRcrsvNghbrLst(DIR_FRWRD)->GetElmntCnt() == nodeCnt_ - 1);
-    assert(node != leaf_ ||
-           node->GetRcrsvNghbrLst(DIR_FRWRD)->GetElmntCnt() == 0);
   }
 
+  // Every other node is reachable from the root and reaches the leaf.
+  assert(cycleDetected_ ||
+         (dir == DIR_FRWRD ? root_ : leaf_)
+                 ->GetRcrsvNghbrBitVector(dir)
+                 ->GetOneCnt() == nodeCnt_ - 1);
+
   if (cycleDetected_)
     return RES_ERROR;
   else
     return RES_SUCCESS;
 }
 
+void DirAcycGraph::UpdateForNewEdge(GraphNode *frmNode, GraphNode *toNode) {
+  assert(rcrsvNghbrBits_[DIR_FRWRD] != NULL &&
+         rcrsvNghbrBits_[DIR_BKWRD] != NULL);
+  assert(frmNode != toNode && !frmNode->IsRcrsvPrdcsr(toNode));
+
+  // Every node that reaches frmNode now reaches every node that toNode
+  // reaches.
+  BitVector prdcsrs(nodeCnt_);
+  BitVector scsrs(nodeCnt_);
+  prdcsrs.Union(*frmNode->GetRcrsvNghbrBitVector(DIR_BKWRD));
+  prdcsrs.SetBit(frmNode->GetNum());
+  scsrs.Union(*toNode->GetRcrsvNghbrBitVector(DIR_FRWRD));
+  scsrs.SetBit(toNode->GetNum());
+
+  // A node that already reaches toNode already reaches all of its successors,
+  // and a node that frmNode already reaches is already reached by all of its
+  // predecessors.
+  for (int i = prdcsrs.GetNxtOneBit(0); i != INVALID_VALUE;
+       i = prdcsrs.GetNxtOneBit(i + 1)) {
+    if (!nodes_[i]->IsRcrsvScsr(toNode))
+      nodes_[i]->AddRcrsvNghbrs(DIR_FRWRD, scsrs);
+  }
+
+  for (int i = scsrs.GetNxtOneBit(0); i != INVALID_VALUE;
+       i = scsrs.GetNxtOneBit(i + 1)) {
+    if (!nodes_[i]->IsRcrsvPrdcsr(frmNode))
+      nodes_[i]->AddRcrsvNghbrs(DIR_BKWRD, prdcsrs);
+  }
+
+  // If toNode comes before frmNode, move it and the nodes that it reaches
+  // between them to after frmNode, keeping the relative order of the moved
+  // nodes and of the others. Nothing between them that toNode does not reach
+  // depends on a moved node, so the order stays topological.
+  UDT_GNODES frstIndx = toNode->GetTplgclOrdr();
+  UDT_GNODES lastIndx = frmNode->GetTplgclOrdr();
+  if (frstIndx > lastIndx)
+    return;
+
+  std::stable_partition(tplgclOrdr_ + frstIndx, tplgclOrdr_ + lastIndx + 1,
+                        [&scsrs](GraphNode *node) {
+                          return !scsrs.GetBit(node->GetNum());
+                        });
+
+  for (UDT_GNODES i = frstIndx; i <= lastIndx; i++) {
+    tplgclOrdr_[i]->SetTplgclOrdr(i);
+  }
+}
+
 void DirAcycGraph::Print(FILE *outFile) {
   fprintf(outFile, "Number of Nodes= %d    Number of Edges= %d\n", nodeCnt_,
           edgeCnt_);
@@ -14,11 +14,13 @@ GraphTrans::GraphTrans(DataDepGraph *dataDepGraph) {
 }
 
 std::unique_ptr<GraphTrans>
-GraphTrans::CreateGraphTrans(TRANS_TYPE type, DataDepGraph *dataDepGraph) {
+GraphTrans::CreateGraphTrans(TRANS_TYPE type, DataDepGraph *dataDepGraph,
+                             const GraphTransTypes &graphTransTypes) {
   switch (type) {
   // Create equivalence detection graph transformation.
   case TT_NSP:
-    return std::unique_ptr<GraphTrans>(new StaticNodeSupTrans(dataDepGraph));
+    return std::unique_ptr<GraphTrans>(new StaticNodeSupTrans(
+        dataDepGraph, graphTransTypes.multiPassNodeSup));
   }
 }
 
@@ -36,29 +38,6 @@ bool GraphTrans::AreNodesIndep_(SchedInstruction *inst1,
     return false;
 }
 
-void GraphTrans::UpdatePrdcsrAndScsr_(SchedInstruction *nodeA,
-                                      SchedInstruction *nodeB) {
-  LinkedList<GraphNode> *nodeBScsrLst = nodeB->GetRcrsvNghbrLst(DIR_FRWRD);
-  LinkedList<GraphNode> *nodeAPrdcsrLst = nodeA->GetRcrsvNghbrLst(DIR_BKWRD);
-
-  // Update lists for the nodes themselves.
-  nodeA->AddRcrsvScsr(nodeB);
-  nodeB->AddRcrsvPrdcsr(nodeA);
-
-  for (GraphNode *X = nodeAPrdcsrLst->GetFrstElmnt(); X != NULL;
-       X = nodeAPrdcsrLst->GetNxtElmnt()) {
-
-    for (GraphNode *Y = nodeBScsrLst->GetFrstElmnt(); Y != NULL;
-         Y = nodeBScsrLst->GetNxtElmnt()) {
-      // Check if Y is reachable f
-      if (!X->IsRcrsvScsr(Y)) {
-        Y->AddRcrsvPrdcsr(X);
-        X->AddRcrsvScsr(Y);
-      }
-    }
-  }
-}
-
 bool StaticNodeSupTrans::TryAddingSuperiorEdge_(SchedInstruction *nodeA,
                                                 SchedInstruction *nodeB) {
   // Return this flag which designates whether an edge was added.
@@ -88,8 +67,22 @@ void StaticNodeSupTrans::AddSuperiorEdge_(SchedInstruction *nodeA,
   Logger::Info("Node %d is superior to node %d", nodeA->GetNum(),
                nodeB->GetNum());
 #endif
-  GetDataDepGraph_()->CreateEdge(nodeA, nodeB, 0, DEP_OTHER);
-  UpdatePrdcsrAndScsr_(nodeA, nodeB);
+  GetDataDepGraph_()->CreateEdgeIncrmntly(nodeA, nodeB, 0, DEP_OTHER);
+}
+
+void StaticNodeSupTrans::CntDefsPerRegType_() {
+  InstCount numNodes = GetNumNodesInGraph_();
+  DataDepGraph *graph = GetDataDepGraph_();
+
+  regTypeCnt_ = graph->GetRegTypeCnt();
+  defCntPerRegType_.assign(numNodes * regTypeCnt_, 0);
+
+  for (int i = 0; i < numNodes; i++) {
+    Register **defs;
+    int defCnt = graph->GetInstByIndx(i)->GetDefs(defs);
+    for (int j = 0; j < defCnt; j++)
+      defCntPerRegType_[i * regTypeCnt_ + defs[j]->GetType()]++;
+  }
 }
 
 FUNC_RESULT StaticNodeSupTrans::ApplyTrans() {
@@ -102,31 +95,47 @@ FUNC_RESULT StaticNodeSupTrans::ApplyTrans() {
   Logger::Info("Applying node superiority graph transformation.");
 #endif
 
+  CntDefsPerRegType_();
+
+  // Only nodes of the same issue type can be superior to one another, so
+  // each node is only paired with the nodes of its issue type. The nodes of
+  // each issue type are kept in increasing order of their numbers, so the
+  // pairs are visited in the same order as when pairing all the nodes.
+  int issuTypeCnt = graph->GetIssuTypeCnt();
+  std::vector<std::vector<SchedInstruction *>> nodesPerIssuType(issuTypeCnt);
+  std::vector<size_t> nodesVisitedPerIssuType(issuTypeCnt, 0);
+  for (int i = 0; i < numNodes; i++) {
+    SchedInstruction *node = graph->GetInstByIndx(i);
+    nodesPerIssuType[node->GetIssueType()].push_back(node);
+  }
+
   // For the first pass visit all nodes. Add sets of independent nodes to a
   // list.
   for (int i = 0; i < numNodes; i++) {
     SchedInstruction *nodeA = graph->GetInstByIndx(i);
-    for (int j = i + 1; j < numNodes; j++) {
-      if (i == j)
-        continue;
-      SchedInstruction *nodeB = graph->GetInstByIndx(j);
+    IssueType issuType = nodeA->GetIssueType();
+    const std::vector<SchedInstruction *> &cnddts = nodesPerIssuType[issuType];
+    size_t frstCnddt = ++nodesVisitedPerIssuType[issuType];
+
+    for (size_t j = frstCnddt; j < cnddts.size(); j++) {
+      SchedInstruction *nodeB = cnddts[j];
 
 #ifdef IS_DEBUG_GRAPH_TRANS
-      Logger::Info("Checking nodes %d:%d", i, j);
+      Logger::Info("Checking nodes %d:%d", i, nodeB->GetNum());
 #endif
       if (AreNodesIndep_(nodeA, nodeB)) {
         didAddEdge = TryAddingSuperiorEdge_(nodeA, nodeB);
         // If the nodes are independent and no superiority was found add the
         // nodes to a list for
         // future passes.
-        if (!didAddEdge)
+        if (!didAddEdge && multiPass_)
           indepNodes.push_back(std::make_pair(nodeA, nodeB));
       }
     }
   }
   
   // Multi pass node superiority.
-  if (GRAPHTRANSFLAGS.multiPassNodeSup)
+  if (multiPass_)
     nodeMultiPass_(indepNodes);
 
   return RES_SUCCESS;
@@ -134,8 +143,6 @@ FUNC_RESULT StaticNodeSupTrans::ApplyTrans() {
 
 bool StaticNodeSupTrans::NodeIsSuperior_(SchedInstruction *nodeA,
                                          SchedInstruction *nodeB) {
-  DataDepGraph *graph = GetDataDepGraph_();
-
   if (nodeA->GetIssueType() != nodeB->GetIssueType()) {
 #ifdef IS_DEBUG_GRAPH_TRANS
     Logger::Info("Node %d is not of the same issue type as node %d",
@@ -144,9 +151,31 @@ bool StaticNodeSupTrans::NodeIsSuperior_(SchedInstruction *nodeA,
     return false;
   }
 
-  // The predecessor list of A must be a sub-list of the predecessor list of B.
   BitVector *predsA = nodeA->GetRcrsvNghbrBitVector(DIR_BKWRD);
   BitVector *predsB = nodeB->GetRcrsvNghbrBitVector(DIR_BKWRD);
+  BitVector *succsA = nodeA->GetRcrsvNghbrBitVector(DIR_FRWRD);
+  BitVector *succsB = nodeB->GetRcrsvNghbrBitVector(DIR_FRWRD);
+
+  // Rule out most pairs by the sizes of the recursive neighbor lists before
+  // comparing the lists themselves.
+  if (predsA->GetOneCnt() > predsB->GetOneCnt() ||
+      succsB->GetOneCnt() > succsA->GetOneCnt())
+    return false;
+
+  // For each register type, the number of registers defined by A is less than
+  // or equal to the number of registers defined by B.
+  const InstCount *defCntsA = &defCntPerRegType_[nodeA->GetNum() * regTypeCnt_];
+  const InstCount *defCntsB = &defCntPerRegType_[nodeB->GetNum() * regTypeCnt_];
+  for (int i = 0; i < regTypeCnt_; i++) {
+    if (defCntsA[i] > defCntsB[i]) {
+#ifdef IS_DEBUG_GRAPH_TRANS
+      Logger::Info("Live range condition 2 failed");
+#endif
+      return false;
+    }
+  }
+
+  // The predecessor list of A must be a sub-list of the predecessor list of B.
   if (!predsA->IsSubVector(predsB)) {
 #ifdef IS_DEBUG_GRAPH_TRANS
     Logger::Info(
@@ -157,8 +186,6 @@ bool StaticNodeSupTrans::NodeIsSuperior_(SchedInstruction *nodeA,
   }
 
   // The successor list of B must be a sub-list of the successor list of A.
-  BitVector *succsA = nodeA->GetRcrsvNghbrBitVector(DIR_FRWRD);
-  BitVector *succsB = nodeB->GetRcrsvNghbrBitVector(DIR_FRWRD);
   if (!succsB->IsSubVector(succsA)) {
 #ifdef IS_DEBUG_GRAPH_TRANS
     Logger::Info(
@@ -186,21 +213,8 @@ bool StaticNodeSupTrans::NodeIsSuperior_(SchedInstruction *nodeA,
   // registers.
   Register **usesA;
   Register **usesB;
-  Register **usesC;
   int useCntA = nodeA->GetUses(usesA);
   int useCntB = nodeB->GetUses(usesB);
-  // Register used by B but not by A.
-  std::list<Register *> usesOnlyB;
-  // A list of registers that will have their live range lengthened
-  // by scheduling B after A.
-  std::list<Register *> lengthenedLiveRegisters;
-  // The number of registers that will be lengthened by
-  // scheduling B after A. Indexed by register type.
-  std::vector<InstCount> lengthenedByB(graph->GetRegTypeCnt());
-  std::fill(lengthenedByB.begin(), lengthenedByB.end(), 0);
-  // The total number of live ranges that could be lengthened by
-  // scheduling B after A.
-  InstCount totalLengthenedByB = 0;
 
   for (int i = 0; i < useCntB; i++) {
     Register *useB = usesB[i];
@@ -274,37 +288,10 @@ bool StaticNodeSupTrans::NodeIsSuperior_(SchedInstruction *nodeA,
   }
 */
 
-  // For each register type, the number of registers defined by A is less than
-  // or equal to the number of registers defined by B.
-  Register **defsA;
-  Register **defsB;
-  int defCntA = nodeA->GetDefs(defsA);
-  int defCntB = nodeB->GetDefs(defsB);
-  int regTypes = graph->GetRegTypeCnt();
-  vector<InstCount> regTypeDefsA(regTypes);
-  vector<InstCount> regTypeDefsB(regTypes);
-
-  for (int i = 0; i < defCntA; i++)
-    regTypeDefsA[defsA[i]->GetType()]++;
-
-  for (int i = 0; i < defCntB; i++)
-    regTypeDefsB[defsB[i]->GetType()]++;
-
-  for (int i = 0; i < regTypes; i++) {
-    // Logger::Info("Def count A for Type %d is %d and B is %d", i,
-    // regTypeDefsA[i], regTypeDefsB[i]);
-    if (regTypeDefsA[i] > regTypeDefsB[i]) {
-#ifdef IS_DEBUG_GRAPH_TRANS
-      Logger::Info("Live range condition 2 failed");
-#endif
-      return false;
-    }
-  }
-
   return true;
 }
 
-void StaticNodeSupTrans::nodeMultiPass_(std::list<std::pair<SchedInstruction *, SchedInstruction *>> indepNodes) {
+void StaticNodeSupTrans::nodeMultiPass_(std::list<std::pair<SchedInstruction *, SchedInstruction *>> &indepNodes) {
 #ifdef IS_DEBUG_GRAPH_TRANS
       Logger::Info("Applying multi-pass node superiority");
 #endif
@@ -335,6 +322,4 @@ void StaticNodeSupTrans::nodeMultiPass_(std::list<std::pair<SchedInstruction *,
   }
 }
 
-GraphTransFlags GraphTrans::GRAPHTRANSFLAGS;
-
 } // end namespace opt_sched
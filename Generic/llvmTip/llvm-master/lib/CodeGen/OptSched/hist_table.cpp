@@ -161,7 +161,7 @@ bool HistEnumTreeNode::DoesDominate_(EnumTreeNode *node,
                                      ENUMTREE_NODEMODE mode,
                                      Enumerator *enumrtr, InstCount shft) {
   InstCount indx, time;
-  InstCount *othrLwrBounds = NULL;
+  const InstCount *othrLwrBounds = NULL;
   InstCount thisTime, othrTime;
   SchedInstruction **lastInsts = enumrtr->lastInsts_;
   SchedInstruction **othrLastInsts = enumrtr->othrLastInsts_;
@@ -174,7 +174,9 @@ bool HistEnumTreeNode::DoesDominate_(EnumTreeNode *node,
 
   if (mode == ETN_ACTIVE) {
     assert(node != NULL && othrHstry == NULL);
-    othrLwrBounds = node->frwrdLwrBounds_;
+    // The node is the one being probed, so its bounds are the current ones.
+    othrLwrBounds =
+        enumrtr->dataDepGraph_->GetStateBlk()->crntLwrBound[DIR_FRWRD];
     othrTime = node->GetTime();
     othrCrntCycleBlkd = node->crntCycleBlkd_;
   } else {
@@ -223,7 +225,7 @@ bool HistEnumTreeNode::DoesDominate_(EnumTreeNode *node,
   bool isAbslutDmnnt = true;
 
   if (othrHstry != NULL) {
-    othrHstry->SetLwrBounds_(othrLwrBounds, othrLastInsts, othrTime,
+    othrHstry->SetLwrBounds_(enumrtr->tmpLwrBounds_, othrLastInsts, othrTime,
                              minTimeToExmn, enumrtr);
   }
 
@@ -428,6 +430,11 @@ bool CostHistEnumTreeNode::DoesDominate(EnumTreeNode *node,
       return true;
   }
 
+  // A feasibility probe only prunes the nodes that cannot lead to a schedule
+  // of the target length.
+  if (static_cast<LengthCostEnumerator *>(enumrtr)->IsFsbltyProbe())
+    return false;
+
   // if the hist node dominates the current node, and the hist node
   // had at least one feasible sched below it, domination will be
   // determined by the cost domination condition
@@ -5,6 +5,8 @@
 #include <cstdio>
 // For exit().
 #include <cstdlib>
+// For serializing output from parallel enumeration workers.
+#include <mutex>
 // For GetProcessorTime().
 #include "llvm/CodeGen/OptSched/generic/utilities.h"
 
@@ -23,6 +25,9 @@ static const int MAX_MSGSIZE = 8000;
 // The current output stream.
 static std::ostream *logStream = &std::cerr;
 
+// Serializes the messages written to the output stream by different threads.
+static std::mutex logStreamLock;
+
 // The periodic logging callback.
 static void (*periodLogCallback)() = NULL;
 // The minimum length of (CPU) time between two calls to the periodic logging
@@ -52,17 +57,23 @@ static void Output(Logger::LOG_LEVEL level, bool timed, const char *message) {
     break;
   }
 
-  (*logStream) << title << ": " << message;
-  if (timed) {
-    (*logStream) << " (Time = " << Utilities::GetProcessorTime() << " ms)";
+  {
+    std::lock_guard<std::mutex> lock(logStreamLock);
+    (*logStream) << title << ": " << message;
+    if (timed) {
+      (*logStream) << " (Time = " << Utilities::GetProcessorTime() << " ms)";
+    }
+    (*logStream) << std::endl;
   }
-  (*logStream) << std::endl;
 
   if (level == Logger::FATAL)
     exit(1);
 }
 
-void Logger::SetLogStream(std::ostream &out) { logStream = &out; }
+void Logger::SetLogStream(std::ostream &out) {
+  std::lock_guard<std::mutex> lock(logStreamLock);
+  logStream = &out;
+}
 
 std::ostream &Logger::GetLogStream() { return *logStream; }
 
@@ -0,0 +1,34 @@
+#include "llvm/CodeGen/OptSched/enum/parallel_enum.h"
+#include <limits>
+#include <tuple>
+
+namespace opt_sched {
+
+ParallelEnumState::ParallelEnumState(int threadCnt, InstCount splitDepth)
+    : threadCnt_(threadCnt), splitDepth_(splitDepth),
+      bestCost_(std::numeric_limits<InstCount>::max()) {
+  assert(threadCnt_ > 1);
+  assert(splitDepth_ > 0);
+}
+/*****************************************************************************/
+
+void ParallelEnumState::UpdtBestCost(InstCount cost) {
+  InstCount crntBest = bestCost_.load(std::memory_order_relaxed);
+
+  while (cost < crntBest &&
+         !bestCost_.compare_exchange_weak(crntBest, cost,
+                                          std::memory_order_acq_rel)) {
+  }
+}
+/*****************************************************************************/
+
+std::atomic<InstCount> &ParallelEnumState::GetItemCrsr(InstCount trgtLngth) {
+  std::lock_guard<std::mutex> lock(crsrMutex_);
+  return itemCrsrs_
+      .emplace(std::piecewise_construct, std::forward_as_tuple(trgtLngth),
+               std::forward_as_tuple(0))
+      .first->second;
+}
+/*****************************************************************************/
+
+} // end namespace opt_sched
@@ -23,10 +23,10 @@ static uint32_t Z[] = {
     0xe14aae61,
 };
 
-// The current generator state. Magical starting values.
-static long j = 23;
-static long k = 54;
-static uint32_t y[] = {
+// The current generator state of each thread. Magical starting values.
+static thread_local long j = 23;
+static thread_local long k = 54;
+static thread_local uint32_t y[] = {
     0x8ca0df45, 0x37334f23, 0x4a5901d2, 0xaeede075, 0xd84bd3cf, 0xa1ce3350,
     0x35074a8f, 0xfd4e6da0, 0xe2c22e6f, 0x045de97e, 0x0e6d45b9, 0x201624a2,
     0x01e10dca, 0x2810aef2, 0xea0be721, 0x3a3781e4, 0xa3602009, 0xd2ffcf69,
@@ -39,8 +39,8 @@ static uint32_t y[] = {
     0xe14aae61,
 };
 
-// The last random number.
-static uint32_t randNum;
+// The last random number of each thread.
+static thread_local uint32_t randNum;
 
 void GenerateNextNumber() {
   randNum = y[j] + y[k];
@@ -104,4 +104,30 @@ void RandomGen::GetRandBits(uint16_t bitCnt, unsigned char *dest) {
   }
 }
 
+RandomStream::RandomStream(int32_t seed) {
+  j_ = 23;
+  k_ = 54;
+
+  if (seed == 0) {
+    for (int32_t i = 0; i < 55; i++) {
+      y_[i] = Z[i];
+    }
+  } else {
+    y_[0] = (A * seed + C) >> 1;
+    for (int32_t i = 1; i < 55; i++) {
+      y_[i] = (A * y_[i - 1] + C) >> 1;
+    }
+  }
+}
+
+uint32_t RandomStream::GetRand32() {
+  uint32_t rand = y_[j_] + y_[k_];
+  y_[k_] = rand;
+  if (--j_ < 0)
+    j_ = 54;
+  if (--k_ < 0)
+    k_ = 54;
+  return rand & 0x7fffffff;
+}
+
 } // end namespace opt_sched
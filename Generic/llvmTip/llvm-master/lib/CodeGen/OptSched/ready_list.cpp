@@ -2,18 +2,18 @@
 #include "llvm/CodeGen/OptSched/basic/data_dep.h"
 #include "llvm/CodeGen/OptSched/generic/logger.h"
 #include "llvm/CodeGen/OptSched/generic/utilities.h"
+#include <algorithm>
 
 namespace opt_sched {
 
-ReadyList::ReadyList(DataDepGraph *dataDepGraph, SchedPriorities prirts) {
+PriorityKeyGen::PriorityKeyGen(DataDepGraph *dataDepGraph,
+                               SchedPriorities prirts) {
   prirts_ = prirts;
-  prirtyLst_ = NULL;
-  keyedEntries_ = NULL;
   int i;
   uint16_t totKeyBits = 0;
 
   useCntBits_ = crtclPathBits_ = scsrCntBits_ = ltncySumBits_ = nodeID_Bits_ =
-      inptSchedOrderBits_ = 0;
+      inptSchedOrderBits_ = rndmBits_ = 0;
 
   // Calculate the number of bits needed to hold the maximum value of each
   // priority scheme
@@ -28,11 +28,6 @@ ReadyList::ReadyList(DataDepGraph *dataDepGraph, SchedPriorities prirts) {
 
     case LSH_LUC:
       prirts_.isDynmc = true;
-      keyedEntries_ = new KeyedEntry<SchedInstruction, unsigned long>
-          *[dataDepGraph->GetInstCnt()];
-      for (int j = 0; j < dataDepGraph->GetInstCnt(); j++) {
-        keyedEntries_[j] = NULL;
-      }
       maxUseCnt_ = dataDepGraph->GetMaxUseCnt();
       useCntBits_ = Utilities::clcltBitsNeededToHoldNum(maxUseCnt_);
       totKeyBits += useCntBits_;
@@ -68,6 +63,13 @@ ReadyList::ReadyList(DataDepGraph *dataDepGraph, SchedPriorities prirts) {
       ltncySumBits_ = Utilities::clcltBitsNeededToHoldNum(maxLtncySum_);
       totKeyBits += ltncySumBits_;
       break;
+
+    case LSH_RND:
+      rndmBits_ =
+          Utilities::clcltBitsNeededToHoldNum(dataDepGraph->GetInstCnt() - 1);
+      maxRndmVal_ = (1UL << rndmBits_) - 1;
+      totKeyBits += rndmBits_;
+      break;
     } // end switch
   }   // end for
 
@@ -77,14 +79,6 @@ ReadyList::ReadyList(DataDepGraph *dataDepGraph, SchedPriorities prirts) {
   Logger::Info("The ready list key size is %d bits", totKeyBits);
 #endif
 
-  prirtyLst_ = new PriorityList<SchedInstruction>;
-  if (prirtyLst_ == NULL)
-    Logger::Fatal("Out of memory.");
-
-  latestSubLst_ = new LinkedList<SchedInstruction>;
-  if (latestSubLst_ == NULL)
-    Logger::Fatal("Out of memory.");
-
   int16_t keySize = 0;
   maxPriority_ = 0;
   for (i = 0; i < prirts_.cnt; i++) {
@@ -109,34 +103,15 @@ ReadyList::ReadyList(DataDepGraph *dataDepGraph, SchedPriorities prirts) {
     case LSH_LS:
       AddPrirtyToKey_(maxPriority_, keySize, ltncySumBits_, maxLtncySum_, maxLtncySum_);
       break;
+    case LSH_RND:
+      AddPrirtyToKey_(maxPriority_, keySize, rndmBits_, maxRndmVal_, maxRndmVal_);
+      break;
     }
   }
 }
 
-ReadyList::~ReadyList() {
-  Reset();
-  if (prirtyLst_)
-    delete prirtyLst_;
-  if (latestSubLst_)
-    delete latestSubLst_;
-  if (keyedEntries_)
-    delete keyedEntries_;
-}
-
-void ReadyList::Reset() {
-  prirtyLst_->Reset();
-  latestSubLst_->Reset();
-}
-
-void ReadyList::CopyList(ReadyList *othrLst) {
-  assert(prirtyLst_->GetElmntCnt() == 0);
-  assert(latestSubLst_->GetElmntCnt() == 0);
-  assert(othrLst != NULL);
-  prirtyLst_->CopyList(othrLst->prirtyLst_);
-}
-
-unsigned long ReadyList::CmputKey_(SchedInstruction *inst, bool isUpdate,
-                                   bool &changed) {
+unsigned long PriorityKeyGen::CmputKey(SchedInstruction *inst, bool isUpdate,
+                                      bool &changed) {
   unsigned long key = 0;
   int16_t keySize = 0;
   int i;
@@ -187,88 +162,80 @@ unsigned long ReadyList::CmputKey_(SchedInstruction *inst, bool isUpdate,
       AddPrirtyToKey_(key, keySize, ltncySumBits_, inst->GetLtncySum(),
                       maxLtncySum_);
       break;
+
+    case LSH_RND:
+      AddPrirtyToKey_(key, keySize, rndmBits_, CmputRndmVal_(inst),
+                      maxRndmVal_);
+      break;
     }
   }
   return key;
 }
 
-void ReadyList::AddLatestSubLists(LinkedList<SchedInstruction> *lst1,
-                                  LinkedList<SchedInstruction> *lst2) {
-  assert(latestSubLst_->GetElmntCnt() == 0);
-  if (lst1 != NULL)
-    AddLatestSubList_(lst1);
-  if (lst2 != NULL)
-    AddLatestSubList_(lst2);
-  prirtyLst_->ResetIterator();
+unsigned long PriorityKeyGen::CmputRndmVal_(SchedInstruction *inst) const {
+  // Multiplying by an odd number and adding a number are both one-to-one
+  // modulo a power of two, so no two instructions get the same value.
+  unsigned long mult = 2 * (unsigned long)prirts_.rndmSeed * 0x9E3779B9UL + 1;
+  unsigned long ofst = (unsigned long)prirts_.rndmSeed * 0x7F4A7C15UL;
+  return ((unsigned long)inst->GetNum() * mult + ofst) & maxRndmVal_;
 }
 
-void ReadyList::Print(std::ostream &out) {
-  out << "\nReady List: ";
-  for (SchedInstruction *crntInst = prirtyLst_->GetFrstElmnt();
-       crntInst != NULL; crntInst = prirtyLst_->GetNxtElmnt()) {
-    out << crntInst->GetNum() << ", ";
-  }
-  prirtyLst_->ResetIterator();
+void PriorityKeyGen::AddPrirtyToKey_(unsigned long &key, int16_t &keySize,
+                                     int16_t bitCnt, unsigned long val,
+                                     unsigned long maxVal) {
+  assert(val <= maxVal);
+  if (keySize > 0)
+    key <<= bitCnt;
+  key |= val;
+  keySize += bitCnt;
 }
 
-void ReadyList::AddLatestSubList_(LinkedList<SchedInstruction> *lst) {
-  assert(lst != NULL);
-
-#ifdef IS_DEBUG_READY_LIST2
-  Logger::GetLogStream() << "Adding to the ready list: ";
-#endif
+ReadyList::ReadyList(DataDepGraph *dataDepGraph, SchedPriorities prirts)
+    : keyGen_(dataDepGraph, prirts) {
+  keyedEntries_ = NULL;
 
-  // Start iterating from the bottom of the list to access the most recent
-  // instructions first.
-  for (SchedInstruction *crntInst = lst->GetLastElmnt(); crntInst != NULL;
-       crntInst = lst->GetPrevElmnt()) {
-    // Once an instruction that is already in the ready list has been
-    // encountered, this instruction and all the ones above it must be in the
-    // ready list already.
-    if (crntInst->IsInReadyList())
-      break;
-    AddInst(crntInst);
-#ifdef IS_DEBUG_READY_LIST2
-    Logger::GetLogStream() << crntInst->GetNum() << ", ";
-#endif
-    crntInst->PutInReadyList();
-    latestSubLst_->InsrtElmnt(crntInst);
+  if (keyGen_.GetPrirts().isDynmc) {
+    keyedEntries_ = new KeyedEntry<SchedInstruction, unsigned long>
+        *[dataDepGraph->GetInstCnt()];
+    for (int j = 0; j < dataDepGraph->GetInstCnt(); j++) {
+      keyedEntries_[j] = NULL;
+    }
   }
 
-#ifdef IS_DEBUG_READY_LIST2
-  Logger::GetLogStream() << "\n";
-#endif
+  prirtyLst_ = new PriorityList<SchedInstruction>;
+  if (prirtyLst_ == NULL)
+    Logger::Fatal("Out of memory.");
 }
 
-void ReadyList::RemoveLatestSubList() {
-#ifdef IS_DEBUG_READY_LIST2
-  Logger::GetLogStream() << "Removing from the ready list: ";
-#endif
+ReadyList::~ReadyList() {
+  Reset();
+  if (prirtyLst_)
+    delete prirtyLst_;
+  if (keyedEntries_)
+    delete[] keyedEntries_;
+}
 
-  for (SchedInstruction *inst = latestSubLst_->GetFrstElmnt(); inst != NULL;
-       inst = latestSubLst_->GetNxtElmnt()) {
-    assert(inst->IsInReadyList());
-    inst->RemoveFromReadyList();
-#ifdef IS_DEBUG_READY_LIST2
-    Logger::GetLogStream() << inst->GetNum() << ", ";
-#endif
-  }
+void ReadyList::Reset() { prirtyLst_->Reset(); }
 
-#ifdef IS_DEBUG_READY_LIST2
-  Logger::GetLogStream() << "\n";
-#endif
+void ReadyList::Print(std::ostream &out) {
+  out << "\nReady List: ";
+  for (SchedInstruction *crntInst = prirtyLst_->GetFrstElmnt();
+       crntInst != NULL; crntInst = prirtyLst_->GetNxtElmnt()) {
+    out << crntInst->GetNum() << ", ";
+  }
+  prirtyLst_->ResetIterator();
 }
 
 void ReadyList::ResetIterator() { prirtyLst_->ResetIterator(); }
 
 void ReadyList::AddInst(SchedInstruction *inst) {
   bool changed;
-  unsigned long key = CmputKey_(inst, false, changed);
+  unsigned long key = keyGen_.CmputKey(inst, false, changed);
   assert(changed == true);
   KeyedEntry<SchedInstruction, unsigned long> *entry =
       prirtyLst_->InsrtElmnt(inst, key, true);
   InstCount instNum = inst->GetNum();
-  if (prirts_.isDynmc)
+  if (keyGen_.GetPrirts().isDynmc)
     keyedEntries_[instNum] = entry;
 }
 
@@ -295,13 +262,13 @@ SchedInstruction *ReadyList::GetNextPriorityInst(unsigned long &key) {
 }
 
 void ReadyList::UpdatePriorities() {
-  assert(prirts_.isDynmc);
+  assert(keyGen_.GetPrirts().isDynmc);
 
   SchedInstruction *inst;
   bool listChanged = false, instChanged = false;
   for (inst = prirtyLst_->GetFrstElmnt(); inst != NULL;
        inst = prirtyLst_->GetNxtElmnt()) {
-    unsigned long key = CmputKey_(inst, true, instChanged);
+    unsigned long key = keyGen_.CmputKey(inst, true, instChanged);
     if (instChanged) {
       prirtyLst_->BoostEntry(keyedEntries_[inst->GetNum()], key);
       listChanged = true;
@@ -315,18 +282,201 @@ bool ReadyList::FindInst(SchedInstruction *inst, int &hitCnt) {
   return prirtyLst_->FindElmnt(inst, hitCnt);
 }
 
-void ReadyList::AddPrirtyToKey_(unsigned long &key, int16_t &keySize,
-                                int16_t bitCnt, unsigned long val,
-                                unsigned long maxVal) {
-  assert(val <= maxVal);
-  if (keySize > 0)
-    key <<= bitCnt;
-  key |= val;
-  keySize += bitCnt;
+unsigned long ReadyList::MaxPriority() { return keyGen_.GetMaxPriority(); }
+
+EnumReadyList::EnumReadyList(DataDepGraph *dataDepGraph,
+                             SchedPriorities prirts)
+    : keyGen_(dataDepGraph, prirts) {
+  dataDepGraph_ = dataDepGraph;
+  totInstCnt_ = dataDepGraph->GetInstCnt();
+  sttcKeys_ = NULL;
+
+  if (!keyGen_.GetPrirts().isDynmc) {
+    sttcKeys_ = new unsigned long[totInstCnt_];
+    if (sttcKeys_ == NULL)
+      Logger::Fatal("Out of memory.");
+  }
+
+  elmnts_ = new Elmnt[totInstCnt_];
+  if (elmnts_ == NULL)
+    Logger::Fatal("Out of memory.");
+
+  log_ = new Chng[2 * totInstCnt_];
+  if (log_ == NULL)
+    Logger::Fatal("Out of memory.");
+
+  instCnt_ = 0;
+  crntIndx_ = -1;
+  logSize_ = 0;
+}
+
+EnumReadyList::~EnumReadyList() {
+  delete[] sttcKeys_;
+  delete[] elmnts_;
+  delete[] log_;
+}
+
+void EnumReadyList::Reset() {
+  instCnt_ = 0;
+  crntIndx_ = -1;
+  logSize_ = 0;
+
+  if (sttcKeys_ != NULL) {
+    bool changed;
+    for (InstCount i = 0; i < totInstCnt_; i++) {
+      sttcKeys_[i] =
+          keyGen_.CmputKey(dataDepGraph_->GetInstByIndx(i), false, changed);
+    }
+  }
+}
+
+EnumReadyList::State EnumReadyList::GetState() const {
+  State state;
+  state.logSize = logSize_;
+  state.crntIndx = crntIndx_;
+  return state;
+}
+
+void EnumReadyList::RestoreState(const State &state) {
+  assert(state.logSize <= logSize_);
+
+#ifdef IS_DEBUG_READY_LIST2
+  Logger::GetLogStream() << "Removing from the ready list: ";
+#endif
+
+  while (logSize_ > state.logSize) {
+    const Chng &chng = log_[--logSize_];
+    if (chng.isAdd) {
+      assert(elmnts_[chng.indx].inst == chng.elmnt.inst);
+      assert(chng.elmnt.inst->IsInReadyList());
+      RmvElmnt_(chng.indx);
+      chng.elmnt.inst->RemoveFromReadyList();
+#ifdef IS_DEBUG_READY_LIST2
+      Logger::GetLogStream() << chng.elmnt.inst->GetNum() << ", ";
+#endif
+    } else {
+      InsrtElmnt_(chng.elmnt, chng.indx);
+    }
+  }
+
+#ifdef IS_DEBUG_READY_LIST2
+  Logger::GetLogStream() << "\n";
+#endif
+
+  crntIndx_ = state.crntIndx;
+}
+
+SchedInstruction *EnumReadyList::GetNextPriorityInst() {
+  assert(crntIndx_ < instCnt_);
+  if (crntIndx_ + 1 == instCnt_)
+    return NULL;
+  return elmnts_[++crntIndx_].inst;
+}
+
+void EnumReadyList::RemoveNextPriorityInst() {
+  assert(crntIndx_ >= 0 && crntIndx_ < instCnt_);
+  assert(logSize_ < 2 * totInstCnt_);
+  Chng &chng = log_[logSize_++];
+  chng.elmnt = elmnts_[crntIndx_];
+  chng.indx = crntIndx_;
+  chng.isAdd = false;
+  RmvElmnt_(crntIndx_);
+  crntIndx_--;
+}
+
+void EnumReadyList::ResetIterator() { crntIndx_ = -1; }
+
+void EnumReadyList::SetIterator(InstCount indx) {
+  assert(indx >= 0 && indx < instCnt_);
+  crntIndx_ = indx;
+}
+
+void EnumReadyList::AddLatestSubLists(LinkedList<SchedInstruction> *lst1,
+                                      LinkedList<SchedInstruction> *lst2) {
+  if (lst1 != NULL)
+    AddLatestSubList_(lst1);
+  if (lst2 != NULL)
+    AddLatestSubList_(lst2);
+  crntIndx_ = -1;
+}
+
+void EnumReadyList::Print(std::ostream &out) {
+  out << "\nReady List: ";
+  for (InstCount i = 0; i < instCnt_; i++) {
+    out << elmnts_[i].inst->GetNum() << ", ";
+  }
+}
+
+void EnumReadyList::AddInst_(SchedInstruction *inst) {
+  Elmnt elmnt;
+  elmnt.inst = inst;
+  if (sttcKeys_ != NULL) {
+    elmnt.key = sttcKeys_[inst->GetNum()];
+  } else {
+    bool changed;
+    elmnt.key = keyGen_.CmputKey(inst, false, changed);
+  }
+
+  // Insert the instruction after all the ones with the same or a higher key.
+  InstCount indx = 0;
+  for (InstCount hi = instCnt_; indx < hi;) {
+    InstCount mid = (indx + hi) / 2;
+    if (elmnts_[mid].key >= elmnt.key) {
+      indx = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  InsrtElmnt_(elmnt, indx);
+
+  assert(logSize_ < 2 * totInstCnt_);
+  Chng &chng = log_[logSize_++];
+  chng.elmnt = elmnt;
+  chng.indx = indx;
+  chng.isAdd = true;
+}
+
+void EnumReadyList::AddLatestSubList_(LinkedList<SchedInstruction> *lst) {
+  assert(lst != NULL);
+
+#ifdef IS_DEBUG_READY_LIST2
+  Logger::GetLogStream() << "Adding to the ready list: ";
+#endif
+
+  // Start iterating from the bottom of the list to access the most recent
+  // instructions first.
+  for (SchedInstruction *crntInst = lst->GetLastElmnt(); crntInst != NULL;
+       crntInst = lst->GetPrevElmnt()) {
+    // Once an instruction that is already in the ready list has been
+    // encountered, this instruction and all the ones above it must be in the
+    // ready list already.
+    if (crntInst->IsInReadyList())
+      break;
+    AddInst_(crntInst);
+#ifdef IS_DEBUG_READY_LIST2
+    Logger::GetLogStream() << crntInst->GetNum() << ", ";
+#endif
+    crntInst->PutInReadyList();
+  }
+
+#ifdef IS_DEBUG_READY_LIST2
+  Logger::GetLogStream() << "\n";
+#endif
+}
+
+void EnumReadyList::InsrtElmnt_(const Elmnt &elmnt, InstCount indx) {
+  assert(indx >= 0 && indx <= instCnt_ && instCnt_ < totInstCnt_);
+  std::copy_backward(elmnts_ + indx, elmnts_ + instCnt_,
+                     elmnts_ + instCnt_ + 1);
+  elmnts_[indx] = elmnt;
+  instCnt_++;
 }
 
-unsigned long ReadyList::MaxPriority() {
-  return maxPriority_;
+void EnumReadyList::RmvElmnt_(InstCount indx) {
+  assert(indx >= 0 && indx < instCnt_);
+  std::copy(elmnts_ + indx + 1, elmnts_ + instCnt_, elmnts_ + indx);
+  instCnt_--;
 }
 
 } // end namespace opt_sched
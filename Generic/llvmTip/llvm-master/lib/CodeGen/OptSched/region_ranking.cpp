@@ -0,0 +1,75 @@
+#include "llvm/CodeGen/OptSched/sched_region/region_ranking.h"
+#include "llvm/CodeGen/OptSched/OptSchedSettings.h"
+#include <algorithm>
+#include <cmath>
+
+namespace opt_sched {
+
+RegionRanking::RegionRanking(float enumPrcntl, float maxTimeoutScale)
+    : bcktCnts_(BCKT_CNT, 0) {
+  enumPrcntl_ = enumPrcntl;
+  maxTimeoutScale_ = maxTimeoutScale;
+  totCnt_ = 0;
+}
+/*****************************************************************************/
+
+RegionRanking &RegionRanking::GetInstance() {
+  static RegionRanking ranking(OptSchedSettings::get().enumWeightPercentile,
+                               OptSchedSettings::get().maxWeightTimeoutScale);
+  return ranking;
+}
+/*****************************************************************************/
+
+RegionRanking::Allotment RegionRanking::Rank(double wght) {
+  Allotment allotment = {true, 1};
+  if (!IsEnabled())
+    return allotment;
+
+  std::lock_guard<std::mutex> lock(lock_);
+  int bckt = GetBckt_(wght);
+  bcktCnts_[bckt]++;
+  totCnt_++;
+
+  // The percentile of a region is the share of the regions ranked so far that
+  // weigh no more than it, so the first region is always enumerated.
+  int64_t atOrBelowCnt = 0;
+  for (int i = 0; i <= bckt; i++)
+    atOrBelowCnt += bcktCnts_[i];
+  float prcntl = 100.0f * atOrBelowCnt / totCnt_;
+  allotment.isEnumerated = prcntl >= enumPrcntl_;
+
+  if (allotment.isEnumerated && maxTimeoutScale_ > 1 && wght > 0) {
+    int mdnBckt = 0;
+    int64_t cnt = bcktCnts_[0];
+    while (2 * cnt < totCnt_)
+      cnt += bcktCnts_[++mdnBckt];
+
+    if (mdnBckt == 0) {
+      allotment.timeoutScale = maxTimeoutScale_;
+    } else {
+      double scale = wght / GetBcktWght_(mdnBckt);
+      allotment.timeoutScale =
+          (float)std::min(std::max(scale, 1.0), (double)maxTimeoutScale_);
+    }
+  }
+
+  return allotment;
+}
+/*****************************************************************************/
+
+int RegionRanking::GetBckt_(double wght) {
+  if (wght <= 0)
+    return 0;
+  double bckt = std::floor(std::log2(wght) * BCKTS_PER_OCTAVE) -
+                MIN_WGHT_EXP * BCKTS_PER_OCTAVE + 1;
+  return (int)std::min(std::max(bckt, 1.0), (double)(BCKT_CNT - 1));
+}
+/*****************************************************************************/
+
+double RegionRanking::GetBcktWght_(int bckt) {
+  return std::exp2((bckt - 1 + MIN_WGHT_EXP * BCKTS_PER_OCTAVE + 0.5) /
+                   BCKTS_PER_OCTAVE);
+}
+/*****************************************************************************/
+
+} // end namespace opt_sched
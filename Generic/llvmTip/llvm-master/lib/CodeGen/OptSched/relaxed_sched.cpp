@@ -1,5 +1,6 @@
 #include "llvm/CodeGen/OptSched/relaxed/relaxed_sched.h"
 #include "llvm/CodeGen/OptSched/generic/logger.h"
+#include "llvm/CodeGen/OptSched/generic/undo_trail.h"
 #include "llvm/CodeGen/OptSched/generic/utilities.h"
 #include <algorithm>
 
@@ -267,6 +268,7 @@ RJ_RelaxedScheduler::RJ_RelaxedScheduler(
     : RelaxedScheduler(dataDepGraph, machMdl, schedUprBound, mainDir, type,
                        maxInstCnt) {
   assert(instLst_->GetElmntCnt() == 0);
+  trail_ = NULL;
 }
 /*****************************************************************************/
 
@@ -572,6 +574,14 @@ bool RJ_RelaxedScheduler::FixInst(SchedInstruction *inst, InstCount cycle) {
   }
 
   assert(avlblSlots_[issuType][cycle] > 0);
+
+  if (trail_ != NULL) {
+    trail_->Save(avlblSlots_[issuType][cycle]);
+    trail_->Save(fxdInstCnt_);
+    trail_->Save(schduldInstCnt_);
+    trail_->Save(isFxd_[dataDepGraph_->GetInstIndx(inst)]);
+  }
+
   avlblSlots_[issuType][cycle]--;
   fxdInstCnt_++;
   schduldInstCnt_++;
@@ -1,6 +1,7 @@
 #include "llvm/CodeGen/OptSched/basic/sched_basic_data.h"
 #include "llvm/CodeGen/OptSched/basic/register.h"
 #include "llvm/CodeGen/OptSched/generic/stats.h"
+#include "llvm/CodeGen/OptSched/generic/undo_trail.h"
 
 namespace opt_sched {
 
@@ -23,20 +24,14 @@ SchedInstruction::SchedInstruction(InstCount num, const string &name,
   crtclPathFrmRoot_ = INVALID_VALUE;
   crtclPathFrmLeaf_ = INVALID_VALUE;
 
-  ltncyPerPrdcsr_ = NULL;
   memAllocd_ = false;
-  sortedPrdcsrLst_ = NULL;
-  sortedScsrLst_ = NULL;
 
-  crtclPathFrmRcrsvScsr_ = NULL;
-  crtclPathFrmRcrsvPrdcsr_ = NULL;
+  crtclPathToRcrsvScsr_ = NULL;
+  crtclPathToRcrsvPrdcsr_ = NULL;
 
   // Dynamic data that changes during scheduling.
+  stateBlk_ = NULL;
   ready_ = false;
-  rdyCyclePerPrdcsr_ = NULL;
-  minRdyCycle_ = INVALID_VALUE;
-  prevMinRdyCyclePerPrdcsr_ = NULL;
-  unschduldPrdcsrCnt_ = 0;
   unschduldScsrCnt_ = 0;
 
   crntRange_ = new SchedRange(this);
@@ -70,17 +65,27 @@ SchedInstruction::~SchedInstruction() {
   delete crntRange_;
 }
 
-void SchedInstruction::SetupForSchdulng(InstCount instCnt, bool isCP_FromScsr,
-                                        bool isCP_FromPrdcsr) {
+void SchedInstruction::SetupForSchdulng() {
   if (memAllocd_)
     DeAllocMem_();
-  AllocMem_(instCnt, isCP_FromScsr, isCP_FromPrdcsr);
+  AllocMem_();
 
   SetPrdcsrNums_();
   SetScsrNums_();
   ComputeAdjustedUseCnt_();
 }
 
+void SchedInstruction::SetStateBlk(InstStateBlk *stateBlk) {
+  assert(memAllocd_);
+  assert(stateBlk->nghbrStrt[DIR_BKWRD][num_ + 1] -
+             stateBlk->nghbrStrt[DIR_BKWRD][num_] ==
+         prdcsrCnt_);
+  stateBlk_ = stateBlk;
+  stateBlk_->schedCycle[num_] = crntSchedCycle_;
+  crntRange_->SetStorage(&stateBlk_->crntLwrBound[DIR_FRWRD][num_],
+                         &stateBlk_->crntLwrBound[DIR_BKWRD][num_]);
+}
+
 bool SchedInstruction::UseFileBounds() {
   bool match = true;
 #ifdef IS_DEBUG_BOUNDS
@@ -132,17 +137,12 @@ bool SchedInstruction::UseFileBounds() {
 
 bool SchedInstruction::InitForSchdulng(InstCount schedLngth,
                                        LinkedList<SchedInstruction> *fxdLst) {
-  crntSchedCycle_ = SCHD_UNSCHDULD;
+  assert(stateBlk_ != NULL);
+  SetSchedCycle_(SCHD_UNSCHDULD);
   crntRlxdCycle_ = SCHD_UNSCHDULD;
-
-  for (InstCount i = 0; i < prdcsrCnt_; i++) {
-    rdyCyclePerPrdcsr_[i] = INVALID_VALUE;
-    prevMinRdyCyclePerPrdcsr_[i] = INVALID_VALUE;
-  }
+  stateBlk_->InitForSchdulng(num_);
 
   ready_ = false;
-  minRdyCycle_ = INVALID_VALUE;
-  unschduldPrdcsrCnt_ = prdcsrCnt_;
   unschduldScsrCnt_ = scsrCnt_;
   lastUseCnt_ = 0;
 
@@ -156,78 +156,101 @@ bool SchedInstruction::InitForSchdulng(InstCount schedLngth,
   return true;
 }
 
-void SchedInstruction::AllocMem_(InstCount instCnt, bool isCP_FromScsr,
-                                 bool isCP_FromPrdcsr) {
+void SchedInstruction::AllocMem_() {
   scsrCnt_ = scsrLst_->GetElmntCnt();
   prdcsrCnt_ = prdcsrLst_->GetElmntCnt();
-  rdyCyclePerPrdcsr_ = new InstCount[prdcsrCnt_];
-  ltncyPerPrdcsr_ = new InstCount[prdcsrCnt_];
-  prevMinRdyCyclePerPrdcsr_ = new InstCount[prdcsrCnt_];
-  sortedPrdcsrLst_ = new PriorityList<SchedInstruction>;
 
-  if (rdyCyclePerPrdcsr_ == NULL || ltncyPerPrdcsr_ == NULL ||
-      prevMinRdyCyclePerPrdcsr_ == NULL || sortedPrdcsrLst_ == NULL) {
-    Logger::Fatal("Out of memory.");
-  }
-
-  InstCount predecessorIndex = 0;
-  for (GraphEdge *edge = prdcsrLst_->GetFrstElmnt(); edge != NULL;
-       edge = prdcsrLst_->GetNxtElmnt()) {
-    ltncyPerPrdcsr_[predecessorIndex++] = edge->label;
-    sortedPrdcsrLst_->InsrtElmnt((SchedInstruction *)edge->GetOtherNode(this),
-                                 edge->label, true);
-  }
+  // The relative critical paths are computed on demand.
+  assert(crtclPathToRcrsvScsr_ == NULL && crtclPathToRcrsvPrdcsr_ == NULL);
 
-  if (isCP_FromScsr) {
-    crtclPathFrmRcrsvScsr_ = new InstCount[instCnt];
-    if (crtclPathFrmRcrsvScsr_ == NULL)
-      Logger::Fatal("Out of memory.");
+  memAllocd_ = true;
+}
 
-    for (InstCount i = 0; i < instCnt; i++) {
-      crtclPathFrmRcrsvScsr_[i] = INVALID_VALUE;
-    }
+void SchedInstruction::DeAllocMem_() {
+  assert(memAllocd_);
 
-    crtclPathFrmRcrsvScsr_[GetNum()] = 0;
+  if (crtclPathToRcrsvScsr_ != NULL) {
+    delete[] crtclPathToRcrsvScsr_;
+    crtclPathToRcrsvScsr_ = NULL;
+  }
+  if (crtclPathToRcrsvPrdcsr_ != NULL) {
+    delete[] crtclPathToRcrsvPrdcsr_;
+    crtclPathToRcrsvPrdcsr_ = NULL;
   }
 
-  if (isCP_FromPrdcsr) {
-    crtclPathFrmRcrsvPrdcsr_ = new InstCount[instCnt];
-    if (crtclPathFrmRcrsvPrdcsr_ == NULL)
-      Logger::Fatal("Out of memory.");
+  memAllocd_ = false;
+}
 
-    for (InstCount i = 0; i < instCnt; i++) {
-      crtclPathFrmRcrsvPrdcsr_[i] = INVALID_VALUE;
-    }
+InstCount *SchedInstruction::GetRltvCrtclPaths_(DIRECTION dir) {
+  InstCount *crtclPaths =
+      dir == DIR_FRWRD ? crtclPathToRcrsvScsr_ : crtclPathToRcrsvPrdcsr_;
 
-    crtclPathFrmRcrsvPrdcsr_[GetNum()] = 0;
+  if (crtclPaths == NULL) {
+    CmputRltvCrtclPaths_(dir);
+    crtclPaths =
+        dir == DIR_FRWRD ? crtclPathToRcrsvScsr_ : crtclPathToRcrsvPrdcsr_;
   }
 
-  memAllocd_ = true;
+  return crtclPaths;
 }
 
-void SchedInstruction::DeAllocMem_() {
-  assert(memAllocd_);
+void SchedInstruction::CmputRltvCrtclPaths_(DIRECTION dir) {
+  InstCount *&crtclPaths =
+      dir == DIR_FRWRD ? crtclPathToRcrsvScsr_ : crtclPathToRcrsvPrdcsr_;
+  BitVector *isRcrsvNghbr = GetRcrsvNghbrBitVector(dir);
+  InstCount instCnt = isRcrsvNghbr->GetSize();
+  InstCount step = dir == DIR_FRWRD ? 1 : -1;
+  // The path to a neighbor in the given direction goes through the neighbor's
+  // neighbors in the opposite direction.
+  DIRECTION opstDir = DirAcycGraph::ReverseDirection(dir);
+  const InstStateBlk *blk = stateBlk_;
+  SchedInstruction *inst = this;
 
-  if (rdyCyclePerPrdcsr_ != NULL)
-    delete[] rdyCyclePerPrdcsr_;
-  if (prevMinRdyCyclePerPrdcsr_ != NULL)
-    delete[] prevMinRdyCyclePerPrdcsr_;
-  if (ltncyPerPrdcsr_ != NULL)
-    delete[] ltncyPerPrdcsr_;
-  if (sortedPrdcsrLst_ != NULL)
-    delete sortedPrdcsrLst_;
-  if (sortedScsrLst_ != NULL)
-    delete sortedScsrLst_;
-  if (crtclPathFrmRcrsvScsr_ != NULL)
-    delete[] crtclPathFrmRcrsvScsr_;
-  if (crtclPathFrmRcrsvPrdcsr_ != NULL)
-    delete[] crtclPathFrmRcrsvPrdcsr_;
+  assert(crtclPaths == NULL && grphTplgclOrdr_ != NULL && blk != NULL);
+  crtclPaths = new InstCount[instCnt];
+  if (crtclPaths == NULL)
+    Logger::Fatal("Out of memory.");
 
-  memAllocd_ = false;
+  for (InstCount i = 0; i < instCnt; i++) {
+    crtclPaths[i] = INVALID_VALUE;
+  }
+
+  crtclPaths[num_] = 0;
+
+  // Visit the recursive neighbors in topological order going away from this
+  // instruction, so that the distances to the neighbors of each of them that
+  // are between it and this instruction are already known. The edges are
+  // read from the state block's arrays rather than from the edge lists.
+  for (InstCount i = tplgclOrdr_ + step; 0 <= i && i < instCnt; i += step) {
+    inst = (SchedInstruction *)grphTplgclOrdr_[i];
+    InstCount instNum = inst->GetNum();
+    if (!isRcrsvNghbr->GetBit(instNum))
+      continue;
+
+    InstCount crtclPath = 0;
+    InstCount end = blk->GetNghbrEndIndx(opstDir, instNum);
+    for (InstCount j = blk->GetFrstNghbrIndx(opstDir, instNum); j < end; j++) {
+      // Only the neighbors that are between this instruction and inst are on
+      // the paths from this instruction.
+      InstCount nghbrCrtclPath = crtclPaths[blk->nghbrs[opstDir][j]];
+      if (nghbrCrtclPath == INVALID_VALUE)
+        continue;
+
+      if ((nghbrCrtclPath + blk->nghbrLtncy[opstDir][j]) > crtclPath) {
+        crtclPath = nghbrCrtclPath + blk->nghbrLtncy[opstDir][j];
+      }
+    }
+    crtclPaths[instNum] = crtclPath;
+  }
+
+  // The distance to the leaf (root) must be equal to the critical path of this
+  // instruction from the leaf (root).
+  assert(inst == this ||
+         crtclPaths[inst->GetNum()] ==
+             GetCrtclPath(DirAcycGraph::ReverseDirection(dir)));
 }
 
-InstCount SchedInstruction::CmputCrtclPath_(DIRECTION dir,
-                                            SchedInstruction *ref) {
+InstCount SchedInstruction::CmputCrtclPath_(DIRECTION dir) {
   // The idea of this function is considering each predecessor (successor) and
   // calculating the length of the path from the root (leaf) through that
   // predecessor (successor) and then taking the maximum value among all these
@@ -239,17 +262,7 @@ InstCount SchedInstruction::CmputCrtclPath_(DIRECTION dir,
        edg = nghbrLst->GetNxtElmnt()) {
     UDT_GLABEL edgLbl = edg->label;
     SchedInstruction *nghbr = (SchedInstruction *)(edg->GetOtherNode(this));
-
-    InstCount nghbrCrtclPath;
-    if (ref == NULL) {
-      nghbrCrtclPath = nghbr->GetCrtclPath(dir);
-    } else {
-      // When computing relative critical paths, we only need to consider
-      // neighbors that belong to the sub-tree rooted at the reference.
-      if (!ref->IsRcrsvNghbr(dir, nghbr))
-        continue;
-      nghbrCrtclPath = nghbr->GetRltvCrtclPath(dir, ref);
-    }
+    InstCount nghbrCrtclPath = nghbr->GetCrtclPath(dir);
     assert(nghbrCrtclPath != INVALID_VALUE);
 
     if ((nghbrCrtclPath + edgLbl) > crtclPath) {
@@ -361,15 +374,15 @@ InstCount SchedInstruction::GetScsrCnt() const {
 }
 
 InstCount SchedInstruction::GetRcrsvPrdcsrCnt() const {
-  assert(rcrsvPrdcsrLst_ != NULL);
-  assert(rcrsvPrdcsrLst_->GetElmntCnt() >= prdcsrCnt_);
-  return rcrsvPrdcsrLst_->GetElmntCnt();
+  assert(isRcrsvPrdcsr_ != NULL);
+  assert(isRcrsvPrdcsr_->GetOneCnt() >= prdcsrCnt_);
+  return isRcrsvPrdcsr_->GetOneCnt();
 }
 
 InstCount SchedInstruction::GetRcrsvScsrCnt() const {
-  assert(rcrsvScsrLst_ != NULL);
-  assert(rcrsvScsrLst_->GetElmntCnt() >= scsrCnt_);
-  return rcrsvScsrLst_->GetElmntCnt();
+  assert(isRcrsvScsr_ != NULL);
+  assert(isRcrsvScsr_->GetOneCnt() >= scsrCnt_);
+  return isRcrsvScsr_->GetOneCnt();
 }
 
 SchedInstruction *SchedInstruction::GetFrstPrdcsr(InstCount *scsrNum,
@@ -480,35 +493,15 @@ InstCount SchedInstruction::CmputCrtclPathFrmLeaf() {
   return crtclPathFrmLeaf_;
 }
 
-InstCount
-SchedInstruction::CmputCrtclPathFrmRcrsvPrdcsr(SchedInstruction *ref) {
-  InstCount refInstNum = ref->GetNum();
-  crtclPathFrmRcrsvPrdcsr_[refInstNum] = CmputCrtclPath_(DIR_FRWRD, ref);
-  return crtclPathFrmRcrsvPrdcsr_[refInstNum];
-}
-
-InstCount SchedInstruction::CmputCrtclPathFrmRcrsvScsr(SchedInstruction *ref) {
-  InstCount refInstNum = ref->GetNum();
-  crtclPathFrmRcrsvScsr_[refInstNum] = CmputCrtclPath_(DIR_BKWRD, ref);
-  return crtclPathFrmRcrsvScsr_[refInstNum];
-}
-
 InstCount SchedInstruction::GetCrtclPath(DIRECTION dir) const {
   return dir == DIR_FRWRD ? crtclPathFrmRoot_ : crtclPathFrmLeaf_;
 }
 
 InstCount SchedInstruction::GetRltvCrtclPath(DIRECTION dir,
                                              SchedInstruction *ref) {
-  InstCount refInstNum = ref->GetNum();
-
-  if (dir == DIR_FRWRD) {
-    assert(crtclPathFrmRcrsvPrdcsr_[refInstNum] != INVALID_VALUE);
-    return crtclPathFrmRcrsvPrdcsr_[refInstNum];
-  } else {
-    assert(dir == DIR_BKWRD);
-    assert(crtclPathFrmRcrsvScsr_[refInstNum] != INVALID_VALUE);
-    return crtclPathFrmRcrsvScsr_[refInstNum];
-  }
+  InstCount *crtclPaths = ref->GetRltvCrtclPaths_(dir);
+  assert(crtclPaths[num_] != INVALID_VALUE);
+  return crtclPaths[num_];
 }
 
 InstCount SchedInstruction::GetLwrBound(DIRECTION dir) const {
@@ -553,28 +546,13 @@ void SchedInstruction::SetBounds(InstCount flb, InstCount blb) {
 bool SchedInstruction::PrdcsrSchduld(InstCount prdcsrNum, InstCount cycle,
                                      InstCount &rdyCycle) {
   assert(prdcsrNum < prdcsrCnt_);
-  rdyCyclePerPrdcsr_[prdcsrNum] = cycle + ltncyPerPrdcsr_[prdcsrNum];
-  prevMinRdyCyclePerPrdcsr_[prdcsrNum] = minRdyCycle_;
-
-  if (rdyCyclePerPrdcsr_[prdcsrNum] > minRdyCycle_) {
-    minRdyCycle_ = rdyCyclePerPrdcsr_[prdcsrNum];
-  }
-
-  rdyCycle = minRdyCycle_;
-  unschduldPrdcsrCnt_--;
-  return (unschduldPrdcsrCnt_ == 0);
+  return stateBlk_->PrdcsrSchduld(num_, prdcsrNum, cycle, rdyCycle);
 }
 
 bool SchedInstruction::PrdcsrUnSchduld(InstCount prdcsrNum,
                                        InstCount &rdyCycle) {
   assert(prdcsrNum < prdcsrCnt_);
-  assert(rdyCyclePerPrdcsr_[prdcsrNum] != INVALID_VALUE);
-  rdyCycle = minRdyCycle_;
-  minRdyCycle_ = prevMinRdyCyclePerPrdcsr_[prdcsrNum];
-  rdyCyclePerPrdcsr_[prdcsrNum] = INVALID_VALUE;
-  unschduldPrdcsrCnt_++;
-  assert(unschduldPrdcsrCnt_ != prdcsrCnt_ || minRdyCycle_ == INVALID_VALUE);
-  return (unschduldPrdcsrCnt_ == 1);
+  return stateBlk_->PrdcsrUnSchduld(num_, prdcsrNum, rdyCycle);
 }
 
 bool SchedInstruction::ScsrSchduld() {
@@ -616,7 +594,7 @@ void SchedInstruction::SetRlxdCycle(InstCount cycle) { crntRlxdCycle_ = cycle; }
 
 void SchedInstruction::Schedule(InstCount cycleNum, InstCount slotNum) {
   assert(crntSchedCycle_ == SCHD_UNSCHDULD);
-  crntSchedCycle_ = cycleNum;
+  SetSchedCycle_(cycleNum);
   crntSchedSlot_ = slotNum;
 }
 
@@ -636,14 +614,20 @@ void SchedInstruction::SetCrntLwrBound(DIRECTION dir, InstCount bound) {
 
 void SchedInstruction::UnSchedule() {
   assert(crntSchedCycle_ != SCHD_UNSCHDULD);
-  crntSchedCycle_ = SCHD_UNSCHDULD;
+  SetSchedCycle_(SCHD_UNSCHDULD);
   crntSchedSlot_ = SCHD_UNSCHDULD;
 }
 
+void SchedInstruction::SetSchedCycle_(InstCount cycle) {
+  crntSchedCycle_ = cycle;
+  if (stateBlk_ != NULL)
+    stateBlk_->schedCycle[num_] = cycle;
+}
+
 void SchedInstruction::UnTightnLwrBounds() { crntRange_->UnTightnLwrBounds(); }
 
-void SchedInstruction::CmtLwrBoundTightnng() {
-  crntRange_->CmtLwrBoundTightnng();
+void SchedInstruction::CmtLwrBoundTightnng(UndoTrail *trail) {
+  crntRange_->CmtLwrBoundTightnng(trail);
 }
 
 void SchedInstruction::SetSig(InstSignature sig) { sig_ = sig; }
@@ -679,16 +663,15 @@ bool SchedInstruction::ProbeScsrsCrntLwrBounds(InstCount cycle) {
   if (cycle <= crntRange_->GetLwrBound(DIR_FRWRD))
     return false;
 
-  LinkedList<GraphEdge> *nghbrLst = scsrLst_;
-  for (GraphEdge *edg = nghbrLst->GetFrstElmnt(); edg != NULL;
-       edg = nghbrLst->GetNxtElmnt()) {
-    UDT_GLABEL edgLbl = edg->label;
-    SchedInstruction *nghbr = (SchedInstruction *)(edg->GetOtherNode(this));
-    InstCount nghbrNewLwrBound = cycle + edgLbl;
+  const InstStateBlk *blk = stateBlk_;
+  const InstCount *crntLwrBound = blk->crntLwrBound[DIR_FRWRD];
+  InstCount end = blk->GetNghbrEndIndx(DIR_FRWRD, num_);
+  for (InstCount i = blk->GetFrstNghbrIndx(DIR_FRWRD, num_); i < end; i++) {
+    InstCount nghbrNewLwrBound = cycle + blk->nghbrLtncy[DIR_FRWRD][i];
 
     // If this neighbor will get delayed by scheduling this instruction in the
     // given cycle.
-    if (nghbrNewLwrBound > nghbr->GetCrntLwrBound(DIR_FRWRD))
+    if (nghbrNewLwrBound > crntLwrBound[blk->nghbrs[DIR_FRWRD][i]])
       return true;
   }
 
@@ -756,18 +739,28 @@ int16_t SchedInstruction::CmputLastUseCnt() {
 SchedRange::SchedRange(SchedInstruction *inst) {
   InitVars_();
   inst_ = inst;
-  frwrdLwrBound_ = INVALID_VALUE;
-  bkwrdLwrBound_ = INVALID_VALUE;
+  frwrdLwrBound_ = &bounds_[DIR_FRWRD];
+  bkwrdLwrBound_ = &bounds_[DIR_BKWRD];
+  *frwrdLwrBound_ = INVALID_VALUE;
+  *bkwrdLwrBound_ = INVALID_VALUE;
   lastCycle_ = INVALID_VALUE;
 }
 
+void SchedRange::SetStorage(InstCount *frwrdLwrBound,
+                            InstCount *bkwrdLwrBound) {
+  *frwrdLwrBound = *frwrdLwrBound_;
+  *bkwrdLwrBound = *bkwrdLwrBound_;
+  frwrdLwrBound_ = frwrdLwrBound;
+  bkwrdLwrBound_ = bkwrdLwrBound;
+}
+
 bool SchedRange::TightnLwrBound(DIRECTION dir, InstCount newBound,
                                 LinkedList<SchedInstruction> *tightndLst,
                                 LinkedList<SchedInstruction> *fxdLst,
                                 bool enforce) {
-  InstCount *boundPtr = (dir == DIR_FRWRD) ? &frwrdLwrBound_ : &bkwrdLwrBound_;
+  InstCount *boundPtr = (dir == DIR_FRWRD) ? frwrdLwrBound_ : bkwrdLwrBound_;
   InstCount crntBound = *boundPtr;
-  InstCount othrBound = (dir == DIR_FRWRD) ? bkwrdLwrBound_ : frwrdLwrBound_;
+  InstCount othrBound = (dir == DIR_FRWRD) ? *bkwrdLwrBound_ : *frwrdLwrBound_;
 
   assert(enforce || IsFsbl_());
   assert(newBound > crntBound);
@@ -781,11 +774,10 @@ bool SchedRange::TightnLwrBound(DIRECTION dir, InstCount newBound,
   }
 
   assert(enforce || !inst_->IsSchduld());
-  assert(enforce || !isFxd_);
+  assert(enforce || !IsFxd());
 
   // If the range equals exactly one cycle.
   if (boundSum == lastCycle_) {
-    isFxd_ = true;
     fxdLst->InsrtElmnt(inst_);
   }
 
@@ -816,9 +808,7 @@ bool SchedRange::TightnLwrBoundRcrsvly(DIRECTION dir, InstCount newBound,
                                        LinkedList<SchedInstruction> *tightndLst,
                                        LinkedList<SchedInstruction> *fxdLst,
                                        bool enforce) {
-  LinkedList<GraphEdge> *nghbrLst =
-      (dir == DIR_FRWRD) ? inst_->scsrLst_ : inst_->prdcsrLst_;
-  InstCount crntBound = (dir == DIR_FRWRD) ? frwrdLwrBound_ : bkwrdLwrBound_;
+  InstCount crntBound = (dir == DIR_FRWRD) ? *frwrdLwrBound_ : *bkwrdLwrBound_;
   bool fsbl = IsFsbl_();
 
   assert(enforce || fsbl);
@@ -830,13 +820,22 @@ bool SchedRange::TightnLwrBoundRcrsvly(DIRECTION dir, InstCount newBound,
     if (!fsbl && !enforce)
       return false;
 
-    for (GraphEdge *edg = nghbrLst->GetFrstElmnt(); edg != NULL;
-         edg = nghbrLst->GetNxtElmnt()) {
-      UDT_GLABEL edgLbl = edg->label;
-      SchedInstruction *nghbr = (SchedInstruction *)(edg->GetOtherNode(inst_));
-      InstCount nghbrNewBound = newBound + edgLbl;
-
-      if (nghbrNewBound > nghbr->GetCrntLwrBound(dir)) {
+    // Walk the neighbors in the state block, so that only the neighbors whose
+    // bounds get tightened are visited.
+    const InstStateBlk *blk = inst_->stateBlk_;
+    assert(blk != NULL);
+    const InstCount *nghbrs = blk->nghbrs[dir];
+    const InstCount *nghbrLtncy = blk->nghbrLtncy[dir];
+    const InstCount *crntLwrBound = blk->crntLwrBound[dir];
+    InstCount end = blk->GetNghbrEndIndx(dir, inst_->GetNum());
+
+    for (InstCount i = blk->GetFrstNghbrIndx(dir, inst_->GetNum()); i < end;
+         i++) {
+      InstCount nghbrNum = nghbrs[i];
+      InstCount nghbrNewBound = newBound + nghbrLtncy[i];
+
+      if (nghbrNewBound > crntLwrBound[nghbrNum]) {
+        SchedInstruction *nghbr = blk->insts[nghbrNum];
         bool nghbrFsblty = nghbr->TightnLwrBoundRcrsvly(
             dir, nghbrNewBound, tightndLst, fxdLst, enforce);
         if (!nghbrFsblty) {
@@ -854,7 +853,7 @@ bool SchedRange::TightnLwrBoundRcrsvly(DIRECTION dir, InstCount newBound,
 
 bool SchedRange::Fix(InstCount cycle, LinkedList<SchedInstruction> *tightndLst,
                      LinkedList<SchedInstruction> *fxdLst) {
-  if (cycle < frwrdLwrBound_ || cycle > GetDeadline())
+  if (cycle < *frwrdLwrBound_ || cycle > GetDeadline())
     return false;
   InstCount backBnd = lastCycle_ - cycle;
   return (TightnLwrBoundRcrsvly(DIR_FRWRD, cycle, tightndLst, fxdLst, false) &&
@@ -863,16 +862,16 @@ bool SchedRange::Fix(InstCount cycle, LinkedList<SchedInstruction> *tightndLst,
 
 void SchedRange::SetBounds(InstCount frwrdLwrBound, InstCount bkwrdLwrBound) {
   InitVars_();
-  frwrdLwrBound_ = frwrdLwrBound;
-  bkwrdLwrBound_ = bkwrdLwrBound;
+  *frwrdLwrBound_ = frwrdLwrBound;
+  *bkwrdLwrBound_ = bkwrdLwrBound;
 }
 
 bool SchedRange::SetBounds(InstCount frwrdLwrBound, InstCount bkwrdLwrBound,
                            InstCount schedLngth,
                            LinkedList<SchedInstruction> *fxdLst) {
   InitVars_();
-  frwrdLwrBound_ = frwrdLwrBound;
-  bkwrdLwrBound_ = bkwrdLwrBound;
+  *frwrdLwrBound_ = frwrdLwrBound;
+  *bkwrdLwrBound_ = bkwrdLwrBound;
   assert(schedLngth != INVALID_VALUE);
   lastCycle_ = schedLngth - 1;
 
@@ -880,7 +879,6 @@ bool SchedRange::SetBounds(InstCount frwrdLwrBound, InstCount bkwrdLwrBound,
     return false;
 
   if (GetLwrBoundSum_() == lastCycle_) {
-    isFxd_ = true;
     assert(fxdLst != NULL);
     fxdLst->InsrtElmnt(inst_);
   }
@@ -893,25 +891,24 @@ void SchedRange::InitVars_() {
   prevBkwrdLwrBound_ = INVALID_VALUE;
   isFrwrdTightnd_ = false;
   isBkwrdTightnd_ = false;
-  isFxd_ = false;
 }
 
 void SchedRange::SetFrwrdBound(InstCount bound) {
-  assert(bound >= frwrdLwrBound_);
-  frwrdLwrBound_ = bound;
+  assert(bound >= *frwrdLwrBound_);
+  *frwrdLwrBound_ = bound;
 }
 
 void SchedRange::SetBkwrdBound(InstCount bound) {
-  assert(bound >= bkwrdLwrBound_);
-  bkwrdLwrBound_ = bound;
+  assert(bound >= *bkwrdLwrBound_);
+  *bkwrdLwrBound_ = bound;
 }
 
 InstCount SchedRange::GetLwrBoundSum_() const {
-  return frwrdLwrBound_ + bkwrdLwrBound_;
+  return *frwrdLwrBound_ + *bkwrdLwrBound_;
 }
 
 InstCount SchedRange::GetDeadline() const {
-  return lastCycle_ - bkwrdLwrBound_;
+  return lastCycle_ - *bkwrdLwrBound_;
 }
 
 bool SchedRange::IsFsbl_() const { return GetLwrBoundSum_() <= lastCycle_; }
@@ -921,45 +918,46 @@ void SchedRange::UnTightnLwrBounds() {
   assert(isFrwrdTightnd_ || isBkwrdTightnd_);
 
   if (isFrwrdTightnd_) {
-    assert(frwrdLwrBound_ != prevFrwrdLwrBound_);
-    frwrdLwrBound_ = prevFrwrdLwrBound_;
+    assert(*frwrdLwrBound_ != prevFrwrdLwrBound_);
+    *frwrdLwrBound_ = prevFrwrdLwrBound_;
     isFrwrdTightnd_ = false;
   }
 
   if (isBkwrdTightnd_) {
-    assert(bkwrdLwrBound_ != prevBkwrdLwrBound_);
-    bkwrdLwrBound_ = prevBkwrdLwrBound_;
+    assert(*bkwrdLwrBound_ != prevBkwrdLwrBound_);
+    *bkwrdLwrBound_ = prevBkwrdLwrBound_;
     isBkwrdTightnd_ = false;
   }
-
-  if (isFxd_)
-    isFxd_ = false;
 }
 
-void SchedRange::CmtLwrBoundTightnng() {
+void SchedRange::CmtLwrBoundTightnng(UndoTrail *trail) {
   assert(isFrwrdTightnd_ || isBkwrdTightnd_);
+
+  if (trail != NULL) {
+    if (isFrwrdTightnd_)
+      trail->Save(*frwrdLwrBound_, prevFrwrdLwrBound_);
+    if (isBkwrdTightnd_)
+      trail->Save(*bkwrdLwrBound_, prevBkwrdLwrBound_);
+  }
+
   isFrwrdTightnd_ = false;
   isBkwrdTightnd_ = false;
 }
 
 InstCount SchedRange::GetLwrBound(DIRECTION dir) const {
-  return (dir == DIR_FRWRD) ? frwrdLwrBound_ : bkwrdLwrBound_;
+  return (dir == DIR_FRWRD) ? *frwrdLwrBound_ : *bkwrdLwrBound_;
 }
 
 bool SchedRange::IsFxd() const { return lastCycle_ == GetLwrBoundSum_(); }
 
 void SchedRange::SetLwrBound(DIRECTION dir, InstCount bound) {
-  InstCount &crntBound = (dir == DIR_FRWRD) ? frwrdLwrBound_ : bkwrdLwrBound_;
+  InstCount &crntBound = (dir == DIR_FRWRD) ? *frwrdLwrBound_ : *bkwrdLwrBound_;
   bool &isTightnd = (dir == DIR_FRWRD) ? isFrwrdTightnd_ : isBkwrdTightnd_;
 
-  if (isFxd_ && bound != crntBound) {
-    assert(bound < crntBound);
-    isFxd_ = false;
-  }
-
   crntBound = bound;
 #ifdef IS_DEBUG
-  InstCount crntBoundPtr = (dir == DIR_FRWRD) ? frwrdLwrBound_ : bkwrdLwrBound_;
+  InstCount crntBoundPtr =
+      (dir == DIR_FRWRD) ? *frwrdLwrBound_ : *bkwrdLwrBound_;
   assert(crntBoundPtr == bound);
 #endif
   isTightnd = false;
@@ -969,4 +967,118 @@ bool SchedRange::IsTightnd(DIRECTION dir) const {
   return (dir == DIR_FRWRD) ? isFrwrdTightnd_ : isBkwrdTightnd_;
 }
 
+/******************************************************************************
+ * InstStateBlk                                                               *
+ ******************************************************************************/
+
+InstStateBlk::InstStateBlk(SchedInstruction **insts, GraphNode **tplgclOrdr,
+                           InstCount instCnt) {
+  this->instCnt = instCnt;
+  this->insts = insts;
+
+  InstCount edgeCnt = 0;
+  for (InstCount i = 0; i < instCnt; i++) {
+    edgeCnt += insts[i]->GetScsrCnt();
+  }
+
+  this->tplgclOrdr = new InstCount[instCnt];
+  issuType = new IssueType[instCnt];
+  blksCycle = new bool[instCnt];
+  schedCycle = new InstCount[instCnt];
+  minRdyCycle = new InstCount[instCnt];
+  unschduldPrdcsrCnt = new InstCount[instCnt];
+  prdcsrNumInScsr = new InstCount[edgeCnt];
+  rdyCyclePerPrdcsr = new InstCount[edgeCnt];
+  prevMinRdyCyclePerPrdcsr = new InstCount[edgeCnt];
+
+  if (this->tplgclOrdr == NULL || issuType == NULL || blksCycle == NULL ||
+      schedCycle == NULL || minRdyCycle == NULL ||
+      unschduldPrdcsrCnt == NULL || prdcsrNumInScsr == NULL ||
+      rdyCyclePerPrdcsr == NULL || prevMinRdyCyclePerPrdcsr == NULL) {
+    Logger::Fatal("Out of memory.");
+  }
+
+  for (int dir = DIR_FRWRD; dir <= DIR_BKWRD; dir++) {
+    crntLwrBound[dir] = new InstCount[instCnt];
+    nghbrStrt[dir] = new InstCount[instCnt + 1];
+    nghbrs[dir] = new InstCount[edgeCnt];
+    nghbrLtncy[dir] = new InstCount[edgeCnt];
+    if (crntLwrBound[dir] == NULL || nghbrStrt[dir] == NULL ||
+        nghbrs[dir] == NULL || nghbrLtncy[dir] == NULL) {
+      Logger::Fatal("Out of memory.");
+    }
+  }
+
+  InstCount scsrIndx = 0, prdcsrIndx = 0;
+  for (InstCount i = 0; i < instCnt; i++) {
+    SchedInstruction *inst = insts[i];
+    assert(inst->GetNum() == i);
+    this->tplgclOrdr[i] = tplgclOrdr[i]->GetNum();
+    issuType[i] = inst->GetIssueType();
+    blksCycle[i] = inst->BlocksCycle();
+    schedCycle[i] = SCHD_UNSCHDULD;
+    crntLwrBound[DIR_FRWRD][i] = INVALID_VALUE;
+    crntLwrBound[DIR_BKWRD][i] = INVALID_VALUE;
+    minRdyCycle[i] = INVALID_VALUE;
+    unschduldPrdcsrCnt[i] = 0;
+
+    InstCount prdcsrNum;
+    UDT_GLABEL ltncy;
+    nghbrStrt[DIR_FRWRD][i] = scsrIndx;
+    for (SchedInstruction *scsr = inst->GetFrstScsr(&prdcsrNum, &ltncy);
+         scsr != NULL; scsr = inst->GetNxtScsr(&prdcsrNum, &ltncy)) {
+      nghbrs[DIR_FRWRD][scsrIndx] = scsr->GetNum();
+      nghbrLtncy[DIR_FRWRD][scsrIndx] = ltncy;
+      prdcsrNumInScsr[scsrIndx] = prdcsrNum;
+      scsrIndx++;
+    }
+
+    nghbrStrt[DIR_BKWRD][i] = prdcsrIndx;
+    for (SchedInstruction *prdcsr = inst->GetFrstPrdcsr(NULL, &ltncy);
+         prdcsr != NULL; prdcsr = inst->GetNxtPrdcsr(NULL, &ltncy)) {
+      nghbrs[DIR_BKWRD][prdcsrIndx] = prdcsr->GetNum();
+      nghbrLtncy[DIR_BKWRD][prdcsrIndx] = ltncy;
+      rdyCyclePerPrdcsr[prdcsrIndx] = INVALID_VALUE;
+      prevMinRdyCyclePerPrdcsr[prdcsrIndx] = INVALID_VALUE;
+      prdcsrIndx++;
+    }
+  }
+
+  assert(scsrIndx == edgeCnt && prdcsrIndx == edgeCnt);
+  nghbrStrt[DIR_FRWRD][instCnt] = scsrIndx;
+  nghbrStrt[DIR_BKWRD][instCnt] = prdcsrIndx;
+}
+
+InstStateBlk::~InstStateBlk() {
+  delete[] tplgclOrdr;
+  delete[] issuType;
+  delete[] blksCycle;
+  delete[] schedCycle;
+  delete[] minRdyCycle;
+  delete[] unschduldPrdcsrCnt;
+  delete[] prdcsrNumInScsr;
+  delete[] rdyCyclePerPrdcsr;
+  delete[] prevMinRdyCyclePerPrdcsr;
+
+  for (int dir = DIR_FRWRD; dir <= DIR_BKWRD; dir++) {
+    delete[] crntLwrBound[dir];
+    delete[] nghbrStrt[dir];
+    delete[] nghbrs[dir];
+    delete[] nghbrLtncy[dir];
+  }
+}
+
+void InstStateBlk::InitForSchdulng(InstCount instNum) {
+  InstCount end = GetNghbrEndIndx(DIR_BKWRD, instNum);
+  InstCount strt = GetFrstNghbrIndx(DIR_BKWRD, instNum);
+
+  for (InstCount i = strt; i < end; i++) {
+    rdyCyclePerPrdcsr[i] = INVALID_VALUE;
+    prevMinRdyCyclePerPrdcsr[i] = INVALID_VALUE;
+  }
+
+  minRdyCycle[instNum] = INVALID_VALUE;
+  unschduldPrdcsrCnt[instNum] = end - strt;
+}
+
 } // end namespace opt_sched
@@ -0,0 +1,57 @@
+#include "llvm/CodeGen/OptSched/sched_region/sched_budget.h"
+#include <algorithm>
+
+namespace opt_sched {
+
+SchedBudget::SchedBudget(Milliseconds budget, InstCount instCnt) {
+  rmnngTime_ = budget;
+  rmnngInstCnt_ = instCnt;
+  spentTime_ = 0;
+}
+/*****************************************************************************/
+
+Milliseconds SchedBudget::Reserve(InstCount instCnt) {
+  std::lock_guard<std::mutex> lock(lock_);
+  Milliseconds share;
+
+  if (instCnt >= rmnngInstCnt_) {
+    // The last region, or one that the instruction count did not foresee,
+    // gets all that is left.
+    share = rmnngTime_;
+    rmnngInstCnt_ = 0;
+  } else {
+    share = rmnngTime_ * instCnt / rmnngInstCnt_;
+    rmnngInstCnt_ -= instCnt;
+  }
+
+  // Timeouts are in whole milliseconds, and a zero timeout disables
+  // enumeration, so small regions get at least one millisecond while there is
+  // time left.
+  if (share == 0 && rmnngTime_ > 0)
+    share = 1;
+
+  rmnngTime_ -= share;
+  return share;
+}
+/*****************************************************************************/
+
+void SchedBudget::Release(Milliseconds share, Milliseconds spent) {
+  std::lock_guard<std::mutex> lock(lock_);
+  rmnngTime_ = std::max<Milliseconds>(rmnngTime_ + share - spent, 0);
+  spentTime_ += spent;
+}
+/*****************************************************************************/
+
+Milliseconds SchedBudget::GetSpentTime() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return spentTime_;
+}
+/*****************************************************************************/
+
+Milliseconds SchedBudget::GetRemainingTime() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return rmnngTime_;
+}
+/*****************************************************************************/
+
+} // end namespace opt_sched
@@ -0,0 +1,344 @@
+#include "llvm/CodeGen/OptSched/sched_region/sched_cache.h"
+#include "llvm/CodeGen/OptSched/basic/register.h"
+#include "llvm/CodeGen/OptSched/generic/logger.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+namespace opt_sched {
+
+namespace {
+
+const uint32_t CACHE_FILE_MAGIC = 0x4353534f; // "OSSC"
+const uint32_t CACHE_FILE_VRSN = 1;
+
+// The header of a cache file. It is followed by one int32_t per instruction
+// holding the linear issue slot of that instruction.
+struct CacheFileHdr {
+  uint32_t magic;
+  uint32_t vrsn;
+  uint64_t key;
+  int32_t instCnt;
+  int32_t issuRate;
+  int32_t cost;
+  int32_t isOptml;
+};
+
+// Computes a 64-bit FNV-1a hash of a sequence of values.
+class KeyHasher {
+public:
+  KeyHasher() : hash_(0xcbf29ce484222325ULL) {}
+
+  void Add(uint64_t val) {
+    for (int i = 0; i < 8; i++) {
+      AddByte_((unsigned char)(val >> (8 * i)));
+    }
+  }
+
+  void Add(const std::string &str) {
+    Add(str.size());
+    for (char c : str) {
+      AddByte_((unsigned char)c);
+    }
+  }
+
+  uint64_t GetHash() const { return hash_; }
+
+private:
+  uint64_t hash_;
+
+  void AddByte_(unsigned char byte) {
+    hash_ ^= byte;
+    hash_ *= 0x100000001b3ULL;
+  }
+};
+
+} // end anonymous namespace
+
+SchedCache::SchedCache(const std::string &dir, const std::string &cnfgSig) {
+  dir_ = dir;
+  KeyHasher hasher;
+  hasher.Add(cnfgSig);
+  cnfgHash_ = hasher.GetHash();
+
+  std::error_code ec = llvm::sys::fs::create_directories(dir_);
+  isEnabled_ = !ec;
+  if (!isEnabled_) {
+    Logger::Error("Cannot create schedule cache directory %s: %s.",
+                  dir_.c_str(), ec.message().c_str());
+  }
+}
+/*****************************************************************************/
+
+UDT_HASHKEY SchedCache::CmputKey(DataDepGraph *dataDepGraph,
+                                 MachineModel *machMdl) const {
+  KeyHasher hasher;
+  InstCount instCnt = dataDepGraph->GetInstCnt();
+
+  hasher.Add(cnfgHash_);
+  hasher.Add(machMdl->GetModelName());
+  hasher.Add(machMdl->GetIssueRate());
+
+  // A model of the same name may come with other register limits or issue
+  // slots, and a schedule found for one is not valid for the other.
+  int issuTypeCnt = machMdl->GetIssueTypeCnt();
+  hasher.Add(issuTypeCnt);
+  for (int i = 0; i < issuTypeCnt; i++) {
+    hasher.Add(machMdl->GetSlotsPerCycle((IssueType)i));
+  }
+
+  int16_t regTypeCnt = machMdl->GetRegTypeCnt();
+  hasher.Add(regTypeCnt);
+  for (int16_t i = 0; i < regTypeCnt; i++) {
+    hasher.Add(machMdl->GetPhysRegCnt(i));
+  }
+
+  hasher.Add(instCnt);
+
+  for (InstCount i = 0; i < instCnt; i++) {
+    SchedInstruction *inst = dataDepGraph->GetInstByIndx(i);
+    hasher.Add(std::string(inst->GetOpCode()));
+    hasher.Add(inst->GetInstType());
+
+    UDT_GLABEL ltncy;
+    DependenceType depType;
+    hasher.Add(inst->GetScsrCnt());
+    for (SchedInstruction *scsr = inst->GetFrstScsr(NULL, &ltncy, &depType);
+         scsr != NULL; scsr = inst->GetNxtScsr(NULL, &ltncy, &depType)) {
+      hasher.Add(scsr->GetNum());
+      hasher.Add(ltncy);
+      hasher.Add(depType);
+    }
+
+    Register **regs;
+    int16_t defCnt = inst->GetDefs(regs);
+    hasher.Add(defCnt);
+    for (int16_t j = 0; j < defCnt; j++) {
+      hasher.Add(regs[j]->GetType());
+      hasher.Add(regs[j]->GetNum());
+    }
+
+    int16_t useCnt = inst->GetUses(regs);
+    hasher.Add(useCnt);
+    for (int16_t j = 0; j < useCnt; j++) {
+      hasher.Add(regs[j]->GetType());
+      hasher.Add(regs[j]->GetNum());
+    }
+  }
+
+  return hasher.GetHash();
+}
+/*****************************************************************************/
+
+std::string SchedCache::GetPath_(UDT_HASHKEY key) const {
+  char fileName[32];
+  std::snprintf(fileName, sizeof(fileName), "%016llx.sched",
+                (unsigned long long)key);
+  llvm::SmallString<256> path(dir_);
+  llvm::sys::path::append(path, fileName);
+  return path.str();
+}
+/*****************************************************************************/
+
+bool SchedCache::Read_(UDT_HASHKEY key, InstCount instCnt, int issuRate,
+                       SchedCacheEntry &entry) const {
+  if (!isEnabled_)
+    return false;
+
+  std::string path = GetPath_(key);
+  uint64_t fileSize;
+  if (llvm::sys::fs::file_size(path, fileSize))
+    return false;
+
+  uint64_t expctdSize = sizeof(CacheFileHdr) + instCnt * sizeof(int32_t);
+  if (fileSize != expctdSize)
+    return false;
+
+  int fd;
+  if (llvm::sys::fs::openFileForRead(path, fd))
+    return false;
+
+  std::error_code ec;
+  llvm::sys::fs::mapped_file_region region(
+      fd, llvm::sys::fs::mapped_file_region::readonly, fileSize, 0, ec);
+  llvm::sys::Process::SafelyCloseFileDescriptor(fd);
+  if (ec)
+    return false;
+
+  CacheFileHdr hdr;
+  std::memcpy(&hdr, region.const_data(), sizeof(hdr));
+  if (hdr.magic != CACHE_FILE_MAGIC || hdr.vrsn != CACHE_FILE_VRSN ||
+      hdr.key != key || hdr.instCnt != instCnt || hdr.issuRate != issuRate) {
+    return false;
+  }
+
+  const char *slots = region.const_data() + sizeof(CacheFileHdr);
+  entry.cost = hdr.cost;
+  entry.isOptml = hdr.isOptml != 0;
+  entry.instSlots.resize(instCnt);
+  for (InstCount i = 0; i < instCnt; i++) {
+    int32_t slot;
+    std::memcpy(&slot, slots + i * sizeof(int32_t), sizeof(slot));
+    entry.instSlots[i] = slot;
+  }
+
+  return true;
+}
+/*****************************************************************************/
+
+bool SchedCache::Find(UDT_HASHKEY key, DataDepGraph *dataDepGraph,
+                      MachineModel *machMdl, SchedCacheEntry &entry) const {
+  InstCount instCnt = dataDepGraph->GetInstCnt();
+  int issuRate = machMdl->GetIssueRate();
+
+  if (!Read_(key, instCnt, issuRate, entry))
+    return false;
+
+  // Guard against corrupted files and key collisions by making sure that the
+  // schedule is a valid one for this graph.
+  InstCount maxSlot = instCnt * issuRate * (dataDepGraph->GetMaxLtncy() + 1);
+  std::vector<bool> isSlotUsed(maxSlot, false);
+  for (InstCount i = 0; i < instCnt; i++) {
+    InstCount slot = entry.instSlots[i];
+    if (slot < 0 || slot >= maxSlot || isSlotUsed[slot]) {
+      Logger::Error("Ignoring invalid schedule cache entry %016llx.",
+                    (unsigned long long)key);
+      return false;
+    }
+    isSlotUsed[slot] = true;
+  }
+
+  for (InstCount i = 0; i < instCnt; i++) {
+    SchedInstruction *inst = dataDepGraph->GetInstByIndx(i);
+    InstCount slot = entry.instSlots[i];
+    UDT_GLABEL ltncy;
+    for (SchedInstruction *scsr = inst->GetFrstScsr(NULL, &ltncy);
+         scsr != NULL; scsr = inst->GetNxtScsr(NULL, &ltncy)) {
+      InstCount scsrSlot = entry.instSlots[scsr->GetNum()];
+      if (scsrSlot <= slot || scsrSlot / issuRate < slot / issuRate + ltncy) {
+        Logger::Error("Ignoring invalid schedule cache entry %016llx.",
+                      (unsigned long long)key);
+        return false;
+      }
+    }
+  }
+
+  // A schedule that got this far still has to pass the full verification,
+  // which also checks the issue slots of every cycle. The graph has not been
+  // set up for scheduling yet, so give it what the verification needs.
+  for (InstCount i = 0; i < instCnt; i++) {
+    SchedInstruction *inst = dataDepGraph->GetInstByIndx(i);
+    inst->SetIssueType(machMdl->GetIssueType(inst->GetInstType()));
+  }
+
+  InstCount uprBound = dataDepGraph->GetAbslutSchedUprBound();
+  dataDepGraph->SetAbslutSchedUprBound(GetSchedLngth(entry, issuRate));
+  InstSchedule sched(machMdl, dataDepGraph, true);
+  FillSched(entry, issuRate, &sched);
+  dataDepGraph->SetAbslutSchedUprBound(uprBound);
+
+  if (!sched.Verify(machMdl, dataDepGraph)) {
+    Logger::Error("Ignoring invalid schedule cache entry %016llx.",
+                  (unsigned long long)key);
+    return false;
+  }
+
+  return true;
+}
+/*****************************************************************************/
+
+void SchedCache::Store(UDT_HASHKEY key, InstSchedule *sched,
+                       MachineModel *machMdl, InstCount instCnt,
+                       InstCount cost, bool isOptml) const {
+  if (!isEnabled_)
+    return;
+
+  int issuRate = machMdl->GetIssueRate();
+
+  SchedCacheEntry oldEntry;
+  if (Read_(key, instCnt, issuRate, oldEntry)) {
+    if (oldEntry.isOptml || (!isOptml && oldEntry.cost <= cost))
+      return;
+  }
+
+  CacheFileHdr hdr;
+  hdr.magic = CACHE_FILE_MAGIC;
+  hdr.vrsn = CACHE_FILE_VRSN;
+  hdr.key = key;
+  hdr.instCnt = instCnt;
+  hdr.issuRate = issuRate;
+  hdr.cost = cost;
+  hdr.isOptml = isOptml ? 1 : 0;
+
+  std::vector<int32_t> slots(instCnt, INVALID_VALUE);
+  InstCount cycleNum, slotNum;
+  for (InstCount i = sched->GetFrstInst(cycleNum, slotNum); i != INVALID_VALUE;
+       i = sched->GetNxtInst(cycleNum, slotNum)) {
+    slots[i] = cycleNum * issuRate + slotNum;
+  }
+
+  // Write to a temporary file first and rename it, so that concurrent
+  // readers never see a partially written entry.
+  llvm::SmallString<256> tmpModel(dir_);
+  llvm::sys::path::append(tmpModel, "%%%%%%%%%%%%.tmp");
+  llvm::SmallString<256> tmpPath;
+  int fd;
+  if (llvm::sys::fs::createUniqueFile(tmpModel, fd, tmpPath))
+    return;
+
+  {
+    llvm::raw_fd_ostream out(fd, /*shouldClose=*/true);
+    out.write(reinterpret_cast<const char *>(&hdr), sizeof(hdr));
+    out.write(reinterpret_cast<const char *>(slots.data()),
+              slots.size() * sizeof(int32_t));
+    out.close();
+
+    if (out.has_error()) {
+      out.clear_error();
+      llvm::sys::fs::remove(tmpPath);
+      return;
+    }
+  }
+
+  if (llvm::sys::fs::rename(tmpPath, GetPath_(key)))
+    llvm::sys::fs::remove(tmpPath);
+}
+/*****************************************************************************/
+
+InstCount SchedCache::GetSchedLngth(const SchedCacheEntry &entry,
+                                    int issuRate) {
+  InstCount maxSlot = 0;
+  for (InstCount slot : entry.instSlots) {
+    maxSlot = std::max(maxSlot, slot);
+  }
+  return maxSlot / issuRate + 1;
+}
+/*****************************************************************************/
+
+void SchedCache::FillSched(const SchedCacheEntry &entry, int issuRate,
+                           InstSchedule *sched) {
+  InstCount slotCnt = GetSchedLngth(entry, issuRate) * issuRate;
+  std::vector<InstCount> instInSlot(slotCnt, SCHD_STALL);
+
+  for (InstCount i = 0; i < (InstCount)entry.instSlots.size(); i++) {
+    instInSlot[entry.instSlots[i]] = i;
+  }
+
+  // Trailing empty slots of the last cycle are not part of the schedule.
+  while (instInSlot.back() == SCHD_STALL) {
+    instInSlot.pop_back();
+  }
+
+  for (InstCount inst : instInSlot) {
+    sched->AppendInst(inst);
+  }
+}
+/*****************************************************************************/
+
+} // end namespace opt_sched
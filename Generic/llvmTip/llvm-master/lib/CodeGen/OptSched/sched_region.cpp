@@ -1,10 +1,13 @@
 #include <algorithm>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <utility>
 
+#include "llvm/CodeGen/OptSched/OptSchedSettings.h"
+#include "llvm/CodeGen/OptSched/aco.h"
 #include "llvm/CodeGen/OptSched/basic/graph_trans.h"
 #include "llvm/CodeGen/OptSched/basic/reg_alloc.h"
-#include "llvm/CodeGen/OptSched/generic/config.h"
 #include "llvm/CodeGen/OptSched/generic/logger.h"
 #include "llvm/CodeGen/OptSched/generic/random.h"
 #include "llvm/CodeGen/OptSched/generic/stats.h"
@@ -14,8 +17,6 @@
 #include "llvm/CodeGen/OptSched/sched_region/sched_region.h"
 #include "llvm/CodeGen/OptSched/spill/bb_spill.h"
 
-extern bool OPTSCHED_gPrintSpills;
-
 namespace opt_sched {
 
 SchedRegion::SchedRegion(MachineModel *machMdl, DataDepGraph *dataDepGraph,
@@ -47,6 +48,22 @@ SchedRegion::SchedRegion(MachineModel *machMdl, DataDepGraph *dataDepGraph,
   instCnt_ = dataDepGraph_->GetInstCnt();
 
   needTrnstvClsr_ = false;
+  prllState_ = NULL;
+  acoColony_ = NULL;
+  acoMmbrIndx_ = 0;
+  sharedAllotment_ = NULL;
+  isWndw_ = false;
+  rndmSeed_ = 0;
+  hasSeedSched_ = false;
+  isSchedOptml_ = false;
+  isSrchCut_ = false;
+  printSpills_ = false;
+
+  const OptSchedSettings &settings = OptSchedSettings::get();
+  minImprvmntRate_ = settings.minImprovementRate;
+  lastImprvmnt_ = 0;
+  lastImprvmntTime_ = prevImprvmntTime_ = 0;
+  minPrllBoundsSize_ = settings.minDagSizeForParallelBounds;
 }
 
 void SchedRegion::UseFileBounds_() {
@@ -87,6 +104,9 @@ FUNC_RESULT SchedRegion::FindOptimalSchedule(
   enumCrntSched_ = NULL;
   enumBestSched_ = NULL;
   bestSched = bestSched_ = NULL;
+  isSchedOptml_ = false;
+  isSrchCut_ = false;
+  RandomGen::SetSeed(rndmSeed_);
 
   Logger::Info("---------------------------------------------------------------"
                "------------");
@@ -124,12 +144,9 @@ FUNC_RESULT SchedRegion::FindOptimalSchedule(
     if (rslt != RES_SUCCESS)
       return rslt;
 
-    // Update graph after each transformation
-    rslt = dataDepGraph_->UpdateSetupForSchdulng(needTrnstvClsr_);
-    if (rslt != RES_SUCCESS) {
-      Logger::Info("Invalid DAG after graph transformations");
-      return rslt;
-    }
+    // The transformations keep the transitive closure and the critical paths
+    // up to date as they add edges, so only the rest of the setup is redone.
+    dataDepGraph_->UpdateSetupForNewEdges();
   }
 
   SetupForSchdulng_();
@@ -158,7 +175,7 @@ FUNC_RESULT SchedRegion::FindOptimalSchedule(
     Logger::Info("Heuristic_Time %d", hurstcTime);
 
 #ifdef IS_DEBUG_SLIL_PRINTOUT
-  if (OPTSCHED_gPrintSpills) {
+  if (printSpills_) {
     const auto &slilVector = this->GetSLIL_();
     for (int j = 0; j < slilVector.size(); j++) {
       Logger::Info(
@@ -183,13 +200,16 @@ FUNC_RESULT SchedRegion::FindOptimalSchedule(
   assert(schedLwrBound_ <= lstSched->GetCrntLngth());
 
   InstCount hurstcExecCost;
-  Config &schedIni = SchedulerOptions::getInstance();
-  if (!schedIni.GetBool("USE_ACO", false)) {
+  if (!OptSchedSettings::get().useACO) {
     CmputNormCost_(lstSched, CCM_DYNMC, hurstcExecCost, true);
   } else {
     CmputNormCost_(lstSched, CCM_STTC, hurstcExecCost, false);
   }
   hurstcCost_ = lstSched->GetCost();
+  if (!hurstcPortfolio_.empty())
+    UseHurstcPortfolio_(lstSched);
+  if (hasSeedSched_)
+    UseSeedSched_(lstSched);
   isLstOptml = CmputUprBounds_(lstSched, useFileBounds);
   boundTime = Utilities::GetProcessorTime() - boundStart;
   Stats::boundComputationTime.Record(boundTime);
@@ -253,6 +273,23 @@ FUNC_RESULT SchedRegion::FindOptimalSchedule(
     return RES_FAIL;
   }
 
+  // The weight of the region decides whether it gets any time to enumerate,
+  // and how much. The windows of a region take their time from the region,
+  // which has already been ranked.
+  bool isEnumAllotted = true;
+  if (isLstOptml == false && !isWndw_) {
+    RegionRanking::Allotment allotment = AllotEnumTime_();
+    isEnumAllotted = allotment.isEnumerated;
+    if (allotment.timeoutScale > 1) {
+      Logger::Info("Scaling the time limits of DAG %s by %.2f for its weight.",
+                   dataDepGraph_->GetDagID(), allotment.timeoutScale);
+      if (rgnTimeout > 0)
+        rgnTimeout = (Milliseconds)(rgnTimeout * allotment.timeoutScale);
+      if (lngthTimeout > 0)
+        lngthTimeout = (Milliseconds)(lngthTimeout * allotment.timeoutScale);
+    }
+  }
+
   // Step #3: Find the optimal schedule if the heuristc was not optimal.
   Milliseconds enumStart = Utilities::GetProcessorTime();
 
@@ -260,9 +297,15 @@ FUNC_RESULT SchedRegion::FindOptimalSchedule(
   Logger::Info("Sched LB = %d, Sched UB = %d", schedLwrBound_, schedUprBound_);
 #endif
 
-  if (isLstOptml == false) {
+  if (isLstOptml == false && isEnumAllotted) {
     dataDepGraph_->SetHard(true);
-    rslt = Optimize_(enumStart, rgnTimeout, lngthTimeout);
+    if (IsWindowed_())
+      rslt = OptimizeInWindows_(enumStart, rgnTimeout, lngthTimeout);
+    else if (acoColony_ != NULL && !acoColony_->IsEnumMmbr(acoMmbrIndx_))
+      rslt = ImproveWithACO_(static_cast<ACOScheduler *>(lstSchdulr),
+                             enumStart, rgnTimeout);
+    else
+      rslt = Optimize_(enumStart, rgnTimeout, lngthTimeout);
     Milliseconds enumTime = Utilities::GetProcessorTime() - enumStart;
 
     if (hurstcTime > 0) {
@@ -277,6 +320,12 @@ FUNC_RESULT SchedRegion::FindOptimalSchedule(
       enumBestSched_->Print(Logger::GetLogStream(), "Optimal");
 #endif
     }
+  } else if (isLstOptml == false) {
+    // The region ends as if it timed out right away, so that its heuristic
+    // schedule is not taken for an optimal one.
+    Logger::Info("Bypassing optimal scheduling due to low weight with cost %d",
+                 bestCost_);
+    rslt = RES_TIMEOUT;
   } else if (rgnTimeout == 0) {
     Logger::Info(
         "Bypassing optimal scheduling due to zero time limit with cost %d",
@@ -305,8 +354,7 @@ FUNC_RESULT SchedRegion::FindOptimalSchedule(
     Logger::Info("Cost Sum: %lu", costSum);
 #endif
 
-  if (SchedulerOptions::getInstance().GetString(
-          "SIMULATE_REGISTER_ALLOCATION") != "NO") {
+  if (OptSchedSettings::get().simRegAllocMode != SIM_REG_ALLOC::NO) {
 #ifdef IS_DEBUG
     RegAlloc_(bestSched, lstSched);
 #endif
@@ -319,6 +367,10 @@ FUNC_RESULT SchedRegion::FindOptimalSchedule(
 
   if (vrfySched_) {
     bool isValidSchdul = bestSched->Verify(machMdl_, dataDepGraph_);
+#ifdef IS_DEBUG_PEAK_PRESSURE
+    if (printSpills_)
+      bestSched->PrintRegPressures();
+#endif
 
     if (isValidSchdul == false) {
       Stats::invalidSchedules++;
@@ -342,6 +394,8 @@ FUNC_RESULT SchedRegion::FindOptimalSchedule(
     bestCost_ = hurstcCost_;
     bestSchedLngth_ = hurstcSchedLngth_;
   }
+  isSchedOptml_ =
+      tookBest && (isLstOptml || (rgnTimeout != 0 && rslt == RES_SUCCESS));
 
   delete lstSchdulr;
   if (bestSched != lstSched)
@@ -449,6 +503,20 @@ FUNC_RESULT SchedRegion::FindOptimalSchedule(
   return rslt;
 }
 
+RegionRanking::Allotment SchedRegion::AllotEnumTime_() {
+  RegionRanking &rnkng = RegionRanking::GetInstance();
+  double wght = (double)dataDepGraph_->GetWeight() * bestCost_;
+
+  if (sharedAllotment_ == NULL)
+    return rnkng.Rank(wght);
+
+  // The workers compute the same heuristic schedule, so whichever of them
+  // gets here first ranks the region for all of them.
+  std::call_once(sharedAllotment_->once,
+                 [&]() { sharedAllotment_->allotment = rnkng.Rank(wght); });
+  return sharedAllotment_->allotment;
+}
+
 FUNC_RESULT SchedRegion::Optimize_(Milliseconds startTime,
                                    Milliseconds rgnTimeout,
                                    Milliseconds lngthTimeout) {
@@ -459,7 +527,14 @@ FUNC_RESULT SchedRegion::Optimize_(Milliseconds startTime,
   enumBestSched_ = AllocNewSched_();
 
   InstCount initCost = bestCost_;
+  lastImprvmnt_ = 0;
+  lastImprvmntTime_ = prevImprvmntTime_ = startTime;
   enumrtr = AllocEnumrtr_(lngthTimeout);
+
+  if (prllState_ != NULL) {
+    enumrtr->SetParallelState(prllState_);
+    prllState_->UpdtBestCost(bestCost_);
+  }
   rslt = Enumerate_(startTime, rgnTimeout, lngthTimeout);
 
   Milliseconds solnTime = Utilities::GetProcessorTime() - startTime;
@@ -480,8 +555,9 @@ FUNC_RESULT SchedRegion::Optimize_(Milliseconds startTime,
     Stats::solutionTimeForSolvedProblems.Record(solnTime);
   } else {
     if (rslt == RES_TIMEOUT) {
-      Logger::Info("DAG timed out with "
+      Logger::Info("DAG %s with "
                    "length=%d, spill cost = %d, tot cost = %d, cost imp=%d.",
+                   isSrchCut_ ? "beam search was cut" : "timed out",
                    bestSchedLngth_, bestSched_->GetSpillCost(), bestCost_,
                    imprvmnt);
     }
@@ -491,6 +567,28 @@ FUNC_RESULT SchedRegion::Optimize_(Milliseconds startTime,
   return rslt;
 }
 
+FUNC_RESULT SchedRegion::ImproveWithACO_(ACOScheduler *acoSchdulr,
+                                         Milliseconds startTime,
+                                         Milliseconds rgnTimeout) {
+  // The colony proves nothing about its schedules, so the result is never
+  // better than a timeout.
+  if (!acoColony_->RunsWithEnum())
+    return RES_TIMEOUT;
+
+  enumBestSched_ = AllocNewSched_();
+  enumBestSched_->Copy(bestSched_);
+  Milliseconds deadline = INVALID_VALUE;
+  if (rgnTimeout != INVALID_VALUE)
+    deadline = startTime + rgnTimeout;
+  acoSchdulr->ImproveSchedule(enumBestSched_, deadline);
+
+  if (enumBestSched_->GetCost() < bestCost_) {
+    bestCost_ = enumBestSched_->GetCost();
+    bestSchedLngth_ = enumBestSched_->GetCrntLngth();
+  }
+  return RES_TIMEOUT;
+}
+
 void SchedRegion::CmputLwrBounds_(bool useFileBounds) {
   RelaxedScheduler *rlxdSchdulr = NULL;
   RelaxedScheduler *rvrsRlxdSchdulr = NULL;
@@ -517,8 +615,24 @@ void SchedRegion::CmputLwrBounds_(bool useFileBounds) {
 
   InstCount frwrdLwrBound = 0;
   InstCount bkwrdLwrBound = 0;
-  frwrdLwrBound = rlxdSchdulr->FindSchedule();
-  bkwrdLwrBound = rvrsRlxdSchdulr->FindSchedule();
+  InstCount spillCostLwrBound = 0;
+
+  if (minPrllBoundsSize_ > 0 && instCnt_ >= minPrllBoundsSize_) {
+    // The backward relaxed scheduler reads the forward bounds, so the two
+    // passes run one after the other. The spill cost bound does not depend on
+    // either of them, so it is computed at the same time and combined with the
+    // length bound afterwards.
+    std::thread costWorker(
+        [&]() { spillCostLwrBound = CmputSpillCostLwrBound(); });
+    frwrdLwrBound = rlxdSchdulr->FindSchedule();
+    bkwrdLwrBound = rvrsRlxdSchdulr->FindSchedule();
+    costWorker.join();
+  } else {
+    frwrdLwrBound = rlxdSchdulr->FindSchedule();
+    bkwrdLwrBound = rvrsRlxdSchdulr->FindSchedule();
+    spillCostLwrBound = CmputSpillCostLwrBound();
+  }
+
   InstCount rlxdLwrBound = std::max(frwrdLwrBound, bkwrdLwrBound);
 
   assert(rlxdLwrBound >= schedLwrBound_);
@@ -536,7 +650,7 @@ void SchedRegion::CmputLwrBounds_(bool useFileBounds) {
   if (useFileBounds)
     UseFileBounds_();
 
-  costLwrBound_ = CmputCostLwrBound();
+  costLwrBound_ = CmputCostLwrBound(spillCostLwrBound);
 
   delete rlxdSchdulr;
   delete rvrsRlxdSchdulr;
@@ -561,6 +675,81 @@ bool SchedRegion::CmputUprBounds_(InstSchedule *lstSched, bool useFileBounds) {
   }
 }
 
+void SchedRegion::UseSeedSched_(InstSchedule *lstSched) {
+  int issuRate = machMdl_->GetIssueRate();
+  if (SchedCache::GetSchedLngth(seedSched_, issuRate) >
+      dataDepGraph_->GetAbslutSchedUprBound())
+    return;
+
+  InstSchedule *seedSched = AllocNewSched_();
+  SchedCache::FillSched(seedSched_, issuRate, seedSched);
+
+  if (seedSched->Verify(machMdl_, dataDepGraph_)) {
+    InstCount seedExecCost;
+    CmputNormCost_(seedSched, CCM_STTC, seedExecCost, false);
+
+    if (seedSched->GetCost() < hurstcCost_) {
+      Logger::Info("Using the cached schedule of cost %d instead of the "
+                   "heuristic schedule of cost %d.",
+                   seedSched->GetCost(), hurstcCost_);
+      lstSched->Copy(seedSched);
+      hurstcCost_ = lstSched->GetCost();
+      hurstcSchedLngth_ = lstSched->GetCrntLngth();
+    }
+  }
+
+  delete seedSched;
+}
+
+void SchedRegion::SetHurstcPortfolio(const std::vector<SchedPriorities> &prirts,
+                                     int rndmRunCnt) {
+  hurstcPortfolio_ = prirts;
+
+  // The random order takes the place of a trailing node ID or input order,
+  // which would leave no ties to break.
+  SchedPriorities rndmPrirts = hurstcPrirts_;
+  int lastIndx = rndmPrirts.cnt - 1;
+  if (lastIndx >= 0 && (rndmPrirts.vctr[lastIndx] == LSH_NID ||
+                        rndmPrirts.vctr[lastIndx] == LSH_ISO))
+    rndmPrirts.vctr[lastIndx] = LSH_RND;
+  else if (rndmPrirts.cnt < MAX_SCHED_PRIRTS)
+    rndmPrirts.vctr[rndmPrirts.cnt++] = LSH_RND;
+
+  for (int i = 1; i <= rndmRunCnt; i++) {
+    rndmPrirts.rndmSeed = i;
+    hurstcPortfolio_.push_back(rndmPrirts);
+  }
+}
+
+void SchedRegion::UseHurstcPortfolio_(InstSchedule *lstSched) {
+  InstSchedule *sched = AllocNewSched_();
+  int bestHurstc = INVALID_VALUE;
+
+  // The heuristics keep their state in the instructions of the graph, so they
+  // take turns.
+  for (int i = 0; i < (int)hurstcPortfolio_.size(); i++) {
+    ListScheduler lstSchdulr(dataDepGraph_, machMdl_, abslutSchedUprBound_,
+                             hurstcPortfolio_[i]);
+    sched->Reset();
+    if (lstSchdulr.FindSchedule(sched, this) != RES_SUCCESS)
+      continue;
+
+    InstCount execCost;
+    CmputNormCost_(sched, CCM_STTC, execCost, false);
+    if (sched->GetCost() < hurstcCost_) {
+      bestHurstc = i;
+      lstSched->Copy(sched);
+      hurstcCost_ = lstSched->GetCost();
+      hurstcSchedLngth_ = lstSched->GetCrntLngth();
+    }
+  }
+
+  if (bestHurstc != INVALID_VALUE)
+    Logger::Info("Using the schedule of portfolio heuristic %d with cost %d.",
+                 bestHurstc, hurstcCost_);
+  delete sched;
+}
+
 void SchedRegion::UpdateScheduleCost(InstSchedule *schedule) {
   InstCount crntExecCost;
   CmputNormCost_(schedule, CCM_STTC, crntExecCost, false);
@@ -598,16 +787,31 @@ void SchedRegion::HandlEnumrtrRslt_(FUNC_RESULT rslt, InstCount trgtLngth) {
   }
 }
 
+void SchedRegion::RecordImprvmnt_(InstCount imprvmnt) {
+  if (!ChksImprvmntRate())
+    return;
+  prevImprvmntTime_ = lastImprvmntTime_;
+  lastImprvmntTime_ = Utilities::GetProcessorTime();
+  lastImprvmnt_ = imprvmnt;
+}
+
+bool SchedRegion::IsImprvmntStalled(Milliseconds now) const {
+  if (!ChksImprvmntRate() || lastImprvmnt_ == 0)
+    return false;
+  Milliseconds intrvl = now - prevImprvmntTime_;
+  if (intrvl <= 0)
+    return false;
+  return lastImprvmnt_ * 1000.0 / intrvl < minImprvmntRate_;
+}
+
 void SchedRegion::RegAlloc_(InstSchedule *&bestSched, InstSchedule *&lstSched) {
   std::unique_ptr<LocalRegAlloc> u_regAllocBest = nullptr;
   std::unique_ptr<LocalRegAlloc> u_regAllocList = nullptr;
 
-  if (SchedulerOptions::getInstance().GetString(
-          "SIMULATE_REGISTER_ALLOCATION") == "HEURISTIC" ||
-      SchedulerOptions::getInstance().GetString(
-          "SIMULATE_REGISTER_ALLOCATION") == "BOTH" ||
-      SchedulerOptions::getInstance().GetString(
-          "SIMULATE_REGISTER_ALLOCATION") == "TAKE_SCHED_WITH_LEAST_SPILLS") {
+  SIM_REG_ALLOC mode = OptSchedSettings::get().simRegAllocMode;
+
+  if (mode == SIM_REG_ALLOC::HEURISTIC || mode == SIM_REG_ALLOC::BOTH ||
+      mode == SIM_REG_ALLOC::TAKE_SCHED_WITH_LEAST_SPILLS) {
     // Simulate register allocation using the heuristic schedule.
     u_regAllocList = std::unique_ptr<LocalRegAlloc>(
         new LocalRegAlloc(lstSched, dataDepGraph_));
@@ -621,12 +825,8 @@ void SchedRegion::RegAlloc_(InstSchedule *&bestSched, InstSchedule *&lstSched) {
 
     u_regAllocList->PrintSpillInfo(ident.c_str());
   }
-  if (SchedulerOptions::getInstance().GetString(
-          "SIMULATE_REGISTER_ALLOCATION") == "BEST" ||
-      SchedulerOptions::getInstance().GetString(
-          "SIMULATE_REGISTER_ALLOCATION") == "BOTH" ||
-      SchedulerOptions::getInstance().GetString(
-          "SIMULATE_REGISTER_ALLOCATION") == "TAKE_SCHED_WITH_LEAST_SPILLS") {
+  if (mode == SIM_REG_ALLOC::BEST || mode == SIM_REG_ALLOC::BOTH ||
+      mode == SIM_REG_ALLOC::TAKE_SCHED_WITH_LEAST_SPILLS) {
     // Simulate register allocation using the best schedule.
     u_regAllocBest = std::unique_ptr<LocalRegAlloc>(
         new LocalRegAlloc(bestSched, dataDepGraph_));
@@ -638,8 +838,7 @@ void SchedRegion::RegAlloc_(InstSchedule *&bestSched, InstSchedule *&lstSched) {
     totalSimSpills_ = u_regAllocBest->GetCost();
   }
 
-  if (SchedulerOptions::getInstance().GetString(
-          "SIMULATE_REGISTER_ALLOCATION") == "TAKE_SCHED_WITH_LEAST_SPILLS")
+  if (mode == SIM_REG_ALLOC::TAKE_SCHED_WITH_LEAST_SPILLS)
     if (u_regAllocList->GetCost() < u_regAllocBest->GetCost()) {
       bestSched = lstSched;
 #ifdef IS_DEBUG
@@ -128,123 +128,147 @@ template class IndexedSetStat<int64_t>;
 template class IndexedSetStat<float>;
 
 // Definitions of the actual statistical records.
-IntDistributionStat nodeCount("Nodes per problem");
-IntDistributionStat nodesPerLength("Nodes per length");
-IntDistributionStat solutionTime("Solution time");
-IntDistributionStat
+thread_local IntDistributionStat nodeCount("Nodes per problem");
+thread_local IntDistributionStat nodesPerLength("Nodes per length");
+thread_local IntDistributionStat solutionTime("Solution time");
+thread_local IntDistributionStat
     solutionTimeForSolvedProblems("Solution time for solved problems");
 
-IntDistributionStat iterations("Iterations");
-IntDistributionStat enumerations("Enumerations");
-IntDistributionStat lengths("Lengths");
+thread_local IntDistributionStat iterations("Iterations");
+thread_local IntDistributionStat enumerations("Enumerations");
+thread_local IntDistributionStat lengths("Lengths");
 
-IntDistributionStat feasibleSchedulesPerLength("Feasible schedules per length");
-IntDistributionStat improvementsPerLength("Improvements per length");
+thread_local IntDistributionStat
+    feasibleSchedulesPerLength("Feasible schedules per length");
+thread_local IntDistributionStat
+    improvementsPerLength("Improvements per length");
 
-IntDistributionStat costChecksPerLength("Cost checks per length");
-IntDistributionStat costPruningsPerLength("Cost prunings per length");
-IntDistributionStat
+thread_local IntDistributionStat costChecksPerLength("Cost checks per length");
+thread_local IntDistributionStat
+    costPruningsPerLength("Cost prunings per length");
+thread_local IntDistributionStat
     dynamicLBIterationsPerPath("Dynamic LB iterations per path");
 
-IntDistributionStat problemSize("Problem size");
-IntDistributionStat solvedProblemSize("Solved problem size");
-IntDistributionStat unsolvedProblemSize("Unsolved problem size");
+thread_local IntDistributionStat problemSize("Problem size");
+thread_local IntDistributionStat solvedProblemSize("Solved problem size");
+thread_local IntDistributionStat unsolvedProblemSize("Unsolved problem size");
 
-IntDistributionStat traceCostLowerBound("Trace cost lower bound");
+thread_local IntDistributionStat traceCostLowerBound("Trace cost lower bound");
 
-IntDistributionStat traceHeuristicCost("Trace heuristic cost");
-IntDistributionStat traceOptimalCost("Trace optimal cost");
+thread_local IntDistributionStat traceHeuristicCost("Trace heuristic cost");
+thread_local IntDistributionStat traceOptimalCost("Trace optimal cost");
 
-IntDistributionStat
+thread_local IntDistributionStat
     traceHeuristicScheduleLength("Trace heuristic schedule length");
-IntDistributionStat traceOptimalScheduleLength("Trace optimal schedule length");
-
-IntDistributionStat regionBuildTime("Region build time");
-IntDistributionStat heuristicTime("Heuristic time");
-IntDistributionStat boundComputationTime("Bound computation time");
-IntDistributionStat enumerationTime("Enumeration time");
-IntDistributionStat
+thread_local IntDistributionStat
+    traceOptimalScheduleLength("Trace optimal schedule length");
+
+thread_local IntDistributionStat regionBuildTime("Region build time");
+thread_local IntDistributionStat heuristicTime("Heuristic time");
+thread_local IntDistributionStat boundComputationTime("Bound computation time");
+thread_local IntDistributionStat enumerationTime("Enumeration time");
+thread_local IntDistributionStat
     enumerationToHeuristicTimeRatio("Enumeration to heuristic time ratio");
-IntDistributionStat verificationTime("Verification time");
-
-IntDistributionStat historyEntriesPerIteration("History entries per iteration");
-IntDistributionStat historyListSize("History list size");
-IntDistributionStat maximumHistoryListSize("Maximum history list size");
-IntDistributionStat traversedHistoryListSize("Traversed history list size");
-IntDistributionStat historyDominationPosition("History domination position");
-IntDistributionStat historyDominationPositionToListSize(
+thread_local IntDistributionStat verificationTime("Verification time");
+
+thread_local IntDistributionStat
+    historyEntriesPerIteration("History entries per iteration");
+thread_local IntDistributionStat historyListSize("History list size");
+thread_local IntDistributionStat
+    maximumHistoryListSize("Maximum history list size");
+thread_local IntDistributionStat
+    traversedHistoryListSize("Traversed history list size");
+thread_local IntDistributionStat
+    historyDominationPosition("History domination position");
+thread_local IntDistributionStat historyDominationPositionToListSize(
     "History domination position to list size");
-IntDistributionStat
+thread_local IntDistributionStat
     historyTableInitializationTime("History table initialization time");
 
-IntDistributionStat scheduledLatency("Scheduled latency");
-
-TimeoutStat timeouts("Timeouts");
-
-IntStat perfectMatchCount("Perfect match count");
-IntStat positiveMismatchCount("Positive mismatch count");
-IntStat negativeMismatchCount("Negative mismatch count");
-IntStat positiveOptimalMismatchCount("Positive optimal mismatch count");
-IntStat negativeOptimalMismatchCount("Negative optimal mismatch count");
-IntStat positiveUpperBoundMismatchCount("Positive upper bound mismatch count");
-IntStat negativeUpperBoundMismatchCount("Negative upper bound mismatch count");
-IntStat positiveLowerBoundMismatchCount("Positive lower bound mismatch count");
-IntStat negativeLowerBoundMismatchCount("Negative lower bound mismatch count");
-
-IntStat signatureDominationTests("Signature domination tests");
-IntStat signatureMatches("Signature matches");
-IntStat signatureAliases("Signature aliases");
-IntStat subsetMatches("Subset matches");
-IntStat absoluteDominationHits("Absolute domination hits");
-IntStat positiveDominationHits("Positive domination hits");
-IntStat negativeDominationHits("Negative domination hits");
-IntStat dominationPruningHits("Domination pruning hits");
-IntStat invalidDominationHits("Invalid domination hits");
-
-IntStat stalls("Stalls");
-IntStat feasibilityTests("Feasibility tests");
-IntStat feasibilityHits("Feasibility hits");
-IntStat nodeSuperiorityInfeasibilityHits("Node superiority infeasibility hits");
-IntStat rangeTighteningInfeasibilityHits("Range tightening infeasibility hits");
-IntStat
+thread_local IntDistributionStat scheduledLatency("Scheduled latency");
+
+thread_local TimeoutStat timeouts("Timeouts");
+
+thread_local IntStat perfectMatchCount("Perfect match count");
+thread_local IntStat positiveMismatchCount("Positive mismatch count");
+thread_local IntStat negativeMismatchCount("Negative mismatch count");
+thread_local IntStat
+    positiveOptimalMismatchCount("Positive optimal mismatch count");
+thread_local IntStat
+    negativeOptimalMismatchCount("Negative optimal mismatch count");
+thread_local IntStat
+    positiveUpperBoundMismatchCount("Positive upper bound mismatch count");
+thread_local IntStat
+    negativeUpperBoundMismatchCount("Negative upper bound mismatch count");
+thread_local IntStat
+    positiveLowerBoundMismatchCount("Positive lower bound mismatch count");
+thread_local IntStat
+    negativeLowerBoundMismatchCount("Negative lower bound mismatch count");
+
+thread_local IntStat signatureDominationTests("Signature domination tests");
+thread_local IntStat signatureMatches("Signature matches");
+thread_local IntStat signatureAliases("Signature aliases");
+thread_local IntStat subsetMatches("Subset matches");
+thread_local IntStat absoluteDominationHits("Absolute domination hits");
+thread_local IntStat positiveDominationHits("Positive domination hits");
+thread_local IntStat negativeDominationHits("Negative domination hits");
+thread_local IntStat dominationPruningHits("Domination pruning hits");
+thread_local IntStat invalidDominationHits("Invalid domination hits");
+
+thread_local IntStat stalls("Stalls");
+thread_local IntStat feasibilityTests("Feasibility tests");
+thread_local IntStat feasibilityHits("Feasibility hits");
+thread_local IntStat
+    nodeSuperiorityInfeasibilityHits("Node superiority infeasibility hits");
+thread_local IntStat
+    rangeTighteningInfeasibilityHits("Range tightening infeasibility hits");
+thread_local IntStat
     historyDominationInfeasibilityHits("History domination infeasibility hits");
-IntStat
+thread_local IntStat
     relaxedSchedulingInfeasibilityHits("Relaxed scheduling infeasibility hits");
-IntStat slotCountInfeasibilityHits("Slot count infeasibility hits");
-IntStat forwardLBInfeasibilityHits("Forward LB infeasibility hits");
-IntStat backwardLBInfeasibilityHits("Backward LB infeasibility hits");
-
-IntStat invalidSchedules("Invalid schedules");
-
-IntStat totalInstructions("Total instructions");
-IntStat instructionsWithTighterFileLB("Instructions with tighter file LB");
-IntStat cyclesTightenedForTighterFileLB(
+thread_local IntStat
+    slotCountInfeasibilityHits("Slot count infeasibility hits");
+thread_local IntStat
+    forwardLBInfeasibilityHits("Forward LB infeasibility hits");
+thread_local IntStat
+    backwardLBInfeasibilityHits("Backward LB infeasibility hits");
+
+thread_local IntStat invalidSchedules("Invalid schedules");
+
+thread_local IntStat totalInstructions("Total instructions");
+thread_local IntStat
+    instructionsWithTighterFileLB("Instructions with tighter file LB");
+thread_local IntStat cyclesTightenedForTighterFileLB(
     "Cycles tightened for instructions with tighter file LB");
-IntStat
+thread_local IntStat
     instructionsWithTighterRelaxedLB("Instructions with tighter relaxed LB");
-IntStat cyclesTightenedForTighterRelaxedLB(
+thread_local IntStat cyclesTightenedForTighterRelaxedLB(
     "Cycles tightened for instructions with tighter relaxed LB");
-IntStat instructionsWithEqualLB("Instructions with equal LB");
-IntStat instructionsWithTighterFileUB("Instructions with tighter file UB");
-IntStat cyclesTightenedForTighterFileUB(
+thread_local IntStat instructionsWithEqualLB("Instructions with equal LB");
+thread_local IntStat
+    instructionsWithTighterFileUB("Instructions with tighter file UB");
+thread_local IntStat cyclesTightenedForTighterFileUB(
     "Cycles tightened for instructions with tighter file UB");
-IntStat
+thread_local IntStat
     instructionsWithTighterRelaxedUB("Instructions with tighter relaxed UB");
-IntStat cyclesTightenedForTighterRelaxedUB(
+thread_local IntStat cyclesTightenedForTighterRelaxedUB(
     "Cycles tightened for instructions with tighter relaxed UB");
-IntStat instructionsWithEqualUB("Instructions with equal UB");
+thread_local IntStat instructionsWithEqualUB("Instructions with equal UB");
 
-IntStat maxReadyListSize("Max ready list size");
+thread_local IntStat maxReadyListSize("Max ready list size");
 
-IntStat negativeNodeDominationHits("Negative node domination hits");
+thread_local IntStat
+    negativeNodeDominationHits("Negative node domination hits");
 
-IndexedIntStat instructionTypeCounts("Instruction type counts");
-IndexedIntSetStat instructionTypeLatencies("Instruction type latencies");
-IndexedIntSetStat dependenceTypeLatencies("Dependence type latencies");
+thread_local IndexedIntStat instructionTypeCounts("Instruction type counts");
+thread_local IndexedIntSetStat
+    instructionTypeLatencies("Instruction type latencies");
+thread_local IndexedIntSetStat
+    dependenceTypeLatencies("Dependence type latencies");
 
-IntStat
+thread_local IntStat
     legalListSchedulerInstructionHits("Legal list scheduler instruction hits");
-IntStat illegalListSchedulerInstructionHits(
+thread_local IntStat illegalListSchedulerInstructionHits(
     "Illegal list scheduler instruction hits");
 }
 
@@ -2,6 +2,6 @@
 #include <chrono>
 
 namespace opt_sched {
-std::chrono::high_resolution_clock::time_point Utilities::startTime =
+const std::chrono::high_resolution_clock::time_point Utilities::startTime =
     std::chrono::high_resolution_clock::now();
 }
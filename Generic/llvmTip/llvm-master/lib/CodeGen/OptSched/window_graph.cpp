@@ -0,0 +1,241 @@
+#include "llvm/CodeGen/OptSched/basic/window_graph.h"
+#include "llvm/CodeGen/OptSched/generic/logger.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace opt_sched {
+
+WindowDataDepGraph::WindowDataDepGraph(DataDepGraph *fullGraph,
+                                       MachineModel *machMdl,
+                                       RegisterFile fullRegFiles[],
+                                       const std::vector<InstCount> &order,
+                                       const std::vector<InstCount> &cycles,
+                                       InstCount bgn, InstCount end,
+                                       int wndwNum)
+    : DataDepGraph(machMdl, LTP_ROUGH, GraphTransTypes()),
+      fullGraph_(fullGraph) {
+  InstCount wndwInstCnt = end - bgn;
+  dagFileFormat_ = DFF_BB;
+  isTraceFormat_ = false;
+  includesNonStandardBlock_ = false;
+  includesUnsupported_ = false;
+  includesCall_ = fullGraph->IncludesCall();
+  includesUnpipelined_ = fullGraph->IncludesUnpipelined();
+  weight_ = fullGraph->GetWeight();
+
+  std::snprintf(dagID_, MAX_NAMESIZE, "%s:w%d", fullGraph->GetDagID(),
+                wndwNum);
+  std::snprintf(compiler_, MAX_NAMESIZE, "OptSched");
+
+  // The extra 2 are for the artifical root and leaf nodes.
+  AllocArrays_(wndwInstCnt + 2);
+
+  std::vector<InstCount> wndwInstNums(fullGraph->GetInstCnt(), INVALID_VALUE);
+  fullInstNums_.assign(order.begin() + bgn, order.begin() + end);
+  for (InstCount i = 0; i < wndwInstCnt; i++)
+    wndwInstNums[fullInstNums_[i]] = i;
+
+  // Create nodes.
+  for (InstCount i = 0; i < wndwInstCnt; i++) {
+    SchedInstruction *fullInst = fullGraph->GetInstByIndx(fullInstNums_[i]);
+    CreateNode_(i, fullInst->GetName(), fullInst->GetInstType(),
+                fullInst->GetOpCode(),
+                i,  // nodeID
+                i,  // fileSchedOrder
+                i,  // fileSchedCycle
+                0,  // fileInstLwrBound
+                0,  // fileInstUprBound
+                0); // blkNum
+  }
+
+  // The window starts in the cycle of its first instruction and ends after
+  // the cycle of its last one.
+  InstCount frstCycle = cycles[order[bgn]];
+  InstCount lastCycle = cycles[order[end - 1]];
+
+  // Create the edges between the instructions of the window. The edges that
+  // cross the boundaries of the window become the latencies of the edges from
+  // the root and to the leaf: the cycle relative to the start of the window
+  // before which an instruction cannot start, given its predecessors before
+  // the window, and the cycles that must follow an instruction before the end
+  // of the window, given its successors after the window. Both are taken from
+  // the cycles of the instructions outside the window in the schedule that
+  // the order comes from.
+  std::vector<InstCount> rlsTimes(wndwInstCnt, 0);
+  std::vector<InstCount> tailTimes(wndwInstCnt, 0);
+  for (InstCount i = 0; i < wndwInstCnt; i++) {
+    SchedInstruction *fullInst = fullGraph->GetInstByIndx(fullInstNums_[i]);
+    UDT_GLABEL ltncy;
+    DependenceType depType;
+    for (SchedInstruction *scsr = fullInst->GetFrstScsr(NULL, &ltncy, &depType);
+         scsr != NULL; scsr = fullInst->GetNxtScsr(NULL, &ltncy, &depType)) {
+      InstCount scsrNum = wndwInstNums[scsr->GetNum()];
+      if (scsrNum != INVALID_VALUE) {
+        CreateEdge_(i, scsrNum, ltncy, depType);
+      } else {
+        InstCount gap = cycles[scsr->GetNum()] - lastCycle - 1;
+        tailTimes[i] = std::max(tailTimes[i], (InstCount)ltncy - gap);
+      }
+    }
+
+    for (SchedInstruction *prdcsr = fullInst->GetFrstPrdcsr(NULL, &ltncy);
+         prdcsr != NULL; prdcsr = fullInst->GetNxtPrdcsr(NULL, &ltncy)) {
+      if (wndwInstNums[prdcsr->GetNum()] == INVALID_VALUE) {
+        InstCount rlsTime = cycles[prdcsr->GetNum()] + ltncy - frstCycle;
+        rlsTimes[i] = std::max(rlsTimes[i], rlsTime);
+      }
+    }
+  }
+
+  // Create artificial root.
+  InstCount rootNum = wndwInstCnt;
+  SchedInstruction *fullRoot = fullGraph->GetRootInst();
+  root_ = CreateNode_(rootNum, fullRoot->GetName(), fullRoot->GetInstType(),
+                      fullRoot->GetOpCode(),
+                      rootNum, // nodeID
+                      rootNum, // fileSchedOrder
+                      rootNum, // fileSchedCycle
+                      0,       // fileInstLwrBound
+                      0,       // fileInstUprBound
+                      0);      // blkNum
+  for (InstCount i = 0; i < wndwInstCnt; i++) {
+    if (insts_[i]->GetPrdcsrCnt() == 0 || rlsTimes[i] > 0)
+      CreateEdge_(rootNum, i, rlsTimes[i], DEP_OTHER);
+  }
+
+  // Create artificial leaf.
+  InstCount leafNum = wndwInstCnt + 1;
+  SchedInstruction *fullLeaf = fullGraph->GetLeafInst();
+  CreateNode_(leafNum, fullLeaf->GetName(), fullLeaf->GetInstType(),
+              fullLeaf->GetOpCode(),
+              leafNum, // nodeID
+              leafNum, // fileSchedOrder
+              leafNum, // fileSchedCycle
+              0,       // fileInstLwrBound
+              0,       // fileInstUprBound
+              0);      // blkNum
+  for (InstCount i = 0; i < wndwInstCnt; i++) {
+    if (insts_[i]->GetScsrCnt() == 0 || tailTimes[i] > 0)
+      CreateEdge_(i, leafNum, tailTimes[i], DEP_OTHER);
+  }
+  AdjstFileSchedCycles_();
+
+  if (Finish_() == RES_ERROR)
+    Logger::Fatal("DAG Finish_() failed.");
+
+  FindRegs_(fullRegFiles, order, bgn, end);
+}
+
+InstCount WindowDataDepGraph::GetFullInstNum(InstCount instNum) const {
+  if (instNum >= (InstCount)fullInstNums_.size())
+    return INVALID_VALUE;
+  return fullInstNums_[instNum];
+}
+
+void WindowDataDepGraph::FindRegs_(RegisterFile fullRegFiles[],
+                                   const std::vector<InstCount> &order,
+                                   InstCount bgn, InstCount end) {
+  std::vector<InstCount> pos(order.size());
+  for (InstCount i = 0; i < (InstCount)order.size(); i++)
+    pos[order[i]] = i;
+
+  regs_.resize(machMdl_->GetRegTypeCnt());
+  for (int16_t i = 0; i < machMdl_->GetRegTypeCnt(); i++) {
+    for (int j = 0; j < fullRegFiles[i].GetRegCnt(); j++) {
+      Register *reg = fullRegFiles[i].GetReg(j);
+      bool isDefdBfr = false, isDefdIn = false;
+      bool isUsedIn = false, isUsedAftr = false;
+
+      for (const SchedInstruction *inst : reg->GetDefList()) {
+        InstCount instPos = pos[inst->GetNum()];
+        if (instPos < bgn)
+          isDefdBfr = true;
+        else if (instPos < end)
+          isDefdIn = true;
+      }
+
+      for (const SchedInstruction *inst : reg->GetUseList()) {
+        InstCount instPos = pos[inst->GetNum()];
+        if (instPos >= end)
+          isUsedAftr = true;
+        else if (instPos >= bgn)
+          isUsedIn = true;
+      }
+
+      // A register used in the window but not defined in it comes from
+      // outside, as does a register that is live across the window.
+      bool isLiveIn =
+          (isDefdBfr && (isUsedIn || isUsedAftr)) || (isUsedIn && !isDefdIn);
+      if (!isDefdIn && !isUsedIn && !isLiveIn)
+        continue;
+      bool isLiveOut = isUsedAftr;
+
+      wndwRegNums_[reg] = regs_[i].size();
+      regs_[i].push_back({reg, isLiveIn, isLiveOut});
+    }
+  }
+}
+
+Register *WindowDataDepGraph::GetWndwReg_(RegisterFile regFiles[],
+                                          const Register *fullReg) {
+  std::map<const Register *, int>::const_iterator it =
+      wndwRegNums_.find(fullReg);
+  assert(it != wndwRegNums_.end());
+  return regFiles[fullReg->GetType()].GetReg(it->second);
+}
+
+void WindowDataDepGraph::CountDefs(RegisterFile regFiles[]) {
+  for (int16_t i = 0; i < machMdl_->GetRegTypeCnt(); i++)
+    regFiles[i].SetRegCnt(regs_[i].size());
+}
+
+void WindowDataDepGraph::AddDefsAndUses(RegisterFile regFiles[]) {
+  InstCount wndwInstCnt = fullInstNums_.size();
+  SchedInstruction *root = insts_[wndwInstCnt];
+  SchedInstruction *leaf = insts_[wndwInstCnt + 1];
+
+  for (int16_t i = 0; i < machMdl_->GetRegTypeCnt(); i++) {
+    for (int j = 0; j < (int)regs_[i].size(); j++) {
+      const WndwReg &wndwReg = regs_[i][j];
+      Register *reg = regFiles[i].GetReg(j);
+      reg->SetWght(wndwReg.fullReg->GetWght());
+      reg->SetPhysicalNumber(wndwReg.fullReg->GetPhysicalNumber());
+
+      if (wndwReg.isLiveIn) {
+        root->AddDef(reg);
+        reg->AddDef(root);
+        reg->SetIsLiveIn(true);
+      }
+
+      if (wndwReg.isLiveOut) {
+        leaf->AddUse(reg);
+        reg->AddUse(leaf);
+        reg->SetIsLiveOut(true);
+      }
+    }
+  }
+
+  for (InstCount i = 0; i < wndwInstCnt; i++) {
+    SchedInstruction *inst = insts_[i];
+    SchedInstruction *fullInst = fullGraph_->GetInstByIndx(fullInstNums_[i]);
+    Register **regs;
+
+    int16_t defCnt = fullInst->GetDefs(regs);
+    for (int16_t j = 0; j < defCnt; j++) {
+      Register *reg = GetWndwReg_(regFiles, regs[j]);
+      inst->AddDef(reg);
+      reg->AddDef(inst);
+    }
+
+    int16_t useCnt = fullInst->GetUses(regs);
+    for (int16_t j = 0; j < useCnt; j++) {
+      Register *reg = GetWndwReg_(regFiles, regs[j]);
+      if (!inst->FindUse(reg)) {
+        inst->AddUse(reg);
+        reg->AddUse(inst);
+      }
+    }
+  }
+}
+
+} // end namespace opt_sched
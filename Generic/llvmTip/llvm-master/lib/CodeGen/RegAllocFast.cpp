@@ -52,7 +52,7 @@ int OPTSCHED_gNumBlockBoundaryStoresBB = 0;
 // The number of loads from live-in registers.
 int OPTSCHED_gNumLiveInLoadsBB = 0;
 // Does the OptScheduler want us to print spill info.
-extern bool OPTSCHED_gPrintSpills;
+extern thread_local bool OPTSCHED_gPrintSpills;
 
 static RegisterRegAlloc fastRegAlloc("fast", "fast register allocator",
                                      createFastRegisterAllocator);
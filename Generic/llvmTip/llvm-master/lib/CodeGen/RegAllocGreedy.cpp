@@ -2608,7 +2608,7 @@ extern int NumSpilledRegs;
 extern int gNumSpilledRanges;
 extern int gNumSpills;
 extern int gNumWeightedSpills;
-extern bool OPTSCHED_gPrintSpills;
+extern thread_local bool OPTSCHED_gPrintSpills;
 extern int gNumReloads;
 extern int gNumSpillsNoCleanup;
 extern int gNumReloadsNoCleanup;
@@ -0,0 +1,371 @@
+//===- optsched-driver.cpp - Run OptSched on DAG files --------------------===//
+//
+// Runs the OptSched branch-and-bound scheduler on scheduling regions that were
+// written to DAG files (e.g. with OUTPUT_DAGS), without going through a
+// compiler. Every DAG in the input files, or only the ones selected with -dag,
+// is scheduled with the settings of the given sched.ini and machine model, and
+// one line of results is printed per DAG.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/CodeGen/OptSched/OptSchedSettings.h"
+#include "llvm/CodeGen/OptSched/basic/data_dep.h"
+#include "llvm/CodeGen/OptSched/basic/machine_model.h"
+#include "llvm/CodeGen/OptSched/basic/register.h"
+#include "llvm/CodeGen/OptSched/generic/buffers.h"
+#include "llvm/CodeGen/OptSched/generic/config.h"
+#include "llvm/CodeGen/OptSched/generic/logger.h"
+#include "llvm/CodeGen/OptSched/generic/utilities.h"
+#include "llvm/CodeGen/OptSched/sched_region/sched_region.h"
+#include "llvm/CodeGen/OptSched/spill/bb_spill.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace llvm;
+using namespace opt_sched;
+
+static cl::list<std::string> InputFiles(cl::Positional, cl::OneOrMore,
+                                        cl::desc("<DAG files>"));
+
+static cl::opt<std::string>
+    OptSchedCfg("optsched-cfg",
+                cl::desc("Path to OptSchedCfg directory holding sched.ini "
+                         "and machine_model.cfg"),
+                cl::init(""));
+
+static cl::opt<std::string>
+    SchedIni("sched-ini", cl::desc("Path to sched.ini (overrides the one in "
+                                   "-optsched-cfg)"),
+             cl::init(""));
+
+static cl::opt<std::string>
+    MachineModelFile("machine-model",
+                     cl::desc("Path to the machine model (overrides the one "
+                              "in -optsched-cfg)"),
+                     cl::init(""));
+
+static cl::list<std::string>
+    DagIDs("dag", cl::ZeroOrMore,
+           cl::desc("Schedule only the DAG with the given ID. May be given "
+                    "more than once"));
+
+static cl::opt<unsigned>
+    ParseThreads("parse-threads",
+                 cl::desc("Number of DAGs parsed concurrently ahead of "
+                          "scheduling them"),
+                 cl::init(1));
+
+// The seed of the random numbers: RANDOM_SEED, or the time the driver started
+// if that is 0. Each DAG offsets it by its index in its file.
+static int RandomSeed;
+
+namespace {
+
+// A data dependence graph read from a DAG file. DAG files do not record
+// registers, so one virtual register is made up for every instruction that
+// has data successors, as was done for the Sun compiler DAGs.
+class FileDataDepGraph : public DataDepGraph {
+public:
+  FileDataDepGraph(MachineModel *machMdl, LATENCY_PRECISION ltncyPrcsn,
+                   GraphTransTypes graphTransTypes)
+      : DataDepGraph(machMdl, ltncyPrcsn, graphTransTypes) {}
+  ~FileDataDepGraph() {}
+
+  void CountDefs(RegisterFile regFiles[]);
+  void AddDefsAndUses(RegisterFile regFiles[]);
+
+private:
+  // Returns the instruction's register type if it defines a register, or
+  // INVALID_VALUE otherwise.
+  int16_t GetDefRegType_(SchedInstruction *inst);
+};
+
+
+} // end anonymous namespace
+
+int16_t FileDataDepGraph::GetDefRegType_(SchedInstruction *inst) {
+  UDT_GLABEL ltncy;
+  DependenceType depType;
+  for (SchedInstruction *scsr = inst->GetFrstScsr(NULL, &ltncy, &depType);
+       scsr != NULL; scsr = inst->GetNxtScsr(NULL, &ltncy, &depType)) {
+    if (depType == DEP_DATA) {
+      if (machMdl_->GetRegTypeCnt() > 1 &&
+          machMdl_->IsFloat(inst->GetInstType()))
+        return 1;
+      return 0;
+    }
+  }
+  return INVALID_VALUE;
+}
+
+void FileDataDepGraph::CountDefs(RegisterFile regFiles[]) {
+  std::vector<int> regDefCounts(machMdl_->GetRegTypeCnt(), 0);
+
+  if (machMdl_->GetRegTypeCnt() > 0) {
+    for (InstCount i = 0; i < instCnt_; i++) {
+      int16_t regType = GetDefRegType_(insts_[i]);
+      if (regType != INVALID_VALUE)
+        regDefCounts[regType]++;
+    }
+  }
+
+  for (int16_t i = 0; i < machMdl_->GetRegTypeCnt(); i++) {
+    regFiles[i].SetRegCnt(regDefCounts[i]);
+  }
+}
+
+void FileDataDepGraph::AddDefsAndUses(RegisterFile regFiles[]) {
+  std::vector<int> regIndices(machMdl_->GetRegTypeCnt(), 0);
+
+  if (machMdl_->GetRegTypeCnt() == 0)
+    return;
+
+  for (InstCount i = 0; i < instCnt_; i++) {
+    SchedInstruction *inst = insts_[i];
+    int16_t regType = GetDefRegType_(inst);
+    if (regType == INVALID_VALUE)
+      continue;
+
+    Register *reg = regFiles[regType].GetReg(regIndices[regType]++);
+    inst->AddDef(reg);
+    reg->AddDef(inst);
+
+    UDT_GLABEL ltncy;
+    DependenceType depType;
+    for (SchedInstruction *scsr = inst->GetFrstScsr(NULL, &ltncy, &depType);
+         scsr != NULL; scsr = inst->GetNxtScsr(NULL, &ltncy, &depType)) {
+      if (depType == DEP_DATA && !scsr->FindUse(reg)) {
+        scsr->AddUse(reg);
+        reg->AddUse(scsr);
+      }
+    }
+  }
+}
+
+// Adds the instruction types that the LLVM machine model wrapper adds to every
+// machine model, so that DAGs dumped by the compiler can be read back.
+static void addLLVMInstTypes(MachineModel &model) {
+  static const char *const typeNames[] = {"Default", "artificial"};
+
+  for (const char *typeName : typeNames) {
+    if (model.GetInstTypeByName(typeName) != INVALID_INST_TYPE)
+      continue;
+
+    InstTypeInfo instType;
+    instType.name = typeName;
+    instType.isCntxtDep = false;
+    instType.issuType = 0;
+    instType.ltncy = 1;
+    instType.pipelined = true;
+    instType.sprtd = true;
+    instType.blksCycle = false;
+    model.AddInstType(instType);
+  }
+}
+
+static const char *getResultName(FUNC_RESULT rslt, bool isEasy,
+                                 bool isSrchCut) {
+  switch (rslt) {
+  case RES_SUCCESS:
+    return isEasy ? "easy" : "optimal";
+  case RES_TIMEOUT:
+    return isSrchCut ? "beam" : "timeout";
+  case RES_FAIL:
+    return "fail";
+  default:
+    return "error";
+  }
+}
+
+// Schedules one DAG, the given one of its file, and prints its results.
+// Returns false if the DAG could not be scheduled.
+static bool scheduleDag(FileDataDepGraph &dag, int dagIndx, MachineModel &model,
+                        const OptSchedSettings &settings) {
+  InstCount instCnt = dag.GetInstCnt();
+  // Regions that are too big are still scheduled if they can be enumerated in
+  // windows.
+  bool isTooBig = instCnt > settings.maxDagSize && settings.windowSize == 0;
+  if (instCnt < settings.minDagSize || isTooBig ||
+      dag.GetWeight() < settings.minDagWeight) {
+    outs() << format("%-40s %6d skipped\n", dag.GetDagID(), instCnt);
+    return true;
+  }
+
+  Milliseconds rgnTimeout = settings.regionTimeout;
+  Milliseconds lngthTimeout = settings.lengthTimeout;
+  if (settings.isTimeoutPerInstruction) {
+    rgnTimeout *= instCnt;
+    lngthTimeout *= instCnt;
+  }
+
+  std::unique_ptr<SchedRegion> region(new BBWithSpill(
+      &model, &dag, 0, settings.histTableHashBits,
+      settings.lowerBoundAlgorithm, settings.heuristicPriorities,
+      settings.enumPriorities, settings.verifySchedule, settings.prune,
+      settings.schedForRPOnly, settings.enumerateStalls,
+      settings.spillCostFactor, settings.spillCostFunction,
+      settings.checkSpillCostSum, settings.checkConflicts, settings.fixLiveIn,
+      settings.fixLiveOut, settings.maxSpillCost));
+  region->SetRndmSeed(RandomSeed + dagIndx);
+  region->SetHurstcPortfolio(settings.heuristicPortfolio,
+                             settings.heuristicPortfolioRandomRuns);
+  region->SetPrintSpills(settings.printSpills == FUNC_SELECTION::ALL);
+  region->BuildFromFile();
+
+  bool isEasy = false;
+  InstCount bestCost = 0;
+  InstCount bestSchedLngth = 0;
+  InstCount hurstcCost = 0;
+  InstCount hurstcSchedLngth = 0;
+  InstSchedule *sched = NULL;
+
+  FUNC_RESULT rslt = region->FindOptimalSchedule(
+      settings.useFileBounds, rgnTimeout, lngthTimeout, isEasy, bestCost,
+      bestSchedLngth, hurstcCost, hurstcSchedLngth, sched,
+      settings.filterByPerp, settings.blocksToKeep);
+  Milliseconds time = Utilities::GetProcessorTime();
+
+  outs() << format("%-40s %6d %8d %6d %8d %6d %-8s %8lld\n", dag.GetDagID(),
+                   instCnt, bestCost, bestSchedLngth, hurstcCost,
+                   hurstcSchedLngth,
+                   getResultName(rslt, isEasy, region->WasSrchCut()),
+                   (long long)time);
+
+  if (sched != NULL)
+    delete sched;
+
+  return rslt == RES_SUCCESS || rslt == RES_TIMEOUT;
+}
+
+// Schedules the selected DAGs in a file. Returns the number of DAGs that could
+// not be read or scheduled.
+static int scheduleFile(const std::string &path, MachineModel &model,
+                        const OptSchedSettings &settings) {
+  DagFileMap dagFile;
+  if (dagFile.Load(path.c_str()) != RES_SUCCESS) {
+    Logger::Error("Cannot open DAG file %s.", path.c_str());
+    return 1;
+  }
+
+  // The file is indexed when it is loaded, so the DAGs that are not selected
+  // are never parsed.
+  std::vector<int> dagIndxs;
+  for (int i = 0; i < dagFile.GetDagCnt(); i++) {
+    if (DagIDs.empty() || std::find(DagIDs.begin(), DagIDs.end(),
+                                    dagFile.GetDagID(i)) != DagIDs.end())
+      dagIndxs.push_back(i);
+  }
+
+  // The DAGs are parsed in batches, one per thread, and then scheduled one at
+  // a time in the order of the file.
+  size_t batchSize = std::max(1u, (unsigned)ParseThreads);
+  int failCnt = 0;
+  for (size_t strt = 0; strt < dagIndxs.size(); strt += batchSize) {
+    size_t cnt = std::min(batchSize, dagIndxs.size() - strt);
+    std::vector<std::unique_ptr<FileDataDepGraph>> dags(cnt);
+    std::vector<FUNC_RESULT> rslts(cnt);
+
+    auto parseDag = [&](size_t i) {
+      SpecsBuffer buf;
+      bool endOfFileReached = false;
+      dags[i].reset(new FileDataDepGraph(&model, settings.latencyPrecision,
+                                         settings.graphTransTypes));
+      rslts[i] = dagFile.SetBuf(dagIndxs[strt + i], buf);
+      if (rslts[i] == RES_SUCCESS)
+        rslts[i] = dags[i]->ReadFrmFile(&buf, endOfFileReached);
+    };
+
+    std::vector<std::thread> parsers;
+    for (size_t i = 1; i < cnt; i++)
+      parsers.emplace_back(parseDag, i);
+    parseDag(0);
+    for (std::thread &parser : parsers)
+      parser.join();
+
+    for (size_t i = 0; i < cnt; i++) {
+      // Each DAG is parsed on its own, so a bad one does not affect the rest.
+      if (rslts[i] != RES_SUCCESS) {
+        Logger::Error("Invalid DAG %s in %s.",
+                      dagFile.GetDagID(dagIndxs[strt + i]).c_str(),
+                      path.c_str());
+        failCnt++;
+        continue;
+      }
+
+      if (!scheduleDag(*dags[i], dagIndxs[strt + i], model, settings))
+        failCnt++;
+    }
+  }
+
+  return failCnt;
+}
+
+int main(int argc, char **argv) {
+  sys::PrintStackTraceOnErrorSignal(argv[0]);
+  PrettyStackTraceProgram X(argc, argv);
+
+  llvm_shutdown_obj Y; // Call llvm_shutdown() on exit.
+  cl::ParseCommandLineOptions(argc, argv, "OptSched DAG file scheduler\n");
+
+  SmallString<128> schedIniPath(SchedIni);
+  if (SchedIni.empty()) {
+    schedIniPath = OptSchedCfg;
+    sys::path::append(schedIniPath, "sched.ini");
+  }
+  SmallString<128> modelPath(MachineModelFile);
+  if (MachineModelFile.empty()) {
+    modelPath = OptSchedCfg;
+    sys::path::append(modelPath, "machine_model.cfg");
+  }
+
+  // Simulated register allocation relies on the artificial entry and exit
+  // instructions that the LLVM pass adds to each region, and DAG files lack
+  // them. Later settings override earlier ones, so turn it off after the
+  // contents of sched.ini.
+  std::ifstream schedIniFile(schedIniPath.c_str());
+  if (!schedIniFile) {
+    errs() << argv[0] << ": cannot open " << schedIniPath << '\n';
+    return 1;
+  }
+  std::stringstream schedIni;
+  schedIni << schedIniFile.rdbuf() << "\nSIMULATE_REGISTER_ALLOCATION NO\n";
+  SchedulerOptions::getInstance().Load(schedIni);
+  const OptSchedSettings &settings = OptSchedSettings::parseLoaded();
+  RandomSeed = settings.randomSeed;
+  if (RandomSeed == 0)
+    RandomSeed = time(NULL);
+
+  MachineModel model(modelPath.str().str());
+  addLLVMInstTypes(model);
+
+  // The columns are: DAG ID, instruction count, best cost and length,
+  // heuristic cost and length, result and scheduling time.
+  outs() << left_justify("dag", 40) << ' ' << right_justify("insts", 6) << ' '
+         << right_justify("cost", 8) << ' ' << right_justify("length", 6) << ' '
+         << right_justify("h_cost", 8) << ' ' << right_justify("h_len", 6)
+         << ' ' << left_justify("result", 8) << ' '
+         << right_justify("time_ms", 8) << '\n';
+
+  int failCnt = 0;
+  for (const std::string &path : InputFiles) {
+    failCnt += scheduleFile(path, model, settings);
+  }
+
+  return failCnt == 0 ? 0 : 1;
+}